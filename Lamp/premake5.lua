@@ -97,6 +97,7 @@ project "Lamp"
 				"LP_DEBUG", 
 				"LP_ENABLE_ASSERTS",
 				"LP_ENABLE_VALIDATION",
+				"LP_ENABLE_SYNC_VALIDATION",
 				"LP_ENABLE_PROFILING"
 			}
 			runtime "Debug"
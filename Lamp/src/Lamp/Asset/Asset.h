@@ -17,7 +17,8 @@ namespace Lamp
 		None = 0,
 		Missing = BIT(0),
 		Invalid = BIT(1),
-		Queued = BIT(2)
+		Queued = BIT(2),
+		RetainCPUData = BIT(3) // CPU copies of uploaded data are kept, e.g. for picking, physics cooking or CPU queries
 	};
 
 	enum class AssetType : uint16_t
@@ -37,6 +38,27 @@ namespace Lamp
 		Scene
 	};
 
+	inline const char* GetAssetTypeName(AssetType type)
+	{
+		switch (type)
+		{
+			case AssetType::Mesh: return "Mesh";
+			case AssetType::MeshSource: return "Mesh Source";
+			case AssetType::Animation: return "Animation";
+			case AssetType::Skeleton: return "Skeleton";
+			case AssetType::Texture: return "Texture";
+			case AssetType::Material: return "Material";
+			case AssetType::Shader: return "Shader";
+			case AssetType::ShaderSource: return "Shader Source";
+			case AssetType::RenderPipeline: return "Render Pipeline";
+			case AssetType::RenderPass: return "Render Pass";
+			case AssetType::RenderGraph: return "Render Graph";
+			case AssetType::Scene: return "Scene";
+		}
+
+		return "None";
+	}
+
 	inline static std::unordered_map<std::string, AssetType> s_assetExtensionsMap =
 	{
 		{ ".fbx", AssetType::MeshSource },
@@ -103,6 +125,8 @@ namespace Lamp
 
 		static AssetType GetStaticType() { return AssetType::None; }
 		virtual AssetType GetType() { return AssetType::None; };
+		virtual uint64_t GetCPUMemorySize() const { return sizeof(Asset); } // used by the asset cache budget
+		virtual uint64_t ReleaseCPUData() { return 0; } // releases CPU copies of data uploaded to the GPU, returns the freed bytes
 
 		uint16_t flags = (uint16_t)AssetFlag::None;
 		AssetHandle handle;
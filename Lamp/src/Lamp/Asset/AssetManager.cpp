@@ -11,6 +11,8 @@
 #include "Lamp/Asset/Importers/RenderGraphImporter.h"
 #include "Lamp/Asset/Importers/SceneImporter.h"
 
+#include "Lamp/Asset/ResidencyManager.h"
+
 #include "Lamp/Core/Base.h"
 #include "Lamp/Log/Log.h"
 
@@ -19,15 +21,21 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <optional>
+
 namespace Lamp
 {
 	static const std::filesystem::path s_assetRegistryPath = "Assets/AssetRegistry.lpreg";
+	static constexpr uint64_t DEFAULT_CACHE_BUDGET = 1024ull * 1024ull * 1024ull;
 
 	AssetManager::AssetManager()
 	{
 		LP_CORE_ASSERT(!s_instance, "AssetManager already exists!");
 		s_instance = this;
 
+		m_mainThreadId = std::this_thread::get_id();
+		m_cacheBudget = DEFAULT_CACHE_BUDGET;
+
 		Initialize();
 	}
 
@@ -54,12 +62,18 @@ namespace Lamp
 
 		LoadAssetRegistry();
 
+		m_isThreadRunning = true;
 		m_loadThread = std::thread(&AssetManager::Thread_LoadAsset, this);
 	}
 
 	void AssetManager::Shutdown()
 	{
-		m_isThreadRunning = false;
+		{
+			std::scoped_lock lock(m_loadMutex);
+			m_isThreadRunning = false;
+		}
+
+		m_threadConditionVar.notify_all();
 		m_loadThread.join();
 
 		SaveAssetRegistry();
@@ -69,16 +83,14 @@ namespace Lamp
 
 	void AssetManager::LoadAsset(const std::filesystem::path& path, Ref<Asset>& asset)
 	{
-		AssetHandle handle = Asset::Null();
-		if (m_assetRegistry.find(path) != m_assetRegistry.end())
-		{
-			handle = m_assetRegistry.at(path);
-		}
-
-		if (handle != Asset::Null() && m_assetCache.find(handle) != m_assetCache.end())
+		const AssetHandle handle = FindHandle(path);
+		if (handle != Asset::Null())
 		{
-			asset = m_assetCache[handle];
-			return;
+			if (Ref<Asset> cachedAsset = GetCachedAsset(handle))
+			{
+				asset = cachedAsset;
+				return;
+			}
 		}
 
 		const auto type = GetAssetTypeFromPath(path);
@@ -100,24 +112,22 @@ namespace Lamp
 		}
 		else
 		{
-			std::scoped_lock<std::mutex> lock(m_loadMutex);
+			std::unique_lock lock(m_registryMutex);
 			m_assetRegistry.emplace(path, asset->handle);
 		}
 
 		asset->path = path;
 
-		{
-			std::scoped_lock<std::mutex> lock(m_loadMutex);
-			m_assetCache.emplace(asset->handle, asset);
-		}
+		ReleaseCPUData(asset, type);
+		CacheAsset(asset);
+		ResidencyManager::Register(asset);
 	}
 
 	void AssetManager::LoadAsset(AssetHandle assetHandle, Ref<Asset>& asset)
 	{
-		auto it = m_assetCache.find(assetHandle);
-		if (it != m_assetCache.end())
+		if (Ref<Asset> cachedAsset = GetCachedAsset(assetHandle))
 		{
-			asset = it->second;
+			asset = cachedAsset;
 			return;
 		}
 
@@ -142,16 +152,12 @@ namespace Lamp
 			return;
 		}
 
-		if (m_assetRegistry.find(asset->path) == m_assetRegistry.end())
 		{
-			m_assetRegistry.emplace(asset->path, asset->handle);
-		}
-
-		if (m_assetCache.find(asset->handle) == m_assetCache.end())
-		{
-			m_assetCache.emplace(asset->handle, asset);
+			std::unique_lock lock(m_registryMutex);
+			m_assetRegistry.try_emplace(asset->path, asset->handle);
 		}
 
+		CacheAsset(asset);
 		m_assetImporters[asset->GetType()]->Save(asset);
 	}
 
@@ -161,6 +167,7 @@ namespace Lamp
 
 		const std::filesystem::path newPath = targetDir / asset->path.filename();
 
+		std::unique_lock lock(m_registryMutex);
 		m_assetRegistry.erase(asset->path);
 		asset->path = newPath;
 
@@ -169,10 +176,9 @@ namespace Lamp
 
 	Ref<Asset> AssetManager::GetAssetRaw(AssetHandle assetHandle)
 	{
-		auto it = m_assetCache.find(assetHandle);
-		if (it != m_assetCache.end())
+		if (Ref<Asset> cachedAsset = GetCachedAsset(assetHandle))
 		{
-			return it->second;
+			return cachedAsset;
 		}
 
 		Ref<Asset> asset;
@@ -204,16 +210,13 @@ namespace Lamp
 
 	AssetHandle AssetManager::GetAssetHandleFromPath(const std::filesystem::path& path)
 	{
-		auto it = m_assetRegistry.find(path);
-		if (it == m_assetRegistry.end())
-		{
-			m_assetRegistry[path] = AssetHandle();
-		}
-		return m_assetRegistry[path];
+		std::unique_lock lock(m_registryMutex);
+		return m_assetRegistry.try_emplace(path, AssetHandle()).first->second;
 	}
 
 	std::filesystem::path AssetManager::GetPathFromAssetHandle(AssetHandle handle)
 	{
+		std::shared_lock lock(m_registryMutex);
 		for (const auto& [path, asset] : m_assetRegistry)
 		{
 			if (asset == handle)
@@ -225,29 +228,85 @@ namespace Lamp
 		return "";
 	}
 
-	void AssetManager::QueueAssetInternal(const std::filesystem::path& path, Ref<Asset>& asset)
+	void AssetManager::SetCacheBudget(uint64_t budgetBytes)
 	{
-		AssetHandle handle = Asset::Null();
+		std::vector<Ref<Asset>> evictedAssets;
 
-		// Check if asset is loaded
 		{
-			if (m_assetRegistry.find(path) != m_assetRegistry.end())
+			std::scoped_lock lock{ m_cacheMutex };
+			m_cacheBudget = budgetBytes;
+
+			if (std::this_thread::get_id() == m_mainThreadId)
 			{
-				handle = m_assetRegistry.at(path);
+				EvictUnreferencedAssets(evictedAssets);
 			}
+		}
+	}
 
-			if (handle != Asset::Null() && m_assetCache.find(handle) != m_assetCache.end())
+	AssetManager::Statistics AssetManager::GetStatistics()
+	{
+		std::scoped_lock lock{ m_cacheMutex };
+
+		Statistics stats{};
+		stats.cachedBytes = m_cacheBytes;
+		stats.budgetBytes = m_cacheBudget;
+		stats.evictedAssets = m_evictedAssets;
+
+		for (const auto& [handle, entry] : m_assetCache)
+		{
+			auto& typeStats = stats.types[entry.asset->GetType()];
+			typeStats.bytes += entry.size;
+			typeStats.count++;
+		}
+
+		for (const auto& [type, releasedBytes] : m_releasedCPUBytes)
+		{
+			stats.types[type].releasedBytes = releasedBytes;
+			stats.releasedCPUBytes += releasedBytes;
+		}
+
+		return stats;
+	}
+
+	void AssetManager::LogCPUDataSavings()
+	{
+		const Statistics stats = GetStatistics();
+
+		for (const auto& [type, typeStats] : stats.types)
+		{
+			if (typeStats.releasedBytes == 0)
 			{
-				asset = m_assetCache[handle];
-				return;
+				continue;
+			}
+
+			const float savedShare = (float)typeStats.releasedBytes / (float)(typeStats.bytes + typeStats.releasedBytes) * 100.f;
+			LP_CORE_INFO("{0}: {1} KB kept, {2} KB released after upload ({3:.1f}% saved)", GetAssetTypeName(type), typeStats.bytes / 1024, typeStats.releasedBytes / 1024, savedShare);
+		}
+
+		const float savedShare = stats.releasedCPUBytes > 0 ? (float)stats.releasedCPUBytes / (float)(stats.cachedBytes + stats.releasedCPUBytes) * 100.f : 0.f;
+		LP_CORE_INFO("Asset CPU memory: {0} KB kept, {1} KB released after upload ({2:.1f}% saved)", stats.cachedBytes / 1024, stats.releasedCPUBytes / 1024, savedShare);
+	}
+
+	void AssetManager::QueueAssetInternal(const std::filesystem::path& path, Ref<Asset>& asset)
+	{
+		const AssetHandle handle = FindHandle(path);
+
+		// Check if asset is loaded
+		{
+			if (handle != Asset::Null())
+			{
+				if (Ref<Asset> cachedAsset = GetCachedAsset(handle))
+				{
+					asset = cachedAsset;
+					return;
+				}
 			}
 		}
 
 		if (handle != Asset::Null())
 		{
-			std::scoped_lock<std::mutex> lock(m_loadMutex);
 			asset->handle = handle;
-			m_assetCache.emplace(handle, asset);
+			CacheAsset(asset);
 		}
 
 		// If not, queue
@@ -255,14 +314,25 @@ namespace Lamp
 			std::scoped_lock lock(m_loadMutex);
 			m_loadQueue.emplace_back(LoadJob{ handle, path });
 		}
+
+		m_threadConditionVar.notify_one();
+	}
+
+	void AssetManager::QueueTask(std::function<void()>&& task)
+	{
+		{
+			std::scoped_lock lock(m_loadMutex);
+			m_taskQueue.emplace_back(std::move(task));
+		}
+
+		m_threadConditionVar.notify_one();
 	}
 
 	void AssetManager::QueueAssetInternal(AssetHandle assetHandle, Ref<Asset>& asset)
 	{
-		auto it = m_assetCache.find(assetHandle);
-		if (it != m_assetCache.end())
+		if (Ref<Asset> cachedAsset = GetCachedAsset(assetHandle))
 		{
-			asset = it->second;
+			asset = cachedAsset;
 			return;
 		}
 
@@ -273,8 +343,117 @@ namespace Lamp
 		}
 	}
 
+	Ref<Asset> AssetManager::GetCachedAsset(AssetHandle assetHandle)
+	{
+		std::scoped_lock lock{ m_cacheMutex };
+
+		auto it = m_assetCache.find(assetHandle);
+		if (it == m_assetCache.end())
+		{
+			return nullptr;
+		}
+
+		m_lruList.splice(m_lruList.begin(), m_lruList, it->second.lruIterator);
+		return it->second.asset;
+	}
+
+	void AssetManager::CacheAsset(Ref<Asset> asset)
+	{
+		const uint64_t size = asset->GetCPUMemorySize();
+
+		// Evicted assets are destroyed after the lock has been released
+		std::vector<Ref<Asset>> evictedAssets;
+
+		{
+			std::scoped_lock lock{ m_cacheMutex };
+
+			auto it = m_assetCache.find(asset->handle);
+			if (it != m_assetCache.end())
+			{
+				m_cacheBytes -= it->second.size;
+
+				it->second.asset = asset;
+				it->second.size = size;
+				m_lruList.splice(m_lruList.begin(), m_lruList, it->second.lruIterator);
+			}
+			else
+			{
+				m_lruList.emplace_front(asset->handle);
+				m_assetCache.emplace(asset->handle, CacheEntry{ asset, size, m_lruList.begin() });
+			}
+
+			m_cacheBytes += size;
+
+			// GPU resources may only be released on the main thread, the loader thread leaves eviction to the next main thread insert
+			if (m_cacheBytes > m_cacheBudget && std::this_thread::get_id() == m_mainThreadId)
+			{
+				EvictUnreferencedAssets(evictedAssets);
+			}
+		}
+	}
+
+	void AssetManager::EvictUnreferencedAssets(std::vector<Ref<Asset>>& outEvictedAssets)
+	{
+		auto it = m_lruList.end();
+		while (it != m_lruList.begin() && m_cacheBytes > m_cacheBudget)
+		{
+			--it;
+
+			auto entryIt = m_assetCache.find(*it);
+			const CacheEntry& entry = entryIt->second;
+
+			// Assets referenced outside of the cache stay, evicting them would only load a duplicate
+			if (entry.asset.use_count() > 1 || entry.asset->IsFlagSet(AssetFlag::Queued))
+			{
+				continue;
+			}
+
+			m_cacheBytes -= entry.size;
+			m_evictedAssets++;
+
+			outEvictedAssets.emplace_back(entry.asset);
+			m_assetCache.erase(entryIt);
+
+			it = m_lruList.erase(it);
+		}
+	}
+
+	void AssetManager::ReleaseCPUData(Ref<Asset> asset, AssetType type)
+	{
+		// Source meshes keep their data for the mesh compiler
+		if (type == AssetType::MeshSource || !asset->IsValid())
+		{
+			return;
+		}
+
+		// The only place CPU data of loaded assets is released, so every released byte is counted once
+		const uint64_t releasedBytes = asset->ReleaseCPUData();
+		if (releasedBytes == 0)
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ m_cacheMutex };
+		m_releasedCPUBytes[type] += releasedBytes;
+	}
+
+	AssetHandle AssetManager::FindHandle(const std::filesystem::path& path)
+	{
+		std::shared_lock lock(m_registryMutex);
+
+		auto it = m_assetRegistry.find(path);
+		if (it == m_assetRegistry.end())
+		{
+			return Asset::Null();
+		}
+
+		return it->second;
+	}
+
 	void AssetManager::SaveAssetRegistry()
 	{
+		std::shared_lock lock(m_registryMutex);
+
 		YAML::Emitter out;
 		out << YAML::BeginMap;
 
@@ -314,6 +493,7 @@ namespace Lamp
 		YAML::Node root = YAML::Load(strStream.str());
 		YAML::Node assets = root["Assets"];
 
+		std::unique_lock lock(m_registryMutex);
 		for (const auto entry : assets)
 		{
 			std::string path = entry["Path"].as<std::string>();
@@ -325,20 +505,41 @@ namespace Lamp
 
 	void AssetManager::Thread_LoadAsset()
 	{
-		m_isThreadRunning = true;
-		while (m_isThreadRunning)
+		while (true)
 		{
-			if (!m_loadQueue.empty())
+			std::function<void()> task;
+			std::optional<LoadJob> job;
+
 			{
-				LoadJob job;
+				std::unique_lock lock(m_loadMutex);
+				m_threadConditionVar.wait(lock, [this]() { return !m_isThreadRunning || !m_taskQueue.empty() || !m_loadQueue.empty(); });
+
+				if (!m_isThreadRunning)
+				{
+					break;
+				}
 
+				if (!m_taskQueue.empty())
+				{
+					task = std::move(m_taskQueue.front());
+					m_taskQueue.erase(m_taskQueue.begin());
+				}
+
+				if (!m_loadQueue.empty())
 				{
-					std::scoped_lock<std::mutex> lock(m_loadMutex);
 					job = m_loadQueue.back();
 					m_loadQueue.pop_back();
 				}
+			}
 
-				const auto type = GetAssetTypeFromPath(job.path);
+			if (task)
+			{
+				task();
+			}
+
+			if (job)
+			{
+				const auto type = GetAssetTypeFromPath(job->path);
 
 				if (m_assetImporters.find(type) == m_assetImporters.end())
 				{
@@ -347,28 +548,32 @@ namespace Lamp
 				}
 
 #ifdef LP_DEBUG
-				LP_CORE_INFO("Loading asset {0}!", job.path.string().c_str());
+				LP_CORE_INFO("Loading asset {0}!", job->path.string().c_str());
 #endif
-				Ref<Asset> asset = m_assetCache.at(job.handle);
+				Ref<Asset> asset = GetCachedAsset(job->handle);
+				if (!asset)
+				{
+					asset = CreateRef<Asset>();
+				}
 
-				m_assetImporters[type]->Load(job.path, asset);
-				if (job.handle != Asset::Null())
+				m_assetImporters[type]->Load(job->path, asset);
+				if (job->handle != Asset::Null())
 				{
-					asset->handle = job.handle;
+					asset->handle = job->handle;
 				}
 				else
 				{
-					std::scoped_lock<std::mutex> lock(m_loadMutex);
-					m_assetRegistry.emplace(job.path, asset->handle);
+					std::unique_lock lock(m_registryMutex);
+					m_assetRegistry.emplace(job->path, asset->handle);
 				}
 
-				asset->path = job.path;
+				asset->path = job->path;
 				asset->SetFlag(AssetFlag::Queued, false);
 
-				{
-					std::scoped_lock<std::mutex> lock(m_loadMutex);
-					m_assetCache[job.handle] = asset;
-				}
+				ReleaseCPUData(asset, type);
+				CacheAsset(asset);
+
+				ResidencyManager::Register(asset);
 			}
 		}
 	}
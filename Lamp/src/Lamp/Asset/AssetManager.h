@@ -7,6 +7,11 @@
 #include <unordered_map>
 #include <filesystem>
 #include <thread>
+#include <list>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
 
 namespace Lamp
 {
@@ -14,6 +19,23 @@ namespace Lamp
 	class AssetManager
 	{
 	public:
+		struct TypeStatistics
+		{
+			uint64_t bytes = 0;
+			uint32_t count = 0;
+			uint64_t releasedBytes = 0; // CPU copies dropped after upload since startup
+		};
+
+		struct Statistics
+		{
+			uint64_t cachedBytes = 0;
+			uint64_t budgetBytes = 0;
+			uint32_t evictedAssets = 0;
+			uint64_t releasedCPUBytes = 0; // sum over all types
+
+			std::unordered_map<AssetType, TypeStatistics> types;
+		};
+
 		AssetManager();
 		~AssetManager();
 
@@ -33,6 +55,13 @@ namespace Lamp
 		AssetHandle GetAssetHandleFromPath(const std::filesystem::path& path);
 		std::filesystem::path GetPathFromAssetHandle(AssetHandle handle);
 
+		// Unreferenced assets are evicted in least recently used order once the cache is over budget
+		void SetCacheBudget(uint64_t budgetBytes);
+		Statistics GetStatistics();
+
+		// Logs the CPU memory saved per asset type by releasing data after upload, compared to keeping it
+		void LogCPUDataSavings();
+
 		inline static AssetManager& Get() { return *s_instance; }
 
 		template<typename T>
@@ -44,12 +73,19 @@ namespace Lamp
 		template<typename T>
 		static Ref<T> GetAsset(const std::filesystem::path& path);
 
+		// Does not keep the asset alive, lock it when it is needed
+		template<typename T>
+		static WeakRef<T> GetAssetWeak(AssetHandle assetHandle);
+
 		template<typename T>
 		static Ref<T> QueueAsset(const std::filesystem::path& path);
 
 		template<typename T>
 		static Ref<T> QueueAsset(AssetHandle handle);
 
+		// Runs the task on the loader thread, used for work which should not stall the frame
+		void QueueTask(std::function<void()>&& task);
+
 	private:
 		struct LoadJob
 		{
@@ -57,26 +93,49 @@ namespace Lamp
 			std::filesystem::path path;
 		};
 
+		struct CacheEntry
+		{
+			Ref<Asset> asset;
+			uint64_t size = 0;
+			std::list<AssetHandle>::iterator lruIterator;
+		};
+
 		inline static AssetManager* s_instance = nullptr;
 
 		void QueueAssetInternal(const std::filesystem::path& path, Ref<Asset>& asset);
 		void QueueAssetInternal(AssetHandle assetHandle, Ref<Asset>& asset);
 
+		Ref<Asset> GetCachedAsset(AssetHandle assetHandle); // marks the asset as most recently used
+		void CacheAsset(Ref<Asset> asset);
+		void EvictUnreferencedAssets(std::vector<Ref<Asset>>& outEvictedAssets); // expects the cache lock to be held
+		void ReleaseCPUData(Ref<Asset> asset, AssetType type);
+
+		AssetHandle FindHandle(const std::filesystem::path& path); // null if the path is not registered
+
 		void SaveAssetRegistry();
 		void LoadAssetRegistry();
 
 		void Thread_LoadAsset();
 
 		std::unordered_map<AssetType, Scope<AssetImporter>> m_assetImporters;
-		std::unordered_map<std::filesystem::path, AssetHandle> m_assetRegistry;
-		std::unordered_map<AssetHandle, Ref<Asset>> m_assetCache;
+		std::unordered_map<std::filesystem::path, AssetHandle> m_assetRegistry; // written by the loader thread as well
+		std::shared_mutex m_registryMutex;
+		std::unordered_map<AssetHandle, CacheEntry> m_assetCache;
+		std::list<AssetHandle> m_lruList; // front is the most recently used asset
+		uint64_t m_cacheBytes = 0;
+		uint64_t m_cacheBudget = 0;
+		uint32_t m_evictedAssets = 0;
+		std::unordered_map<AssetType, uint64_t> m_releasedCPUBytes; // per type, guarded by the cache lock
+		std::mutex m_cacheMutex;
 
 		std::thread m_loadThread;
+		std::thread::id m_mainThreadId;
 		std::mutex m_loadMutex;
 		std::atomic_bool m_isThreadRunning = false;
-		std::condition_variable m_threadConditionVar;
+		std::condition_variable m_threadConditionVar; // signaled when a job or task is queued and on shutdown
 
 		std::vector<LoadJob> m_loadQueue;
+		std::vector<std::function<void()>> m_taskQueue;
 	};
 
 	template<typename T>
@@ -93,6 +152,12 @@ namespace Lamp
 		return std::reinterpret_pointer_cast<T>(asset);
 	}
 
+	template<typename T>
+	inline WeakRef<T> AssetManager::GetAssetWeak(AssetHandle assetHandle)
+	{
+		return GetAsset<T>(assetHandle);
+	}
+
 	template<typename T>
 	inline AssetHandle AssetManager::GetHandle(const std::filesystem::path& path)
 	{
@@ -102,10 +167,10 @@ namespace Lamp
 			return Asset::Null();
 		}
 
-		auto it = Get().m_assetRegistry.find(path);
-		if (it != Get().m_assetRegistry.end())
+		const AssetHandle handle = Get().FindHandle(path);
+		if (handle != Asset::Null())
 		{
-			return it->second;
+			return handle;
 		}
 	
 		Ref<T> asset = GetAsset<T>(path);
@@ -106,13 +106,12 @@ namespace Lamp
 			const auto& imageInfos = shader->GetResources().imageInfos;
 			auto& shaderInputDefinitions = const_cast<std::unordered_map<uint32_t, std::string>&>(shader->GetResources().shaderTextureDefinitions);
 
-			auto setIt = imageInfos.find((uint32_t)DescriptorSetType::PerMaterial);
-			if (setIt != imageInfos.end())
+			const auto [begin, end] = Shader::ShaderResources::FindSet(imageInfos, (uint32_t)DescriptorSetType::PerMaterial);
+			if (begin != end)
 			{
 				for (const auto& [binding, name] : inputTextures)
 				{
-					auto inputIt = setIt->second.find(binding);
-					if (inputIt == setIt->second.end())
+					if (!Shader::ShaderResources::Find(imageInfos, (uint32_t)DescriptorSetType::PerMaterial, binding))
 					{
 						LP_CORE_ERROR("Shader {0} does not have a texture input with binding {1}, but this is defined in definition!", path.string().c_str(), binding);
 					}
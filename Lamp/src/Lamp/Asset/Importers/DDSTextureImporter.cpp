@@ -2,13 +2,11 @@
 #include "DDSTextureImporter.h"
 
 #include "Lamp/Log/Log.h"
-#include "Lamp/Core/Graphics/VulkanAllocator.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
 
 #include "Lamp/Rendering/Texture/Image2D.h"
 #include "Lamp/Rendering/Texture/Texture2D.h"
 
-#include "Lamp/Utility/ImageUtility.h"
-
 #include <vulkan/vulkan.h>
 
 #define TINYDDSLOADER_IMPLEMENTATION
@@ -88,34 +86,6 @@ namespace Lamp
 		}
 
 		auto imageData = dds.GetImageData();
-		
-		VkDeviceSize size = imageData->m_memSlicePitch;
-		void* dataPtr = imageData->m_mem;
-		uint32_t width = imageData->m_width;
-		uint32_t height = imageData->m_height;
-		
-		VkBuffer stagingBuffer;
-		VmaAllocation stagingAllocation;
-		
-		VulkanAllocator allocator{ "Texture2D - Create" };
-
-		// Create staging buffer
-		{
-			VkBufferCreateInfo bufferInfo{};
-			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferInfo.size = size;
-			bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-			stagingAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, stagingBuffer);
-		}
-
-		// Map memory
-		{
-			void* bufferPtr = allocator.MapMemory<void>(stagingAllocation);
-			memcpy_s(bufferPtr, size, dataPtr, size);
-			allocator.UnmapMemory(stagingAllocation);
-		}
 
 		Ref<Image2D> image;
 
@@ -124,54 +94,34 @@ namespace Lamp
 			ImageSpecification imageSpec{};
 			imageSpec.format = Utility::DDSToLampImageFormat(dds.GetFormat());
 			imageSpec.usage = ImageUsage::Texture;
-			imageSpec.width = width;
-			imageSpec.height = height;
+			imageSpec.width = imageData->m_width;
+			imageSpec.height = imageData->m_height;
 			imageSpec.mips = dds.GetMipCount();
 
 			image = Image2D::Create(imageSpec);
-		
-			Utility::TransitionImageLayout(image->GetHandle(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-			Utility::CopyBufferToImage(stagingBuffer, image->GetHandle(), width, height);
 		}
 
-		allocator.DestroyBuffer(stagingBuffer, stagingAllocation);
-
-		// Set mip data
+		// Upload all mips in one batch
 		{
-			for (uint32_t i = 1; i < dds.GetMipCount(); i++)
-			{
-				VmaAllocation mipStagingAllocation;
-				VkBuffer mipStagingBuffer;
+			std::vector<ImageUploadRegion> regions;
+			regions.reserve(dds.GetMipCount());
 
+			for (uint32_t i = 0; i < dds.GetMipCount(); i++)
+			{
 				auto mipData = dds.GetImageData(i);
-				VkDeviceSize mipSize = mipData->m_memSlicePitch;
-
-				// Create mip staging buffer
-				{
-					VkBufferCreateInfo bufferInfo{};
-					bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-					bufferInfo.size = mipSize;
-					bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-					bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-					mipStagingAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, mipStagingBuffer);
-				}
-
-				// Map mip memory
-				{
-					void* bufferPtr = allocator.MapMemory<void>(mipStagingAllocation);
-					memcpy_s(bufferPtr, mipSize, mipData->m_mem, mipSize);
-					allocator.UnmapMemory(mipStagingAllocation);
-				}				
-				
-				Utility::CopyBufferToImage(mipStagingBuffer, image->GetHandle(), mipData->m_width, mipData->m_height, i);
-				allocator.DestroyBuffer(mipStagingBuffer, mipStagingAllocation);
+
+				ImageUploadRegion& region = regions.emplace_back();
+				region.data = mipData->m_mem;
+				region.size = mipData->m_memSlicePitch;
+				region.width = mipData->m_width;
+				region.height = mipData->m_height;
+				region.mipLevel = i;
 			}
 
-			Utility::TransitionImageLayout(image->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			UploadManager::UploadImage(image->GetHandle(), regions, dds.GetMipCount(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			image->SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 		}
 
-
 		Ref<Texture2D> texture = CreateRef<Texture2D>();
 		texture->m_image = image;
 
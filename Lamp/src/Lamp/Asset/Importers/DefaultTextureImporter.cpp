@@ -1,14 +1,11 @@
 #include "lppch.h"
 #include "DefaultTextureImporter.h"
 
-#include "Lamp/Core/Graphics/GraphicsContext.h"
-#include "Lamp/Core/Graphics/VulkanAllocator.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
 
 #include "Lamp/Rendering/Texture/Image2D.h"
 #include "Lamp/Rendering/Texture/Texture2D.h"
 
-#include "Lamp/Utility/ImageUtility.h"
-
 #include <stb_image/stb_image.h>
 
 namespace Lamp
@@ -37,32 +34,6 @@ namespace Lamp
 			size = (uint64_t)(width * height * STBI_rgb_alpha);
 		}
 
-		VkBuffer stagingBuffer;
-		VmaAllocation stagingAllocation;
-		auto device = GraphicsContext::GetDevice();
-
-		VulkanAllocator allocator{ "Texture2D - Create" };
-
-		// Create staging buffer
-		{
-			VkBufferCreateInfo bufferInfo{};
-			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferInfo.size = size;
-			bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-			stagingAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, stagingBuffer);
-		}
-
-		// Map memory
-		{
-			void* bufferPtr = allocator.MapMemory<void>(stagingAllocation);
-			memcpy_s(bufferPtr, size, imageData, size);
-			allocator.UnmapMemory(stagingAllocation);
-		}
-
-		stbi_image_free(imageData);
-
 		Ref<Image2D> image;
 
 		// Create image
@@ -75,22 +46,35 @@ namespace Lamp
 			imageSpec.mips = (!isHDR) ? static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1 : 1;
 
 			image = Image2D::Create(imageSpec);
+		}
+
+		// Upload
+		{
+			ImageUploadRegion region{};
+			region.data = imageData;
+			region.size = size;
+			region.width = (uint32_t)width;
+			region.height = (uint32_t)height;
 
-			Utility::TransitionImageLayout(image->GetHandle(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-			Utility::CopyBufferToImage(stagingBuffer, image->GetHandle(), width, height);
-			
 			if (!isHDR)
 			{
-				image->GenerateMips(true); // implicitly converts from VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+				// Mips are generated on the graphics queue once ownership has been acquired
+				UploadManager::UploadImage(image->GetHandle(), { region }, image->GetSpecification().mips, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, [image](VkCommandBuffer commandBuffer)
+				{
+					image->SetLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+					image->GenerateMips(true, commandBuffer); // implicitly converts from VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+				});
 			}
 			else
 			{
-				Utility::TransitionImageLayout(image->GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				UploadManager::UploadImage(image->GetHandle(), { region }, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				image->SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 			}
 		}
 
-		allocator.DestroyBuffer(stagingBuffer, stagingAllocation);
-		
+		// The data has been copied into staging memory
+		stbi_image_free(imageData);
+
 		Ref<Texture2D> texture = CreateRef<Texture2D>();
 		texture->m_image = image;
 
@@ -11,7 +11,7 @@
 
 namespace Lamp
 {
-	Ref<Mesh> FbxImporter::ImportMeshImpl(const std::filesystem::path& path)
+	Ref<Mesh> FbxImporter::ImportMeshImpl(const std::filesystem::path& path, bool createGPUResources)
 	{
 		FbxManager* sdkManager = FbxManager::Create();
 		FbxIOSettings* ioSettings = FbxIOSettings::Create(sdkManager, IOSROOT);
@@ -62,7 +62,10 @@ namespace Lamp
 			ProcessMesh(node->GetMesh(), fbxScene, mesh);
 		}
 
-		mesh->Construct();
+		if (createGPUResources)
+		{
+			mesh->Construct();
+		}
 
 		importer->Destroy();
 
@@ -15,7 +15,7 @@ namespace Lamp
 		FbxImporter() = default;
 
 	protected:
-		Ref<Mesh> ImportMeshImpl(const std::filesystem::path& path);
+		Ref<Mesh> ImportMeshImpl(const std::filesystem::path& path, bool createGPUResources);
 
 	private:
 		void ProcessMesh(FbxMesh* fbxMesh, FbxScene* aScene, Ref<Mesh> mesh);
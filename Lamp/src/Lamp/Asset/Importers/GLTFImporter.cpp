@@ -18,7 +18,7 @@
 
 namespace Lamp
 {
-	Ref<Mesh> GLTFImporter::ImportMeshImpl(const std::filesystem::path& path)
+	Ref<Mesh> GLTFImporter::ImportMeshImpl(const std::filesystem::path& path, bool createGPUResources)
 	{
 		if (!std::filesystem::exists(path))
 		{
@@ -74,7 +74,10 @@ namespace Lamp
 			LoadNode(node, gltfInput, nullptr, mesh);
 		}
 
-		mesh->Construct();
+		if (createGPUResources)
+		{
+			mesh->Construct();
+		}
 
 		return mesh;
 	}
@@ -45,7 +45,7 @@ namespace Lamp
 		GLTFImporter() = default;
 
 	protected:
-		Ref<Mesh> ImportMeshImpl(const std::filesystem::path& path);
+		Ref<Mesh> ImportMeshImpl(const std::filesystem::path& path, bool createGPUResources);
 
 	private:
 		void LoadNode(const tinygltf::Node& inputNode, const tinygltf::Model& inputModel, GLTF::Node* parent, Ref<Mesh> outMesh);
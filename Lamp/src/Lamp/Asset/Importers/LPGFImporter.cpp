@@ -8,7 +8,7 @@
 
 namespace Lamp
 {
-	Ref<Mesh> LPGFImporter::ImportMeshImpl(const std::filesystem::path& path)
+	Ref<Mesh> LPGFImporter::ImportMeshImpl(const std::filesystem::path& path, bool createGPUResources)
 	{
 		if (!std::filesystem::exists(path))
 		{
@@ -86,7 +86,10 @@ namespace Lamp
 			}
 		}
 
-		mesh->Construct();
+		if (createGPUResources)
+		{
+			mesh->Construct();
+		}
 
 		return mesh;
 	}
@@ -11,6 +11,6 @@ namespace Lamp
 		LPGFImporter() = default;
 
 	protected:
-		Ref<Mesh> ImportMeshImpl(const std::filesystem::path& path);
+		Ref<Mesh> ImportMeshImpl(const std::filesystem::path& path, bool createGPUResources);
 	};
 }
\ No newline at end of file
@@ -19,9 +19,9 @@ namespace Lamp
 		s_importers.clear();
 	}
 
-	Ref<Mesh> MeshTypeImporter::ImportMesh(const std::filesystem::path& path)
+	Ref<Mesh> MeshTypeImporter::ImportMesh(const std::filesystem::path& path, bool createGPUResources)
 	{
-		return s_importers[FormatFromExtension(path)]->ImportMeshImpl(path);
+		return s_importers[FormatFromExtension(path)]->ImportMeshImpl(path, createGPUResources);
 	}
 
 	MeshTypeImporter::MeshFormat MeshTypeImporter::FormatFromExtension(const std::filesystem::path& path)
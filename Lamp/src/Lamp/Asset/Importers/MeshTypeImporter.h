@@ -15,10 +15,11 @@ namespace Lamp
 		static void Initialize();
 		static void Shutdown();
 		
-		static Ref<Mesh> ImportMesh(const std::filesystem::path& path);
+		// Without GPU resources only the CPU side data is imported, used to restore released vertex and index data
+		static Ref<Mesh> ImportMesh(const std::filesystem::path& path, bool createGPUResources = true);
 
 	protected:
-		virtual Ref<Mesh> ImportMeshImpl(const std::filesystem::path& path) = 0;
+		virtual Ref<Mesh> ImportMeshImpl(const std::filesystem::path& path, bool createGPUResources) = 0;
 
 	private:
 		enum class MeshFormat
@@ -2,16 +2,21 @@
 #include "lppch.h"
 #include "Material.h"
 
+#include "Lamp/Asset/ResidencyManager.h"
+
 #include "Lamp/Core/Application.h"
 #include "Lamp/Core/Window.h"
 #include "Lamp/Core/Graphics/Swapchain.h"
 
 #include "Lamp/Core/Graphics/GraphicsContext.h"
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/DescriptorAllocator.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
 
 #include "Lamp/Log/Log.h"
 
 #include "Lamp/Rendering/RenderPipeline/RenderPipeline.h"
+#include "Lamp/Rendering/Shader/ShaderUtility.h"
 
 #include "Lamp/Rendering/Buffer/UniformBuffer/UniformBufferRegistry.h"
 #include "Lamp/Rendering/Buffer/UniformBuffer/UniformBufferSet.h"
@@ -32,15 +37,12 @@ namespace Lamp
 	{
 		m_renderPipeline->AddReference(this);
 		SetupMaterialFromPipeline();
-
-		CreateDescriptorPool();
 		AllocateAndSetupDescriptorSets();
 	}
 
 	Material::~Material()
 	{
-		vkDestroyDescriptorPool(GraphicsContext::GetDevice()->GetHandle(), m_descriptorPool, nullptr);
-		m_descriptorPool = nullptr;
+		ReleaseDescriptorSets();
 
 		if (m_renderPipeline)
 		{
@@ -50,18 +52,48 @@ namespace Lamp
 
 	void Material::Bind(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t passIndex) const
 	{
-		LP_PROFILE_FUNCTION();
+		PipelineBindState bindState{};
+		Bind(commandBuffer, frameIndex, passIndex, bindState);
+	}
 
-		m_renderPipeline->Bind(commandBuffer);
+	void Material::Bind(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t passIndex, PipelineBindState& bindState) const
+	{
+		LP_PROFILE_FUNCTION();
 
-		auto device = GraphicsContext::GetDevice();
-		vkUpdateDescriptorSets(device->GetHandle(), (uint32_t)m_writeDescriptors[frameIndex].size(), m_writeDescriptors[frameIndex].data(), 0, nullptr);
+		m_renderPipeline->Bind(commandBuffer, bindState);
 
 		// TODO: Switch to bind all sets at once
 
-		for (uint32_t i = 0; i < (uint32_t)m_frameDescriptorSets[frameIndex].size(); i++)
+		const auto& setNumbers = m_renderPipeline->GetSpecification().shader->GetResources().realSetNumbers;
+		const auto& descriptorSets = m_frameDescriptorSets[frameIndex];
+
+		for (uint32_t i = 0; i < (uint32_t)descriptorSets.size(); i++)
+		{
+			const uint32_t set = setNumbers[i];
+
+			// Sets with dynamic offsets are bound again when the pass changes, the offsets select the pass slice
+			if (set < PipelineBindState::MAX_SETS && bindState.descriptorSets[set] == descriptorSets[i] && (bindState.descriptorSetPasses[set] == passIndex || !m_renderPipeline->HasDynamicOffsets(set)))
+			{
+				bindState.statistics.skippedCalls++;
+				continue;
+			}
+
+			m_renderPipeline->BindDescriptorSet(commandBuffer, descriptorSets[i], set, passIndex);
+			bindState.statistics.descriptorSetBinds++;
+
+			if (set < PipelineBindState::MAX_SETS)
+			{
+				bindState.descriptorSets[set] = descriptorSets[i];
+				bindState.descriptorSetPasses[set] = passIndex;
+			}
+		}
+	}
+
+	void Material::MarkTexturesUsed() const
+	{
+		for (const auto& [binding, texture] : m_textures)
 		{
-			m_renderPipeline->BindDescriptorSet(commandBuffer, m_frameDescriptorSets[frameIndex].at(i), m_descriptorSetBindings[frameIndex].at(i), passIndex);
+			ResidencyManager::MarkUsed(*texture);
 		}
 	}
 
@@ -81,43 +113,69 @@ namespace Lamp
 	{
 		LP_PROFILE_FUNCTION();
 
-		if (m_descriptorPool)
-		{
-			vkResetDescriptorPool(GraphicsContext::GetDevice()->GetHandle(), m_descriptorPool, 0);
-		}
-
-		m_descriptorSetBindings.clear();
-		m_frameDescriptorSets.clear();
-		m_writeDescriptors.clear();
+		ReleaseDescriptorSets();
+		m_imageOverrides.clear();
 
-		m_shaderResources.clear();
 		SetupMaterialFromPipeline();
 		AllocateAndSetupDescriptorSets();
-
-		for (auto& writeDescriptor : m_writeDescriptors)
-		{
-		}
 	}
 
 	void Material::UpdateInternalTexture(uint32_t set, uint32_t binding, uint32_t frameIndex, Ref<Image2D> image)
 	{
 		LP_PROFILE_FUNCTION();
-		auto& shaderResource = m_shaderResources.at(frameIndex);
 
-		auto setIt = shaderResource.imageInfos.find(set);
-		if (setIt == shaderResource.imageInfos.end())
+		const auto& writeDescriptors = m_renderPipeline->GetSpecification().shader->GetResources().writeDescriptors;
+
+		const Shader::WriteDescriptor* writeDescriptor = Shader::ShaderResources::Find(writeDescriptors, set, binding);
+		if (!writeDescriptor || writeDescriptor->type != Shader::ResourceType::SampledImage)
 		{
 			return;
 		}
 
-		auto bindingIt = setIt->second.find(binding);
-		if (bindingIt == setIt->second.end())
+		const uint32_t writeIndex = (uint32_t)(writeDescriptor - writeDescriptors.data());
+
+		auto [it, inserted] = m_imageOverrides.try_emplace(GetOverrideKey(writeIndex, frameIndex));
+		VkDescriptorImageInfo& info = it->second;
+
+		if (inserted)
+		{
+			info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		else if (info.imageView == image->GetView() && info.sampler == image->GetSampler())
 		{
 			return;
 		}
 
-		bindingIt->second.info.imageView = image->GetView();
-		bindingIt->second.info.sampler = image->GetSampler();
+		info.imageView = image->GetView();
+		info.sampler = image->GetSampler();
+
+		// Only descriptors which actually changed are written, binding the material does not touch the sets
+		VkWriteDescriptorSet write = writeDescriptor->write;
+		write.dstSet = m_frameDescriptorSets[frameIndex][writeDescriptor->setIndex];
+		write.pImageInfo = &info;
+
+		vkUpdateDescriptorSets(GraphicsContext::GetDevice()->GetHandle(), 1, &write, 0, nullptr);
+	}
+
+	void Material::RefreshTextures(uint32_t frameIndex)
+	{
+		const uint64_t generation = GetTextureGeneration();
+		if (m_frameTextureGenerations[frameIndex] == generation)
+		{
+			return;
+		}
+
+		m_frameTextureGenerations[frameIndex] = generation;
+
+		const auto& setNumbers = m_renderPipeline->GetSpecification().shader->GetResources().realSetNumbers;
+		for (uint32_t i = 0; i < (uint32_t)setNumbers.size(); i++)
+		{
+			if (setNumbers[i] == (uint32_t)DescriptorSetType::PerMaterial)
+			{
+				WriteDescriptorSets(frameIndex, 1u << i);
+				break;
+			}
+		}
 	}
 
 	Ref<Material> Material::Create(const std::string& name, uint32_t index, Ref<RenderPipeline> renderPipeline)
@@ -125,145 +183,346 @@ namespace Lamp
 		return CreateRef<Material>(name, index, renderPipeline);
 	}
 
-	void Material::CreateDescriptorPool()
+	void Material::ReleaseSharedDescriptorSets()
 	{
-		VkDescriptorPoolCreateInfo poolInfo{};
-		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.flags = 0;
-		poolInfo.maxSets = 100; // TODO: Make this dynamic
-		poolInfo.poolSizeCount = (uint32_t)m_shaderResources[0].poolSizes.size();
-		poolInfo.pPoolSizes = m_shaderResources[0].poolSizes.data();
-
-		LP_VK_CHECK(vkCreateDescriptorPool(GraphicsContext::GetDevice()->GetHandle(), &poolInfo, nullptr, &m_descriptorPool));
+		std::scoped_lock lock{ s_sharedDescriptorSetMutex };
+
+		for (const auto& [hash, sharedSet] : s_sharedDescriptorSets)
+		{
+			DescriptorAllocator::Free(sharedSet.descriptorPool, 1);
+		}
+
+		s_sharedDescriptorSets.clear();
+	}
+
+	void Material::UpdateSharedBuffers(uint32_t frameIndex)
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::scoped_lock lock{ s_sharedDescriptorSetMutex };
+
+		std::vector<VkWriteDescriptorSet> writes;
+		std::vector<VkDescriptorBufferInfo> bufferInfos;
+
+		size_t writeCount = 0;
+		for (const auto& [hash, sharedSet] : s_sharedDescriptorSets)
+		{
+			writeCount += sharedSet.frameIndex == frameIndex ? sharedSet.bufferWrites.size() : 0;
+		}
+
+		// Reserve up front so that the info pointers stay valid
+		writes.reserve(writeCount);
+		bufferInfos.reserve(writeCount);
+
+		for (const auto& [hash, sharedSet] : s_sharedDescriptorSets)
+		{
+			if (sharedSet.frameIndex != frameIndex)
+			{
+				continue;
+			}
+
+			for (const auto& writeDescriptor : sharedSet.bufferWrites)
+			{
+				const uint32_t set = Shader::ShaderResources::GetSet(writeDescriptor.key);
+				const uint32_t binding = Shader::ShaderResources::GetBinding(writeDescriptor.key);
+
+				VkDescriptorBufferInfo& info = bufferInfos.emplace_back();
+				info.offset = 0;
+
+				if (writeDescriptor.type == Shader::ResourceType::UniformBuffer)
+				{
+					Ref<UniformBuffer> ubo = UniformBufferRegistry::Get(set, binding)->Get(frameIndex);
+
+					info.buffer = ubo->GetHandle();
+					info.range = ubo->GetSize();
+				}
+				else
+				{
+					Ref<ShaderStorageBuffer> ssb = ShaderStorageBufferRegistry::Get(set, binding)->Get(frameIndex);
+
+					info.buffer = ssb->GetHandle();
+					info.range = ssb->GetSize();
+				}
+
+				VkWriteDescriptorSet& write = writes.emplace_back(writeDescriptor.write);
+				write.dstSet = sharedSet.descriptorSet;
+				write.pBufferInfo = &info;
+			}
+		}
+
+		vkUpdateDescriptorSets(GraphicsContext::GetDevice()->GetHandle(), (uint32_t)writes.size(), writes.data(), 0, nullptr);
 	}
 
 	void Material::AllocateAndSetupDescriptorSets()
 	{
 		const uint32_t framesInFlight = Application::Get().GetWindow()->GetSwapchain().GetFramesInFlight();
-		auto device = GraphicsContext::GetDevice();
+		const auto& resources = m_renderPipeline->GetSpecification().shader->GetResources();
 
+		std::vector<VkDescriptorSetLayout> ownedSetLayouts;
+		for (uint32_t i = 0; i < (uint32_t)resources.realSetLayouts.size(); i++)
+		{
+			if ((resources.sharedSetMask & (1u << i)) == 0)
+			{
+				ownedSetLayouts.emplace_back(resources.realSetLayouts[i]);
+			}
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo = resources.setAllocInfo;
+		allocInfo.descriptorSetCount = (uint32_t)ownedSetLayouts.size();
+		allocInfo.pSetLayouts = ownedSetLayouts.data();
+
+		m_ownedSetCount = allocInfo.descriptorSetCount;
 		m_frameDescriptorSets.resize(framesInFlight);
-		m_descriptorSetBindings.resize(framesInFlight);
-		m_writeDescriptors.resize(framesInFlight);
+		m_frameTextureGenerations.assign(framesInFlight, GetTextureGeneration());
+		m_descriptorPools.resize(framesInFlight);
+
+		std::vector<VkDescriptorSet> ownedSets(m_ownedSetCount);
 
-		for (uint32_t i = 0; i < (uint32_t)m_frameDescriptorSets.size(); i++)
+		for (uint32_t i = 0; i < framesInFlight; i++)
 		{
 			auto& sets = m_frameDescriptorSets[i];
-			auto& shaderResources = m_shaderResources[i];
+			sets.resize(resources.realSetLayouts.size());
 
-			VkDescriptorSetAllocateInfo allocInfo = shaderResources.setAllocInfo;
-			allocInfo.descriptorPool = m_descriptorPool;
-			sets.resize(allocInfo.descriptorSetCount);
+			m_descriptorPools[i] = DescriptorAllocator::Allocate(allocInfo, ownedSets.data());
+			bool allocated = m_descriptorPools[i] || m_ownedSetCount == 0;
 
-			vkAllocateDescriptorSets(device->GetHandle(), &allocInfo, sets.data());
-
-			uint32_t index = 0;
-			for (auto& [set, bindings] : shaderResources.writeDescriptors)
+			for (uint32_t setIndex = 0, ownedIndex = 0; setIndex < (uint32_t)sets.size() && allocated; setIndex++)
 			{
-				for (auto& [binding, write] : bindings)
+				if ((resources.sharedSetMask & (1u << setIndex)) == 0)
+				{
+					sets[setIndex] = ownedSets[ownedIndex++];
+				}
+				else
 				{
-					auto& writeDescriptor = m_writeDescriptors[i].emplace_back(write);
-
-					if (shaderResources.uniformBuffersInfos[set].find(binding) != shaderResources.uniformBuffersInfos[set].end())
-					{
-						writeDescriptor.pBufferInfo = &shaderResources.uniformBuffersInfos[set].at(binding).info;
-					}
-					else if (shaderResources.storageBuffersInfos[set].find(binding) != shaderResources.storageBuffersInfos[set].end())
-					{
-						writeDescriptor.pBufferInfo = &shaderResources.storageBuffersInfos[set].at(binding).info;
-					}
-					else if (shaderResources.imageInfos[set].find(binding) != shaderResources.imageInfos[set].end())
-					{
-						writeDescriptor.pImageInfo = &shaderResources.imageInfos[set].at(binding).info;
-					}
-
-					writeDescriptor.dstSet = sets[index];
+					sets[setIndex] = GetOrCreateSharedDescriptorSet(setIndex, i);
+					allocated = sets[setIndex] != nullptr;
 				}
+			}
+
+			// Without sets the material is not drawn, see HasDescriptorSets
+			if (!allocated)
+			{
+				LP_CORE_ERROR("Unable to allocate the descriptor sets of material {0}!", m_name);
+				ReleaseDescriptorSets();
 
-				m_descriptorSetBindings[i].emplace_back(set);
-				index++;
+				return;
 			}
+
+			WriteDescriptorSets(i, ~resources.sharedSetMask);
 		}
 	}
 
-	void Material::SetupMaterialFromPipeline()
+	void Material::ReleaseDescriptorSets()
 	{
-		const uint32_t framesInFlight = Application::Get().GetWindow()->GetSwapchain().GetFramesInFlight();
+		for (uint32_t i = 0; i < (uint32_t)m_descriptorPools.size(); i++)
+		{
+			// Sets might still be in use by frames in flight
+			DeletionQueue::RetireDescriptorSets(m_descriptorPools[i], m_ownedSetCount);
+		}
 
-		for (uint32_t i = 0; i < framesInFlight; i++)
+		m_descriptorPools.clear();
+		m_frameDescriptorSets.clear();
+		m_frameTextureGenerations.clear();
+		m_ownedSetCount = 0;
+	}
+
+	VkDescriptorSet Material::GetOrCreateSharedDescriptorSet(uint32_t setIndex, uint32_t frameIndex)
+	{
+		const auto& resources = m_renderPipeline->GetSpecification().shader->GetResources();
+		const VkDescriptorSetLayout setLayout = resources.realSetLayouts[setIndex];
+
+		// Layouts are hash-consed, so the handle identifies the bindings. The set number picks the registry buffers
+		size_t hash = std::hash<VkDescriptorSetLayout>()(setLayout);
+		hash = Utility::HashCombine(hash, std::hash<uint32_t>()(resources.realSetNumbers[setIndex]));
+		hash = Utility::HashCombine(hash, std::hash<uint32_t>()(frameIndex));
+
+		std::scoped_lock lock{ s_sharedDescriptorSetMutex };
+
+		auto it = s_sharedDescriptorSets.find(hash);
+		if (it != s_sharedDescriptorSets.end())
+		{
+			return it->second.descriptorSet;
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo = resources.setAllocInfo;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &setLayout;
+
+		SharedDescriptorSet sharedSet{};
+		sharedSet.descriptorPool = DescriptorAllocator::Allocate(allocInfo, &sharedSet.descriptorSet);
+		sharedSet.frameIndex = frameIndex;
+
+		if (!sharedSet.descriptorPool)
 		{
-			m_shaderResources.emplace_back(m_renderPipeline->GetSpecification().shader->GetResources());
+			return nullptr;
 		}
 
-		for (uint32_t i = 0; i < (uint32_t)m_shaderResources.size(); i++)
+		for (const auto& writeDescriptor : resources.writeDescriptors)
 		{
-			for (auto& [set, bindings] : m_shaderResources[i].uniformBuffersInfos)
+			const bool isBuffer = writeDescriptor.type == Shader::ResourceType::UniformBuffer || writeDescriptor.type == Shader::ResourceType::StorageBuffer;
+			if (writeDescriptor.setIndex == setIndex && isBuffer)
 			{
-				for (auto& [binding, info] : bindings)
-				{
-					Ref<UniformBuffer> ubo = UniformBufferRegistry::Get(set, binding)->Get(i);
+				sharedSet.bufferWrites.emplace_back(writeDescriptor);
+			}
+		}
 
-					info.info.buffer = ubo->GetHandle();
-					info.info.range = ubo->GetSize();
-				}
+		s_sharedDescriptorSets.emplace(hash, sharedSet);
+		m_frameDescriptorSets[frameIndex][setIndex] = sharedSet.descriptorSet;
+		WriteDescriptorSets(frameIndex, 1u << setIndex);
+
+		return sharedSet.descriptorSet;
+	}
+
+	void Material::WriteDescriptorSets(uint32_t frameIndex, uint32_t setMask)
+	{
+		const auto& resources = m_renderPipeline->GetSpecification().shader->GetResources();
+		const auto& sets = m_frameDescriptorSets[frameIndex];
+
+		std::vector<VkWriteDescriptorSet> writes;
+		std::vector<VkDescriptorBufferInfo> bufferInfos;
+		std::vector<VkDescriptorImageInfo> imageInfos;
+
+		// Reserve up front so that the info pointers stay valid
+		writes.reserve(resources.writeDescriptors.size());
+		bufferInfos.reserve(resources.writeDescriptors.size());
+		imageInfos.reserve(resources.writeDescriptors.size());
+
+		for (uint32_t i = 0; i < (uint32_t)resources.writeDescriptors.size(); i++)
+		{
+			const auto& writeDescriptor = resources.writeDescriptors[i];
+			if ((setMask & (1u << writeDescriptor.setIndex)) == 0)
+			{
+				continue;
 			}
 
-			for (auto& [set, bindings] : m_shaderResources[i].storageBuffersInfos)
+			const uint32_t set = Shader::ShaderResources::GetSet(writeDescriptor.key);
+			const uint32_t binding = Shader::ShaderResources::GetBinding(writeDescriptor.key);
+
+			VkWriteDescriptorSet& write = writes.emplace_back(writeDescriptor.write);
+			write.dstSet = sets[writeDescriptor.setIndex];
+
+			switch (writeDescriptor.type)
 			{
-				for (auto& [binding, info] : bindings)
+				case Shader::ResourceType::UniformBuffer:
 				{
-					Ref<ShaderStorageBuffer> ssb = ShaderStorageBufferRegistry::Get(set, binding)->Get(i);
+					Ref<UniformBuffer> ubo = UniformBufferRegistry::Get(set, binding)->Get(frameIndex);
+
+					VkDescriptorBufferInfo& info = bufferInfos.emplace_back(resources.uniformBuffersInfos[writeDescriptor.resourceIndex].info);
+					info.buffer = ubo->GetHandle();
+					info.range = ubo->GetSize();
 
-					info.info.buffer = ssb->GetHandle();
-					info.info.range = ssb->GetSize();
+					write.pBufferInfo = &info;
+					break;
 				}
-			}
 
-			for (auto& [set, bindings] : m_shaderResources[i].imageInfos)
-			{
-				if (set != (uint32_t)DescriptorSetType::PerMaterial)
+				case Shader::ResourceType::StorageBuffer:
 				{
-					for (auto& [binding, info] : bindings)
-					{
-						if (info.dimension == ImageDimension::Dim2D)
-						{
-							auto defaultTexture = Renderer::GetDefaultData().whiteTexture;
-
-							info.info.imageView = defaultTexture->GetImage()->GetView();
-							info.info.sampler = defaultTexture->GetImage()->GetSampler();
-						}
-						else if (info.dimension == ImageDimension::DimCube)
-						{
-							auto defaultTexture = Renderer::GetDefaultData().blackCubeImage;
-
-							info.info.imageView = defaultTexture->GetView();
-							info.info.sampler = defaultTexture->GetSampler();
-						}
-					}
+					Ref<ShaderStorageBuffer> ssb = ShaderStorageBufferRegistry::Get(set, binding)->Get(frameIndex);
+
+					VkDescriptorBufferInfo& info = bufferInfos.emplace_back(resources.storageBuffersInfos[writeDescriptor.resourceIndex].info);
+					info.buffer = ssb->GetHandle();
+					info.range = ssb->GetSize();
+
+					write.pBufferInfo = &info;
+					break;
+				}
+
+				case Shader::ResourceType::StorageImage:
+				{
+					write.pImageInfo = &imageInfos.emplace_back(resources.storageImagesInfos[writeDescriptor.resourceIndex].info);
+					break;
+				}
+
+				case Shader::ResourceType::SampledImage:
+				{
+					write.pImageInfo = &imageInfos.emplace_back(GetSampledImageInfo(resources.imageInfos[writeDescriptor.resourceIndex], i, frameIndex));
+					break;
 				}
 			}
+		}
 
-			for (auto& input : m_renderPipeline->GetSpecification().framebufferInputs)
+		vkUpdateDescriptorSets(GraphicsContext::GetDevice()->GetHandle(), (uint32_t)writes.size(), writes.data(), 0, nullptr);
+	}
+
+	void Material::SetupMaterialFromPipeline()
+	{
+		const auto& imageInfos = m_renderPipeline->GetSpecification().shader->GetResources().imageInfos;
+		const auto [begin, end] = Shader::ShaderResources::FindSet(imageInfos, (uint32_t)DescriptorSetType::PerMaterial);
+
+		for (auto it = begin; it != end; ++it)
+		{
+			const uint32_t binding = Shader::ShaderResources::GetBinding(it->key);
+			if (m_textures.find(binding) == m_textures.end())
 			{
-				auto& imageInfo = m_shaderResources[i].imageInfos[input.set][input.binding].info;
-				imageInfo.imageView = m_renderPipeline->GetSpecification().framebuffer->GetColorAttachment(input.attachmentIndex)->GetView();
-				imageInfo.sampler = m_renderPipeline->GetSpecification().framebuffer->GetColorAttachment(input.attachmentIndex)->GetSampler();
+				auto defaultTexture = Renderer::GetDefaultData().whiteTexture;
+				m_textures.emplace(binding, defaultTexture);
 			}
+		}
+	}
+
+	const VkDescriptorImageInfo Material::GetSampledImageInfo(const Shader::SampledImage& image, uint32_t writeIndex, uint32_t frameIndex) const
+	{
+		const uint32_t set = Shader::ShaderResources::GetSet(image.key);
+		const uint32_t binding = Shader::ShaderResources::GetBinding(image.key);
+
+		VkDescriptorImageInfo info = image.info;
 
-			if (m_shaderResources[i].imageInfos.find((uint32_t)DescriptorSetType::PerMaterial) != m_shaderResources[i].imageInfos.end())
+		if (set == (uint32_t)DescriptorSetType::PerMaterial)
+		{
+			const auto& texture = m_textures.at(binding);
+
+			info.imageView = texture->GetImage()->GetView();
+			info.sampler = texture->GetImage()->GetSampler();
+
+			return info;
+		}
+
+		auto overrideIt = m_imageOverrides.find(GetOverrideKey(writeIndex, frameIndex));
+		if (overrideIt != m_imageOverrides.end())
+		{
+			return overrideIt->second;
+		}
+
+		for (const auto& input : m_renderPipeline->GetSpecification().framebufferInputs)
+		{
+			if (input.set == set && input.binding == binding)
 			{
-				for (auto& [binding, imageInfo] : m_shaderResources[i].imageInfos[(uint32_t)DescriptorSetType::PerMaterial])
-				{
-					if (m_textures.find(binding) == m_textures.end())
-					{
-						auto defaultTexture = Renderer::GetDefaultData().whiteTexture;
-						m_textures.emplace(binding, defaultTexture);
-					}
-
-					imageInfo.info.imageView = m_textures.at(binding)->GetImage()->GetView();
-					imageInfo.info.sampler = m_textures.at(binding)->GetImage()->GetSampler();
-				}
+				auto attachment = m_renderPipeline->GetSpecification().framebuffer->GetColorAttachment(input.attachmentIndex);
+
+				info.imageView = attachment->GetView();
+				info.sampler = attachment->GetSampler();
+
+				return info;
 			}
 		}
+
+		if (image.dimension == ImageDimension::Dim2D)
+		{
+			auto defaultTexture = Renderer::GetDefaultData().whiteTexture;
+
+			info.imageView = defaultTexture->GetImage()->GetView();
+			info.sampler = defaultTexture->GetImage()->GetSampler();
+		}
+		else if (image.dimension == ImageDimension::DimCube)
+		{
+			auto defaultTexture = Renderer::GetDefaultData().blackCubeImage;
+
+			info.imageView = defaultTexture->GetView();
+			info.sampler = defaultTexture->GetSampler();
+		}
+
+		return info;
+	}
+
+	const uint64_t Material::GetTextureGeneration() const
+	{
+		// Generations only increase, so the sum changes whenever any of the textures swaps its image
+		uint64_t generation = 0;
+		for (const auto& [binding, texture] : m_textures)
+		{
+			generation += texture->GetGeneration();
+		}
+
+		return generation;
 	}
 }
@@ -5,6 +5,8 @@
 #include "Lamp/Rendering/Shader/Shader.h"
 #include "Lamp/Rendering/RenderPipeline/RenderPipeline.h"
 
+#include <mutex>
+
 namespace Lamp
 {
 	class Texture2D;
@@ -19,38 +21,62 @@ namespace Lamp
 		~Material();
 
 		void Bind(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t passIndex = 0) const;
+		void Bind(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t passIndex, PipelineBindState& bindState) const; // Safe to record from multiple threads
+		void MarkTexturesUsed() const; // Keeps the textures resident, only called from the thread recording the frame
 		void SetPushConstant(VkCommandBuffer cmdBuffer, uint32_t offset, uint32_t size, const void* data) const;
 		void SetTexture(uint32_t binding, Ref<Texture2D> texture);
 		void Invalidate();
 
 		void UpdateInternalTexture(uint32_t set, uint32_t binding, uint32_t frameIndex, Ref<Image2D> image);
+		void RefreshTextures(uint32_t frameIndex); // Rewrites the material set of the frame if a texture swapped its image
 
 		inline const std::string& GetName() const { return m_name; }
 		inline const std::map<uint32_t, Ref<Texture2D>>& GetTextures() const { return m_textures; }
-		inline const std::unordered_map<uint32_t, std::string>& GetTextureDefinitions() const { return m_shaderResources[0].shaderTextureDefinitions; }
+		inline const std::unordered_map<uint32_t, std::string>& GetTextureDefinitions() const { return m_renderPipeline->GetSpecification().shader->GetResources().shaderTextureDefinitions; }
 		inline const size_t GetPipelineHash() const { return m_renderPipeline->GetHash(); }
+		inline const bool HasDescriptorSets() const { return !m_frameDescriptorSets.empty(); } // false if the allocation failed, the material can not be bound
 
 		static Ref<Material> Create(const std::string& name, uint32_t index, Ref<RenderPipeline> renderPipeline);
+		static void ReleaseSharedDescriptorSets();
+		static void UpdateSharedBuffers(uint32_t frameIndex); // Re-points shared sets at the current registry uniform and storage buffers
 
 	private:
 		friend class MultiMaterialImporter;
 
-		void CreateDescriptorPool();
 		void AllocateAndSetupDescriptorSets();
+		void ReleaseDescriptorSets();
+		void WriteDescriptorSets(uint32_t frameIndex, uint32_t setMask);
+		VkDescriptorSet GetOrCreateSharedDescriptorSet(uint32_t setIndex, uint32_t frameIndex);
 
 		void SetupMaterialFromPipeline();
+		const VkDescriptorImageInfo GetSampledImageInfo(const Shader::SampledImage& image, uint32_t writeIndex, uint32_t frameIndex) const;
+		const uint64_t GetTextureGeneration() const;
+
+		static constexpr uint64_t GetOverrideKey(uint32_t writeIndex, uint32_t frameIndex) { return ((uint64_t)writeIndex << 32) | frameIndex; }
 
 		Ref<RenderPipeline> m_renderPipeline;
 
 		std::map<uint32_t, Ref<Texture2D>> m_textures; // binding -> texture
-		std::vector<Shader::ShaderResources> m_shaderResources;
-		std::vector<std::vector<uint32_t>> m_descriptorSetBindings; // maps descriptor set vector index to descriptor set binding
-		std::vector<std::vector<VkDescriptorSet>> m_frameDescriptorSets; // frame -> index -> descriptor set
-		std::vector<std::vector<VkWriteDescriptorSet>> m_writeDescriptors;
+		std::unordered_map<uint64_t, VkDescriptorImageInfo> m_imageOverrides; // (shader write descriptor index, frame) -> image
+		std::vector<std::vector<VkDescriptorSet>> m_frameDescriptorSets; // frame -> real set index -> descriptor set
+		std::vector<uint64_t> m_frameTextureGenerations; // frame -> texture generation the material set was written with
 
-		VkDescriptorPool m_descriptorPool = nullptr;
+		std::vector<VkDescriptorPool> m_descriptorPools; // frame -> pool the owned sets were allocated from
+		uint32_t m_ownedSetCount = 0;
 
 		std::string m_name;
 		uint32_t m_index;
+
+		struct SharedDescriptorSet
+		{
+			VkDescriptorSet descriptorSet = nullptr;
+			VkDescriptorPool descriptorPool = nullptr;
+
+			uint32_t frameIndex = 0;
+			std::vector<Shader::WriteDescriptor> bufferWrites;
+		};
+
+		inline static std::unordered_map<size_t, SharedDescriptorSet> s_sharedDescriptorSets; // hash(layout, set, frame) -> set
+		inline static std::mutex s_sharedDescriptorSetMutex;
 	};
 }
\ No newline at end of file
@@ -1,18 +1,30 @@
 #include "lppch.h"
 #include "Mesh.h"
 
+#include "Lamp/Asset/Importers/MeshTypeImporter.h"
+
+#include "Lamp/Log/Log.h"
+
 #include "Lamp/Rendering/Buffer/VertexBuffer.h"
 #include "Lamp/Rendering/Buffer/IndexBuffer.h"
 
 namespace Lamp
 {
+	Mesh::Mesh(const std::vector<SubMesh>& subMeshes, Ref<MultiMaterial> material)
+		: m_subMeshes(subMeshes), m_material(material)
+	{}
+
 	void Mesh::Construct()
 	{
 		m_vertexBuffer = VertexBuffer::Create(m_vertices, sizeof(Vertex) * (uint32_t)m_vertices.size());
 		m_indexBuffer = IndexBuffer::Create(m_indices, (uint32_t)m_indices.size());
+		m_memorySize = sizeof(Vertex) * m_vertices.size() + sizeof(uint32_t) * m_indices.size();
+
+		m_vertexCount = m_vertices.size();
+		m_indexCount = m_indices.size();
 	
 		glm::vec3 minAABB = glm::vec3(std::numeric_limits<float>::max());
-		glm::vec3 maxAABB = glm::vec3(std::numeric_limits<float>::min());
+		glm::vec3 maxAABB = glm::vec3(std::numeric_limits<float>::lowest());
 		
 		for (const auto& vert : m_vertices)
 		{
@@ -26,8 +38,64 @@ namespace Lamp
 		}
 
 		glm::vec3 center = (maxAABB + minAABB) * 0.5f;
-		float radius = glm::length(minAABB - maxAABB);
+		float radius = glm::length(maxAABB - minAABB) * 0.5f;
 
 		m_boundingSphere = { center, radius };
 	}
+
+	void Mesh::SetRetainCPUData(bool retain)
+	{
+		SetFlag(AssetFlag::RetainCPUData, retain);
+
+		if (retain)
+		{
+			LoadCPUData();
+		}
+	}
+
+	bool Mesh::LoadCPUData()
+	{
+		if (HasCPUData())
+		{
+			return true;
+		}
+
+		if (path.empty())
+		{
+			return false;
+		}
+
+		Ref<Mesh> loaded = MeshTypeImporter::ImportMesh(path, false);
+		if (!loaded || loaded->m_vertices.empty())
+		{
+			LP_CORE_ERROR("Failed to reload CPU data of mesh {0}!", path.string().c_str());
+			return false;
+		}
+
+		m_vertices = std::move(loaded->m_vertices);
+		m_indices = std::move(loaded->m_indices);
+
+		return true;
+	}
+
+	uint64_t Mesh::ReleaseCPUData()
+	{
+		if (IsFlagSet(AssetFlag::RetainCPUData))
+		{
+			return 0;
+		}
+
+		const uint64_t releasedBytes = sizeof(Vertex) * m_vertices.capacity() + sizeof(uint32_t) * m_indices.capacity();
+
+		// Uploads copy into staging memory right away, so pending uploads do not need the CPU copies
+		std::vector<Vertex>().swap(m_vertices);
+		std::vector<uint32_t>().swap(m_indices);
+
+		return releasedBytes;
+	}
+
+	uint64_t Mesh::GetCPUMemorySize() const
+	{
+		return sizeof(Mesh) + sizeof(Vertex) * m_vertices.capacity() + sizeof(uint32_t) * m_indices.capacity() + sizeof(SubMesh) * m_subMeshes.capacity();
+	}
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "Lamp/Rendering/Vertex.h"
 #include "Lamp/Rendering/BoundingStructures.h"
 
+#include <atomic>
 #include <vector>
 #include <unordered_map>
 
@@ -20,28 +21,43 @@ namespace Lamp
 	{
 	public:
 		Mesh() = default;
+		Mesh(const std::vector<SubMesh>& subMeshes, Ref<MultiMaterial> material); // without geometry, it is never constructed
 		~Mesh() override {}
 
 		void Construct();
 
+		// Reloads released vertex and index data from the asset file, retained data is never released
+		void SetRetainCPUData(bool retain);
+		bool LoadCPUData();
+
 		inline const std::vector<SubMesh>& GetSubMeshes() const { return m_subMeshes; }
 		inline const Ref<MultiMaterial>& GetMaterial() const { return m_material; }
 
-		inline const size_t GetVertexCount() const { return m_vertices.size(); }
-		inline const size_t GetIndexCount() const { return m_indices.size(); }
+		inline const size_t GetVertexCount() const { return m_vertexCount; }
+		inline const size_t GetIndexCount() const { return m_indexCount; }
+
+		inline const bool HasCPUData() const { return !m_vertices.empty(); }
+		inline const std::vector<Vertex>& GetVertices() const { return m_vertices; }
+		inline const std::vector<uint32_t>& GetIndices() const { return m_indices; }
 		inline const BoundingSphere& GetBoundingSphere() const { return m_boundingSphere; }
 		
 		inline const Ref<VertexBuffer>& GetVertexBuffer() const { return m_vertexBuffer; }
 		inline const Ref<IndexBuffer>& GetIndexBuffer() const { return m_indexBuffer; }
 
+		inline const bool IsResident() const { return m_isResident.load(); }
+		inline const uint64_t GetLastUsedFrame() const { return m_lastUsedFrame; }
+
 		static AssetType GetStaticType() { return AssetType::Mesh; }
 		AssetType GetType() override { return GetStaticType(); }
+		uint64_t GetCPUMemorySize() const override;
+		uint64_t ReleaseCPUData() override;
 
 	private:
 		friend class FbxImporter;
 		friend class GLTFImporter;
 		friend class LPGFImporter;
 		friend class MeshCompiler;
+		friend class ResidencyManager;
 
 		std::vector<SubMesh> m_subMeshes;
 
@@ -50,9 +66,18 @@ namespace Lamp
 		std::vector<Vertex> m_vertices;
 		std::vector<uint32_t> m_indices;
 
+		size_t m_vertexCount = 0;
+		size_t m_indexCount = 0;
+
 		Ref<VertexBuffer> m_vertexBuffer;
 		Ref<IndexBuffer> m_indexBuffer;
 
 		BoundingSphere m_boundingSphere;
+
+		std::atomic_uint64_t m_lastUsedFrame = 0; // meshes are marked by every thread submitting them
+		uint64_t m_memorySize = 0;
+
+		std::atomic_bool m_isResident = true; // read by every thread submitting the mesh, set after the buffers are swapped
+		std::atomic_bool m_reloadRequested = false;
 	};
 }
\ No newline at end of file
@@ -17,6 +17,13 @@ namespace Lamp
 			return false;
 		}
 
+		// Compiled meshes release their vertex data after upload
+		if (!mesh->LoadCPUData())
+		{
+			LP_CORE_ERROR("Mesh {0} has no vertex data to compile!", mesh->path.string());
+			return false;
+		}
+
 		if (materialHandle == Asset::Null())
 		{
 			CreateMaterial(mesh, destination);
@@ -4,4 +4,7 @@
 
 namespace Lamp
 {
+	MultiMaterial::MultiMaterial(const std::string& name, const std::unordered_map<uint32_t, Ref<Material>>& materials)
+		: m_name(name), m_materials(materials)
+	{}
 }
\ No newline at end of file
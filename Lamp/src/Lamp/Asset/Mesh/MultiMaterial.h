@@ -9,6 +9,7 @@ namespace Lamp
 	{
 	public:
 		MultiMaterial() = default;
+		MultiMaterial(const std::string& name, const std::unordered_map<uint32_t, Ref<Material>>& materials);
 
 		inline const std::unordered_map<uint32_t, Ref<Material>>& GetMaterials() const { return m_materials; }
 		inline const std::string& GetName() const { return m_name; }
@@ -52,21 +52,21 @@ namespace Lamp
 
 		Ref<RenderPipelineCompute> computePipeline = RenderPipelineCompute::Create(spec.shader, framesInFlight);
 
-		auto shaderResources = spec.shader->GetResources();
-		for (auto& [set, bindings] : shaderResources.uniformBuffersInfos)
+		const auto& shaderResources = spec.shader->GetResources();
+		for (const auto& info : shaderResources.uniformBuffersInfos)
 		{
-			for (auto& [binding, info] : bindings)
-			{
-				computePipeline->SetUniformBuffer(UniformBufferRegistry::Get(set, binding), set, binding);
-			}
+			const uint32_t set = Shader::ShaderResources::GetSet(info.key);
+			const uint32_t binding = Shader::ShaderResources::GetBinding(info.key);
+
+			computePipeline->SetUniformBuffer(UniformBufferRegistry::Get(set, binding), set, binding);
 		}
 
-		for (auto& [set, bindings] : shaderResources.storageBuffersInfos)
+		for (const auto& info : shaderResources.storageBuffersInfos)
 		{
-			for (auto& [binding, info] : bindings)
-			{
-				computePipeline->SetStorageBuffer(ShaderStorageBufferRegistry::Get(set, binding), set, binding);
-			}
+			const uint32_t set = Shader::ShaderResources::GetSet(info.key);
+			const uint32_t binding = Shader::ShaderResources::GetBinding(info.key);
+
+			computePipeline->SetStorageBuffer(ShaderStorageBufferRegistry::Get(set, binding), set, binding);
 		}
 
 		m_computePipeline = computePipeline;
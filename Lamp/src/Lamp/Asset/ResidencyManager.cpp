@@ -0,0 +1,532 @@
+#include "lppch.h"
+#include "ResidencyManager.h"
+
+#include "Lamp/Asset/Asset.h"
+#include "Lamp/Asset/AssetManager.h"
+#include "Lamp/Asset/Mesh/Mesh.h"
+#include "Lamp/Asset/Importers/TextureImporter.h"
+#include "Lamp/Asset/Importers/MeshTypeImporter.h"
+
+#include "Lamp/Core/Application.h"
+#include "Lamp/Core/Window.h"
+#include "Lamp/Core/Graphics/Swapchain.h"
+#include "Lamp/Core/Graphics/VulkanAllocator.h"
+
+#include "Lamp/Log/Log.h"
+
+#include "Lamp/Rendering/Renderer.h"
+#include "Lamp/Rendering/Buffer/VertexBuffer.h"
+#include "Lamp/Rendering/Buffer/IndexBuffer.h"
+#include "Lamp/Rendering/Texture/Texture2D.h"
+
+#include <mutex>
+#include <unordered_set>
+
+namespace Lamp
+{
+	struct CompletedReload
+	{
+		WeakRef<Asset> asset;
+		Ref<Asset> loaded; // null when the import failed
+		Asset* target = nullptr;
+	};
+
+	struct PendingRelease
+	{
+		uint64_t frame = 0; // the deletion queue has destroyed the evicted resources by then
+		uint64_t bytes = 0;
+	};
+
+	struct ResidencyManagerData
+	{
+		std::vector<WeakRef<Asset>> resources;
+
+		uint64_t budgetBytes = 0;
+		std::atomic_uint64_t currentFrame = 0;
+
+		std::vector<PendingRelease> pendingReleases; // evicted memory the heap usage still includes
+
+		uint32_t frameEvictions = 0;
+		uint32_t frameReloads = 0;
+
+		std::atomic_uint32_t pendingReloads = 0; // requests made since the flags were last scanned
+		uint32_t deferredReloads = 0; // requests which did not fit in flight during the last scan
+		std::mutex mutex;
+
+		std::unordered_set<Asset*> reloadsInFlight;
+		std::vector<CompletedReload> completedReloads;
+		std::mutex reloadMutex;
+	};
+
+	static ResidencyManagerData* s_residencyData = nullptr;
+
+	static constexpr uint32_t MAX_RELOADS_IN_FLIGHT = 8;
+
+	// Without an explicit budget eviction starts above the first fraction of the heap budget and frees down to the second
+	static constexpr float HEAP_BUDGET_EVICT_FRACTION = 0.9f;
+	static constexpr float HEAP_BUDGET_TARGET_FRACTION = 0.8f;
+
+	void ResidencyManager::Register(Ref<Asset> asset)
+	{
+		if (!asset || !asset->IsValid() || asset->path.empty())
+		{
+			return;
+		}
+
+		if (asset->GetType() == AssetType::Texture)
+		{
+			Ref<Texture2D> texture = std::reinterpret_pointer_cast<Texture2D>(asset);
+			texture->m_memorySize = texture->GetImage()->GetMemorySize();
+			texture->m_lastUsedFrame = GetCurrentFrame();
+		}
+		else if (asset->GetType() == AssetType::Mesh)
+		{
+			Ref<Mesh> mesh = std::reinterpret_pointer_cast<Mesh>(asset);
+			mesh->m_lastUsedFrame = GetCurrentFrame();
+		}
+		else
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ s_residencyData->mutex };
+
+		// Assets released by the asset cache are dropped before the list grows
+		auto& resources = s_residencyData->resources;
+		if (resources.size() == resources.capacity())
+		{
+			resources.erase(std::remove_if(resources.begin(), resources.end(), [](const WeakRef<Asset>& resource) { return resource.expired(); }), resources.end());
+		}
+
+		resources.emplace_back(asset);
+	}
+
+	void ResidencyManager::MarkUsed(Texture2D& texture)
+	{
+		texture.m_lastUsedFrame = s_residencyData->currentFrame.load();
+
+		if (!texture.m_isResident && !texture.m_reloadRequested.exchange(true))
+		{
+			s_residencyData->pendingReloads++;
+		}
+	}
+
+	void ResidencyManager::MarkUsed(Mesh& mesh)
+	{
+		mesh.m_lastUsedFrame = s_residencyData->currentFrame.load();
+
+		// Only the first thread requesting the reload counts it
+		if (!mesh.m_isResident && !mesh.m_reloadRequested.exchange(true))
+		{
+			s_residencyData->pendingReloads++;
+		}
+	}
+
+	void ResidencyManager::Update()
+	{
+		LP_PROFILE_FUNCTION();
+
+		s_residencyData->currentFrame++;
+		s_residencyData->frameEvictions = 0;
+		s_residencyData->frameReloads = 0;
+
+		ApplyReloads();
+
+		// Requests are recounted from the asset flags, so requesters released before their reload are not waited on
+		if (s_residencyData->pendingReloads.exchange(0) > 0 || s_residencyData->deferredReloads > 0)
+		{
+			ReloadResources();
+		}
+
+		const uint64_t bytesOverBudget = GetBytesOverBudget();
+		if (bytesOverBudget > 0)
+		{
+			EvictResources(bytesOverBudget);
+		}
+	}
+
+	void ResidencyManager::SetBudget(uint64_t budgetBytes)
+	{
+		s_residencyData->budgetBytes = budgetBytes;
+	}
+
+	ResidencyManager::Statistics ResidencyManager::GetStatistics()
+	{
+		std::scoped_lock lock{ s_residencyData->mutex };
+
+		Statistics stats{};
+		stats.residentBytes = CalculateResidentBytes();
+		stats.budgetBytes = s_residencyData->budgetBytes;
+		stats.frameEvictions = s_residencyData->frameEvictions;
+		stats.frameReloads = s_residencyData->frameReloads;
+
+		for (const auto& weakAsset : s_residencyData->resources)
+		{
+			Ref<Asset> asset = weakAsset.lock();
+			if (!asset)
+			{
+				continue;
+			}
+
+			if (asset->GetType() == AssetType::Texture)
+			{
+				const bool resident = std::reinterpret_pointer_cast<Texture2D>(asset)->IsResident();
+				resident ? stats.residentTextures++ : stats.evictedTextures++;
+			}
+			else
+			{
+				const bool resident = std::reinterpret_pointer_cast<Mesh>(asset)->IsResident();
+				resident ? stats.residentMeshes++ : stats.evictedMeshes++;
+			}
+		}
+
+		return stats;
+	}
+
+	uint64_t ResidencyManager::GetCurrentFrame()
+	{
+		return s_residencyData->currentFrame;
+	}
+
+	void ResidencyManager::Initialize()
+	{
+		s_residencyData = new ResidencyManagerData();
+	}
+
+	void ResidencyManager::Shutdown()
+	{
+		delete s_residencyData;
+		s_residencyData = nullptr;
+	}
+
+	uint64_t ResidencyManager::GetBytesOverBudget()
+	{
+		const uint64_t currentFrame = s_residencyData->currentFrame;
+		std::erase_if(s_residencyData->pendingReleases, [currentFrame](const PendingRelease& release) { return release.frame <= currentFrame; });
+
+		if (s_residencyData->budgetBytes > 0)
+		{
+			std::scoped_lock lock{ s_residencyData->mutex };
+
+			const uint64_t residentBytes = CalculateResidentBytes();
+			return residentBytes > s_residencyData->budgetBytes ? residentBytes - s_residencyData->budgetBytes : 0;
+		}
+
+		uint64_t usage = 0;
+		uint64_t budget = 0;
+
+		for (const auto& heap : VulkanAllocator::GetStatistics().heaps)
+		{
+			if (heap.deviceLocal)
+			{
+				usage += heap.usage;
+				budget += heap.budget;
+			}
+		}
+
+		// Evicted resources stay allocated until the frames using them have retired, they must not be freed a second time
+		uint64_t pendingBytes = 0;
+		for (const auto& release : s_residencyData->pendingReleases)
+		{
+			pendingBytes += release.bytes;
+		}
+
+		usage -= std::min(usage, pendingBytes);
+
+		if ((float)usage < (float)budget * HEAP_BUDGET_EVICT_FRACTION)
+		{
+			return 0;
+		}
+
+		return usage - (uint64_t)((float)budget * HEAP_BUDGET_TARGET_FRACTION);
+	}
+
+	uint64_t ResidencyManager::CalculateResidentBytes()
+	{
+		// Summed on demand so that assets released by the asset cache drop out on their own
+		uint64_t residentBytes = 0;
+		for (const auto& weakAsset : s_residencyData->resources)
+		{
+			Ref<Asset> asset = weakAsset.lock();
+			if (!asset)
+			{
+				continue;
+			}
+
+			if (asset->GetType() == AssetType::Texture)
+			{
+				auto texture = std::reinterpret_pointer_cast<Texture2D>(asset);
+				residentBytes += texture->m_isResident ? texture->m_memorySize : 0;
+			}
+			else
+			{
+				auto mesh = std::reinterpret_pointer_cast<Mesh>(asset);
+				residentBytes += mesh->m_isResident ? mesh->m_memorySize : 0;
+			}
+		}
+
+		return residentBytes;
+	}
+
+	std::vector<Ref<Asset>> ResidencyManager::GetEvictionCandidates(uint64_t framesInFlight)
+	{
+		LP_PROFILE_FUNCTION();
+
+		const uint64_t currentFrame = s_residencyData->currentFrame;
+		std::vector<std::pair<uint64_t, Ref<Asset>>> candidates; // last used frame -> asset
+
+		{
+			std::scoped_lock lock{ s_residencyData->mutex };
+
+			auto expired = std::remove_if(s_residencyData->resources.begin(), s_residencyData->resources.end(), [](const WeakRef<Asset>& asset) { return asset.expired(); });
+			s_residencyData->resources.erase(expired, s_residencyData->resources.end());
+
+			for (const auto& weakAsset : s_residencyData->resources)
+			{
+				Ref<Asset> asset = weakAsset.lock();
+				if (!asset)
+				{
+					continue;
+				}
+
+				uint64_t lastUsedFrame = 0;
+				bool resident = false;
+
+				if (asset->GetType() == AssetType::Texture)
+				{
+					auto texture = std::reinterpret_pointer_cast<Texture2D>(asset);
+					lastUsedFrame = texture->m_lastUsedFrame;
+					resident = texture->m_isResident;
+				}
+				else
+				{
+					auto mesh = std::reinterpret_pointer_cast<Mesh>(asset);
+					lastUsedFrame = mesh->m_lastUsedFrame;
+					resident = mesh->m_isResident;
+				}
+
+				if (resident && lastUsedFrame + framesInFlight < currentFrame)
+				{
+					candidates.emplace_back(lastUsedFrame, asset);
+				}
+			}
+		}
+
+		// Stable, so resources last used in the same frame keep their registration order
+		std::stable_sort(candidates.begin(), candidates.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+		std::vector<Ref<Asset>> result;
+		result.reserve(candidates.size());
+
+		for (auto& [lastUsedFrame, asset] : candidates)
+		{
+			result.emplace_back(std::move(asset));
+		}
+
+		return result;
+	}
+
+	void ResidencyManager::EvictResources(uint64_t bytesToFree)
+	{
+		LP_PROFILE_FUNCTION();
+
+		// Resources used by frames which might still be in flight cannot be evicted
+		const uint64_t framesInFlight = (uint64_t)Application::Get().GetWindow()->GetSwapchain().GetFramesInFlight();
+		const std::vector<Ref<Asset>> candidates = GetEvictionCandidates(framesInFlight);
+
+		uint64_t freedBytes = 0;
+		for (const auto& asset : candidates)
+		{
+			if (freedBytes >= bytesToFree)
+			{
+				break;
+			}
+
+			uint64_t memorySize = 0;
+			bool evicted = false;
+
+			if (asset->GetType() == AssetType::Texture)
+			{
+				Texture2D& texture = *std::reinterpret_pointer_cast<Texture2D>(asset);
+				memorySize = texture.m_memorySize;
+				evicted = EvictTexture(texture);
+			}
+			else
+			{
+				Mesh& mesh = *std::reinterpret_pointer_cast<Mesh>(asset);
+				memorySize = mesh.m_memorySize;
+				evicted = EvictMesh(mesh);
+			}
+
+			if (evicted)
+			{
+				freedBytes += memorySize;
+				s_residencyData->frameEvictions++;
+			}
+		}
+
+		if (freedBytes > 0)
+		{
+			// One frame on top of the frames in flight, for the deletion queue to run after the last of them retired
+			s_residencyData->pendingReleases.emplace_back(PendingRelease{ s_residencyData->currentFrame + framesInFlight + 1, freedBytes });
+		}
+
+		if (s_residencyData->frameEvictions > 0)
+		{
+			LP_CORE_INFO("Evicted {0} resources ({1} MB) from GPU memory!", s_residencyData->frameEvictions, freedBytes / (1024ull * 1024ull));
+		}
+	}
+
+	void ResidencyManager::ReloadResources()
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::vector<Ref<Asset>> requested;
+		uint32_t deferredReloads = 0;
+
+		{
+			std::scoped_lock lock{ s_residencyData->mutex };
+
+			for (const auto& weakAsset : s_residencyData->resources)
+			{
+				Ref<Asset> asset = weakAsset.lock();
+				if (!asset)
+				{
+					continue;
+				}
+
+				const bool reloadRequested = asset->GetType() == AssetType::Texture ? std::reinterpret_pointer_cast<Texture2D>(asset)->m_reloadRequested.load() : std::reinterpret_pointer_cast<Mesh>(asset)->m_reloadRequested.load();
+				if (!reloadRequested || s_residencyData->reloadsInFlight.contains(asset.get()))
+				{
+					continue;
+				}
+
+				if (s_residencyData->reloadsInFlight.size() + requested.size() < MAX_RELOADS_IN_FLIGHT)
+				{
+					requested.emplace_back(asset);
+				}
+				else
+				{
+					deferredReloads++;
+				}
+			}
+		}
+
+		s_residencyData->deferredReloads = deferredReloads;
+
+		// The import runs on the loader thread, the resource keeps its placeholder until the result is applied
+		for (const auto& asset : requested)
+		{
+			s_residencyData->reloadsInFlight.emplace(asset.get());
+
+			AssetManager::Get().QueueTask([weakAsset = WeakRef<Asset>(asset), target = asset.get(), type = asset->GetType(), path = asset->path]()
+			{
+				Ref<Asset> loaded;
+				if (type == AssetType::Texture)
+				{
+					loaded = TextureImporter::ImportTexture(path);
+				}
+				else
+				{
+					loaded = MeshTypeImporter::ImportMesh(path);
+				}
+
+				std::scoped_lock lock{ s_residencyData->reloadMutex };
+				s_residencyData->completedReloads.emplace_back(CompletedReload{ weakAsset, loaded, target });
+			});
+		}
+	}
+
+	void ResidencyManager::ApplyReloads()
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::vector<CompletedReload> completedReloads;
+
+		{
+			std::scoped_lock lock{ s_residencyData->reloadMutex };
+			completedReloads.swap(s_residencyData->completedReloads);
+		}
+
+		for (const auto& reload : completedReloads)
+		{
+			s_residencyData->reloadsInFlight.erase(reload.target);
+
+			Ref<Asset> asset = reload.asset.lock();
+			if (!asset)
+			{
+				continue;
+			}
+
+			bool reloaded = false;
+			if (asset->GetType() == AssetType::Texture)
+			{
+				Texture2D& texture = *std::reinterpret_pointer_cast<Texture2D>(asset);
+				texture.m_reloadRequested = false;
+
+				reloaded = ReloadTexture(texture, std::reinterpret_pointer_cast<Texture2D>(reload.loaded));
+			}
+			else
+			{
+				Mesh& mesh = *std::reinterpret_pointer_cast<Mesh>(asset);
+				mesh.m_reloadRequested = false;
+
+				reloaded = ReloadMesh(mesh, std::reinterpret_pointer_cast<Mesh>(reload.loaded));
+			}
+
+			s_residencyData->frameReloads += reloaded ? 1 : 0;
+		}
+	}
+
+	bool ResidencyManager::EvictTexture(Texture2D& texture)
+	{
+		// The image is destroyed once the frames using it have retired, materials switch to the placeholder on their next frame
+		texture.m_image = Renderer::GetDefaultData().placeholderTexture->GetImage();
+		texture.m_isResident = false;
+		texture.m_generation++;
+
+		return true;
+	}
+
+	bool ResidencyManager::EvictMesh(Mesh& mesh)
+	{
+		// The buffers are retired to the deletion queue, so frames still using them are unaffected
+		mesh.m_vertexBuffer = nullptr;
+		mesh.m_indexBuffer = nullptr;
+		mesh.m_isResident = false;
+
+		return true;
+	}
+
+	bool ResidencyManager::ReloadTexture(Texture2D& texture, Ref<Texture2D> loaded)
+	{
+		if (!loaded)
+		{
+			LP_CORE_ERROR("Failed to reload texture {0}!", texture.path.string().c_str());
+			return false;
+		}
+
+		texture.m_image = loaded->m_image;
+		texture.m_memorySize = texture.m_image->GetMemorySize();
+		texture.m_isResident = true;
+		texture.m_generation++;
+
+		return true;
+	}
+
+	bool ResidencyManager::ReloadMesh(Mesh& mesh, Ref<Mesh> loaded)
+	{
+		// The materials of the reloaded mesh are discarded, the evicted mesh keeps its own
+		if (!loaded)
+		{
+			LP_CORE_ERROR("Failed to reload mesh {0}!", mesh.path.string().c_str());
+			return false;
+		}
+
+		mesh.m_vertexBuffer = loaded->m_vertexBuffer;
+		mesh.m_indexBuffer = loaded->m_indexBuffer;
+		mesh.m_isResident = true;
+
+		return true;
+	}
+}
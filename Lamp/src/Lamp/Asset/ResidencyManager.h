@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+
+#include <vector>
+
+namespace Lamp
+{
+	class Asset;
+	class Texture2D;
+	class Mesh;
+
+	class ResidencyManager
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t residentBytes = 0;
+			uint64_t budgetBytes = 0; // zero when following the device local heap budgets
+
+			uint32_t residentTextures = 0;
+			uint32_t residentMeshes = 0;
+			uint32_t evictedTextures = 0;
+			uint32_t evictedMeshes = 0;
+
+			uint32_t frameEvictions = 0;
+			uint32_t frameReloads = 0;
+		};
+
+		// Only textures and meshes loaded through the asset manager are tracked, they are reloaded from their path
+		static void Register(Ref<Asset> asset);
+
+		// Stamps the resource with the current frame, evicted resources are queued for reload. Meshes can be marked from any thread
+		static void MarkUsed(Texture2D& texture);
+		static void MarkUsed(Mesh& mesh);
+
+		// Evicts the least recently used resources when over budget and queues requested reloads on the asset loader thread.
+		// Finished reloads are swapped in here as well, so it must be called at the start of the frame on the thread recording it
+		static void Update();
+
+		// A budget of zero evicts based on the device local heap budgets instead
+		static void SetBudget(uint64_t budgetBytes);
+
+		// Resident resources which no frame in flight uses, least recently used first
+		static std::vector<Ref<Asset>> GetEvictionCandidates(uint64_t framesInFlight);
+
+		static Statistics GetStatistics();
+		static uint64_t GetCurrentFrame();
+
+		static void Initialize();
+		static void Shutdown();
+
+	private:
+		ResidencyManager() = delete;
+
+		static uint64_t GetBytesOverBudget();
+		static uint64_t CalculateResidentBytes(); // expects the lock to be held
+		static void EvictResources(uint64_t bytesToFree);
+		static void ReloadResources();
+		static void ApplyReloads();
+
+		static bool EvictTexture(Texture2D& texture);
+		static bool EvictMesh(Mesh& mesh);
+		static bool ReloadTexture(Texture2D& texture, Ref<Texture2D> loaded);
+		static bool ReloadMesh(Mesh& mesh, Ref<Mesh> loaded);
+	};
+}
@@ -4,6 +4,7 @@
 #include "Lamp/Log/Log.h"
 #include "Lamp/Core/Base.h"
 #include "Lamp/Core/Window.h"
+#include "Lamp/Core/RenderThread.h"
 
 #include "Lamp/Core/Graphics/GraphicsContext.h"
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
@@ -12,6 +13,7 @@
 
 #include "Lamp/Asset/AssetManager.h"
 #include "Lamp/Asset/MaterialRegistry.h"
+#include "Lamp/Asset/ResidencyManager.h"
 
 #include "Lamp/ImGui/ImGuiImplementation.h"
 
@@ -45,6 +47,7 @@ namespace Lamp
 		m_window = Window::Create(windowProperties);
 		m_window->SetEventCallback(LP_BIND_EVENT_FN(Application::OnEvent));
 
+		ResidencyManager::Initialize();
 		m_assetManager = CreateRef<AssetManager>();
 
 		UniformBufferRegistry::Initialize();
@@ -62,11 +65,13 @@ namespace Lamp
 		Renderer::Initialize();
 		MaterialRegistry::Initialize();
 
-		m_imguiImplementation = ImGuiImplementation::Create();
+		m_imguiImplementation = ImGuiImplementation::Create(info.useRenderThread);
 	}
 
 	Application::~Application()
 	{
+		m_renderThread = nullptr;
+
 		Log::Shutdown();
 		vkDeviceWaitIdle(GraphicsContext::GetDevice()->GetHandle());
 
@@ -83,6 +88,7 @@ namespace Lamp
 		UniformBufferRegistry::Shutdowm();
 
 		m_assetManager = nullptr;
+		ResidencyManager::Shutdown();
 		Renderer::Shutdowm();
 		m_window = nullptr;
 		s_instance = nullptr;
@@ -94,12 +100,15 @@ namespace Lamp
 
 		auto device = GraphicsContext::GetDevice()->GetHandle();
 
+		if (m_applicationInfo.useRenderThread)
+		{
+			m_renderThread = RenderThread::Create([this](FramePacket& packet) { RenderFrame(packet); });
+		}
+
 		while (m_isRunning)
 		{
 			LP_PROFILE_FRAME("Frame");
 
-			m_window->BeginFrame();
-
 			float time = (float)glfwGetTime();
 			m_currentFrameTime = time - m_lastFrameTime;
 			m_lastFrameTime = time;
@@ -128,8 +137,21 @@ namespace Lamp
 				m_imguiImplementation->End();
 			}
 
-			m_window->Present();
+			// The render thread records this frame while the next one is updated, the queue holds back an update running further ahead
+			Scope<FramePacket> packet = Renderer::TakeFramePacket();
+			if (m_renderThread)
+			{
+				m_renderThread->Submit(std::move(packet));
+			}
+			else
+			{
+				RenderFrame(*packet);
+			}
+
+			m_window->PollEvents();
 		}
+
+		m_renderThread = nullptr;
 	}
 
 	void Application::OnEvent(Event& event)
@@ -167,7 +189,23 @@ namespace Lamp
 			return false;
 		}
 
+		// The swapchain can not be recreated while a frame is recorded into it
+		if (m_renderThread)
+		{
+			m_renderThread->Flush();
+		}
+
 		m_window->Resize(e.GetWidth(), e.GetHeight());
 		return false;
 	}
+
+	void Application::RenderFrame(FramePacket& packet)
+	{
+		LP_PROFILE_FUNCTION();
+
+		// Waits for the GPU to finish the frame which last used this frame's resources, so the frames in flight stay bounded with or without a render thread
+		m_window->BeginFrame();
+		Renderer::RenderFramePacket(packet);
+		m_window->Present();
+	}
 }
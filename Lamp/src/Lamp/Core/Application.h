@@ -18,8 +18,8 @@ namespace Lamp
 {
 	struct ApplicationInfo
 	{
-		ApplicationInfo(const std::string& aTitle = "Lamp", uint32_t aWidth = 1280, uint32_t aHeight = 720, bool aUseVSync = true, bool aEnableImGui = true)
-			: title(aTitle), width(aWidth), height(aHeight), useVSync(aUseVSync), enableImGui(aEnableImGui)
+		ApplicationInfo(const std::string& aTitle = "Lamp", uint32_t aWidth = 1280, uint32_t aHeight = 720, bool aUseVSync = true, bool aEnableImGui = true, bool aUseRenderThread = false)
+			: title(aTitle), width(aWidth), height(aHeight), useVSync(aUseVSync), enableImGui(aEnableImGui), useRenderThread(aUseRenderThread)
 		{ }
 
 		std::string title;
@@ -27,11 +27,16 @@ namespace Lamp
 		uint32_t height;
 		bool useVSync;
 		bool enableImGui;
+
+		// Frames are recorded and submitted on a separate thread while the next one is updated. The layers may then only reach the GPU through the renderer's submit functions
+		bool useRenderThread;
 	};
 
 	class Window;
 	class AssetManager;
 	class ImGuiImplementation;
+	class RenderThread;
+	struct FramePacket;
 
 	class Application
 	{
@@ -51,6 +56,8 @@ namespace Lamp
 		bool OnWindowCloseEvent(WindowCloseEvent& e);
 		bool OnWindowResizeEvent(WindowResizeEvent& e);
 
+		void RenderFrame(FramePacket& packet);
+
 		const std::vector<const char*> m_validationLayers = { "VK_LAYER_KHRONOS_validation" };
 		bool m_isRunning = true;
 
@@ -60,6 +67,7 @@ namespace Lamp
 		Ref<Window> m_window;
 		Ref<AssetManager> m_assetManager;
 		Scope<ImGuiImplementation> m_imguiImplementation;
+		Scope<RenderThread> m_renderThread;
 		
 		LayerStack m_layerStack;
 
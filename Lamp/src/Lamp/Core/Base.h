@@ -12,10 +12,7 @@ const char* VKResultToString(int32_t result);
 	#define LP_ENABLE_DEBUG_ALLOCATIONS
 	#define LP_ENABLE_SHADER_DEBUG
 #else
-
-#ifdef LP_RELEASE
-	#define LP_ENABLE_SHADER_DEBUG
-#endif
+	#define LP_ENABLE_SHADER_OPTIMIZATION
 
 	#define LP_DEBUGBREAK();
 	#define LP_VK_CHECK(x) x
@@ -47,4 +44,7 @@ template<typename T, typename ... Args>
 constexpr Ref<T> CreateRef(Args&& ... args)
 {
 	return std::make_shared<T>(std::forward<Args>(args)...);
-}
\ No newline at end of file
+}
+
+template<typename T>
+using WeakRef = std::weak_ptr<T>;
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "lppch.h"
+#include "BarrierBatch.h"
+
+#include "Lamp/Log/Log.h"
+
+#include "Lamp/Rendering/Texture/Image2D.h"
+
+namespace Lamp
+{
+	namespace Utility
+	{
+		static constexpr VkAccessFlags2 WRITE_ACCESS_MASK = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+			VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+		inline static bool IsWriteAccess(VkAccessFlags2 access)
+		{
+			return (access & WRITE_ACCESS_MASK) != 0;
+		}
+	}
+
+	void BarrierBatch::TransitionImage(Image2D& image, VkImageLayout newLayout, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, const VkImageSubresourceRange& range)
+	{
+		const auto& specification = image.GetSpecification();
+
+		const uint32_t levelCount = range.levelCount == VK_REMAINING_MIP_LEVELS ? specification.mips - range.baseMipLevel : range.levelCount;
+		const uint32_t layerCount = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? specification.layers - range.baseArrayLayer : range.layerCount;
+
+		LP_CORE_ASSERT(range.baseMipLevel + levelCount <= specification.mips && range.baseArrayLayer + layerCount <= specification.layers, "Subresource range is outside of the image!");
+
+		const bool dstWrites = Utility::IsWriteAccess(dstAccess);
+		const size_t firstBarrier = m_imageBarriers.size();
+
+		auto addBarrier = [&](const Image2D::SubresourceState& state, uint32_t mip, uint32_t baseLayer, uint32_t count)
+		{
+			const VkAccessFlags2 srcAccess = state.access & Utility::WRITE_ACCESS_MASK;
+
+			// Runs covering the same layers of the previous mip with the same source state are extended instead
+			for (size_t index = m_imageBarriers.size(); index > firstBarrier; index--)
+			{
+				auto& barrier = m_imageBarriers[index - 1];
+				if (barrier.oldLayout == state.layout && barrier.srcStageMask == state.stage && barrier.srcAccessMask == srcAccess &&
+					barrier.subresourceRange.baseArrayLayer == baseLayer && barrier.subresourceRange.layerCount == count &&
+					barrier.subresourceRange.baseMipLevel + barrier.subresourceRange.levelCount == mip)
+				{
+					barrier.subresourceRange.levelCount++;
+					return;
+				}
+			}
+
+			AddImageBarrier(image.GetHandle(), state.stage, srcAccess, dstStage, dstAccess, state.layout, newLayout, { range.aspectMask, mip, 1, baseLayer, count });
+		};
+
+		for (uint32_t mip = range.baseMipLevel; mip < range.baseMipLevel + levelCount; mip++)
+		{
+			Image2D::SubresourceState runState{};
+			uint32_t runStart = 0;
+			uint32_t runCount = 0;
+
+			for (uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + layerCount; layer++)
+			{
+				auto& state = image.GetState(mip, layer);
+
+				// Reads of a subresource which is already in the layout and has not been written since its last barrier need nothing
+				if (state.layout == newLayout && !dstWrites && !Utility::IsWriteAccess(state.access))
+				{
+					state.stage |= dstStage;
+					state.access |= dstAccess;
+					continue;
+				}
+
+				const bool continuesRun = runCount > 0 && runStart + runCount == layer && runState.layout == state.layout && runState.stage == state.stage && runState.access == state.access;
+				if (!continuesRun)
+				{
+					if (runCount > 0)
+					{
+						addBarrier(runState, mip, runStart, runCount);
+					}
+
+					runState = state;
+					runStart = layer;
+					runCount = 0;
+				}
+
+				runCount++;
+				state = { newLayout, dstStage, dstAccess };
+			}
+
+			if (runCount > 0)
+			{
+				addBarrier(runState, mip, runStart, runCount);
+			}
+		}
+	}
+
+	void BarrierBatch::TransitionImage(Image2D& image, VkImageLayout newLayout, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
+	{
+		TransitionImage(image, newLayout, dstStage, dstAccess, image.GetSubresourceRange());
+	}
+
+	void BarrierBatch::AddImageBarrier(VkImage image, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, VkImageLayout oldLayout, VkImageLayout newLayout, const VkImageSubresourceRange& range, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+	{
+		auto& barrier = m_imageBarriers.emplace_back();
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		barrier.pNext = nullptr;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = srcQueueFamily;
+		barrier.dstQueueFamilyIndex = dstQueueFamily;
+		barrier.image = image;
+		barrier.subresourceRange = range;
+	}
+
+	void BarrierBatch::AddBufferBarrier(VkBuffer buffer, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, VkDeviceSize offset, VkDeviceSize size, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+	{
+		auto& barrier = m_bufferBarriers.emplace_back();
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+		barrier.pNext = nullptr;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+		barrier.srcQueueFamilyIndex = srcQueueFamily;
+		barrier.dstQueueFamilyIndex = dstQueueFamily;
+		barrier.buffer = buffer;
+		barrier.offset = offset;
+		barrier.size = size;
+	}
+
+	void BarrierBatch::AddMemoryBarrier(VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
+	{
+		auto& barrier = m_memoryBarriers.emplace_back();
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+		barrier.pNext = nullptr;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+	}
+
+	void BarrierBatch::Flush(VkCommandBuffer commandBuffer)
+	{
+		if (IsEmpty())
+		{
+			return;
+		}
+
+		VkDependencyInfo dependencyInfo{};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.memoryBarrierCount = (uint32_t)m_memoryBarriers.size();
+		dependencyInfo.pMemoryBarriers = m_memoryBarriers.data();
+		dependencyInfo.bufferMemoryBarrierCount = (uint32_t)m_bufferBarriers.size();
+		dependencyInfo.pBufferMemoryBarriers = m_bufferBarriers.data();
+		dependencyInfo.imageMemoryBarrierCount = (uint32_t)m_imageBarriers.size();
+		dependencyInfo.pImageMemoryBarriers = m_imageBarriers.data();
+
+		vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+		Clear();
+	}
+
+	void BarrierBatch::Clear()
+	{
+		m_imageBarriers.clear();
+		m_bufferBarriers.clear();
+		m_memoryBarriers.clear();
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace Lamp
+{
+	class Image2D;
+	class BarrierBatch
+	{
+	public:
+		// Transitions the tracked subresources in the range, subresources which are read again in the same layout are skipped
+		void TransitionImage(Image2D& image, VkImageLayout newLayout, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, const VkImageSubresourceRange& range);
+		void TransitionImage(Image2D& image, VkImageLayout newLayout, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess);
+
+		// Untracked barriers, the source scope is up to the caller
+		void AddImageBarrier(VkImage image, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, VkImageLayout oldLayout, VkImageLayout newLayout, const VkImageSubresourceRange& range, uint32_t srcQueueFamily = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED);
+		void AddBufferBarrier(VkBuffer buffer, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE, uint32_t srcQueueFamily = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED);
+		void AddMemoryBarrier(VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess);
+
+		// Records everything accumulated since the last flush with a single vkCmdPipelineBarrier2
+		void Flush(VkCommandBuffer commandBuffer);
+		void Clear();
+
+		inline const bool IsEmpty() const { return m_imageBarriers.empty() && m_bufferBarriers.empty() && m_memoryBarriers.empty(); }
+		inline const uint32_t GetBarrierCount() const { return (uint32_t)(m_imageBarriers.size() + m_bufferBarriers.size() + m_memoryBarriers.size()); }
+
+	private:
+		std::vector<VkImageMemoryBarrier2> m_imageBarriers;
+		std::vector<VkBufferMemoryBarrier2> m_bufferBarriers;
+		std::vector<VkMemoryBarrier2> m_memoryBarriers;
+	};
+}
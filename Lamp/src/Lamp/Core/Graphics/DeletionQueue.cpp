@@ -0,0 +1,353 @@
+#include "lppch.h"
+#include "DeletionQueue.h"
+
+#include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/DescriptorAllocator.h"
+#include "Lamp/Core/Graphics/VulkanAllocator.h"
+
+#include "Lamp/Log/Log.h"
+
+#include <deque>
+#include <mutex>
+
+namespace Lamp
+{
+	struct DeletionQueue::RetireList
+	{
+		struct AllocatedBuffer
+		{
+			VkBuffer buffer;
+			VmaAllocation allocation;
+		};
+
+		struct AllocatedImage
+		{
+			VkImage image;
+			VmaAllocation allocation;
+		};
+
+		struct DescriptorSets
+		{
+			VkDescriptorPool pool;
+			uint32_t setCount;
+		};
+
+		uint64_t timelineValue = 0;
+
+		// Cleared but not shrunk when recycled, so steady state retirement does not allocate
+		std::vector<AllocatedBuffer> buffers;
+		std::vector<AllocatedImage> images;
+		std::vector<VkImageView> imageViews;
+		std::vector<VkPipeline> pipelines;
+		std::vector<VkPipelineCache> pipelineCaches;
+		std::vector<DescriptorSets> descriptorSets;
+		std::vector<VmaAllocation> allocations;
+		std::vector<std::function<void()>> functions;
+
+		inline const uint64_t GetCount() const
+		{
+			return buffers.size() + images.size() + imageViews.size() + pipelines.size() + pipelineCaches.size() + descriptorSets.size() + allocations.size() + functions.size();
+		}
+	};
+
+	struct DeletionQueueData
+	{
+		Ref<GraphicsDevice> device;
+
+		Scope<DeletionQueue::RetireList> pendingList;
+		std::deque<Scope<DeletionQueue::RetireList>> submittedLists; // ordered by timeline value
+		std::vector<Scope<DeletionQueue::RetireList>> freeLists;
+
+		uint64_t totalRetired = 0;
+		std::mutex mutex;
+	};
+
+	static DeletionQueueData* s_deletionData = nullptr;
+
+	static constexpr uint32_t MAX_FREE_LISTS = 4;
+
+	void DeletionQueue::RetireBuffer(VkBuffer buffer, VmaAllocation allocation)
+	{
+		if (buffer == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ s_deletionData->mutex };
+		s_deletionData->pendingList->buffers.push_back({ buffer, allocation });
+	}
+
+	void DeletionQueue::RetireImage(VkImage image, VmaAllocation allocation)
+	{
+		if (image == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ s_deletionData->mutex };
+		s_deletionData->pendingList->images.push_back({ image, allocation });
+	}
+
+	void DeletionQueue::RetireAllocation(VmaAllocation allocation)
+	{
+		if (allocation == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ s_deletionData->mutex };
+		s_deletionData->pendingList->allocations.push_back(allocation);
+	}
+
+	void DeletionQueue::RetireImageView(VkImageView imageView)
+	{
+		if (imageView == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ s_deletionData->mutex };
+		s_deletionData->pendingList->imageViews.push_back(imageView);
+	}
+
+	void DeletionQueue::RetirePipeline(VkPipeline pipeline)
+	{
+		if (pipeline == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ s_deletionData->mutex };
+		s_deletionData->pendingList->pipelines.push_back(pipeline);
+	}
+
+	void DeletionQueue::RetirePipelineCache(VkPipelineCache pipelineCache)
+	{
+		if (pipelineCache == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ s_deletionData->mutex };
+		s_deletionData->pendingList->pipelineCaches.push_back(pipelineCache);
+	}
+
+	void DeletionQueue::RetireDescriptorSets(VkDescriptorPool pool, uint32_t setCount)
+	{
+		if (pool == VK_NULL_HANDLE || setCount == 0)
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ s_deletionData->mutex };
+		s_deletionData->pendingList->descriptorSets.push_back({ pool, setCount });
+	}
+
+	void DeletionQueue::RetireFunction(std::function<void()>&& function)
+	{
+		std::scoped_lock lock{ s_deletionData->mutex };
+		s_deletionData->pendingList->functions.emplace_back(std::move(function));
+	}
+
+	void DeletionQueue::Update()
+	{
+		const VkQueue graphicsQueue = s_deletionData->device->GetGraphicsQueue();
+		Update(s_deletionData->device->GetTimelineValue(graphicsQueue), s_deletionData->device->GetCompletedTimelineValue(graphicsQueue));
+	}
+
+	void DeletionQueue::Update(uint64_t submittedValue, uint64_t completedValue)
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::vector<Scope<RetireList>> completedLists;
+
+		{
+			std::scoped_lock lock{ s_deletionData->mutex };
+
+			// Anything retired so far may still be used by work submitted up to now
+			if (s_deletionData->pendingList->GetCount() > 0)
+			{
+				s_deletionData->pendingList->timelineValue = submittedValue;
+				s_deletionData->submittedLists.emplace_back(std::move(s_deletionData->pendingList));
+
+				if (!s_deletionData->freeLists.empty())
+				{
+					s_deletionData->pendingList = std::move(s_deletionData->freeLists.back());
+					s_deletionData->freeLists.pop_back();
+				}
+				else
+				{
+					s_deletionData->pendingList = CreateScope<RetireList>();
+				}
+			}
+
+			auto& submittedLists = s_deletionData->submittedLists;
+			while (!submittedLists.empty() && submittedLists.front()->timelineValue <= completedValue)
+			{
+				completedLists.emplace_back(std::move(submittedLists.front()));
+				submittedLists.pop_front();
+			}
+		}
+
+		// Destroyed outside of the lock, retired functions might release further resources
+		for (auto& list : completedLists)
+		{
+			DestroyList(*list);
+			RecycleList(std::move(list));
+		}
+	}
+
+	void DeletionQueue::Flush()
+	{
+		LP_PROFILE_FUNCTION();
+
+		// Retired functions can release further resources, so keep going until nothing is left
+		bool hasRetirements = true;
+		while (hasRetirements)
+		{
+			std::vector<Scope<RetireList>> lists;
+
+			{
+				std::scoped_lock lock{ s_deletionData->mutex };
+
+				for (auto& list : s_deletionData->submittedLists)
+				{
+					lists.emplace_back(std::move(list));
+				}
+
+				s_deletionData->submittedLists.clear();
+
+				lists.emplace_back(std::move(s_deletionData->pendingList));
+				s_deletionData->pendingList = CreateScope<RetireList>();
+			}
+
+			for (auto& list : lists)
+			{
+				DestroyList(*list);
+			}
+
+			std::scoped_lock lock{ s_deletionData->mutex };
+			hasRetirements = s_deletionData->pendingList->GetCount() > 0;
+		}
+	}
+
+	DeletionQueue::Statistics DeletionQueue::GetStatistics()
+	{
+		std::scoped_lock lock{ s_deletionData->mutex };
+
+		Statistics stats{};
+		stats.totalRetired = s_deletionData->totalRetired;
+		stats.retireLists = (uint32_t)s_deletionData->submittedLists.size();
+		stats.freeLists = (uint32_t)s_deletionData->freeLists.size();
+		stats.pendingRetirements = s_deletionData->pendingList->GetCount();
+
+		for (const auto& list : s_deletionData->submittedLists)
+		{
+			stats.pendingRetirements += list->GetCount();
+		}
+
+		return stats;
+	}
+
+	void DeletionQueue::Initialize(Ref<GraphicsDevice> graphicsDevice)
+	{
+		s_deletionData = new DeletionQueueData();
+		s_deletionData->device = graphicsDevice;
+		s_deletionData->pendingList = CreateScope<RetireList>();
+	}
+
+	void DeletionQueue::Shutdown()
+	{
+		Flush();
+
+		delete s_deletionData;
+		s_deletionData = nullptr;
+	}
+
+	void DeletionQueue::DestroyList(RetireList& list)
+	{
+		LP_PROFILE_FUNCTION();
+
+		// Functions first, they might hold references to objects which retire further resources
+		for (auto it = list.functions.rbegin(); it != list.functions.rend(); it++)
+		{
+			(*it)();
+		}
+
+		// Without a device the typed lists are only counted, which lets the queue run without Vulkan
+		if (s_deletionData->device)
+		{
+			const VkDevice device = s_deletionData->device->GetHandle();
+
+			for (const auto& descriptorSets : list.descriptorSets)
+			{
+				DescriptorAllocator::Free(descriptorSets.pool, descriptorSets.setCount);
+			}
+
+			for (const auto& pipeline : list.pipelines)
+			{
+				vkDestroyPipeline(device, pipeline, nullptr);
+			}
+
+			for (const auto& pipelineCache : list.pipelineCaches)
+			{
+				vkDestroyPipelineCache(device, pipelineCache, nullptr);
+			}
+
+			// Views have to go before the images they were created from
+			for (const auto& imageView : list.imageViews)
+			{
+				vkDestroyImageView(device, imageView, nullptr);
+			}
+
+			VulkanAllocator allocator{ "DeletionQueue - Destroy" };
+
+			for (const auto& image : list.images)
+			{
+				if (image.allocation)
+				{
+					allocator.DestroyImage(image.image, image.allocation);
+				}
+				else
+				{
+					vkDestroyImage(device, image.image, nullptr);
+				}
+			}
+
+			for (const auto& buffer : list.buffers)
+			{
+				allocator.DestroyBuffer(buffer.buffer, buffer.allocation);
+			}
+
+			// Memory goes last, aliasing images placed in it are destroyed above
+			for (const auto& allocation : list.allocations)
+			{
+				allocator.Free(allocation);
+			}
+		}
+
+		{
+			std::scoped_lock lock{ s_deletionData->mutex };
+			s_deletionData->totalRetired += list.GetCount();
+		}
+
+		list.buffers.clear();
+		list.images.clear();
+		list.imageViews.clear();
+		list.pipelines.clear();
+		list.pipelineCaches.clear();
+		list.descriptorSets.clear();
+		list.allocations.clear();
+		list.functions.clear();
+	}
+
+	void DeletionQueue::RecycleList(Scope<RetireList>&& list)
+	{
+		std::scoped_lock lock{ s_deletionData->mutex };
+
+		if (s_deletionData->freeLists.size() < MAX_FREE_LISTS)
+		{
+			s_deletionData->freeLists.emplace_back(std::move(list));
+		}
+	}
+}
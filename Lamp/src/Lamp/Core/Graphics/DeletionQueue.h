@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+
+#include <vulkan/vulkan.h>
+#include <vma/VulkanMemoryAllocator.h>
+
+#include <functional>
+
+namespace Lamp
+{
+	class GraphicsDevice;
+	class DeletionQueue
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t pendingRetirements = 0; // not yet destroyed
+			uint64_t totalRetired = 0;
+
+			uint32_t retireLists = 0; // lists waiting on the timeline
+			uint32_t freeLists = 0; // destroyed lists kept for reuse
+		};
+
+		// Resources are destroyed once the graphics timeline has passed all work submitted before they were retired
+		static void RetireBuffer(VkBuffer buffer, VmaAllocation allocation);
+		static void RetireImage(VkImage image, VmaAllocation allocation); // Images aliasing memory they do not own are retired with a null allocation
+		static void RetireAllocation(VmaAllocation allocation);
+		static void RetireImageView(VkImageView imageView);
+		static void RetirePipeline(VkPipeline pipeline);
+		static void RetirePipelineCache(VkPipelineCache pipelineCache);
+		static void RetireDescriptorSets(VkDescriptorPool pool, uint32_t setCount);
+
+		// For anything without a typed list, allocates per item
+		static void RetireFunction(std::function<void()>&& function);
+
+		// Tags the resources retired since the last call with the current graphics timeline value and destroys completed lists
+		static void Update();
+		static void Update(uint64_t submittedValue, uint64_t completedValue); // with the graphics timeline values already known
+
+		// Destroys everything regardless of the timeline, the device has to be idle
+		static void Flush();
+
+		static Statistics GetStatistics();
+
+		static void Initialize(Ref<GraphicsDevice> graphicsDevice); // without a device only retired functions are destroyed, typed retirements are dropped
+		static void Shutdown();
+
+	private:
+		DeletionQueue() = delete;
+
+		struct RetireList;
+		friend struct DeletionQueueData;
+
+		static void DestroyList(RetireList& list);
+		static void RecycleList(Scope<RetireList>&& list);
+	};
+}
@@ -0,0 +1,325 @@
+#include "lppch.h"
+#include "DescriptorAllocator.h"
+
+#include "Lamp/Core/Graphics/GraphicsDevice.h"
+
+#include "Lamp/Log/Log.h"
+
+#include <mutex>
+
+namespace Lamp
+{
+	namespace Utility
+	{
+		inline static bool ShouldGrowDescriptorPool(VkResult result)
+		{
+			return result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL;
+		}
+	}
+
+	struct FrameDescriptorPools
+	{
+		std::vector<VkDescriptorPool> pools;
+		uint32_t currentPool = 0;
+		uint32_t allocatedSets = 0;
+	};
+
+	struct DescriptorAllocatorData
+	{
+		VkDevice device = nullptr;
+
+		VkDescriptorPool currentPool = nullptr;
+		std::unordered_map<VkDescriptorPool, uint32_t> persistentPools; // pool -> live set count
+		std::vector<VkDescriptorPool> freePools;
+		std::vector<FrameDescriptorPools> framePools;
+
+		uint32_t createdPools = 0;
+		uint32_t liveSets = 0;
+
+		std::mutex mutex;
+	};
+
+	static DescriptorAllocatorData* s_descriptorData = nullptr;
+
+	static constexpr uint32_t SETS_PER_POOL = 1024;
+	static constexpr uint32_t MAX_FREE_POOLS = 8;
+
+	// Twice the requested sets at the standard ratios, so sets heavier than the ratios assume fit as well
+	static constexpr uint32_t GetDedicatedPoolSize(uint32_t setCount) { return std::max(setCount, SETS_PER_POOL) * 2; }
+
+	VkDescriptorPool DescriptorAllocator::Allocate(VkDescriptorSetAllocateInfo allocInfo, VkDescriptorSet* outSets)
+	{
+		LP_PROFILE_FUNCTION();
+
+		if (allocInfo.descriptorSetCount == 0)
+		{
+			return nullptr;
+		}
+
+		std::scoped_lock lock{ s_descriptorData->mutex };
+
+		if (!s_descriptorData->currentPool)
+		{
+			s_descriptorData->currentPool = GetPool();
+		}
+
+		allocInfo.descriptorPool = s_descriptorData->currentPool;
+		VkResult result = vkAllocateDescriptorSets(s_descriptorData->device, &allocInfo, outSets);
+
+		if (Utility::ShouldGrowDescriptorPool(result))
+		{
+			// The full pool stays alive until all of its sets have been freed
+			if (s_descriptorData->persistentPools[s_descriptorData->currentPool] == 0)
+			{
+				s_descriptorData->persistentPools.erase(s_descriptorData->currentPool);
+				RecyclePool(s_descriptorData->currentPool);
+			}
+
+			s_descriptorData->currentPool = GetPool();
+			allocInfo.descriptorPool = s_descriptorData->currentPool;
+			result = vkAllocateDescriptorSets(s_descriptorData->device, &allocInfo, outSets);
+		}
+
+		if (Utility::ShouldGrowDescriptorPool(result))
+		{
+			// The request does not fit an empty pool, it gets one of its own. It is recycled like any other pool once its sets are freed
+			allocInfo.descriptorPool = CreatePool(GetDedicatedPoolSize(allocInfo.descriptorSetCount));
+			result = vkAllocateDescriptorSets(s_descriptorData->device, &allocInfo, outSets);
+
+			if (result != VK_SUCCESS)
+			{
+				RecyclePool(allocInfo.descriptorPool);
+			}
+		}
+
+		if (result != VK_SUCCESS)
+		{
+			LP_CORE_ERROR("Failed to allocate {0} descriptor sets: {1}", allocInfo.descriptorSetCount, VKResultToString(result));
+			std::fill_n(outSets, allocInfo.descriptorSetCount, VK_NULL_HANDLE);
+
+			return nullptr;
+		}
+
+		s_descriptorData->persistentPools[allocInfo.descriptorPool] += allocInfo.descriptorSetCount;
+		s_descriptorData->liveSets += allocInfo.descriptorSetCount;
+
+		return allocInfo.descriptorPool;
+	}
+
+	void DescriptorAllocator::Free(VkDescriptorPool pool, uint32_t setCount)
+	{
+		if (!pool || !s_descriptorData)
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ s_descriptorData->mutex };
+
+		auto it = s_descriptorData->persistentPools.find(pool);
+		if (it == s_descriptorData->persistentPools.end())
+		{
+			LP_CORE_ERROR("Trying to free descriptor sets from a pool not owned by the descriptor allocator!");
+			return;
+		}
+
+		LP_CORE_ASSERT(it->second >= setCount, "Freeing more descriptor sets than were allocated from pool!");
+
+		it->second -= setCount;
+		s_descriptorData->liveSets -= setCount;
+
+		if (it->second == 0 && pool != s_descriptorData->currentPool)
+		{
+			s_descriptorData->persistentPools.erase(it);
+			RecyclePool(pool);
+		}
+	}
+
+	bool DescriptorAllocator::AllocateFrame(VkDescriptorSetAllocateInfo allocInfo, uint32_t frameIndex, VkDescriptorSet* outSets)
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::scoped_lock lock{ s_descriptorData->mutex };
+
+		if (frameIndex >= (uint32_t)s_descriptorData->framePools.size())
+		{
+			s_descriptorData->framePools.resize(frameIndex + 1);
+		}
+
+		auto& frame = s_descriptorData->framePools[frameIndex];
+		if (frame.pools.empty())
+		{
+			frame.pools.emplace_back(GetPool());
+		}
+
+		allocInfo.descriptorPool = frame.pools[frame.currentPool];
+		VkResult result = vkAllocateDescriptorSets(s_descriptorData->device, &allocInfo, outSets);
+
+		if (Utility::ShouldGrowDescriptorPool(result))
+		{
+			frame.currentPool++;
+			if (frame.currentPool == (uint32_t)frame.pools.size())
+			{
+				frame.pools.emplace_back(GetPool());
+			}
+
+			allocInfo.descriptorPool = frame.pools[frame.currentPool];
+			result = vkAllocateDescriptorSets(s_descriptorData->device, &allocInfo, outSets);
+		}
+
+		if (Utility::ShouldGrowDescriptorPool(result))
+		{
+			// Becomes the current pool of the frame, so it is reset with the others
+			frame.currentPool++;
+			frame.pools.insert(frame.pools.begin() + frame.currentPool, CreatePool(GetDedicatedPoolSize(allocInfo.descriptorSetCount)));
+
+			allocInfo.descriptorPool = frame.pools[frame.currentPool];
+			result = vkAllocateDescriptorSets(s_descriptorData->device, &allocInfo, outSets);
+		}
+
+		if (result != VK_SUCCESS)
+		{
+			LP_CORE_ERROR("Failed to allocate {0} frame descriptor sets: {1}", allocInfo.descriptorSetCount, VKResultToString(result));
+			std::fill_n(outSets, allocInfo.descriptorSetCount, VK_NULL_HANDLE);
+
+			return false;
+		}
+
+		frame.allocatedSets += allocInfo.descriptorSetCount;
+		return true;
+	}
+
+	void DescriptorAllocator::ResetFrame(uint32_t frameIndex)
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::scoped_lock lock{ s_descriptorData->mutex };
+
+		if (frameIndex >= (uint32_t)s_descriptorData->framePools.size())
+		{
+			return;
+		}
+
+		auto& frame = s_descriptorData->framePools[frameIndex];
+
+		// Only the pools used last time need a reset, the rest are already empty
+		for (uint32_t i = 0; i <= frame.currentPool && i < (uint32_t)frame.pools.size(); i++)
+		{
+			LP_VK_CHECK(vkResetDescriptorPool(s_descriptorData->device, frame.pools[i], 0));
+		}
+
+		frame.currentPool = 0;
+		frame.allocatedSets = 0;
+	}
+
+	DescriptorAllocator::Statistics DescriptorAllocator::GetStatistics()
+	{
+		std::scoped_lock lock{ s_descriptorData->mutex };
+
+		Statistics stats{};
+		stats.liveSets = s_descriptorData->liveSets;
+		stats.livePools = s_descriptorData->createdPools;
+		stats.freePools = (uint32_t)s_descriptorData->freePools.size();
+
+		for (const auto& frame : s_descriptorData->framePools)
+		{
+			stats.frameSets += frame.allocatedSets;
+		}
+
+		return stats;
+	}
+
+	void DescriptorAllocator::Initialize(Ref<GraphicsDevice> graphicsDevice)
+	{
+		s_descriptorData = new DescriptorAllocatorData();
+		s_descriptorData->device = graphicsDevice->GetHandle();
+	}
+
+	void DescriptorAllocator::Shutdown()
+	{
+		if (s_descriptorData->liveSets > 0)
+		{
+			LP_CORE_WARN("Descriptor allocator shut down with {0} live descriptor sets!", s_descriptorData->liveSets);
+		}
+
+		for (const auto& [pool, setCount] : s_descriptorData->persistentPools)
+		{
+			vkDestroyDescriptorPool(s_descriptorData->device, pool, nullptr);
+		}
+
+		if (s_descriptorData->currentPool && s_descriptorData->persistentPools.find(s_descriptorData->currentPool) == s_descriptorData->persistentPools.end())
+		{
+			vkDestroyDescriptorPool(s_descriptorData->device, s_descriptorData->currentPool, nullptr);
+		}
+
+		for (const auto& pool : s_descriptorData->freePools)
+		{
+			vkDestroyDescriptorPool(s_descriptorData->device, pool, nullptr);
+		}
+
+		for (const auto& frame : s_descriptorData->framePools)
+		{
+			for (const auto& pool : frame.pools)
+			{
+				vkDestroyDescriptorPool(s_descriptorData->device, pool, nullptr);
+			}
+		}
+
+		delete s_descriptorData;
+		s_descriptorData = nullptr;
+	}
+
+	VkDescriptorPool DescriptorAllocator::GetPool()
+	{
+		if (!s_descriptorData->freePools.empty())
+		{
+			VkDescriptorPool pool = s_descriptorData->freePools.back();
+			s_descriptorData->freePools.pop_back();
+
+			return pool;
+		}
+
+		return CreatePool(SETS_PER_POOL);
+	}
+
+	VkDescriptorPool DescriptorAllocator::CreatePool(uint32_t setCount)
+	{
+		VkDescriptorPoolSize poolSizes[] =
+		{
+			{ VK_DESCRIPTOR_TYPE_SAMPLER, setCount / 2 },
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, setCount * 4 },
+			{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, setCount / 2 },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, setCount },
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, setCount * 2 },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, setCount * 2 },
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, setCount * 2 },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, setCount }
+		};
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = 0;
+		poolInfo.maxSets = setCount;
+		poolInfo.poolSizeCount = (uint32_t)ARRAYSIZE(poolSizes);
+		poolInfo.pPoolSizes = poolSizes;
+
+		VkDescriptorPool pool = nullptr;
+		LP_VK_CHECK(vkCreateDescriptorPool(s_descriptorData->device, &poolInfo, nullptr, &pool));
+
+		s_descriptorData->createdPools++;
+		return pool;
+	}
+
+	void DescriptorAllocator::RecyclePool(VkDescriptorPool pool)
+	{
+		if (s_descriptorData->freePools.size() >= MAX_FREE_POOLS)
+		{
+			vkDestroyDescriptorPool(s_descriptorData->device, pool, nullptr);
+			s_descriptorData->createdPools--;
+
+			return;
+		}
+
+		LP_VK_CHECK(vkResetDescriptorPool(s_descriptorData->device, pool, 0));
+		s_descriptorData->freePools.emplace_back(pool);
+	}
+}
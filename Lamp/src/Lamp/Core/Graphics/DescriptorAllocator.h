@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+
+#include <vulkan/vulkan.h>
+
+namespace Lamp
+{
+	class GraphicsDevice;
+	class DescriptorAllocator
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t liveSets = 0;
+			uint32_t frameSets = 0;
+
+			uint32_t livePools = 0;
+			uint32_t freePools = 0;
+		};
+
+		// Persistent sets, released per pool once all sets allocated from it are freed. Returns nullptr and null sets on failure
+		static VkDescriptorPool Allocate(VkDescriptorSetAllocateInfo allocInfo, VkDescriptorSet* outSets);
+		static void Free(VkDescriptorPool pool, uint32_t setCount);
+
+		// Transient sets, all frame pools are reset wholesale at the start of the frame
+		static bool AllocateFrame(VkDescriptorSetAllocateInfo allocInfo, uint32_t frameIndex, VkDescriptorSet* outSets);
+		static void ResetFrame(uint32_t frameIndex);
+
+		static Statistics GetStatistics();
+
+		static void Initialize(Ref<GraphicsDevice> graphicsDevice);
+		static void Shutdown();
+
+	private:
+		DescriptorAllocator() = delete;
+
+		static VkDescriptorPool GetPool();
+		static VkDescriptorPool CreatePool(uint32_t setCount);
+		static void RecyclePool(VkDescriptorPool pool);
+	};
+}
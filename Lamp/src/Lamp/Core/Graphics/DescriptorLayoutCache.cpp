@@ -0,0 +1,203 @@
+#include "lppch.h"
+#include "DescriptorLayoutCache.h"
+
+#include "Lamp/Core/Graphics/GraphicsDevice.h"
+
+#include "Lamp/Log/Log.h"
+#include "Lamp/Rendering/Shader/ShaderUtility.h"
+
+#include <mutex>
+
+namespace Lamp
+{
+	namespace Utility
+	{
+		inline static bool IsEqual(const VkDescriptorSetLayoutBinding& lhs, const VkDescriptorSetLayoutBinding& rhs)
+		{
+			return lhs.binding == rhs.binding && lhs.descriptorType == rhs.descriptorType && lhs.descriptorCount == rhs.descriptorCount && lhs.stageFlags == rhs.stageFlags;
+		}
+
+		inline static bool IsEqual(const VkPushConstantRange& lhs, const VkPushConstantRange& rhs)
+		{
+			return lhs.stageFlags == rhs.stageFlags && lhs.offset == rhs.offset && lhs.size == rhs.size;
+		}
+
+		template<typename T>
+		inline static bool IsEqual(const std::vector<T>& lhs, const std::vector<T>& rhs)
+		{
+			return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const T& a, const T& b) { return IsEqual(a, b); });
+		}
+	}
+
+	struct SetLayoutDescription
+	{
+		std::vector<VkDescriptorSetLayoutBinding> bindings; // sorted by binding
+
+		bool operator==(const SetLayoutDescription& other) const
+		{
+			return Utility::IsEqual(bindings, other.bindings);
+		}
+	};
+
+	struct PipelineLayoutDescription
+	{
+		std::vector<VkDescriptorSetLayout> setLayouts;
+		std::vector<VkPushConstantRange> pushConstantRanges;
+
+		bool operator==(const PipelineLayoutDescription& other) const
+		{
+			return setLayouts == other.setLayouts && Utility::IsEqual(pushConstantRanges, other.pushConstantRanges);
+		}
+	};
+
+	struct SetLayoutDescriptionHash
+	{
+		size_t operator()(const SetLayoutDescription& description) const
+		{
+			size_t hash = std::hash<size_t>()(description.bindings.size());
+			for (const auto& binding : description.bindings)
+			{
+				hash = Utility::HashCombine(hash, std::hash<uint32_t>()(binding.binding));
+				hash = Utility::HashCombine(hash, std::hash<uint32_t>()((uint32_t)binding.descriptorType));
+				hash = Utility::HashCombine(hash, std::hash<uint32_t>()(binding.descriptorCount));
+				hash = Utility::HashCombine(hash, std::hash<uint32_t>()(binding.stageFlags));
+			}
+
+			return hash;
+		}
+	};
+
+	struct PipelineLayoutDescriptionHash
+	{
+		size_t operator()(const PipelineLayoutDescription& description) const
+		{
+			size_t hash = std::hash<size_t>()(description.setLayouts.size());
+			for (const auto& setLayout : description.setLayouts)
+			{
+				hash = Utility::HashCombine(hash, std::hash<VkDescriptorSetLayout>()(setLayout));
+			}
+
+			for (const auto& range : description.pushConstantRanges)
+			{
+				hash = Utility::HashCombine(hash, std::hash<uint32_t>()(range.stageFlags));
+				hash = Utility::HashCombine(hash, std::hash<uint32_t>()(range.offset));
+				hash = Utility::HashCombine(hash, std::hash<uint32_t>()(range.size));
+			}
+
+			return hash;
+		}
+	};
+
+	struct DescriptorLayoutCacheData
+	{
+		VkDevice device = nullptr;
+
+		std::unordered_map<SetLayoutDescription, VkDescriptorSetLayout, SetLayoutDescriptionHash> setLayouts;
+		std::unordered_map<PipelineLayoutDescription, VkPipelineLayout, PipelineLayoutDescriptionHash> pipelineLayouts;
+
+		uint32_t requestedSetLayouts = 0;
+		uint32_t requestedPipelineLayouts = 0;
+
+		std::mutex mutex;
+	};
+
+	static DescriptorLayoutCacheData* s_layoutCacheData = nullptr;
+
+	VkDescriptorSetLayout DescriptorLayoutCache::GetOrCreateSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+	{
+		SetLayoutDescription description{ bindings };
+		std::sort(description.bindings.begin(), description.bindings.end(), [](const auto& lhs, const auto& rhs) { return lhs.binding < rhs.binding; });
+
+		std::scoped_lock lock{ s_layoutCacheData->mutex };
+		s_layoutCacheData->requestedSetLayouts++;
+
+		auto it = s_layoutCacheData->setLayouts.find(description);
+		if (it != s_layoutCacheData->setLayouts.end())
+		{
+			return it->second;
+		}
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = nullptr;
+		layoutInfo.bindingCount = (uint32_t)description.bindings.size();
+		layoutInfo.pBindings = description.bindings.data();
+
+		VkDescriptorSetLayout setLayout = nullptr;
+		LP_VK_CHECK(vkCreateDescriptorSetLayout(s_layoutCacheData->device, &layoutInfo, nullptr, &setLayout));
+
+		s_layoutCacheData->setLayouts.emplace(std::move(description), setLayout);
+		return setLayout;
+	}
+
+	VkPipelineLayout DescriptorLayoutCache::GetOrCreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges)
+	{
+		PipelineLayoutDescription description{ setLayouts, pushConstantRanges };
+
+		std::scoped_lock lock{ s_layoutCacheData->mutex };
+		s_layoutCacheData->requestedPipelineLayouts++;
+
+		auto it = s_layoutCacheData->pipelineLayouts.find(description);
+		if (it != s_layoutCacheData->pipelineLayouts.end())
+		{
+			return it->second;
+		}
+
+		VkPipelineLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		layoutInfo.setLayoutCount = (uint32_t)description.setLayouts.size();
+		layoutInfo.pSetLayouts = description.setLayouts.data();
+		layoutInfo.pushConstantRangeCount = (uint32_t)description.pushConstantRanges.size();
+		layoutInfo.pPushConstantRanges = description.pushConstantRanges.data();
+
+		VkPipelineLayout pipelineLayout = nullptr;
+		LP_VK_CHECK(vkCreatePipelineLayout(s_layoutCacheData->device, &layoutInfo, nullptr, &pipelineLayout));
+
+		s_layoutCacheData->pipelineLayouts.emplace(std::move(description), pipelineLayout);
+		return pipelineLayout;
+	}
+
+	DescriptorLayoutCache::Statistics DescriptorLayoutCache::GetStatistics()
+	{
+		std::scoped_lock lock{ s_layoutCacheData->mutex };
+
+		Statistics stats{};
+		stats.requestedSetLayouts = s_layoutCacheData->requestedSetLayouts;
+		stats.uniqueSetLayouts = (uint32_t)s_layoutCacheData->setLayouts.size();
+		stats.requestedPipelineLayouts = s_layoutCacheData->requestedPipelineLayouts;
+		stats.uniquePipelineLayouts = (uint32_t)s_layoutCacheData->pipelineLayouts.size();
+
+		return stats;
+	}
+
+	void DescriptorLayoutCache::LogStatistics()
+	{
+		const Statistics stats = GetStatistics();
+
+		LP_CORE_INFO("Descriptor layout cache:");
+		LP_CORE_INFO("	Set layouts: {0} requested, {1} created", stats.requestedSetLayouts, stats.uniqueSetLayouts);
+		LP_CORE_INFO("	Pipeline layouts: {0} requested, {1} created", stats.requestedPipelineLayouts, stats.uniquePipelineLayouts);
+	}
+
+	void DescriptorLayoutCache::Initialize(Ref<GraphicsDevice> graphicsDevice)
+	{
+		s_layoutCacheData = new DescriptorLayoutCacheData();
+		s_layoutCacheData->device = graphicsDevice->GetHandle();
+	}
+
+	void DescriptorLayoutCache::Shutdown()
+	{
+		for (const auto& [description, pipelineLayout] : s_layoutCacheData->pipelineLayouts)
+		{
+			vkDestroyPipelineLayout(s_layoutCacheData->device, pipelineLayout, nullptr);
+		}
+
+		for (const auto& [description, setLayout] : s_layoutCacheData->setLayouts)
+		{
+			vkDestroyDescriptorSetLayout(s_layoutCacheData->device, setLayout, nullptr);
+		}
+
+		delete s_layoutCacheData;
+		s_layoutCacheData = nullptr;
+	}
+}
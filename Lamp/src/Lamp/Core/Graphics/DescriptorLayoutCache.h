@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace Lamp
+{
+	class GraphicsDevice;
+	class DescriptorLayoutCache
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t requestedSetLayouts = 0;
+			uint32_t uniqueSetLayouts = 0;
+
+			uint32_t requestedPipelineLayouts = 0;
+			uint32_t uniquePipelineLayouts = 0;
+		};
+
+		// Layouts are hash-consed on their description and live until shutdown, so equal handles mean compatible layouts
+		static VkDescriptorSetLayout GetOrCreateSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+		static VkPipelineLayout GetOrCreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges);
+
+		static Statistics GetStatistics();
+		static void LogStatistics();
+
+		static void Initialize(Ref<GraphicsDevice> graphicsDevice);
+		static void Shutdown();
+
+	private:
+		DescriptorLayoutCache() = delete;
+	};
+}
@@ -6,6 +6,10 @@
 
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
 #include "Lamp/Core/Graphics/VulkanAllocator.h"
+#include "Lamp/Core/Graphics/DescriptorAllocator.h"
+#include "Lamp/Core/Graphics/DescriptorLayoutCache.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
 
 #include <vulkan/vulkan.h>
 #include <GLFW/glfw3.h>
@@ -91,9 +95,14 @@ namespace Lamp
 		dynamicRendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
 		dynamicRendering.dynamicRendering = VK_TRUE;
 
+		VkPhysicalDeviceSynchronization2Features synchronization2{};
+		synchronization2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+		synchronization2.pNext = &dynamicRendering;
+		synchronization2.synchronization2 = VK_TRUE;
+
 		VkPhysicalDeviceVulkan11Features vulkan11Features{};
 		vulkan11Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
-		vulkan11Features.pNext = &dynamicRendering;		
+		vulkan11Features.pNext = &synchronization2;
 		vulkan11Features.shaderDrawParameters = VK_TRUE;
 
 		VkPhysicalDeviceVulkan12Features vk12Features{};
@@ -110,10 +119,18 @@ namespace Lamp
 		m_device = GraphicsDevice::Create(m_physicalDevice, enabledFeatures);
 
 		VulkanAllocator::Initialize(m_device);
+		DescriptorAllocator::Initialize(m_device);
+		DescriptorLayoutCache::Initialize(m_device);
+		UploadManager::Initialize(m_device);
+		DeletionQueue::Initialize(m_device);
 	}
 
 	void GraphicsContext::Shutdown()
 	{
+		UploadManager::Shutdown();
+		DeletionQueue::Shutdown();
+		DescriptorLayoutCache::Shutdown();
+		DescriptorAllocator::Shutdown();
 		VulkanAllocator::Shutdown();
 		
 		m_device = nullptr;
@@ -178,6 +195,19 @@ namespace Lamp
 
 		createInfo.pNext = (VkDebugUtilsMessengerCreateInfoEXT*)&debugCreateInfo;
 
+		#ifdef LP_ENABLE_SYNC_VALIDATION
+		// Reports hazards between the recorded barriers and the accesses, slows down every submit considerably
+		const VkValidationFeatureEnableEXT enabledFeatures[] = { VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT };
+
+		VkValidationFeaturesEXT validationFeatures{};
+		validationFeatures.sType = VK_STRUCTURE_TYPE_VALIDATION_FEATURES_EXT;
+		validationFeatures.pNext = &debugCreateInfo;
+		validationFeatures.enabledValidationFeatureCount = (uint32_t)ARRAYSIZE(enabledFeatures);
+		validationFeatures.pEnabledValidationFeatures = enabledFeatures;
+
+		createInfo.pNext = &validationFeatures;
+		#endif
+
 		createInfo.enabledLayerCount = static_cast<uint32_t>(m_validationLayers.size());
 		createInfo.ppEnabledLayerNames = m_validationLayers.data();
 		#else
@@ -260,6 +290,10 @@ namespace Lamp
 		extensionsVector.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 		#endif
 
+		#ifdef LP_ENABLE_SYNC_VALIDATION
+		extensionsVector.push_back(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME); // provided by the validation layer
+		#endif
+
 		return extensionsVector;
 	}
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 #include "Lamp/Log/Log.h"
 #include "Lamp/Core/Base.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
+
+#include <array>
 
 namespace Lamp
 {
@@ -30,12 +33,87 @@ namespace Lamp
 
 		m_capabilities.minUBOOffsetAlignment = m_physicalDeviceProperties.limits.minUniformBufferOffsetAlignment;
 		m_capabilities.minSSBOOffsetAlignment = m_physicalDeviceProperties.limits.minStorageBufferOffsetAlignment;
+		m_capabilities.timestampPeriod = m_physicalDeviceProperties.limits.timestampPeriod;
+		m_capabilities.hasQueueTimestamps = m_physicalDeviceProperties.limits.timestampComputeAndGraphics == VK_TRUE;
 
 		if (!m_physicalDevice)
 		{
 			throw std::runtime_error("Failed to find a supported device!");
 		}
 
+		// Memory heaps
+		{
+			// Without resizable BAR only a small window of device local memory is host visible
+			constexpr VkDeviceSize MIN_REBAR_HEAP_SIZE = 256ull * 1024ull * 1024ull;
+			constexpr VkMemoryPropertyFlags rebarFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+			vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+
+			for (uint32_t heapIndex = 0; heapIndex < m_memoryProperties.memoryHeapCount; heapIndex++)
+			{
+				const VkMemoryHeap& heap = m_memoryProperties.memoryHeaps[heapIndex];
+				LP_CORE_INFO("Memory heap {0}: {1} MB, device local: {2}", heapIndex, heap.size / (1024ull * 1024ull), (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0);
+			}
+
+			for (uint32_t typeIndex = 0; typeIndex < m_memoryProperties.memoryTypeCount; typeIndex++)
+			{
+				const VkMemoryType& type = m_memoryProperties.memoryTypes[typeIndex];
+				const VkMemoryHeap& heap = m_memoryProperties.memoryHeaps[type.heapIndex];
+
+				if ((type.propertyFlags & rebarFlags) == rebarFlags && heap.size > MIN_REBAR_HEAP_SIZE)
+				{
+					m_capabilities.hasResizableBAR = true;
+				}
+			}
+
+			LP_CORE_INFO("Resizable BAR: {0}", m_capabilities.hasResizableBAR ? "available" : "not available");
+		}
+
+		// Optional extensions
+		{
+			uint32_t extensionCount = 0;
+			vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr);
+
+			std::vector<VkExtensionProperties> extensions(extensionCount);
+			vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, extensions.data());
+
+			for (const auto& extension : extensions)
+			{
+				if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+				{
+					m_capabilities.hasMemoryBudget = true;
+				}
+
+				if (strcmp(extension.extensionName, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) == 0)
+				{
+					m_capabilities.hasCalibratedTimestamps = true;
+				}
+			}
+		}
+
+		// Calibrated timestamps are only useful if both the device and the host clock can be sampled
+		if (m_capabilities.hasCalibratedTimestamps)
+		{
+			auto getTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+
+			uint32_t domainCount = 0;
+			std::vector<VkTimeDomainEXT> domains;
+
+			if (getTimeDomains)
+			{
+				getTimeDomains(m_physicalDevice, &domainCount, nullptr);
+				domains.resize(domainCount);
+				getTimeDomains(m_physicalDevice, &domainCount, domains.data());
+			}
+
+			const bool hasDeviceDomain = std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != domains.end();
+			const bool hasHostDomain = std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT) != domains.end();
+
+			m_capabilities.hasCalibratedTimestamps = hasDeviceDomain && hasHostDomain;
+		}
+
+		LP_CORE_INFO("Calibrated timestamps: {0}", m_capabilities.hasCalibratedTimestamps ? "available" : "not available, queue overlap will not be measured");
+
 		uint32_t queueFamilyCount = 0;
 		vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
 		LP_CORE_ASSERT(queueFamilyCount > 0, "No queue families supported!");
@@ -44,7 +122,6 @@ namespace Lamp
 		vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, queueFamilyProperties.data());
 
 		int32_t i = 0;
-		bool foundQueues = false;
 		for (const auto& prop : queueFamilyProperties)
 		{
 			if (prop.queueFlags & VK_QUEUE_GRAPHICS_BIT)
@@ -66,14 +143,25 @@ namespace Lamp
 
 			if (m_queueIndices.IsComplete())
 			{
-				foundQueues = true;
 				break;
 			}
 
 			i++;
 		}
 
-		LP_CORE_ASSERT(foundQueues, "No fitting queue found!");
+		// Without dedicated families the work is submitted to the graphics queue instead
+		if (m_queueIndices.computeQueueIndex == -1)
+		{
+			m_queueIndices.computeQueueIndex = m_queueIndices.graphicsQueueIndex;
+		}
+
+		if (m_queueIndices.transferQueueIndex == -1)
+		{
+			m_queueIndices.transferQueueIndex = m_queueIndices.graphicsQueueIndex;
+		}
+
+		LP_CORE_ASSERT(m_queueIndices.IsComplete(), "No fitting queue found!");
+		LP_CORE_INFO("Async compute: {0}", m_queueIndices.HasAsyncCompute() ? "available" : "not available, compute work shares the graphics queue");
 	}
 
 	PhysicalGraphicsDevice::~PhysicalGraphicsDevice()
@@ -102,7 +190,7 @@ namespace Lamp
 			queueInfo.pQueuePriorities = queuePriority;
 			queueInfo.queueCount = 1;
 
-			if (queue == 0)
+			if (queue == (uint32_t)queueIndices.graphicsQueueIndex)
 			{
 				queueInfo.queueCount++;
 			}
@@ -118,6 +206,16 @@ namespace Lamp
 		createInfo.pEnabledFeatures = nullptr;
 
 		std::vector<const char*> enabledExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+		if (physicalDevice->GetCapabilities().hasMemoryBudget)
+		{
+			enabledExtensions.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		}
+
+		if (physicalDevice->GetCapabilities().hasCalibratedTimestamps)
+		{
+			enabledExtensions.emplace_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+		}
+
 		createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
 		createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
@@ -133,6 +231,11 @@ namespace Lamp
 		vkGetDeviceQueue(m_device, queueIndices.computeQueueIndex, 0, &m_computeQueue);
 		vkGetDeviceQueue(m_device, queueIndices.transferQueueIndex, 0, &m_transferQueue);
 
+		if (physicalDevice->GetCapabilities().hasCalibratedTimestamps)
+		{
+			m_getCalibratedTimestamps = (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(m_device, "vkGetCalibratedTimestampsEXT");
+		}
+
 		// Create main thread (faster to use) command pool
 		{
 			VkCommandPoolCreateInfo commandPoolInfo{};
@@ -143,6 +246,29 @@ namespace Lamp
 			LP_VK_CHECK(vkCreateCommandPool(m_device, &commandPoolInfo, nullptr, &m_graphicsCommandPool));
 		}
 
+		// Create queue timelines
+		{
+			VkSemaphoreTypeCreateInfo semaphoreTypeInfo{};
+			semaphoreTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+			semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+			semaphoreTypeInfo.initialValue = 0;
+
+			VkSemaphoreCreateInfo semaphoreInfo{};
+			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			semaphoreInfo.pNext = &semaphoreTypeInfo;
+
+			for (VkQueue queue : { m_graphicsQueue, m_threadSafeGraphicsQueue, m_computeQueue, m_transferQueue })
+			{
+				if (m_queueTimelines.find(queue) != m_queueTimelines.end())
+				{
+					continue;
+				}
+
+				auto& timeline = m_queueTimelines[queue] = CreateScope<QueueTimeline>();
+				LP_VK_CHECK(vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &timeline->semaphore));
+			}
+		}
+
 		// Optick GPU
 #ifdef LP_ENABLE_PROFILING
 		{
@@ -156,36 +282,60 @@ namespace Lamp
 
 	GraphicsDevice::~GraphicsDevice()
 	{
-		for (auto& it : m_commandPoolMap)
+		for (auto& [threadId, threadPools] : m_threadCommandPools)
 		{
-			vkDestroyCommandPool(m_device, it.second, nullptr);
+			for (auto& [queueFamily, threadPool] : threadPools)
+			{
+				vkDestroyCommandPool(m_device, threadPool.commandPool, nullptr);
+			}
 		}
+
+		m_threadCommandPools.clear();
 		m_commandPoolMap.clear();
 
+		for (const auto& [queue, timeline] : m_queueTimelines)
+		{
+			vkDestroySemaphore(m_device, timeline->semaphore, nullptr);
+		}
+
+		m_queueTimelines.clear();
+
 		vkDestroyCommandPool(m_device, m_graphicsCommandPool, nullptr);
 		vkDestroyDevice(m_device, nullptr);
 	}
 
 	VkCommandBuffer GraphicsDevice::GetThreadSafeCommandBuffer(bool begin)
 	{
-		VkCommandPool commandPool;
+		return GetThreadSafeCommandBuffer(begin, (uint32_t)m_physicalDevice->GetQueueIndices().graphicsQueueIndex);
+	}
+
+	VkCommandBuffer GraphicsDevice::GetThreadSafeCommandBuffer(bool begin, uint32_t queueFamilyIndex)
+	{
 		VkCommandBuffer commandBuffer;
 
-		VkCommandPoolCreateInfo commandPoolInfo{};
-		commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-		commandPoolInfo.queueFamilyIndex = m_physicalDevice->GetQueueIndices().graphicsQueueIndex;
-		commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		{
+			std::scoped_lock lock{ m_threadCommandPoolMutex };
+			ThreadCommandPool& threadPool = GetThreadCommandPool(queueFamilyIndex);
 
-		LP_VK_CHECK(vkCreateCommandPool(m_device, &commandPoolInfo, nullptr, &commandPool));
+			if (!threadPool.freeCommandBuffers.empty())
+			{
+				commandBuffer = threadPool.freeCommandBuffers.back();
+				threadPool.freeCommandBuffers.pop_back();
+			}
+			else
+			{
+				VkCommandBufferAllocateInfo allocInfo{};
+				allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocInfo.commandBufferCount = 1;
+				allocInfo.commandPool = threadPool.commandPool;
+				allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.commandBufferCount = 1;
-		allocInfo.commandPool = commandPool;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+				LP_VK_CHECK(vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer));
+			}
 
-		LP_VK_CHECK(vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer));
-		m_commandPoolMap.emplace(commandBuffer, commandPool);
+			threadPool.usedCommandBuffers++;
+			m_commandPoolMap[commandBuffer] = &threadPool;
+		}
 
 		if (begin) [[likely]]
 		{
@@ -244,9 +394,7 @@ namespace Lamp
 	void GraphicsDevice::FlushThreadSafeCommandBuffer(VkCommandBuffer cmdBuffer, VkQueue queue)
 	{
 		LP_CORE_ASSERT(cmdBuffer != VK_NULL_HANDLE, "Unable to flush null command buffer!");
-		LP_CORE_ASSERT(m_commandPoolMap.find(cmdBuffer) != m_commandPoolMap.end(), "Command buffer not found in map! Was this command buffer created from the device?");
-		
-		const std::scoped_lock<std::mutex> lock(m_commandBufferFlushMutex);
+
 		LP_VK_CHECK(vkEndCommandBuffer(cmdBuffer));
 
 		VkSubmitInfo submitInfo{};
@@ -254,31 +402,17 @@ namespace Lamp
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &cmdBuffer;
 
-		VkFenceCreateInfo fenceInfo{};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = 0;
-
-		VkFence fence;
-		LP_VK_CHECK(vkCreateFence(m_device, &fenceInfo, nullptr, &fence));
-		LP_VK_CHECK(vkQueueWaitIdle(queue));
-		LP_VK_CHECK(vkQueueSubmit(queue, 1, &submitInfo, fence));
-		LP_VK_CHECK(vkWaitForFences(m_device, 1, &fence, VK_TRUE, 1000000000));
-
-		vkDestroyFence(m_device, fence, nullptr);
-
-		VkCommandPool cmdPool = m_commandPoolMap.at(cmdBuffer);
-		vkDestroyCommandPool(m_device, cmdPool, nullptr);
+		// Only this submit is waited on, earlier work on the queue is left running
+		const uint64_t value = Submit(queue, submitInfo);
+		WaitForTimeline(queue, value);
 
-		m_commandPoolMap.erase(cmdBuffer);
+		// The submit has completed, so the command buffer can be reused
+		RecycleThreadSafeCommandBuffer(cmdBuffer);
 	}
 
 	void GraphicsDevice::FreeThreadSafeCommandBuffer(VkCommandBuffer cmdBuffer)
 	{
-		LP_CORE_ASSERT(m_commandPoolMap.find(cmdBuffer) != m_commandPoolMap.end(), "Command buffer not found in map! Was this command buffer created from the device?");
-		VkCommandPool cmdPool = m_commandPoolMap.at(cmdBuffer);
-		vkDestroyCommandPool(m_device, cmdPool, nullptr);
-
-		m_commandPoolMap.erase(cmdBuffer);
+		RecycleThreadSafeCommandBuffer(cmdBuffer);
 	}
 
 	void GraphicsDevice::FlushCommandBuffer(VkCommandBuffer cmdBuffer)
@@ -291,21 +425,19 @@ namespace Lamp
 		LP_CORE_ASSERT(cmdBuffer != VK_NULL_HANDLE, "Unable to flush null command buffer!");
 		LP_VK_CHECK(vkEndCommandBuffer(cmdBuffer));
 
+		if (queue == m_graphicsQueue)
+		{
+			UploadManager::Update();
+		}
+
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &cmdBuffer;
 
-		VkFenceCreateInfo fenceInfo{};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = 0;
-
-		VkFence fence;
-		LP_VK_CHECK(vkCreateFence(m_device, &fenceInfo, nullptr, &fence));
-		LP_VK_CHECK(vkQueueSubmit(queue, 1, &submitInfo, fence));
-		LP_VK_CHECK(vkWaitForFences(m_device, 1, &fence, VK_TRUE, 1000000000));
+		const uint64_t value = Submit(queue, submitInfo);
+		WaitForTimeline(queue, value);
 
-		vkDestroyFence(m_device, fence, nullptr);
 		vkFreeCommandBuffers(m_device, m_graphicsCommandPool, 1, &cmdBuffer);
 	}
 
@@ -314,6 +446,221 @@ namespace Lamp
 		vkFreeCommandBuffers(m_device, m_graphicsCommandPool, 1, &cmdBuffer);
 	}
 
+	VkQueue GraphicsDevice::GetQueue(QueueType queueType) const
+	{
+		switch (queueType)
+		{
+			case QueueType::Graphics: return m_graphicsQueue;
+			case QueueType::Compute: return m_computeQueue;
+			case QueueType::Transfer: return m_transferQueue;
+		}
+
+		return m_graphicsQueue;
+	}
+
+	uint32_t GraphicsDevice::GetQueueFamilyIndex(QueueType queueType) const
+	{
+		const auto& queueIndices = m_physicalDevice->GetQueueIndices();
+
+		switch (queueType)
+		{
+			case QueueType::Graphics: return (uint32_t)queueIndices.graphicsQueueIndex;
+			case QueueType::Compute: return (uint32_t)queueIndices.computeQueueIndex;
+			case QueueType::Transfer: return (uint32_t)queueIndices.transferQueueIndex;
+		}
+
+		return (uint32_t)queueIndices.graphicsQueueIndex;
+	}
+
+	uint64_t GraphicsDevice::Submit(VkQueue queue, const VkSubmitInfo& submitInfo, const std::vector<QueueWait>& queueWaits)
+	{
+		LP_PROFILE_FUNCTION();
+		LP_CORE_ASSERT(submitInfo.pNext == nullptr, "Submit info already has a pNext chain!");
+
+		QueueTimeline& timeline = GetQueueTimeline(queue);
+
+		// Binary semaphores passed in ignore their values
+		std::vector<VkSemaphore> waitSemaphores{ submitInfo.pWaitSemaphores, submitInfo.pWaitSemaphores + submitInfo.waitSemaphoreCount };
+		std::vector<VkPipelineStageFlags> waitStages{ submitInfo.pWaitDstStageMask, submitInfo.pWaitDstStageMask + submitInfo.waitSemaphoreCount };
+		std::vector<uint64_t> waitValues(submitInfo.waitSemaphoreCount, 0);
+
+		for (const auto& queueWait : queueWaits)
+		{
+			waitSemaphores.emplace_back(GetQueueTimeline(queueWait.queue).semaphore);
+			waitStages.emplace_back(queueWait.stage);
+			waitValues.emplace_back(queueWait.value);
+		}
+
+		std::vector<VkSemaphore> signalSemaphores{ submitInfo.pSignalSemaphores, submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount };
+		std::vector<uint64_t> signalValues(submitInfo.signalSemaphoreCount, 0);
+
+		signalSemaphores.emplace_back(timeline.semaphore);
+
+		std::scoped_lock lock{ timeline.submitMutex };
+
+		const uint64_t value = timeline.submittedValue + 1;
+		signalValues.emplace_back(value);
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.waitSemaphoreValueCount = (uint32_t)waitValues.size();
+		timelineInfo.pWaitSemaphoreValues = waitValues.data();
+		timelineInfo.signalSemaphoreValueCount = (uint32_t)signalValues.size();
+		timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+		VkSubmitInfo timelineSubmitInfo = submitInfo;
+		timelineSubmitInfo.pNext = &timelineInfo;
+		timelineSubmitInfo.waitSemaphoreCount = (uint32_t)waitSemaphores.size();
+		timelineSubmitInfo.pWaitSemaphores = waitSemaphores.data();
+		timelineSubmitInfo.pWaitDstStageMask = waitStages.data();
+		timelineSubmitInfo.signalSemaphoreCount = (uint32_t)signalSemaphores.size();
+		timelineSubmitInfo.pSignalSemaphores = signalSemaphores.data();
+
+		LP_VK_CHECK(vkQueueSubmit(queue, 1, &timelineSubmitInfo, nullptr));
+
+		timeline.submittedValue = value;
+		return value;
+	}
+
+	void GraphicsDevice::Present(VkQueue queue, const VkPresentInfoKHR& presentInfo)
+	{
+		LP_PROFILE_FUNCTION();
+
+		QueueTimeline& timeline = GetQueueTimeline(queue);
+
+		std::scoped_lock lock{ timeline.submitMutex };
+		LP_VK_CHECK(vkQueuePresentKHR(queue, &presentInfo));
+	}
+
+	uint64_t GraphicsDevice::GetTimelineValue(VkQueue queue) const
+	{
+		QueueTimeline& timeline = GetQueueTimeline(queue);
+
+		std::scoped_lock lock{ timeline.submitMutex };
+		return timeline.submittedValue;
+	}
+
+	uint64_t GraphicsDevice::GetCompletedTimelineValue(VkQueue queue) const
+	{
+		QueueTimeline& timeline = GetQueueTimeline(queue);
+
+		uint64_t value = 0;
+		LP_VK_CHECK(vkGetSemaphoreCounterValue(m_device, timeline.semaphore, &value));
+
+		timeline.completedValue = value;
+		return value;
+	}
+
+	bool GraphicsDevice::IsTimelineComplete(VkQueue queue, uint64_t value) const
+	{
+		if (value <= GetQueueTimeline(queue).completedValue)
+		{
+			return true;
+		}
+
+		return value <= GetCompletedTimelineValue(queue);
+	}
+
+	void GraphicsDevice::WaitForTimeline(VkQueue queue, uint64_t value) const
+	{
+		LP_PROFILE_FUNCTION();
+
+		if (IsTimelineComplete(queue, value))
+		{
+			return;
+		}
+
+		QueueTimeline& timeline = GetQueueTimeline(queue);
+
+		VkSemaphoreWaitInfo waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &timeline.semaphore;
+		waitInfo.pValues = &value;
+
+		LP_VK_CHECK(vkWaitSemaphores(m_device, &waitInfo, UINT64_MAX));
+
+		uint64_t completed = timeline.completedValue;
+		while (completed < value && !timeline.completedValue.compare_exchange_weak(completed, value));
+	}
+
+	bool GraphicsDevice::GetCalibratedTimestamps(uint64_t& outDeviceTimestamp, uint64_t& outHostNanoseconds) const
+	{
+		if (!m_getCalibratedTimestamps)
+		{
+			return false;
+		}
+
+		std::array<VkCalibratedTimestampInfoEXT, 2> infos{};
+		infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+		infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		infos[1].timeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+
+		std::array<uint64_t, 2> timestamps{};
+		uint64_t maxDeviation = 0;
+
+		if (m_getCalibratedTimestamps(m_device, (uint32_t)infos.size(), infos.data(), timestamps.data(), &maxDeviation) != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+
+		outDeviceTimestamp = timestamps[0];
+		outHostNanoseconds = (uint64_t)((double)timestamps[1] * 1000000000.0 / (double)frequency.QuadPart);
+
+		return true;
+	}
+
+	GraphicsDevice::QueueTimeline& GraphicsDevice::GetQueueTimeline(VkQueue queue) const
+	{
+		auto it = m_queueTimelines.find(queue);
+		LP_CORE_ASSERT(it != m_queueTimelines.end(), "Queue was not created by the device!");
+
+		return *it->second;
+	}
+
+	GraphicsDevice::ThreadCommandPool& GraphicsDevice::GetThreadCommandPool(uint32_t queueFamilyIndex)
+	{
+		ThreadCommandPool& threadPool = m_threadCommandPools[std::this_thread::get_id()][queueFamilyIndex];
+		if (!threadPool.commandPool)
+		{
+			VkCommandPoolCreateInfo commandPoolInfo{};
+			commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			commandPoolInfo.queueFamilyIndex = queueFamilyIndex;
+			commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+			LP_VK_CHECK(vkCreateCommandPool(m_device, &commandPoolInfo, nullptr, &threadPool.commandPool));
+		}
+
+		return threadPool;
+	}
+
+	void GraphicsDevice::RecycleThreadSafeCommandBuffer(VkCommandBuffer cmdBuffer)
+	{
+		std::scoped_lock lock{ m_threadCommandPoolMutex };
+
+		auto it = m_commandPoolMap.find(cmdBuffer);
+		LP_CORE_ASSERT(it != m_commandPoolMap.end(), "Command buffer not found in map! Was this command buffer created from the device?");
+
+		ThreadCommandPool& threadPool = *it->second;
+		m_commandPoolMap.erase(it);
+
+		threadPool.retiredCommandBuffers.emplace_back(cmdBuffer);
+		threadPool.usedCommandBuffers--;
+
+		// Buffers can only be reset together with their pool, which is done once none of them are in use
+		if (threadPool.usedCommandBuffers == 0)
+		{
+			LP_VK_CHECK(vkResetCommandPool(m_device, threadPool.commandPool, 0));
+
+			threadPool.freeCommandBuffers.insert(threadPool.freeCommandBuffers.end(), threadPool.retiredCommandBuffers.begin(), threadPool.retiredCommandBuffers.end());
+			threadPool.retiredCommandBuffers.clear();
+		}
+	}
+
 	Ref<GraphicsDevice> GraphicsDevice::Create(Ref<PhysicalGraphicsDevice> physicalDevice, VkPhysicalDeviceFeatures2 enabledFeatures)
 	{
 		return CreateRef<GraphicsDevice>(physicalDevice, enabledFeatures);
@@ -5,7 +5,9 @@
 
 #include <vulkan/vulkan.h>
 
+#include <atomic>
 #include <mutex>
+#include <thread>
 
 namespace Lamp
 {
@@ -23,12 +25,22 @@ namespace Lamp
 			int32_t transferQueueIndex = -1;
 			int32_t presentQueueIndex = -1;
 			int32_t computeQueueIndex = -1;
+
+			// False when compute work has to share the graphics queue
+			inline bool HasAsyncCompute() const { return computeQueueIndex != graphicsQueueIndex; }
 		};
 		
 		struct Capabilities
 		{
 			uint64_t minUBOOffsetAlignment;
 			uint64_t minSSBOOffsetAlignment;
+
+			bool hasResizableBAR = false; // large parts of device local memory are host visible
+			bool hasMemoryBudget = false; // VK_EXT_memory_budget is supported
+
+			float timestampPeriod = 0.f; // nanoseconds per timestamp tick
+			bool hasQueueTimestamps = false; // timestamps can be written on the graphics and compute queues
+			bool hasCalibratedTimestamps = false; // VK_EXT_calibrated_timestamps can map device timestamps onto the host clock
 		};
 
 		PhysicalGraphicsDevice(VkInstance instance);
@@ -37,6 +49,7 @@ namespace Lamp
 		inline VkPhysicalDevice GetHandle() const { return m_physicalDevice; }
 		inline const QueueIndices& GetQueueIndices() const { return m_queueIndices; }
 		inline const Capabilities& GetCapabilities() const { return m_capabilities; }
+		inline const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const { return m_memoryProperties; }
 
 		static Ref<PhysicalGraphicsDevice> Create(VkInstance instance);
 
@@ -46,6 +59,21 @@ namespace Lamp
 
 		VkPhysicalDevice m_physicalDevice = nullptr;
 		VkPhysicalDeviceProperties m_physicalDeviceProperties;
+		VkPhysicalDeviceMemoryProperties m_memoryProperties;
+	};
+
+	enum class QueueType : uint32_t
+	{
+		Graphics = 0,
+		Compute,
+		Transfer
+	};
+
+	struct QueueWait
+	{
+		VkQueue queue = nullptr;
+		uint64_t value = 0;
+		VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
 	};
 
 	class GraphicsDevice
@@ -55,6 +83,7 @@ namespace Lamp
 		~GraphicsDevice();
 
 		VkCommandBuffer GetThreadSafeCommandBuffer(bool begin);
+		VkCommandBuffer GetThreadSafeCommandBuffer(bool begin, uint32_t queueFamilyIndex);
 		VkCommandBuffer GetCommandBuffer(bool begin);
 		VkCommandBuffer CreateSecondaryCommandBuffer();
 
@@ -66,20 +95,61 @@ namespace Lamp
 		void FlushCommandBuffer(VkCommandBuffer cmdBuffer, VkQueue queue);
 		void FreeCommandBuffer(VkCommandBuffer cmdBuffer);
 
+		// Every queue owns a timeline semaphore which each submit signals with the next value
+		uint64_t Submit(VkQueue queue, const VkSubmitInfo& submitInfo, const std::vector<QueueWait>& queueWaits = {});
+		void Present(VkQueue queue, const VkPresentInfoKHR& presentInfo); // shares the queue lock with the submits
+		uint64_t GetTimelineValue(VkQueue queue) const;
+		uint64_t GetCompletedTimelineValue(VkQueue queue) const;
+
+		bool IsTimelineComplete(VkQueue queue, uint64_t value) const;
+		void WaitForTimeline(VkQueue queue, uint64_t value) const;
+
+		// Samples the device timestamp counter and the host clock (in nanoseconds) at the same moment
+		bool GetCalibratedTimestamps(uint64_t& outDeviceTimestamp, uint64_t& outHostNanoseconds) const;
+
 		inline VkDevice GetHandle() const { return m_device; }
 		inline VkQueue GetGraphicsQueue() const { return m_graphicsQueue; }
 		inline VkQueue GetComputeQueue() const { return m_computeQueue; }
 		inline VkQueue GetTransferQueue() const { return m_transferQueue; }
+
+		VkQueue GetQueue(QueueType queueType) const;
+		uint32_t GetQueueFamilyIndex(QueueType queueType) const;
 		
 		inline Ref<PhysicalGraphicsDevice> GetPhysicalDevice() const { return m_physicalDevice; }
 		static Ref<GraphicsDevice> Create(Ref<PhysicalGraphicsDevice> physicalDevice, VkPhysicalDeviceFeatures2 enabledFeatures);
 
 	private:
+		struct ThreadCommandPool
+		{
+			VkCommandPool commandPool = nullptr;
+
+			std::vector<VkCommandBuffer> freeCommandBuffers;
+			std::vector<VkCommandBuffer> retiredCommandBuffers; // waiting for the pool to be reset
+			uint32_t usedCommandBuffers = 0;
+		};
+
+		struct QueueTimeline
+		{
+			VkSemaphore semaphore = nullptr;
+			uint64_t submittedValue = 0;
+			mutable std::atomic<uint64_t> completedValue = 0;
+
+			std::mutex submitMutex; // also guards the queue itself
+		};
+
+		ThreadCommandPool& GetThreadCommandPool(uint32_t queueFamilyIndex);
+		void RecycleThreadSafeCommandBuffer(VkCommandBuffer cmdBuffer);
+
+		QueueTimeline& GetQueueTimeline(VkQueue queue) const;
+
 		const std::vector<const char*> m_validationLayers = { "VK_LAYER_KHRONOS_validation" };
-		std::mutex m_commandBufferFlushMutex;
 		Ref<PhysicalGraphicsDevice> m_physicalDevice;
 	
-		std::unordered_map<VkCommandBuffer, VkCommandPool> m_commandPoolMap;
+		std::unordered_map<std::thread::id, std::unordered_map<uint32_t, ThreadCommandPool>> m_threadCommandPools; // thread -> queue family -> pool
+		std::unordered_map<VkCommandBuffer, ThreadCommandPool*> m_commandPoolMap;
+		std::mutex m_threadCommandPoolMutex;
+
+		std::unordered_map<VkQueue, Scope<QueueTimeline>> m_queueTimelines;
 		VkCommandPool m_graphicsCommandPool;
 
 		VkDevice m_device;
@@ -88,5 +158,7 @@ namespace Lamp
 		VkQueue m_transferQueue;
 
 		VkQueue m_threadSafeGraphicsQueue;
+
+		PFN_vkGetCalibratedTimestampsEXT m_getCalibratedTimestamps = nullptr;
 	};
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "Lamp/Core/Graphics/GraphicsContext.h"
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
 
 #include "Lamp/Log/Log.h"
 
@@ -65,7 +66,6 @@ namespace Lamp
 		{
 			vkDestroySemaphore(m_vulkanDevice, m_presentSemaphores[i], nullptr);
 			vkDestroySemaphore(m_vulkanDevice, m_renderSemaphores[i], nullptr);
-			vkDestroyFence(m_vulkanDevice, m_renderFences[i], nullptr);
 		}
 
 		vkDestroyRenderPass(m_vulkanDevice, m_renderPass, nullptr);
@@ -83,10 +83,10 @@ namespace Lamp
 	void Swapchain::BeginFrame()
 	{
 		LP_PROFILE_FUNCTION();
-		auto device = GraphicsContext::GetDevice()->GetHandle();
+		auto graphicsDevice = GraphicsContext::GetDevice();
+		auto device = graphicsDevice->GetHandle();
 
-		LP_VK_CHECK(vkWaitForFences(device, 1, &m_renderFences[m_currentFrame], VK_TRUE, 1000000000));
-		LP_VK_CHECK(vkResetFences(device, 1, &m_renderFences[m_currentFrame]));
+		graphicsDevice->WaitForTimeline(graphicsDevice->GetGraphicsQueue(), m_frameTimelineValues[m_currentFrame]);
 
 		LP_VK_CHECK(vkAcquireNextImageKHR(device, m_swapchain, 1000000000, m_presentSemaphores[m_currentFrame], nullptr, &m_currentImage));
 		LP_VK_CHECK(vkResetCommandPool(device, m_commandPools[m_currentFrame], 0));
@@ -100,6 +100,9 @@ namespace Lamp
 		{
 			LP_PROFILE_SCOPE("Swapchain::QueueSubmit");
 
+			// Uploads used this frame have to be acquired by the graphics queue first
+			UploadManager::Update();
+
 			VkSubmitInfo submitInfo{};
 			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 			submitInfo.commandBufferCount = 1;
@@ -114,7 +117,8 @@ namespace Lamp
 			const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 			submitInfo.pWaitDstStageMask = &waitStage;
 
-			LP_VK_CHECK(vkQueueSubmit(GraphicsContext::GetDevice()->GetGraphicsQueue(), 1, &submitInfo, m_renderFences[m_currentFrame]));
+			auto device = GraphicsContext::GetDevice();
+			m_frameTimelineValues[m_currentFrame] = device->Submit(device->GetGraphicsQueue(), submitInfo);
 		}
 
 		// Present to screen
@@ -132,7 +136,8 @@ namespace Lamp
 			presentInfo.pImageIndices = &m_currentImage;
 
 			OPTICK_GPU_FLIP(&m_swapchain);
-			LP_VK_CHECK(vkQueuePresentKHR(GraphicsContext::GetDevice()->GetGraphicsQueue(), &presentInfo));
+			auto device = GraphicsContext::GetDevice();
+			device->Present(device->GetGraphicsQueue(), presentInfo);
 		}
 
 		m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
@@ -327,17 +332,10 @@ namespace Lamp
 
 	void Swapchain::CreateSyncObjects()
 	{
-		VkFenceCreateInfo fenceInfo{};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
 		auto device = GraphicsContext::GetDevice()->GetHandle();
 
-		m_renderFences.resize(m_framesInFlight);
-		for (size_t i = 0; i < m_renderFences.size(); i++)
-		{
-			LP_VK_CHECK(vkCreateFence(device, &fenceInfo, nullptr, &m_renderFences[i]));
-		}
+		// Frames are paced by the graphics queue timeline, value 0 is always complete
+		m_frameTimelineValues.resize(m_framesInFlight, 0);
 
 		VkSemaphoreCreateInfo semaphoreInfo{};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -57,7 +57,7 @@ namespace Lamp
 		std::vector<VkImageView> m_imageViews;
 		std::vector<VkFramebuffer> m_framebuffers;
 
-		std::vector<VkFence> m_renderFences;
+		std::vector<uint64_t> m_frameTimelineValues; // graphics timeline value of each frame's submit
 		std::vector<VkSemaphore> m_renderSemaphores;
 		std::vector<VkSemaphore> m_presentSemaphores;
 
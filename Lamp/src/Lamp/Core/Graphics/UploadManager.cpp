@@ -0,0 +1,628 @@
+#include "lppch.h"
+#include "UploadManager.h"
+
+#include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/VulkanAllocator.h"
+#include "Lamp/Core/Graphics/BarrierBatch.h"
+
+#include "Lamp/Log/Log.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Lamp
+{
+	namespace Utility
+	{
+		inline static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+	struct UploadManager::UploadBatch
+	{
+		UploadTicket ticket = 0;
+
+		VkCommandBuffer transferCommandBuffer = nullptr;
+		VkCommandBuffer acquireCommandBuffer = nullptr;
+
+		uint64_t transferValue = 0; // transfer queue timeline
+		uint64_t acquireValue = 0; // graphics queue timeline
+
+		VkDeviceSize ringEnd = 0;
+		std::vector<std::pair<VkBuffer, VmaAllocation>> dedicatedStagingBuffers;
+
+		// Buffer ownership transfers are recorded once for the whole batch when it is submitted
+		BarrierBatch releaseBarriers;
+		BarrierBatch acquireBarriers;
+
+		uint32_t uploadCount = 0;
+		bool transferRetired = false;
+		bool acquireSubmitted = false;
+	};
+
+	struct UploadManagerData
+	{
+		Ref<GraphicsDevice> device;
+		std::thread::id mainThreadId;
+		std::thread::id renderThreadId;
+
+		uint32_t transferQueueFamily = 0;
+		uint32_t graphicsQueueFamily = 0;
+
+		VkCommandPool transferCommandPool = nullptr;
+		VkCommandPool acquireCommandPool = nullptr;
+
+		VkBuffer ringBuffer = nullptr;
+		VmaAllocation ringAllocation = nullptr;
+		uint8_t* ringData = nullptr;
+		VkDeviceSize ringHead = 0;
+		VkDeviceSize ringTail = 0;
+
+		Scope<UploadManager::UploadBatch> pendingBatch;
+		std::deque<Scope<UploadManager::UploadBatch>> submittedBatches;
+		std::vector<Scope<UploadManager::UploadBatch>> freeBatches;
+
+		UploadTicket nextTicket = 1;
+		UploadTicket completedTicket = 0;
+
+		UploadManager::Statistics statistics;
+
+		std::mutex mutex;
+		std::condition_variable acquireCondition;
+	};
+
+	static UploadManagerData* s_uploadData = nullptr;
+
+	static constexpr VkDeviceSize STAGING_RING_SIZE = 64ull * 1024ull * 1024ull;
+	static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+	UploadTicket UploadManager::UploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::scoped_lock lock{ s_uploadData->mutex };
+
+		VkBuffer stagingBuffer = nullptr;
+		void* stagingData = nullptr;
+		const VkDeviceSize stagingOffset = AllocateStaging(size, stagingBuffer, stagingData);
+
+		memcpy_s(stagingData, size, data, size);
+
+		UploadBatch& batch = GetPendingBatch();
+
+		VkBufferCopy copy{};
+		copy.srcOffset = stagingOffset;
+		copy.dstOffset = dstOffset;
+		copy.size = size;
+
+		vkCmdCopyBuffer(batch.transferCommandBuffer, stagingBuffer, dstBuffer, 1, &copy);
+
+		if (s_uploadData->transferQueueFamily != s_uploadData->graphicsQueueFamily)
+		{
+			const uint32_t srcFamily = s_uploadData->transferQueueFamily;
+			const uint32_t dstFamily = s_uploadData->graphicsQueueFamily;
+
+			batch.releaseBarriers.AddBufferBarrier(dstBuffer, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, dstOffset, size, srcFamily, dstFamily);
+			batch.acquireBarriers.AddBufferBarrier(dstBuffer, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT, dstOffset, size, srcFamily, dstFamily);
+		}
+
+		batch.uploadCount++;
+		s_uploadData->statistics.uploads++;
+		s_uploadData->statistics.uploadedBytes += size;
+
+		return batch.ticket;
+	}
+
+	UploadTicket UploadManager::UploadImage(VkImage dstImage, const std::vector<ImageUploadRegion>& regions, uint32_t mipCount, VkImageLayout finalLayout, std::function<void(VkCommandBuffer)>&& onAcquire)
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::scoped_lock lock{ s_uploadData->mutex };
+
+		// All regions are staged in one block so that an image never straddles two batches
+		VkDeviceSize totalSize = 0;
+		for (const auto& region : regions)
+		{
+			totalSize = Utility::AlignUp(totalSize, STAGING_ALIGNMENT) + region.size;
+		}
+
+		VkBuffer stagingBuffer = nullptr;
+		void* stagingData = nullptr;
+		const VkDeviceSize stagingOffset = AllocateStaging(totalSize, stagingBuffer, stagingData);
+
+		std::vector<VkBufferImageCopy> copies;
+		copies.reserve(regions.size());
+
+		VkDeviceSize regionOffset = 0;
+		for (const auto& region : regions)
+		{
+			regionOffset = Utility::AlignUp(regionOffset, STAGING_ALIGNMENT);
+			memcpy_s((uint8_t*)stagingData + regionOffset, region.size, region.data, region.size);
+
+			VkBufferImageCopy& copy = copies.emplace_back();
+			copy.bufferOffset = stagingOffset + regionOffset;
+			copy.bufferRowLength = 0;
+			copy.bufferImageHeight = 0;
+			copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			copy.imageSubresource.mipLevel = region.mipLevel;
+			copy.imageSubresource.baseArrayLayer = 0;
+			copy.imageSubresource.layerCount = 1;
+			copy.imageOffset = { 0, 0, 0 };
+			copy.imageExtent = { region.width, region.height, 1 };
+
+			regionOffset += region.size;
+		}
+
+		UploadBatch& batch = GetPendingBatch();
+
+		const VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, mipCount, 0, 1 };
+
+		BarrierBatch barriers;
+		barriers.AddImageBarrier(dstImage, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, range);
+		barriers.Flush(batch.transferCommandBuffer);
+
+		vkCmdCopyBufferToImage(batch.transferCommandBuffer, stagingBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)copies.size(), copies.data());
+
+		// The layout transition is part of the release/acquire pair
+		constexpr VkAccessFlags2 acquireAccess = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+		if (s_uploadData->transferQueueFamily != s_uploadData->graphicsQueueFamily)
+		{
+			const uint32_t srcFamily = s_uploadData->transferQueueFamily;
+			const uint32_t dstFamily = s_uploadData->graphicsQueueFamily;
+
+			barriers.AddImageBarrier(dstImage, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout, range, srcFamily, dstFamily);
+			barriers.Flush(batch.transferCommandBuffer);
+
+			// Acquired right away, the work recorded by the callback depends on it
+			barriers.AddImageBarrier(dstImage, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, acquireAccess, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout, range, srcFamily, dstFamily);
+			barriers.Flush(batch.acquireCommandBuffer);
+		}
+		else
+		{
+			barriers.AddImageBarrier(dstImage, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, acquireAccess, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout, range);
+			barriers.Flush(batch.transferCommandBuffer);
+		}
+
+		// Graphics only work, like mip generation, is recorded after the acquire
+		if (onAcquire)
+		{
+			onAcquire(batch.acquireCommandBuffer);
+		}
+
+		batch.uploadCount++;
+		s_uploadData->statistics.uploads++;
+		s_uploadData->statistics.uploadedBytes += totalSize;
+
+		return batch.ticket;
+	}
+
+	bool UploadManager::IsComplete(UploadTicket ticket)
+	{
+		std::scoped_lock lock{ s_uploadData->mutex };
+		RetireBatches();
+
+		return ticket <= s_uploadData->completedTicket;
+	}
+
+	void UploadManager::Wait(UploadTicket ticket)
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::unique_lock lock{ s_uploadData->mutex };
+		RetireBatches();
+
+		if (ticket <= s_uploadData->completedTicket)
+		{
+			return;
+		}
+
+		if (s_uploadData->pendingBatch && s_uploadData->pendingBatch->ticket == ticket)
+		{
+			FlushInternal();
+		}
+
+		auto it = std::find_if(s_uploadData->submittedBatches.begin(), s_uploadData->submittedBatches.end(), [ticket](const auto& batch) { return batch->ticket == ticket; });
+		if (it == s_uploadData->submittedBatches.end())
+		{
+			return;
+		}
+
+		UploadBatch* batch = it->get();
+
+		// Acquires are only submitted by the threads submitting frames, other threads wait for the next graphics submit
+		if (IsGraphicsThread())
+		{
+			SubmitAcquires();
+		}
+		else
+		{
+			s_uploadData->acquireCondition.wait(lock, [batch, ticket]() { return batch->ticket != ticket || batch->acquireSubmitted; });
+
+			// Already retired by another thread and recycled
+			if (batch->ticket != ticket)
+			{
+				return;
+			}
+		}
+
+		s_uploadData->device->WaitForTimeline(s_uploadData->device->GetGraphicsQueue(), batch->acquireValue);
+		RetireBatches();
+	}
+
+	void UploadManager::Flush()
+	{
+		std::scoped_lock lock{ s_uploadData->mutex };
+		FlushInternal();
+	}
+
+	void UploadManager::Update()
+	{
+		LP_PROFILE_FUNCTION();
+
+		if (!s_uploadData)
+		{
+			return;
+		}
+
+		std::scoped_lock lock{ s_uploadData->mutex };
+		LP_CORE_ASSERT(IsGraphicsThread(), "UploadManager::Update must be called on the main or render thread!");
+
+		FlushInternal();
+		SubmitAcquires();
+		RetireBatches();
+	}
+
+	void UploadManager::SetRenderThread(std::thread::id threadId)
+	{
+		std::scoped_lock lock{ s_uploadData->mutex };
+		s_uploadData->renderThreadId = threadId;
+	}
+
+	UploadManager::Statistics UploadManager::GetStatistics()
+	{
+		std::scoped_lock lock{ s_uploadData->mutex };
+		return s_uploadData->statistics;
+	}
+
+	void UploadManager::Initialize(Ref<GraphicsDevice> graphicsDevice)
+	{
+		s_uploadData = new UploadManagerData();
+		s_uploadData->device = graphicsDevice;
+		s_uploadData->mainThreadId = std::this_thread::get_id();
+
+		const auto& queueIndices = graphicsDevice->GetPhysicalDevice()->GetQueueIndices();
+		s_uploadData->transferQueueFamily = (uint32_t)queueIndices.transferQueueIndex;
+		s_uploadData->graphicsQueueFamily = (uint32_t)queueIndices.graphicsQueueIndex;
+
+		// Command pools
+		{
+			VkCommandPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+			poolInfo.queueFamilyIndex = s_uploadData->transferQueueFamily;
+			LP_VK_CHECK(vkCreateCommandPool(graphicsDevice->GetHandle(), &poolInfo, nullptr, &s_uploadData->transferCommandPool));
+
+			poolInfo.queueFamilyIndex = s_uploadData->graphicsQueueFamily;
+			LP_VK_CHECK(vkCreateCommandPool(graphicsDevice->GetHandle(), &poolInfo, nullptr, &s_uploadData->acquireCommandPool));
+		}
+
+		// Staging ring
+		{
+			VkBufferCreateInfo bufferInfo{};
+			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferInfo.size = STAGING_RING_SIZE;
+			bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			VulkanAllocator allocator{ "UploadManager - Staging Ring", MemoryCategory::Staging };
+			s_uploadData->ringAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_ONLY, s_uploadData->ringBuffer);
+			s_uploadData->ringData = allocator.MapMemory<uint8_t>(s_uploadData->ringAllocation);
+		}
+	}
+
+	void UploadManager::Shutdown()
+	{
+		auto device = s_uploadData->device->GetHandle();
+		VulkanAllocator allocator{ "UploadManager - Destroy" };
+
+		// Batches which never had their ownership acquired are simply dropped, the device is idle at this point
+		if (s_uploadData->pendingBatch)
+		{
+			s_uploadData->submittedBatches.emplace_back(std::move(s_uploadData->pendingBatch));
+		}
+
+		auto destroyBatch = [&](Scope<UploadBatch>& batch)
+		{
+			for (const auto& [buffer, allocation] : batch->dedicatedStagingBuffers)
+			{
+				allocator.UnmapMemory(allocation);
+				allocator.DestroyBuffer(buffer, allocation);
+			}
+		};
+
+		for (auto& batch : s_uploadData->submittedBatches)
+		{
+			destroyBatch(batch);
+		}
+
+		for (auto& batch : s_uploadData->freeBatches)
+		{
+			destroyBatch(batch);
+		}
+
+		vkDestroyCommandPool(device, s_uploadData->transferCommandPool, nullptr);
+		vkDestroyCommandPool(device, s_uploadData->acquireCommandPool, nullptr);
+
+		allocator.UnmapMemory(s_uploadData->ringAllocation);
+		allocator.DestroyBuffer(s_uploadData->ringBuffer, s_uploadData->ringAllocation);
+
+		delete s_uploadData;
+		s_uploadData = nullptr;
+	}
+
+	UploadManager::UploadBatch& UploadManager::GetPendingBatch()
+	{
+		if (s_uploadData->pendingBatch)
+		{
+			return *s_uploadData->pendingBatch;
+		}
+
+		auto device = s_uploadData->device->GetHandle();
+
+		if (!s_uploadData->freeBatches.empty())
+		{
+			s_uploadData->pendingBatch = std::move(s_uploadData->freeBatches.back());
+			s_uploadData->freeBatches.pop_back();
+		}
+		else
+		{
+			s_uploadData->pendingBatch = CreateScope<UploadBatch>();
+			UploadBatch& batch = *s_uploadData->pendingBatch;
+
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.commandBufferCount = 1;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
+			allocInfo.commandPool = s_uploadData->transferCommandPool;
+			LP_VK_CHECK(vkAllocateCommandBuffers(device, &allocInfo, &batch.transferCommandBuffer));
+
+			allocInfo.commandPool = s_uploadData->acquireCommandPool;
+			LP_VK_CHECK(vkAllocateCommandBuffers(device, &allocInfo, &batch.acquireCommandBuffer));
+		}
+
+		UploadBatch& batch = *s_uploadData->pendingBatch;
+		batch.ticket = s_uploadData->nextTicket++;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		LP_VK_CHECK(vkBeginCommandBuffer(batch.transferCommandBuffer, &beginInfo));
+		LP_VK_CHECK(vkBeginCommandBuffer(batch.acquireCommandBuffer, &beginInfo));
+
+		return batch;
+	}
+
+	VkDeviceSize UploadManager::AllocateStaging(VkDeviceSize size, VkBuffer& outBuffer, void*& outMappedData)
+	{
+		if (size <= STAGING_RING_SIZE)
+		{
+			VkDeviceSize offset = 0;
+			bool allocated = TryAllocateFromRing(size, offset);
+
+			while (!allocated)
+			{
+				// Make room by submitting the current batch and waiting for the oldest copies to finish
+				FlushInternal();
+
+				auto it = std::find_if(s_uploadData->submittedBatches.begin(), s_uploadData->submittedBatches.end(), [](const auto& batch) { return !batch->transferRetired; });
+				if (it == s_uploadData->submittedBatches.end())
+				{
+					break;
+				}
+
+				s_uploadData->device->WaitForTimeline(s_uploadData->device->GetTransferQueue(), (*it)->transferValue);
+				RetireBatches();
+
+				allocated = TryAllocateFromRing(size, offset);
+			}
+
+			if (allocated)
+			{
+				outBuffer = s_uploadData->ringBuffer;
+				outMappedData = s_uploadData->ringData + offset;
+
+				return offset;
+			}
+		}
+
+		// Uploads larger than the ring get their own staging buffer, released together with the batch
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VulkanAllocator allocator{ "UploadManager - Dedicated Staging", MemoryCategory::Staging };
+
+		VmaAllocation allocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_ONLY, outBuffer);
+		outMappedData = allocator.MapMemory<void>(allocation);
+
+		GetPendingBatch().dedicatedStagingBuffers.emplace_back(outBuffer, allocation);
+		s_uploadData->statistics.dedicatedStagingBuffers++;
+
+		return 0;
+	}
+
+	bool UploadManager::TryAllocateFromRing(VkDeviceSize size, VkDeviceSize& outOffset)
+	{
+		// Head == tail means the ring is empty, allocations never make the head catch up with the tail
+		if (s_uploadData->ringHead == s_uploadData->ringTail)
+		{
+			s_uploadData->ringHead = 0;
+			s_uploadData->ringTail = 0;
+		}
+
+		const VkDeviceSize head = Utility::AlignUp(s_uploadData->ringHead, STAGING_ALIGNMENT);
+		const VkDeviceSize tail = s_uploadData->ringTail;
+
+		if (s_uploadData->ringHead >= tail)
+		{
+			if (head + size <= STAGING_RING_SIZE)
+			{
+				outOffset = head;
+			}
+			else if (size < tail)
+			{
+				outOffset = 0;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else if (head + size < tail)
+		{
+			outOffset = head;
+		}
+		else
+		{
+			return false;
+		}
+
+		s_uploadData->ringHead = outOffset + size;
+		return true;
+	}
+
+	bool UploadManager::IsGraphicsThread()
+	{
+		const std::thread::id threadId = std::this_thread::get_id();
+		return threadId == s_uploadData->mainThreadId || threadId == s_uploadData->renderThreadId;
+	}
+
+	void UploadManager::FlushInternal()
+	{
+		if (!s_uploadData->pendingBatch)
+		{
+			return;
+		}
+
+		LP_PROFILE_FUNCTION();
+
+		Scope<UploadBatch> batch = std::move(s_uploadData->pendingBatch);
+		batch->ringEnd = s_uploadData->ringHead;
+
+		batch->releaseBarriers.Flush(batch->transferCommandBuffer);
+		batch->acquireBarriers.Flush(batch->acquireCommandBuffer);
+
+		LP_VK_CHECK(vkEndCommandBuffer(batch->transferCommandBuffer));
+		LP_VK_CHECK(vkEndCommandBuffer(batch->acquireCommandBuffer));
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch->transferCommandBuffer;
+
+		batch->transferValue = s_uploadData->device->Submit(s_uploadData->device->GetTransferQueue(), submitInfo);
+
+		s_uploadData->statistics.submits++;
+		s_uploadData->submittedBatches.emplace_back(std::move(batch));
+	}
+
+	void UploadManager::SubmitAcquires()
+	{
+		bool submitted = false;
+
+		for (auto& batch : s_uploadData->submittedBatches)
+		{
+			if (batch->acquireSubmitted)
+			{
+				continue;
+			}
+
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &batch->acquireCommandBuffer;
+
+			QueueWait transferWait{};
+			transferWait.queue = s_uploadData->device->GetTransferQueue();
+			transferWait.value = batch->transferValue;
+			transferWait.stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+			batch->acquireValue = s_uploadData->device->Submit(s_uploadData->device->GetGraphicsQueue(), submitInfo, { transferWait });
+
+			batch->acquireSubmitted = true;
+			submitted = true;
+		}
+
+		if (submitted)
+		{
+			s_uploadData->acquireCondition.notify_all();
+		}
+	}
+
+	void UploadManager::RetireBatches()
+	{
+		for (auto& batch : s_uploadData->submittedBatches)
+		{
+			if (batch->transferRetired)
+			{
+				continue;
+			}
+
+			if (!s_uploadData->device->IsTimelineComplete(s_uploadData->device->GetTransferQueue(), batch->transferValue))
+			{
+				break;
+			}
+
+			s_uploadData->ringTail = batch->ringEnd;
+			batch->transferRetired = true;
+
+			VulkanAllocator allocator{ "UploadManager - Dedicated Staging", MemoryCategory::Staging };
+			for (const auto& [buffer, allocation] : batch->dedicatedStagingBuffers)
+			{
+				allocator.UnmapMemory(allocation);
+				allocator.DestroyBuffer(buffer, allocation);
+			}
+
+			batch->dedicatedStagingBuffers.clear();
+		}
+
+		while (!s_uploadData->submittedBatches.empty())
+		{
+			UploadBatch* batch = s_uploadData->submittedBatches.front().get();
+			if (!batch->transferRetired || !batch->acquireSubmitted || !s_uploadData->device->IsTimelineComplete(s_uploadData->device->GetGraphicsQueue(), batch->acquireValue))
+			{
+				break;
+			}
+
+			s_uploadData->completedTicket = batch->ticket;
+
+			RecycleBatch(batch);
+			s_uploadData->freeBatches.emplace_back(std::move(s_uploadData->submittedBatches.front()));
+			s_uploadData->submittedBatches.pop_front();
+		}
+	}
+
+	void UploadManager::RecycleBatch(UploadBatch* batch)
+	{
+		LP_VK_CHECK(vkResetCommandBuffer(batch->transferCommandBuffer, 0));
+		LP_VK_CHECK(vkResetCommandBuffer(batch->acquireCommandBuffer, 0));
+
+		batch->ticket = 0;
+		batch->transferValue = 0;
+		batch->acquireValue = 0;
+		batch->ringEnd = 0;
+		batch->uploadCount = 0;
+		batch->transferRetired = false;
+		batch->acquireSubmitted = false;
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace Lamp
+{
+	using UploadTicket = uint64_t;
+
+	struct ImageUploadRegion
+	{
+		const void* data = nullptr;
+		VkDeviceSize size = 0;
+
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevel = 0;
+	};
+
+	class GraphicsDevice;
+	struct UploadManagerData;
+	class UploadManager
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t uploads = 0;
+			uint64_t uploadedBytes = 0;
+
+			uint32_t submits = 0;
+			uint32_t dedicatedStagingBuffers = 0;
+		};
+
+		// Copies are recorded into the current batch and executed on the transfer queue, ownership is then acquired by the graphics queue
+		static UploadTicket UploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+		static UploadTicket UploadImage(VkImage dstImage, const std::vector<ImageUploadRegion>& regions, uint32_t mipCount, VkImageLayout finalLayout, std::function<void(VkCommandBuffer)>&& onAcquire = nullptr);
+
+		static bool IsComplete(UploadTicket ticket);
+		static void Wait(UploadTicket ticket);
+
+		// Submits the current batch to the transfer queue
+		static void Flush();
+
+		// Must be called on the main or render thread before work is submitted to the graphics queue
+		static void Update();
+
+		// The render thread submits the frames when one is used, so it acquires uploads as well
+		static void SetRenderThread(std::thread::id threadId);
+
+		static Statistics GetStatistics();
+
+		static void Initialize(Ref<GraphicsDevice> graphicsDevice);
+		static void Shutdown();
+
+	private:
+		friend struct UploadManagerData;
+
+		UploadManager() = delete;
+
+		struct UploadBatch;
+
+		static UploadBatch& GetPendingBatch();
+		static VkDeviceSize AllocateStaging(VkDeviceSize size, VkBuffer& outBuffer, void*& outMappedData);
+		static bool TryAllocateFromRing(VkDeviceSize size, VkDeviceSize& outOffset);
+
+		static bool IsGraphicsThread(); // expects the lock to be held
+		static void FlushInternal();
+		static void SubmitAcquires();
+		static void RetireBatches();
+		static void RecycleBatch(UploadBatch* batch);
+	};
+}
@@ -6,6 +6,8 @@
 
 #include "Lamp/Log/Log.h"
 
+#include <mutex>
+
 namespace Lamp
 {
 	struct VulkanAllocatorData
@@ -13,12 +15,23 @@ namespace Lamp
 		VmaAllocator allocator;
 		uint64_t totalFreedBytes = 0;
 		uint64_t totalAllocatedBytes = 0;
+
+		std::array<uint64_t, (size_t)MemoryCategory::Count> categoryBytes{};
+		std::array<uint32_t, (size_t)MemoryCategory::Count> categoryAllocations{};
+
+		std::vector<VulkanAllocator::HeapBudget> heaps;
+		std::vector<bool> heapsOverBudget; // heap -> above the warning fraction last update
+
+		float budgetWarningFraction = 0.9f;
+		VulkanAllocator::BudgetWarningCallback budgetWarningCallback;
+
+		std::mutex mutex;
 	};
 
 	static VulkanAllocatorData* s_allocatorData = nullptr;
 
-	VulkanAllocator::VulkanAllocator(const std::string& tag)
-		: m_tag(tag)
+	VulkanAllocator::VulkanAllocator(const std::string& tag, MemoryCategory category)
+		: m_tag(tag), m_category(category)
 	{
 	}
 
@@ -41,55 +54,99 @@ namespace Lamp
 
 	VmaAllocation VulkanAllocator::AllocateBuffer(VkBufferCreateInfo bufferCreateInfo, VmaMemoryUsage memoryUsage, VkBuffer& outBuffer)
 	{
-		VmaAllocationCreateInfo allocCreateInfo{};
+		VmaAllocationCreateInfo allocCreateInfo = GetAllocationCreateInfo();
 		allocCreateInfo.usage = memoryUsage;
 
 		VmaAllocation allocation;
 		vmaCreateBuffer(s_allocatorData->allocator, &bufferCreateInfo, &allocCreateInfo, &outBuffer, &allocation, nullptr);
 
+		OnAllocated(allocation);
+		return allocation;
+	}
+
+	VmaAllocation VulkanAllocator::AllocateBuffer(VkBufferCreateInfo bufferCreateInfo, VkMemoryPropertyFlags requiredFlags, VkBuffer& outBuffer, void** outMappedData)
+	{
+		VmaAllocationCreateInfo allocCreateInfo = GetAllocationCreateInfo();
+		allocCreateInfo.usage = VMA_MEMORY_USAGE_UNKNOWN;
+		allocCreateInfo.requiredFlags = requiredFlags;
+
+		if (outMappedData)
+		{
+			allocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+		}
+
+		VmaAllocation allocation;
 		VmaAllocationInfo allocInfo{};
-		vmaGetAllocationInfo(s_allocatorData->allocator, allocation, &allocInfo);
+		LP_VK_CHECK(vmaCreateBuffer(s_allocatorData->allocator, &bufferCreateInfo, &allocCreateInfo, &outBuffer, &allocation, &allocInfo));
+
+		if (outMappedData)
+		{
+			*outMappedData = allocInfo.pMappedData;
+		}
 
-		s_allocatorData->totalAllocatedBytes += allocInfo.size;
+		OnAllocated(allocation);
 
-#ifdef LP_ENABLE_DEBUG_ALLOCATIONS
-		m_allocatedBytes += (uint64_t)allocInfo.size;
-#endif
+		VkPhysicalDeviceMemoryProperties memoryProperties{};
+		vmaGetMemoryProperties(s_allocatorData->allocator, &memoryProperties);
+
+		const uint32_t heapIndex = memoryProperties.memoryTypes[allocInfo.memoryType].heapIndex;
+		LP_CORE_INFO("{0}: {1} bytes placed in memory type {2} (heap {3}, flags {4:#x})", m_tag.empty() ? "VulkanAllocator" : m_tag, allocInfo.size, allocInfo.memoryType, heapIndex, memoryProperties.memoryTypes[allocInfo.memoryType].propertyFlags);
+
+		return allocation;
+	}
+
+	VmaAllocation VulkanAllocator::AllocateMappedBuffer(VkBufferCreateInfo bufferCreateInfo, VmaMemoryUsage memoryUsage, VkBuffer& outBuffer, void*& outMappedData)
+	{
+		VmaAllocationCreateInfo allocCreateInfo = GetAllocationCreateInfo();
+		allocCreateInfo.usage = memoryUsage;
+		allocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+		allocCreateInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+		VmaAllocation allocation;
+		VmaAllocationInfo allocInfo{};
+		vmaCreateBuffer(s_allocatorData->allocator, &bufferCreateInfo, &allocCreateInfo, &outBuffer, &allocation, &allocInfo);
+
+		outMappedData = allocInfo.pMappedData;
+		OnAllocated(allocation);
 
 		return allocation;
 	}
 
 	VmaAllocation VulkanAllocator::AllocateImage(VkImageCreateInfo bufferCreateInfo, VmaMemoryUsage memoryUsage, VkImage& outImage)
 	{
-		VmaAllocationCreateInfo allocCreateInfo{};
+		VmaAllocationCreateInfo allocCreateInfo = GetAllocationCreateInfo();
 		allocCreateInfo.usage = memoryUsage;
 
 		VmaAllocation allocation;
 		vmaCreateImage(s_allocatorData->allocator, &bufferCreateInfo, &allocCreateInfo, &outImage, &allocation, nullptr);
 
-		VmaAllocationInfo allocInfo{};
-		vmaGetAllocationInfo(s_allocatorData->allocator, allocation, &allocInfo);
+		OnAllocated(allocation);
+		return allocation;
+	}
 
-		s_allocatorData->totalAllocatedBytes += allocInfo.size;
+	VmaAllocation VulkanAllocator::AllocateMemory(const VkMemoryRequirements& memoryRequirements, VmaMemoryUsage memoryUsage)
+	{
+		VmaAllocationCreateInfo allocCreateInfo = GetAllocationCreateInfo();
+		allocCreateInfo.usage = memoryUsage;
 
-#ifdef LP_ENABLE_DEBUG_ALLOCATIONS
-		m_allocatedBytes += (uint64_t)allocInfo.size;
-#endif
+		VmaAllocation allocation;
+		LP_VK_CHECK(vmaAllocateMemory(s_allocatorData->allocator, &memoryRequirements, &allocCreateInfo, &allocation, nullptr));
 
+		OnAllocated(allocation);
 		return allocation;
 	}
 
+	void VulkanAllocator::CreateAliasingImage(VmaAllocation allocation, VkImageCreateInfo imageCreateInfo, VkImage& outImage)
+	{
+		LP_CORE_ASSERT(allocation, "Unable to alias null allocation!");
+		LP_VK_CHECK(vmaCreateAliasingImage(s_allocatorData->allocator, allocation, &imageCreateInfo, &outImage));
+	}
+
 	void VulkanAllocator::Free(VmaAllocation allocation)
 	{
 		LP_CORE_ASSERT(allocation, "Unable to free null allocation!");
 
-		VmaAllocationInfo allocInfo{};
-		vmaGetAllocationInfo(s_allocatorData->allocator, allocation, &allocInfo);
-		s_allocatorData->totalFreedBytes += allocInfo.size;
-
-#ifdef LP_ENABLE_DEBUG_ALLOCATIONS
-		m_freedBytes += (uint64_t)allocInfo.size;
-#endif
+		OnFreed(allocation);
 		vmaFreeMemory(s_allocatorData->allocator, allocation);
 	}
 
@@ -98,13 +155,7 @@ namespace Lamp
 		LP_CORE_ASSERT(buffer, "Unable to destroy null buffer!");
 		LP_CORE_ASSERT(allocation, "Unable to free null allocation!");
 
-		VmaAllocationInfo allocInfo{};
-		vmaGetAllocationInfo(s_allocatorData->allocator, allocation, &allocInfo);
-		s_allocatorData->totalFreedBytes += allocInfo.size;
-
-#ifdef LP_ENABLE_DEBUG_ALLOCATIONS
-		m_freedBytes += (uint64_t)allocInfo.size;
-#endif
+		OnFreed(allocation);
 
 		vmaDestroyBuffer(s_allocatorData->allocator, buffer, allocation);
 	}
@@ -114,13 +165,7 @@ namespace Lamp
 		LP_CORE_ASSERT(image, "Unable to destroy null image!");
 		LP_CORE_ASSERT(allocation, "Unable to free null allocation!");
 
-		VmaAllocationInfo allocInfo{};
-		vmaGetAllocationInfo(s_allocatorData->allocator, allocation, &allocInfo);
-		s_allocatorData->totalFreedBytes += allocInfo.size;
-
-#ifdef LP_ENABLE_DEBUG_ALLOCATIONS
-		m_freedBytes += (uint64_t)allocInfo.size;
-#endif
+		OnFreed(allocation);
 
 		vmaDestroyImage(s_allocatorData->allocator, image, allocation);
 	}
@@ -140,7 +185,19 @@ namespace Lamp
 		info.device = graphicsDevice->GetHandle();
 		info.instance = GraphicsContext::Get().GetInstance();
 
+		if (graphicsDevice->GetPhysicalDevice()->GetCapabilities().hasMemoryBudget)
+		{
+			info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+		}
+
 		LP_VK_CHECK(vmaCreateAllocator(&info, &s_allocatorData->allocator));
+
+		s_allocatorData->budgetWarningCallback = [](uint32_t heapIndex, const HeapBudget& heap)
+		{
+			LP_CORE_WARN("Memory heap {0} is using {1} MB of its {2} MB budget!", heapIndex, heap.usage / (1024ull * 1024ull), heap.budget / (1024ull * 1024ull));
+		};
+
+		Update();
 	}
 
 	void VulkanAllocator::Shutdown()
@@ -157,8 +214,151 @@ namespace Lamp
 		s_allocatorData = nullptr;
 	}
 
+	void VulkanAllocator::Update()
+	{
+		LP_PROFILE_FUNCTION();
+
+		const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+		vmaGetMemoryProperties(s_allocatorData->allocator, &memoryProperties);
+
+		std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+		vmaGetHeapBudgets(s_allocatorData->allocator, budgets.data());
+
+		std::vector<std::pair<uint32_t, HeapBudget>> crossedHeaps;
+
+		{
+			std::scoped_lock lock{ s_allocatorData->mutex };
+
+			s_allocatorData->heaps.resize(memoryProperties->memoryHeapCount);
+			s_allocatorData->heapsOverBudget.resize(memoryProperties->memoryHeapCount, false);
+
+			for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++)
+			{
+				HeapBudget& heap = s_allocatorData->heaps[i];
+				heap.usage = budgets[i].usage;
+				heap.budget = budgets[i].budget;
+				heap.deviceLocal = (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+
+				const bool overBudget = heap.budget > 0 && (float)heap.usage >= (float)heap.budget * s_allocatorData->budgetWarningFraction;
+				if (overBudget && !s_allocatorData->heapsOverBudget[i])
+				{
+					crossedHeaps.emplace_back(i, heap);
+				}
+
+				s_allocatorData->heapsOverBudget[i] = overBudget;
+			}
+		}
+
+		if (s_allocatorData->budgetWarningCallback)
+		{
+			for (const auto& [heapIndex, heap] : crossedHeaps)
+			{
+				s_allocatorData->budgetWarningCallback(heapIndex, heap);
+			}
+		}
+	}
+
+	VulkanAllocator::Statistics VulkanAllocator::GetStatistics()
+	{
+		std::scoped_lock lock{ s_allocatorData->mutex };
+
+		Statistics stats{};
+		stats.heaps = s_allocatorData->heaps;
+		stats.categoryBytes = s_allocatorData->categoryBytes;
+		stats.categoryAllocations = s_allocatorData->categoryAllocations;
+
+		return stats;
+	}
+
+	std::string VulkanAllocator::BuildStatsString(bool detailed)
+	{
+		char* statsString = nullptr;
+		vmaBuildStatsString(s_allocatorData->allocator, &statsString, detailed ? VK_TRUE : VK_FALSE);
+
+		std::string result{ statsString };
+		vmaFreeStatsString(s_allocatorData->allocator, statsString);
+
+		return result;
+	}
+
+	void VulkanAllocator::SetBudgetWarning(float budgetFraction, BudgetWarningCallback&& callback)
+	{
+		std::scoped_lock lock{ s_allocatorData->mutex };
+
+		s_allocatorData->budgetWarningFraction = budgetFraction;
+		if (callback)
+		{
+			s_allocatorData->budgetWarningCallback = std::move(callback);
+		}
+
+		// Heaps already above the new fraction should warn again
+		std::fill(s_allocatorData->heapsOverBudget.begin(), s_allocatorData->heapsOverBudget.end(), false);
+	}
+
+	const char* VulkanAllocator::GetCategoryName(MemoryCategory category)
+	{
+		switch (category)
+		{
+			case MemoryCategory::General: return "General";
+			case MemoryCategory::Mesh: return "Mesh";
+			case MemoryCategory::Texture: return "Texture";
+			case MemoryCategory::RenderTarget: return "Render Target";
+			case MemoryCategory::Staging: return "Staging";
+			case MemoryCategory::SceneBuffer: return "Scene Buffer";
+		}
+
+		return "Unknown";
+	}
+
 	VmaAllocator& VulkanAllocator::GetAllocator()
 	{
 		return s_allocatorData->allocator;
 	}
+
+	void VulkanAllocator::OnAllocated(VmaAllocation allocation)
+	{
+		VmaAllocationInfo allocInfo{};
+		vmaGetAllocationInfo(s_allocatorData->allocator, allocation, &allocInfo);
+
+		{
+			std::scoped_lock lock{ s_allocatorData->mutex };
+
+			s_allocatorData->totalAllocatedBytes += allocInfo.size;
+			s_allocatorData->categoryBytes[(size_t)m_category] += allocInfo.size;
+			s_allocatorData->categoryAllocations[(size_t)m_category]++;
+		}
+
+#ifdef LP_ENABLE_DEBUG_ALLOCATIONS
+		m_allocatedBytes += (uint64_t)allocInfo.size;
+#endif
+	}
+
+	void VulkanAllocator::OnFreed(VmaAllocation allocation)
+	{
+		VmaAllocationInfo allocInfo{};
+		vmaGetAllocationInfo(s_allocatorData->allocator, allocation, &allocInfo);
+
+		// The category is stored with the allocation, the freeing allocator might have been created with another one
+		const size_t category = (size_t)reinterpret_cast<uintptr_t>(allocInfo.pUserData);
+
+		{
+			std::scoped_lock lock{ s_allocatorData->mutex };
+
+			s_allocatorData->totalFreedBytes += allocInfo.size;
+			s_allocatorData->categoryBytes[category] -= allocInfo.size;
+			s_allocatorData->categoryAllocations[category]--;
+		}
+
+#ifdef LP_ENABLE_DEBUG_ALLOCATIONS
+		m_freedBytes += (uint64_t)allocInfo.size;
+#endif
+	}
+
+	VmaAllocationCreateInfo VulkanAllocator::GetAllocationCreateInfo() const
+	{
+		VmaAllocationCreateInfo allocCreateInfo{};
+		allocCreateInfo.pUserData = reinterpret_cast<void*>((uintptr_t)m_category);
+
+		return allocCreateInfo;
+	}
 }
\ No newline at end of file
@@ -4,19 +4,55 @@
 
 #include <vma/VulkanMemoryAllocator.h>
 
+#include <array>
+#include <functional>
+
 namespace Lamp
 {
+	enum class MemoryCategory : uint32_t
+	{
+		General = 0,
+		Mesh,
+		Texture,
+		RenderTarget,
+		Staging,
+		SceneBuffer,
+
+		Count
+	};
+
 	class GraphicsDevice;
 	class VulkanAllocator
 	{
 	public:
+		struct HeapBudget
+		{
+			uint64_t usage = 0;
+			uint64_t budget = 0;
+			bool deviceLocal = false;
+		};
+
+		struct Statistics
+		{
+			std::vector<HeapBudget> heaps;
+
+			std::array<uint64_t, (size_t)MemoryCategory::Count> categoryBytes{};
+			std::array<uint32_t, (size_t)MemoryCategory::Count> categoryAllocations{};
+		};
+
+		using BudgetWarningCallback = std::function<void(uint32_t heapIndex, const HeapBudget& heap)>;
+
 		VulkanAllocator() = default;
-		VulkanAllocator(const std::string& tag);
+		VulkanAllocator(const std::string& tag, MemoryCategory category = MemoryCategory::General);
 
 		~VulkanAllocator();
 		
 		VmaAllocation AllocateBuffer(VkBufferCreateInfo bufferCreateInfo, VmaMemoryUsage memoryUsage, VkBuffer& outBuffer);
+		VmaAllocation AllocateBuffer(VkBufferCreateInfo bufferCreateInfo, VkMemoryPropertyFlags requiredFlags, VkBuffer& outBuffer, void** outMappedData = nullptr); // Picks a memory type with the required flags, logging the chosen heap
+		VmaAllocation AllocateMappedBuffer(VkBufferCreateInfo bufferCreateInfo, VmaMemoryUsage memoryUsage, VkBuffer& outBuffer, void*& outMappedData); // Coherent and mapped for the whole lifetime of the buffer
 		VmaAllocation AllocateImage(VkImageCreateInfo bufferCreateInfo, VmaMemoryUsage memoryUsage, VkImage& outImage);
+		VmaAllocation AllocateMemory(const VkMemoryRequirements& memoryRequirements, VmaMemoryUsage memoryUsage); // Raw memory, resources are placed in it with CreateAliasingImage
+		void CreateAliasingImage(VmaAllocation allocation, VkImageCreateInfo imageCreateInfo, VkImage& outImage); // The image does not own the memory and is destroyed with vkDestroyImage
 	
 		void Free(VmaAllocation allocation);
 		void DestroyBuffer(VkBuffer buffer, VmaAllocation allocation);
@@ -35,13 +71,28 @@ namespace Lamp
 		static void Initialize(Ref<GraphicsDevice> graphicsDevice);
 		static void Shutdown();
 
+		// Queries the heap budgets, should be called once per frame
+		static void Update();
+
+		static Statistics GetStatistics();
+		static std::string BuildStatsString(bool detailed = false); // JSON report from VMA
+
+		// The callback fires once when the usage of a heap crosses the given fraction of its budget
+		static void SetBudgetWarning(float budgetFraction, BudgetWarningCallback&& callback = nullptr);
+		static const char* GetCategoryName(MemoryCategory category);
+
 		static VmaAllocator& GetAllocator();
 	private:
+		void OnAllocated(VmaAllocation allocation);
+		void OnFreed(VmaAllocation allocation);
+
+		VmaAllocationCreateInfo GetAllocationCreateInfo() const;
 		
 	#ifdef LP_ENABLE_DEBUG_ALLOCATIONS
 		uint64_t m_allocatedBytes = 0;
 		uint64_t m_freedBytes = 0;
 	#endif
 		std::string m_tag;
+		MemoryCategory m_category = MemoryCategory::General;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,87 @@
+#include "lppch.h"
+#include "RenderThread.h"
+
+#include "Lamp/Log/Log.h"
+
+#include "Lamp/Core/Graphics/UploadManager.h"
+#include "Lamp/Rendering/Renderer.h"
+
+namespace Lamp
+{
+	RenderThread::RenderThread(RenderFunction&& renderFunction, uint32_t maxQueuedFrames)
+		: m_renderFunction(std::move(renderFunction)), m_maxQueuedFrames(maxQueuedFrames)
+	{
+		LP_CORE_ASSERT(maxQueuedFrames > 0, "Render thread needs room for at least one frame!");
+
+		m_thread = std::thread(&RenderThread::Thread_Render, this);
+		UploadManager::SetRenderThread(m_thread.get_id());
+	}
+
+	RenderThread::~RenderThread()
+	{
+		// Frames which are already queued are still rendered
+		{
+			std::scoped_lock lock{ m_mutex };
+			m_isRunning = false;
+		}
+
+		m_submitConditionVar.notify_all();
+		m_thread.join();
+
+		UploadManager::SetRenderThread({});
+	}
+
+	void RenderThread::Submit(Scope<FramePacket> packet)
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::unique_lock lock{ m_mutex };
+		m_renderedConditionVar.wait(lock, [this]() { return m_queue.size() < m_maxQueuedFrames; });
+
+		m_queue.emplace_back(std::move(packet));
+		m_submitConditionVar.notify_one();
+	}
+
+	void RenderThread::Flush()
+	{
+		LP_PROFILE_FUNCTION();
+
+		std::unique_lock lock{ m_mutex };
+		m_renderedConditionVar.wait(lock, [this]() { return m_queue.empty() && !m_isRendering; });
+	}
+
+	Scope<RenderThread> RenderThread::Create(RenderFunction&& renderFunction, uint32_t maxQueuedFrames)
+	{
+		return CreateScope<RenderThread>(std::move(renderFunction), maxQueuedFrames);
+	}
+
+	void RenderThread::Thread_Render()
+	{
+		LP_PROFILE_THREAD("Render");
+
+		std::unique_lock lock{ m_mutex };
+		while (true)
+		{
+			m_submitConditionVar.wait(lock, [this]() { return !m_isRunning || !m_queue.empty(); });
+			if (m_queue.empty())
+			{
+				return;
+			}
+
+			Scope<FramePacket> packet = std::move(m_queue.front());
+			m_queue.pop_front();
+			m_isRendering = true;
+
+			// The producer can build the next frame while this one is recorded
+			lock.unlock();
+			m_renderedConditionVar.notify_all();
+
+			m_renderFunction(*packet);
+			packet = nullptr;
+
+			lock.lock();
+			m_isRendering = false;
+			m_renderedConditionVar.notify_all();
+		}
+	}
+}
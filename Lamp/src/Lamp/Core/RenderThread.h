@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Lamp
+{
+	struct FramePacket;
+	class RenderThread
+	{
+	public:
+		using RenderFunction = std::function<void(FramePacket& packet)>;
+
+		// The queue bounds how many frames the producing thread can run ahead of the frame being rendered
+		RenderThread(RenderFunction&& renderFunction, uint32_t maxQueuedFrames = 1);
+		~RenderThread();
+
+		// Blocks while the queue is full
+		void Submit(Scope<FramePacket> packet);
+
+		// Returns when every submitted packet has been rendered, the render thread is idle until the next submit
+		void Flush();
+
+		inline const std::thread::id GetThreadId() const { return m_thread.get_id(); }
+
+		static Scope<RenderThread> Create(RenderFunction&& renderFunction, uint32_t maxQueuedFrames = 1);
+
+	private:
+		void Thread_Render();
+
+		std::thread m_thread;
+		RenderFunction m_renderFunction;
+
+		std::mutex m_mutex;
+		std::condition_variable m_submitConditionVar;
+		std::condition_variable m_renderedConditionVar;
+
+		std::deque<Scope<FramePacket>> m_queue;
+		const uint32_t m_maxQueuedFrames;
+
+		bool m_isRendering = false;
+		bool m_isRunning = true;
+	};
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace Lamp
+{
+	// One buffer per writing thread, so appending needs no synchronization. The buffers are moved out together while no thread is writing.
+	// A thread writes to one set per element type at a time, a thread switching sets (or writing to a recreated one) registers again
+	template<typename T>
+	class ThreadLocalBuffers
+	{
+	public:
+		ThreadLocalBuffers();
+
+		// Registered on the first call from each thread
+		std::vector<T>& Get();
+
+		// Appends the buffers in registration order and clears them, they keep their capacity. Buffers of exited threads are dropped afterwards
+		void MoveInto(std::vector<T>& outItems);
+
+		const uint32_t GetBufferCount() const;
+
+	private:
+		struct Buffer
+		{
+			std::vector<T> items;
+			bool isReleased = false; // the owning thread has exited or moved on to another set
+		};
+
+		struct Registry
+		{
+			std::vector<Scope<Buffer>> buffers;
+			mutable std::mutex mutex;
+		};
+
+		struct ThreadEntry
+		{
+			~ThreadEntry();
+			void Release();
+
+			uint64_t id = 0;
+			WeakRef<Registry> registry;
+			Buffer* buffer = nullptr;
+		};
+
+		inline static std::atomic_uint64_t s_nextId = 1;
+
+		Ref<Registry> m_registry;
+		uint64_t m_id = 0;
+	};
+
+	template<typename T>
+	inline ThreadLocalBuffers<T>::ThreadLocalBuffers()
+		: m_registry(CreateRef<Registry>()), m_id(s_nextId++)
+	{
+	}
+
+	template<typename T>
+	inline std::vector<T>& ThreadLocalBuffers<T>::Get()
+	{
+		// The id is unique per set, so an entry of a destroyed set is never mistaken for one of this set
+		static thread_local ThreadEntry entry;
+		if (entry.id != m_id)
+		{
+			entry.Release();
+
+			std::scoped_lock lock{ m_registry->mutex };
+			entry.buffer = m_registry->buffers.emplace_back(CreateScope<Buffer>()).get();
+			entry.registry = m_registry;
+			entry.id = m_id;
+		}
+
+		return entry.buffer->items;
+	}
+
+	template<typename T>
+	inline void ThreadLocalBuffers<T>::MoveInto(std::vector<T>& outItems)
+	{
+		std::scoped_lock lock{ m_registry->mutex };
+
+		size_t itemCount = 0;
+		for (const auto& buffer : m_registry->buffers)
+		{
+			itemCount += buffer->items.size();
+		}
+
+		outItems.reserve(outItems.size() + itemCount);
+
+		for (const auto& buffer : m_registry->buffers)
+		{
+			outItems.insert(outItems.end(), std::make_move_iterator(buffer->items.begin()), std::make_move_iterator(buffer->items.end()));
+			buffer->items.clear();
+		}
+
+		std::erase_if(m_registry->buffers, [](const Scope<Buffer>& buffer) { return buffer->isReleased; });
+	}
+
+	template<typename T>
+	inline const uint32_t ThreadLocalBuffers<T>::GetBufferCount() const
+	{
+		std::scoped_lock lock{ m_registry->mutex };
+		return (uint32_t)m_registry->buffers.size();
+	}
+
+	template<typename T>
+	inline ThreadLocalBuffers<T>::ThreadEntry::~ThreadEntry()
+	{
+		Release();
+	}
+
+	template<typename T>
+	inline void ThreadLocalBuffers<T>::ThreadEntry::Release()
+	{
+		// Items written before the thread exited are still merged, the buffer is dropped by the next merge
+		if (Ref<Registry> lockedRegistry = registry.lock())
+		{
+			std::scoped_lock lock{ lockedRegistry->mutex };
+			buffer->isReleased = true;
+		}
+
+		registry.reset();
+		buffer = nullptr;
+		id = 0;
+	}
+}
@@ -0,0 +1,91 @@
+#include "lppch.h"
+#include "ThreadPool.h"
+
+#include "Lamp/Log/Log.h"
+
+namespace Lamp
+{
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		LP_CORE_ASSERT(threadCount > 0, "Thread pool needs at least one thread!");
+
+		m_threads.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			m_threads.emplace_back(&ThreadPool::Thread_Work, this, i);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::scoped_lock lock{ m_mutex };
+			m_isRunning = false;
+		}
+
+		m_workConditionVar.notify_all();
+
+		for (auto& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	void ThreadPool::ParallelFor(uint32_t jobCount, const Job& job)
+	{
+		LP_PROFILE_FUNCTION();
+
+		if (jobCount == 0)
+		{
+			return;
+		}
+
+		std::unique_lock lock{ m_mutex };
+		LP_CORE_ASSERT(m_pendingJobs == 0, "ParallelFor can not be nested or called from multiple threads!");
+
+		m_job = &job;
+		m_jobCount = jobCount;
+		m_nextJob = 0;
+		m_pendingJobs = jobCount;
+
+		m_workConditionVar.notify_all();
+		m_doneConditionVar.wait(lock, [this]() { return m_pendingJobs == 0; });
+
+		m_job = nullptr;
+		m_jobCount = 0;
+		m_nextJob = 0;
+	}
+
+	Ref<ThreadPool> ThreadPool::Create(uint32_t threadCount)
+	{
+		return CreateRef<ThreadPool>(threadCount);
+	}
+
+	void ThreadPool::Thread_Work(uint32_t threadIndex)
+	{
+		LP_PROFILE_THREAD("Worker");
+
+		std::unique_lock lock{ m_mutex };
+		while (true)
+		{
+			m_workConditionVar.wait(lock, [this]() { return !m_isRunning || m_nextJob < m_jobCount; });
+			if (!m_isRunning)
+			{
+				return;
+			}
+
+			// Jobs are claimed under the lock, so a late worker can never pick up an index of a finished call
+			const uint32_t jobIndex = m_nextJob++;
+			const Job* job = m_job;
+
+			lock.unlock();
+			(*job)(jobIndex, threadIndex);
+			lock.lock();
+
+			if (--m_pendingJobs == 0)
+			{
+				m_doneConditionVar.notify_all();
+			}
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Lamp
+{
+	class ThreadPool
+	{
+	public:
+		using Job = std::function<void(uint32_t jobIndex, uint32_t threadIndex)>;
+
+		ThreadPool(uint32_t threadCount);
+		~ThreadPool();
+
+		// Runs the job once per index on the workers and returns when all of them have finished. The thread index identifies the worker running the job
+		void ParallelFor(uint32_t jobCount, const Job& job);
+
+		inline const uint32_t GetThreadCount() const { return (uint32_t)m_threads.size(); }
+
+		static Ref<ThreadPool> Create(uint32_t threadCount);
+
+	private:
+		void Thread_Work(uint32_t threadIndex);
+
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_workConditionVar;
+		std::condition_variable m_doneConditionVar;
+
+		const Job* m_job = nullptr;
+		uint32_t m_jobCount = 0;
+		uint32_t m_nextJob = 0;
+		uint32_t m_pendingJobs = 0;
+
+		bool m_isRunning = true;
+	};
+}
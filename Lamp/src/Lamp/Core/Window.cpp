@@ -44,6 +44,10 @@ namespace Lamp
 	void Window::Present()
 	{
 		m_swapchain->Present();
+	}
+
+	void Window::PollEvents()
+	{
 		glfwPollEvents();
 	}
 
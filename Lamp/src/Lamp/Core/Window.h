@@ -47,6 +47,7 @@ namespace Lamp
 
 		void BeginFrame();
 		void Present();
+		void PollEvents(); // main thread only
 
 		void SetEventCallback(const EventCallbackFn& callback);
 		void SetWindowMode(WindowMode windowMode);
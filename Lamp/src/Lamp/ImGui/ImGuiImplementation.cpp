@@ -8,6 +8,7 @@
 #include "Lamp/Core/Window.h"
 
 #include "Lamp/Log/Log.h"
+#include "Lamp/Rendering/Renderer.h"
 #include "Lamp/Utility/FileSystem.h"
 
 #include <backends/imgui_impl_glfw.h>
@@ -21,6 +22,21 @@ namespace Lamp
 {
 	static std::vector<VkCommandBuffer> s_imGuiCommandBuffer;
 
+	// The draw lists are reused by the next frame, so the render thread draws from a copy
+	struct ImGuiImplementation::DrawDataSnapshot
+	{
+		~DrawDataSnapshot()
+		{
+			for (ImDrawList* drawList : drawLists)
+			{
+				IM_DELETE(drawList);
+			}
+		}
+
+		ImDrawData drawData;
+		std::vector<ImDrawList*> drawLists;
+	};
+
 	namespace Utils
 	{
 		inline void VulkanCheckResult(VkResult result)
@@ -38,7 +54,8 @@ namespace Lamp
 		}
 	}
 
-	ImGuiImplementation::ImGuiImplementation()
+	ImGuiImplementation::ImGuiImplementation(bool useRenderThread)
+		: m_useRenderThread(useRenderThread)
 	{
 		IMGUI_CHECKVERSION();
 		ImGui::CreateContext();
@@ -46,7 +63,10 @@ namespace Lamp
 		ImGuiIO& io = ImGui::GetIO(); (void)io;
 		io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;	//Enable keyboard controls
 		io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;		//Enable docking
-		io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;		//Enable multiple viewports
+		if (!useRenderThread)
+		{
+			io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;	//Enable multiple viewports
+		}
 		
 		io.ConfigWindowsMoveFromTitleBarOnly = true;
 		io.IniFilename = nullptr;
@@ -242,15 +262,49 @@ namespace Lamp
 		}
 		ImGui::Render();
 
+		Ref<DrawDataSnapshot> snapshot;
+		if (m_useRenderThread)
+		{
+			const ImDrawData* drawData = ImGui::GetDrawData();
+
+			snapshot = CreateRef<DrawDataSnapshot>();
+			snapshot->drawData = *drawData;
+
+			for (int32_t i = 0; i < drawData->CmdListsCount; i++)
+			{
+				snapshot->drawLists.emplace_back(drawData->CmdLists[i]->CloneOutput());
+			}
+
+			snapshot->drawData.CmdLists = snapshot->drawLists.data();
+		}
+
+		// The swapchain is only resized while the render thread is idle, so the size matches it when the job runs
+		const uint32_t width = Application::Get().GetWindow()->GetWidth();
+		const uint32_t height = Application::Get().GetWindow()->GetHeight();
+
+		Renderer::SubmitRenderJob([this, snapshot, width, height]()
+			{
+				RecordDrawData(snapshot ? &snapshot->drawData : ImGui::GetDrawData(), width, height);
+			});
+
+		ImGuiIO& io = ImGui::GetIO(); (void)io;
+
+		if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+		{
+			ImGui::UpdatePlatformWindows();
+			ImGui::RenderPlatformWindowsDefault();
+		}
+	}
+
+	void ImGuiImplementation::RecordDrawData(ImDrawData* drawData, uint32_t width, uint32_t height)
+	{
+		LP_PROFILE_FUNCTION();
 
 		auto& swapchain = Application::Get().GetWindow()->GetSwapchain();
 
 		VkCommandBuffer drawCmdBuffer;
 		VkCommandBuffer secondaryCmdBuffer;
 
-		uint32_t width = Application::Get().GetWindow()->GetWidth();
-		uint32_t height = Application::Get().GetWindow()->GetHeight();
-
 		// Begin command buffer
 		{
 			uint32_t frameIndex = swapchain.GetCurrentFrame();
@@ -326,7 +380,6 @@ namespace Lamp
 			vkCmdSetScissor(secondaryCmdBuffer, 0, 1, &scissor);
 		}
 
-		ImDrawData* drawData = ImGui::GetDrawData();
 		ImGui_ImplVulkan_RenderDrawData(drawData, secondaryCmdBuffer);
 
 		LP_VK_CHECK(vkEndCommandBuffer(secondaryCmdBuffer));
@@ -335,19 +388,11 @@ namespace Lamp
 		vkCmdEndRenderPass(drawCmdBuffer);
 
 		LP_VK_CHECK(vkEndCommandBuffer(drawCmdBuffer));
-
-		ImGuiIO& io = ImGui::GetIO(); (void)io;
-
-		if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
-		{
-			ImGui::UpdatePlatformWindows();
-			ImGui::RenderPlatformWindowsDefault();
-		}
 	}
 
-	Scope<ImGuiImplementation> ImGuiImplementation::Create()
+	Scope<ImGuiImplementation> ImGuiImplementation::Create(bool useRenderThread)
 	{
-		return CreateScope<ImGuiImplementation>();
+		return CreateScope<ImGuiImplementation>(useRenderThread);
 	}
 
 	std::filesystem::path ImGuiImplementation::GetOrCreateIniPath()
@@ -5,23 +5,30 @@
 #include <vulkan/vulkan.h>
 
 struct ImFont;
+struct ImDrawData;
 namespace Lamp
 {
 	class ImGuiImplementation
 	{
 	public:
-		ImGuiImplementation();
+		// With a render thread the draw data is copied into the frame packet, platform windows are not supported then as they are rendered on the calling thread
+		ImGuiImplementation(bool useRenderThread);
 		~ImGuiImplementation();
 
 		void Begin();
-		void End();
+		void End(); // submits a render job drawing the frame into the swapchain
 		
-		static Scope<ImGuiImplementation> Create();
+		static Scope<ImGuiImplementation> Create(bool useRenderThread = false);
 
 	private:
+		struct DrawDataSnapshot;
+
 		std::filesystem::path GetOrCreateIniPath();
+		void RecordDrawData(ImDrawData* drawData, uint32_t width, uint32_t height);
 
 		ImFont* m_font;
 		VkDescriptorPool m_descriptorPool;
+
+		bool m_useRenderThread = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "lppch.h"
+#include "BufferCapacity.h"
+
+namespace Lamp
+{
+	BufferCapacity::BufferCapacity(uint32_t minCapacity, uint32_t shrinkFrameCount)
+		: m_capacity(std::max(minCapacity, 1u)), m_minCapacity(std::max(minCapacity, 1u)), m_shrinkFrameCount(shrinkFrameCount)
+	{
+	}
+
+	bool BufferCapacity::Update(uint32_t count)
+	{
+		uint32_t newCapacity = m_capacity;
+
+		if (count > newCapacity)
+		{
+			while (newCapacity < count)
+			{
+				newCapacity *= 2;
+			}
+
+			m_smallFrameCount = 0;
+		}
+		else if (m_shrinkFrameCount > 0 && count < newCapacity / 4 && newCapacity > m_minCapacity)
+		{
+			// Only shrink once the count has stayed small for a while, to avoid reallocating every other frame
+			m_smallFrameCount++;
+			if (m_smallFrameCount >= m_shrinkFrameCount)
+			{
+				newCapacity = std::max(newCapacity / 2, m_minCapacity);
+				m_smallFrameCount = 0;
+			}
+		}
+		else
+		{
+			m_smallFrameCount = 0;
+		}
+
+		if (newCapacity == m_capacity)
+		{
+			return false;
+		}
+
+		m_capacity = newCapacity;
+		return true;
+	}
+}
\ No newline at end of file
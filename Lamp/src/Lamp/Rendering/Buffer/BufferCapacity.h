@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Lamp
+{
+	// Scene buffers of the renderer
+	constexpr uint32_t MIN_OBJECT_CAPACITY = 8192;
+	constexpr uint32_t OBJECT_SHRINK_FRAME_COUNT = 300;
+	constexpr uint32_t MIN_VIEW_CAPACITY = 4;
+
+	// Element capacity of a growable buffer. It doubles until the count fits, and halves (down to the minimum) once the count has stayed below a quarter of it for the shrink frame count.
+	// A shrink frame count of zero never shrinks
+	class BufferCapacity
+	{
+	public:
+		BufferCapacity() = default;
+		BufferCapacity(uint32_t minCapacity, uint32_t shrinkFrameCount = 0);
+
+		// Called once per frame, returns true if the capacity changed
+		bool Update(uint32_t count);
+
+		inline uint32_t Get() const { return m_capacity; }
+
+	private:
+		uint32_t m_capacity = 1;
+		uint32_t m_minCapacity = 1;
+		uint32_t m_shrinkFrameCount = 0;
+		uint32_t m_smallFrameCount = 0; // consecutive frames the buffer has been mostly unused
+	};
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "CommandBuffer.h"
 
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
 #include "Lamp/Core/Graphics/GraphicsContext.h"
 
 #include "Lamp/Core/Application.h"
@@ -12,21 +13,25 @@
 
 namespace Lamp
 {
-	CommandBuffer::CommandBuffer(uint32_t count, bool swapchainTarget)
-		: m_count(count), m_swapchainTarget(swapchainTarget)
+	CommandBuffer::CommandBuffer(uint32_t count, bool swapchainTarget, QueueType queueType)
+		: m_count(count), m_swapchainTarget(swapchainTarget), m_queueType(queueType)
 	{
 		auto device = GraphicsContext::GetDevice();
+		m_queue = device->GetQueue(queueType);
+
+		LP_CORE_ASSERT(!swapchainTarget || queueType == QueueType::Graphics, "Swapchain command buffers are submitted to the graphics queue!");
+
 		if (!swapchainTarget)
 		{
 			m_commandPools.resize(count);
 			m_commandBuffers.resize(count);
-			m_submitFences.resize(count);
+			m_submitValues.resize(count, 0);
 
 			for (uint32_t i = 0; i < count; i++)
 			{
 				VkCommandPoolCreateInfo poolInfo{};
 				poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-				poolInfo.queueFamilyIndex = GraphicsContext::GetPhysicalDevice()->GetQueueIndices().graphicsQueueIndex;
+				poolInfo.queueFamilyIndex = device->GetQueueFamilyIndex(queueType);
 				poolInfo.flags = 0;
 
 				LP_VK_CHECK(vkCreateCommandPool(device->GetHandle(), &poolInfo, nullptr, &m_commandPools[i]));
@@ -42,14 +47,6 @@ namespace Lamp
 
 				LP_VK_CHECK(vkAllocateCommandBuffers(device->GetHandle(), &allocInfo, &m_commandBuffers[i]));
 			}
-
-			for (uint32_t i = 0; i < count; i++)
-			{
-				VkFenceCreateInfo fenceInfo{};
-				fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-				fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-				LP_VK_CHECK(vkCreateFence(device->GetHandle(), &fenceInfo, nullptr, &m_submitFences[i]));
-			}
 		}
 		else
 		{
@@ -72,11 +69,6 @@ namespace Lamp
 		{
 			auto device = GraphicsContext::GetDevice();
 
-			for (auto& fence : m_submitFences)
-			{
-				vkDestroyFence(device->GetHandle(), fence, nullptr);
-			}
-
 			for (uint32_t i = 0; i < m_commandPools.size(); i++)
 			{
 				vkDestroyCommandPool(device->GetHandle(), m_commandPools[i], nullptr);
@@ -94,7 +86,7 @@ namespace Lamp
 
 		if (!m_swapchainTarget)
 		{
-			vkWaitForFences(device->GetHandle(), 1, &m_submitFences[index], VK_TRUE, UINT64_MAX);
+			device->WaitForTimeline(m_queue, m_submitValues[index]);
 			LP_VK_CHECK(vkResetCommandPool(device->GetHandle(), m_commandPools[index], 0));
 		}
 
@@ -103,11 +95,15 @@ namespace Lamp
 		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 		LP_VK_CHECK(vkBeginCommandBuffer(m_commandBuffers[index], &beginInfo));
 	
-		OPTICK_GPU_CONTEXT(m_commandBuffers[index]);
-		OPTICK_GPU_EVENT("Test");
+		// The GPU profiler is only set up for the graphics queue
+		if (m_queueType == QueueType::Graphics)
+		{
+			OPTICK_GPU_CONTEXT(m_commandBuffers[index]);
+			OPTICK_GPU_EVENT("Test");
+		}
 	}
 
-	void CommandBuffer::End()
+	void CommandBuffer::End(const std::vector<QueueWait>& queueWaits)
 	{
 		auto device = GraphicsContext::GetDevice();
 		const uint32_t index = m_swapchainTarget ? Application::Get().GetWindow()->GetSwapchain().GetCurrentFrame() : m_currentCommandPool;
@@ -116,13 +112,18 @@ namespace Lamp
 
 		if (!m_swapchainTarget)
 		{
+			if (m_queue == device->GetGraphicsQueue())
+			{
+				UploadManager::Update();
+			}
+
 			VkSubmitInfo submitInfo{};
 			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 			submitInfo.commandBufferCount = 1;
 			submitInfo.pCommandBuffers = &m_commandBuffers[index];
 
-			vkResetFences(device->GetHandle(), 1, &m_submitFences[index]);
-			LP_VK_CHECK(vkQueueSubmit(device->GetGraphicsQueue(), 1, &submitInfo, m_submitFences[index]));
+			m_submitValues[index] = device->Submit(m_queue, submitInfo, queueWaits);
+			m_lastSubmitValue = m_submitValues[index];
 		}
 
 		m_currentCommandPool = (m_currentCommandPool + 1) % m_count;
@@ -140,9 +141,9 @@ namespace Lamp
 		return index;
 	}
 
-	Ref<CommandBuffer> CommandBuffer::Create(uint32_t count, bool swapchainTarget)
+	Ref<CommandBuffer> CommandBuffer::Create(uint32_t count, bool swapchainTarget, QueueType queueType)
 	{
-		return CreateRef<CommandBuffer>(count, swapchainTarget);
+		return CreateRef<CommandBuffer>(count, swapchainTarget, queueType);
 	}
 
 }
\ No newline at end of file
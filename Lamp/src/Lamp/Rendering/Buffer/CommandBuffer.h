@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Lamp/Core/Base.h"
+#include "Lamp/Core/Graphics/GraphicsDevice.h"
 
 #include <vulkan/vulkan.h>
 
@@ -9,21 +10,28 @@ namespace Lamp
 	class CommandBuffer
 	{
 	public:
-		CommandBuffer(uint32_t count, bool swapchainTarget);
+		CommandBuffer(uint32_t count, bool swapchainTarget, QueueType queueType);
 		~CommandBuffer();
 		
 		void Begin();
-		void End();
+		void End(const std::vector<QueueWait>& queueWaits = {}); // The submit waits for the given queue timeline values
 
 		VkCommandBuffer GetCurrentCommandBuffer();
 		uint32_t GetCurrentIndex();
+
+		inline VkQueue GetQueue() const { return m_queue; }
+		inline const uint64_t GetLastSubmitValue() const { return m_lastSubmitValue; }
 		
-		static Ref<CommandBuffer> Create(uint32_t count, bool swapchainTarget = false);
+		static Ref<CommandBuffer> Create(uint32_t count, bool swapchainTarget = false, QueueType queueType = QueueType::Graphics);
 
 	private:
 		std::vector<VkCommandPool> m_commandPools;
 		std::vector<VkCommandBuffer> m_commandBuffers;
-		std::vector<VkFence> m_submitFences;
+		std::vector<uint64_t> m_submitValues; // queue timeline value per command buffer
+		uint64_t m_lastSubmitValue = 0;
+
+		QueueType m_queueType = QueueType::Graphics;
+		VkQueue m_queue = nullptr;
 
 		bool m_swapchainTarget = false;
 		uint32_t m_currentCommandPool = 0;
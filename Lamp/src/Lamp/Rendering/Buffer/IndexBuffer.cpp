@@ -2,6 +2,10 @@
 #include "IndexBuffer.h"
 
 #include "Lamp/Core/Graphics/GraphicsContext.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
+
+#include "Lamp/Rendering/RenderPipeline/PipelineCommon.h"
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
 
 namespace Lamp
@@ -20,11 +24,8 @@ namespace Lamp
 
 	IndexBuffer::~IndexBuffer()
 	{
-		if (m_buffer)
-		{
-			VulkanAllocator allocator{ "IndexBuffer - Destroy" };
-			allocator.DestroyBuffer(m_buffer, m_bufferAllocation);
-		}
+		// Frames still in flight might be reading the buffer
+		DeletionQueue::RetireBuffer(m_buffer, m_bufferAllocation);
 	}
 
 	void IndexBuffer::Bind(VkCommandBuffer commandBuffer)
@@ -35,6 +36,19 @@ namespace Lamp
 		vkCmdBindIndexBuffer(commandBuffer, m_buffer, offset, VK_INDEX_TYPE_UINT32);
 	}
 
+	void IndexBuffer::Bind(VkCommandBuffer commandBuffer, PipelineBindState& bindState)
+	{
+		if (bindState.indexBuffer == m_buffer)
+		{
+			bindState.statistics.skippedCalls++;
+			return;
+		}
+
+		Bind(commandBuffer);
+		bindState.indexBuffer = m_buffer;
+		bindState.statistics.indexBufferBinds++;
+	}
+
 	Ref<IndexBuffer> IndexBuffer::Create(const std::vector<uint32_t>& indices, uint32_t count)
 	{
 		return CreateRef<IndexBuffer>(indices, count);
@@ -47,44 +61,15 @@ namespace Lamp
 
 	void IndexBuffer::SetData(const void* data, uint32_t size)
 	{
-		auto device = GraphicsContext::GetDevice();
+		VulkanAllocator allocator{ "IndexBuffer - Create", MemoryCategory::Mesh };
 
-		VkBuffer stagingBuffer;
-		VmaAllocation stagingAllocation;
-		VkDeviceSize bufferSize = size;
-		VulkanAllocator allocator{ "IndexBuffer - Create" };
-
-		if (m_buffer != VK_NULL_HANDLE)
-		{
-			allocator.DestroyBuffer(m_buffer, m_bufferAllocation);
-		}
-
-		if (data != nullptr)
-		{
-			// Create staging buffer
-			{
-				VkBufferCreateInfo bufferInfo{};
-				bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-				bufferInfo.size = bufferSize;
-				bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-				bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-				stagingAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_ONLY, stagingBuffer);
-			}
-
-			// Copy to staging buffer
-			{
-				void* buffData = allocator.MapMemory<void>(stagingAllocation);
-				memcpy_s(buffData, size, data, size);
-				allocator.UnmapMemory(stagingAllocation);
-			}
-		}
+		DeletionQueue::RetireBuffer(m_buffer, m_bufferAllocation);
 
 		// Create GPU buffer
 		{
 			VkBufferCreateInfo bufferInfo{};
 			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferInfo.size = bufferSize;
+			bufferInfo.size = size;
 			bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
@@ -93,20 +78,7 @@ namespace Lamp
 
 		if (data != nullptr)
 		{
-			// Copy from staging buffer to GPU buffer
-			{
-				VkCommandBuffer cmdBuffer = device->GetThreadSafeCommandBuffer(true);
-
-				VkBufferCopy copy{};
-				copy.srcOffset = 0;
-				copy.dstOffset = 0;
-				copy.size = bufferSize;
-
-				vkCmdCopyBuffer(cmdBuffer, stagingBuffer, m_buffer, 1, &copy);
-				device->FlushThreadSafeCommandBuffer(cmdBuffer);
-			}
-
-			allocator.DestroyBuffer(stagingBuffer, stagingAllocation);
+			m_uploadTicket = UploadManager::UploadBuffer(m_buffer, data, size);
 		}
 	}
 }
\ No newline at end of file
@@ -1,11 +1,13 @@
 #pragma once
 
 #include "Lamp/Core/Graphics/VulkanAllocator.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
 
 #include <vector>
 
 namespace Lamp
 {
+	struct PipelineBindState;
 	class IndexBuffer
 	{
 	public:
@@ -14,6 +16,9 @@ namespace Lamp
 		~IndexBuffer();
 
 		void Bind(VkCommandBuffer commandBuffer);
+		void Bind(VkCommandBuffer commandBuffer, PipelineBindState& bindState); // skipped if already bound
+
+		inline const UploadTicket GetUploadTicket() const { return m_uploadTicket; }
 
 		static Ref<IndexBuffer> Create(const std::vector<uint32_t>& pIndices, uint32_t count);
 		static Ref<IndexBuffer> Create(uint32_t* pIndices, uint32_t count);
@@ -24,5 +29,7 @@ namespace Lamp
 		VkBuffer m_buffer = nullptr;
 		VmaAllocation m_bufferAllocation = nullptr;
 		uint32_t m_count = 0;
+
+		UploadTicket m_uploadTicket = 0;
 	};
 }
\ No newline at end of file
@@ -3,20 +3,27 @@
 
 #include "Lamp/Core/Graphics/GraphicsContext.h"
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
+#include "Lamp/Core/Graphics/BarrierBatch.h"
 #include "Lamp/Log/Log.h"
 
 #include "Lamp/Rendering/Shader/ShaderUtility.h"
 
+#include <array>
+
 namespace Lamp
 {
-	ShaderStorageBuffer::ShaderStorageBuffer(uint64_t size, bool indirect)
-		: m_isIndirect(indirect)
+	ShaderStorageBuffer::ShaderStorageBuffer(uint64_t size, bool indirect, StorageBufferMemory memory)
+		: m_isIndirect(indirect), m_memory(memory)
 	{
-		Resize(size);
+		m_size = size;
+		m_totalSize = size;
+
+		CreateBuffer();
 	}
 
-	ShaderStorageBuffer::ShaderStorageBuffer(uint64_t elementSize, uint32_t elementCount, bool indirectBuffer)
-		: m_isDynamic(true), m_isIndirect(indirectBuffer)
+	ShaderStorageBuffer::ShaderStorageBuffer(uint64_t elementSize, uint32_t elementCount, bool indirectBuffer, StorageBufferMemory memory)
+		: m_isDynamic(true), m_isIndirect(indirectBuffer), m_memory(memory)
 	{
 		const uint64_t minSSBOAlignment = GraphicsContext::GetDevice()->GetPhysicalDevice()->GetCapabilities().minSSBOOffsetAlignment;
 		uint64_t alignedSize = elementSize;
@@ -29,60 +36,85 @@ namespace Lamp
 		m_size = alignedSize;
 		m_totalSize = alignedSize * (uint64_t)elementCount;
 
-		const VkDeviceSize bufferSize = m_totalSize;
+		CreateBuffer();
+	}
 
-		VulkanAllocator allocator{ "ShaderStorageBuffer - Create" };
+	ShaderStorageBuffer::~ShaderStorageBuffer()
+	{
+		Release();
+	}
 
-		VkBufferCreateInfo bufferInfo{};
-		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferInfo.size = bufferSize;
-		bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-		if (m_isIndirect)
+	void ShaderStorageBuffer::Resize(uint64_t newSize)
+	{
+		LP_PROFILE_FUNCTION();
+
+		if (m_isDynamic)
 		{
-			bufferInfo.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
-			bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			const uint64_t minSSBOAlignment = GraphicsContext::GetDevice()->GetPhysicalDevice()->GetCapabilities().minSSBOOffsetAlignment;
+			if (minSSBOAlignment > 0)
+			{
+				newSize = Utility::GetAlignedSize(newSize, minSSBOAlignment);
+			}
 		}
 
-		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (newSize == m_size)
+		{
+			return;
+		}
 
-		m_bufferAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, m_buffer);
-	}
+		const uint64_t elementCount = m_isDynamic ? m_totalSize / m_size : 1;
 
-	ShaderStorageBuffer::~ShaderStorageBuffer()
-	{
-		Release();
+		Release(true);
+
+		m_size = newSize;
+		m_totalSize = newSize * elementCount;
+
+		CreateBuffer();
 	}
 
-	void ShaderStorageBuffer::Resize(uint64_t newSize)
+	void ShaderStorageBuffer::SetElementCount(uint32_t elementCount)
 	{
-		LP_CORE_ASSERT(!m_isDynamic, "Resizing not properly implemented for dynamic SSBOs!");
+		LP_PROFILE_FUNCTION();
+		LP_CORE_ASSERT(m_isDynamic, "Only dynamic storage buffers have an element count!");
 
-		if (newSize > m_size)
+		if (elementCount == GetElementCount())
 		{
-			Release();
-			
-			m_size = newSize;
-			m_totalSize = newSize;
+			return;
+		}
 
-			auto device = GraphicsContext::GetDevice();
-			const VkDeviceSize bufferSize = newSize;
+		Release(true);
 
-			VulkanAllocator allocator{ "ShaderStorageBuffer - Create" };
+		m_totalSize = m_size * (uint64_t)elementCount;
 
-			VkBufferCreateInfo bufferInfo{};
-			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferInfo.size = bufferSize;
-			bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-			if (m_isIndirect)
-			{
-				bufferInfo.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
-				bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-			}
+		CreateBuffer();
+	}
 
-			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	void ShaderStorageBuffer::Upload(VkCommandBuffer commandBuffer, uint64_t size, VkPipelineStageFlags2 dstStage)
+	{
+		if (!m_stagingBuffer || size == 0)
+		{
+			return;
+		}
 
-			m_bufferAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, m_buffer);
+		LP_PROFILE_FUNCTION();
+
+		VkBufferCopy copy{};
+		copy.srcOffset = 0;
+		copy.dstOffset = 0;
+		copy.size = std::min(size, m_totalSize);
+
+		vkCmdCopyBuffer(commandBuffer, m_stagingBuffer, m_buffer, 1, &copy);
+
+		VkAccessFlags2 dstAccess = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+		if (m_isIndirect)
+		{
+			dstAccess |= VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
+			dstStage |= VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
 		}
+
+		BarrierBatch barriers;
+		barriers.AddBufferBarrier(m_buffer, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, dstStage, dstAccess, 0, copy.size);
+		barriers.Flush(commandBuffer);
 	}
 
 	const uint64_t ShaderStorageBuffer::GetOffsetSize() const
@@ -98,24 +130,98 @@ namespace Lamp
 		return dynamicAlignment;
 	}
 
-	void ShaderStorageBuffer::Unmap()
+	Ref<ShaderStorageBuffer> ShaderStorageBuffer::Create(uint64_t size, bool indirectBuffer, StorageBufferMemory memory)
 	{
-		VulkanAllocator allocator{};
-		allocator.UnmapMemory(m_bufferAllocation);
+		return CreateRef<ShaderStorageBuffer>(size, indirectBuffer, memory);
 	}
 
-	Ref<ShaderStorageBuffer> ShaderStorageBuffer::Create(uint64_t size, bool indirectBuffer)
+	Ref<ShaderStorageBuffer> ShaderStorageBuffer::Create(uint64_t elementSize, uint32_t elementCount, bool indirectBuffer, StorageBufferMemory memory)
 	{
-		return CreateRef<ShaderStorageBuffer>(size, indirectBuffer);
+		return CreateRef<ShaderStorageBuffer>(elementSize, elementCount, indirectBuffer, memory);
 	}
 
-	Ref<ShaderStorageBuffer> ShaderStorageBuffer::Create(uint64_t elementSize, uint32_t elementCount, bool indirectBuffer)
+	void ShaderStorageBuffer::CreateBuffer()
 	{
-		return CreateRef<ShaderStorageBuffer>(elementSize, elementCount, indirectBuffer);
+		VulkanAllocator allocator{ "ShaderStorageBuffer - Create", MemoryCategory::SceneBuffer };
+
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = m_totalSize;
+		bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		if (m_isIndirect)
+		{
+			bufferInfo.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+			bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		}
+
+		// Culling runs on the compute queue in async frames and on the graphics queue otherwise, so the buffers are shared by both families instead of transferring ownership back and forth
+		auto device = GraphicsContext::GetDevice();
+		const std::array<uint32_t, 2> queueFamilies = { device->GetQueueFamilyIndex(QueueType::Graphics), device->GetQueueFamilyIndex(QueueType::Compute) };
+		const bool concurrent = queueFamilies[0] != queueFamilies[1];
+
+		bufferInfo.sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+		bufferInfo.queueFamilyIndexCount = concurrent ? (uint32_t)queueFamilies.size() : 0;
+		bufferInfo.pQueueFamilyIndices = concurrent ? queueFamilies.data() : nullptr;
+
+		switch (m_memory)
+		{
+			case StorageBufferMemory::Host:
+			{
+				m_bufferAllocation = allocator.AllocateMappedBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, m_buffer, m_mappedData);
+				break;
+			}
+
+			case StorageBufferMemory::DeviceUpload:
+			{
+				const bool hasResizableBAR = GraphicsContext::GetDevice()->GetPhysicalDevice()->GetCapabilities().hasResizableBAR;
+				if (hasResizableBAR)
+				{
+					m_bufferAllocation = allocator.AllocateBuffer(bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_buffer, &m_mappedData);
+					break;
+				}
+
+				// Without resizable BAR the CPU writes into a staging buffer which is copied every frame
+				bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+				m_bufferAllocation = allocator.AllocateBuffer(bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_buffer);
+
+				VkBufferCreateInfo stagingInfo{};
+				stagingInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+				stagingInfo.size = m_totalSize;
+				stagingInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+				stagingInfo.sharingMode = bufferInfo.sharingMode;
+				stagingInfo.queueFamilyIndexCount = bufferInfo.queueFamilyIndexCount;
+				stagingInfo.pQueueFamilyIndices = bufferInfo.pQueueFamilyIndices;
+
+				m_stagingAllocation = allocator.AllocateMappedBuffer(stagingInfo, VMA_MEMORY_USAGE_CPU_ONLY, m_stagingBuffer, m_mappedData);
+				break;
+			}
+
+			case StorageBufferMemory::Device:
+			{
+				bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+				m_bufferAllocation = allocator.AllocateBuffer(bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_buffer);
+				break;
+			}
+		}
 	}
 
-	void ShaderStorageBuffer::Release()
+	void ShaderStorageBuffer::Release(bool deferred)
 	{
+		if (deferred)
+		{
+			// Frames still in flight might be reading the old buffers
+			DeletionQueue::RetireBuffer(m_buffer, m_bufferAllocation);
+			DeletionQueue::RetireBuffer(m_stagingBuffer, m_stagingAllocation);
+
+			m_buffer = nullptr;
+			m_bufferAllocation = nullptr;
+			m_stagingBuffer = nullptr;
+			m_stagingAllocation = nullptr;
+			m_mappedData = nullptr;
+
+			return;
+		}
+
 		if (m_buffer != VK_NULL_HANDLE)
 		{
 			VulkanAllocator allocator{ "ShaderStorageBuffer - Destroy" };
@@ -123,6 +229,16 @@ namespace Lamp
 
 			m_buffer = nullptr;
 			m_bufferAllocation = nullptr;
+			m_mappedData = nullptr;
+		}
+
+		if (m_stagingBuffer != VK_NULL_HANDLE)
+		{
+			VulkanAllocator allocator{ "ShaderStorageBuffer - Destroy" };
+			allocator.DestroyBuffer(m_stagingBuffer, m_stagingAllocation);
+
+			m_stagingBuffer = nullptr;
+			m_stagingAllocation = nullptr;
 		}
 	}
-}
\ No newline at end of file
+}
@@ -4,30 +4,47 @@
 
 namespace Lamp
 {
+	enum class StorageBufferMemory
+	{
+		Host, // Host visible, read by the GPU over the bus
+		DeviceUpload, // Written by the CPU every frame, device local and mapped with resizable BAR, staged otherwise
+		Device // Only written by the GPU
+	};
+
 	class ShaderStorageBuffer
 	{
 	public:
-		ShaderStorageBuffer(uint64_t size, bool indirectBuffer = false);
-		ShaderStorageBuffer(uint64_t elementSize, uint32_t elementCount, bool indirectBuffer = false);
+		ShaderStorageBuffer(uint64_t size, bool indirectBuffer = false, StorageBufferMemory memory = StorageBufferMemory::Host);
+		ShaderStorageBuffer(uint64_t elementSize, uint32_t elementCount, bool indirectBuffer = false, StorageBufferMemory memory = StorageBufferMemory::Host);
 		~ShaderStorageBuffer();
 
+		// Reallocates the buffer, the old one is released once the frames using it have retired. Dynamic buffers resize each element
 		void Resize(uint64_t newSize);
 
+		// Reallocates a dynamic buffer with a different number of elements, the element size is kept
+		void SetElementCount(uint32_t elementCount);
+
+		// Copies the staging buffer into the device buffer, does nothing if the device buffer is mapped directly. The stages have to be supported by the queue the command buffer is submitted to
+		void Upload(VkCommandBuffer commandBuffer, uint64_t size, VkPipelineStageFlags2 dstStage = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
 		inline const VkBuffer GetHandle() const { return m_buffer; }
 		inline const uint64_t GetSize() const { return m_size; }
 		inline const uint64_t GetTotalSize() const { return m_size; }
+		inline const StorageBufferMemory GetMemory() const { return m_memory; }
+		inline const uint32_t GetElementCount() const { return (uint32_t)(m_totalSize / m_size); }
 
 		const uint64_t GetOffsetSize() const;
 
+		// The buffer is persistently mapped, so this only returns the mapped pointer
 		template<typename T>
 		T* Map();
-		void Unmap();
 
-		static Ref<ShaderStorageBuffer> Create(uint64_t size, bool indirectBuffer = false);
-		static Ref<ShaderStorageBuffer> Create(uint64_t elementSize, uint32_t elementCount, bool indirectBuffer = false);
+		static Ref<ShaderStorageBuffer> Create(uint64_t size, bool indirectBuffer = false, StorageBufferMemory memory = StorageBufferMemory::Host);
+		static Ref<ShaderStorageBuffer> Create(uint64_t elementSize, uint32_t elementCount, bool indirectBuffer = false, StorageBufferMemory memory = StorageBufferMemory::Host);
 
 	private:
-		void Release();
+		void CreateBuffer();
+		void Release(bool deferred = false);
 
 		uint64_t m_size = 0;
 		uint64_t m_totalSize = 0;
@@ -35,15 +52,22 @@ namespace Lamp
 		bool m_isDynamic = false;
 		bool m_isIndirect = false;
 
+		StorageBufferMemory m_memory = StorageBufferMemory::Host;
+
 		VkBuffer m_buffer = nullptr;
 		VmaAllocation m_bufferAllocation = nullptr;
+
+		VkBuffer m_stagingBuffer = nullptr;
+		VmaAllocation m_stagingAllocation = nullptr;
+
+		void* m_mappedData = nullptr;
 	};
 
 	template<typename T>
 	inline T* ShaderStorageBuffer::Map()
 	{
-		VulkanAllocator allocator{};
-		return allocator.MapMemory<T>(m_bufferAllocation);
+		LP_CORE_ASSERT(m_mappedData, "Device only storage buffers can not be mapped!");
+		return reinterpret_cast<T*>(m_mappedData);
 	}
 
-}
\ No newline at end of file
+}
@@ -3,21 +3,21 @@
 
 namespace Lamp
 {
-	ShaderStorageBufferSet::ShaderStorageBufferSet(uint64_t size, uint32_t count, bool indirectBuffer)
+	ShaderStorageBufferSet::ShaderStorageBufferSet(uint64_t size, uint32_t count, bool indirectBuffer, StorageBufferMemory memory)
 	{
 		m_storageBuffers.reserve(count);
 		for (uint32_t i = 0; i < count; i++)
 		{
-			m_storageBuffers.emplace_back(ShaderStorageBuffer::Create(size, indirectBuffer));
+			m_storageBuffers.emplace_back(ShaderStorageBuffer::Create(size, indirectBuffer, memory));
 		}
 	}
 
-	ShaderStorageBufferSet::ShaderStorageBufferSet(uint64_t elementSize, uint32_t elementCount, uint32_t bufferCount, bool indirectBuffer)
+	ShaderStorageBufferSet::ShaderStorageBufferSet(uint64_t elementSize, uint32_t elementCount, uint32_t bufferCount, bool indirectBuffer, StorageBufferMemory memory)
 	{
 		m_storageBuffers.reserve(bufferCount);
 		for (uint32_t i = 0; i < bufferCount; i++)
 		{
-			m_storageBuffers.emplace_back(ShaderStorageBuffer::Create(elementSize, elementCount, indirectBuffer));
+			m_storageBuffers.emplace_back(ShaderStorageBuffer::Create(elementSize, elementCount, indirectBuffer, memory));
 		}
 	}
 
@@ -26,13 +26,29 @@ namespace Lamp
 		m_storageBuffers.clear();
 	}
 
-	Ref<ShaderStorageBufferSet> ShaderStorageBufferSet::Create(uint64_t size, uint32_t count, bool indirectBuffer)
+	void ShaderStorageBufferSet::Resize(uint64_t newSize)
 	{
-		return CreateRef<ShaderStorageBufferSet>(size, count, indirectBuffer);
+		for (const auto& storageBuffer : m_storageBuffers)
+		{
+			storageBuffer->Resize(newSize);
+		}
+	}
+
+	void ShaderStorageBufferSet::SetElementCount(uint32_t elementCount)
+	{
+		for (const auto& storageBuffer : m_storageBuffers)
+		{
+			storageBuffer->SetElementCount(elementCount);
+		}
+	}
+
+	Ref<ShaderStorageBufferSet> ShaderStorageBufferSet::Create(uint64_t size, uint32_t count, bool indirectBuffer, StorageBufferMemory memory)
+	{
+		return CreateRef<ShaderStorageBufferSet>(size, count, indirectBuffer, memory);
 	}
 
-	Ref<ShaderStorageBufferSet> ShaderStorageBufferSet::Create(uint64_t elementSize, uint32_t elementCount, uint32_t bufferCount, bool indirectBuffer)
+	Ref<ShaderStorageBufferSet> ShaderStorageBufferSet::Create(uint64_t elementSize, uint32_t elementCount, uint32_t bufferCount, bool indirectBuffer, StorageBufferMemory memory)
 	{
-		return CreateRef<ShaderStorageBufferSet>(elementSize, elementCount, bufferCount, indirectBuffer);
+		return CreateRef<ShaderStorageBufferSet>(elementSize, elementCount, bufferCount, indirectBuffer, memory);
 	}
 }
\ No newline at end of file
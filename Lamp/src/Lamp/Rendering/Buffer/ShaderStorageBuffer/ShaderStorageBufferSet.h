@@ -12,14 +12,17 @@ namespace Lamp
 	class ShaderStorageBufferSet
 	{
 	public:
-		ShaderStorageBufferSet(uint64_t size, uint32_t count, bool indirectBuffer);
-		ShaderStorageBufferSet(uint64_t elementSize, uint32_t elementCount, uint32_t bufferCount, bool indirectBuffer);
+		ShaderStorageBufferSet(uint64_t size, uint32_t count, bool indirectBuffer, StorageBufferMemory memory);
+		ShaderStorageBufferSet(uint64_t elementSize, uint32_t elementCount, uint32_t bufferCount, bool indirectBuffer, StorageBufferMemory memory);
 		~ShaderStorageBufferSet();
 
+		void Resize(uint64_t newSize);
+		void SetElementCount(uint32_t elementCount);
+
 		inline const Ref<ShaderStorageBuffer> Get(uint32_t index) const { return m_storageBuffers[index]; }
 
-		static Ref<ShaderStorageBufferSet> Create(uint64_t size, uint32_t count, bool indirectBuffer = false);
-		static Ref<ShaderStorageBufferSet> Create(uint64_t elementSize, uint32_t elementCount, uint32_t bufferCount, bool indirectBuffer = false);
+		static Ref<ShaderStorageBufferSet> Create(uint64_t size, uint32_t count, bool indirectBuffer = false, StorageBufferMemory memory = StorageBufferMemory::Host);
+		static Ref<ShaderStorageBufferSet> Create(uint64_t elementSize, uint32_t elementCount, uint32_t bufferCount, bool indirectBuffer = false, StorageBufferMemory memory = StorageBufferMemory::Host);
 
 	private:
 		std::vector<Ref<ShaderStorageBuffer>> m_storageBuffers;
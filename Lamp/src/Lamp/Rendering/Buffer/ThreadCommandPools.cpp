@@ -0,0 +1,86 @@
+#include "lppch.h"
+#include "ThreadCommandPools.h"
+
+#include "Lamp/Core/Graphics/GraphicsContext.h"
+#include "Lamp/Log/Log.h"
+
+namespace Lamp
+{
+	ThreadCommandPools::ThreadCommandPools(uint32_t threadCount, uint32_t frameCount, QueueType queueType)
+		: m_threadCount(threadCount)
+	{
+		auto device = GraphicsContext::GetDevice();
+
+		m_pools.resize(frameCount);
+		for (auto& framePools : m_pools)
+		{
+			framePools.resize(threadCount);
+			for (auto& threadPool : framePools)
+			{
+				VkCommandPoolCreateInfo poolInfo{};
+				poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+				poolInfo.queueFamilyIndex = device->GetQueueFamilyIndex(queueType);
+				poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+				LP_VK_CHECK(vkCreateCommandPool(device->GetHandle(), &poolInfo, nullptr, &threadPool.commandPool));
+			}
+		}
+	}
+
+	ThreadCommandPools::~ThreadCommandPools()
+	{
+		auto device = GraphicsContext::GetDevice();
+
+		for (const auto& framePools : m_pools)
+		{
+			for (const auto& threadPool : framePools)
+			{
+				vkDestroyCommandPool(device->GetHandle(), threadPool.commandPool, nullptr);
+			}
+		}
+
+		m_pools.clear();
+	}
+
+	void ThreadCommandPools::Reset(uint32_t frameIndex)
+	{
+		LP_PROFILE_FUNCTION();
+
+		auto device = GraphicsContext::GetDevice();
+
+		for (auto& threadPool : m_pools[frameIndex])
+		{
+			if (threadPool.usedCount == 0)
+			{
+				continue;
+			}
+
+			LP_VK_CHECK(vkResetCommandPool(device->GetHandle(), threadPool.commandPool, 0));
+			threadPool.usedCount = 0;
+		}
+	}
+
+	VkCommandBuffer ThreadCommandPools::Allocate(uint32_t frameIndex, uint32_t threadIndex)
+	{
+		auto& threadPool = m_pools[frameIndex][threadIndex];
+
+		if (threadPool.usedCount == (uint32_t)threadPool.commandBuffers.size())
+		{
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.commandPool = threadPool.commandPool;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			allocInfo.commandBufferCount = 1;
+
+			VkCommandBuffer& commandBuffer = threadPool.commandBuffers.emplace_back();
+			LP_VK_CHECK(vkAllocateCommandBuffers(GraphicsContext::GetDevice()->GetHandle(), &allocInfo, &commandBuffer));
+		}
+
+		return threadPool.commandBuffers[threadPool.usedCount++];
+	}
+
+	Ref<ThreadCommandPools> ThreadCommandPools::Create(uint32_t threadCount, uint32_t frameCount, QueueType queueType)
+	{
+		return CreateRef<ThreadCommandPools>(threadCount, frameCount, queueType);
+	}
+}
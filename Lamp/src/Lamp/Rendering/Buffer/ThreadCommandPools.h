@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+#include "Lamp/Core/Graphics/GraphicsDevice.h"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace Lamp
+{
+	// Secondary command buffers recorded on worker threads, every thread has its own pool per frame so recording needs no locks
+	class ThreadCommandPools
+	{
+	public:
+		ThreadCommandPools(uint32_t threadCount, uint32_t frameCount, QueueType queueType = QueueType::Graphics);
+		~ThreadCommandPools();
+
+		// The submission of the frame's previous use has to have completed
+		void Reset(uint32_t frameIndex);
+
+		// Only the thread owning the index may allocate from it, the buffers are reused after the frame is reset
+		VkCommandBuffer Allocate(uint32_t frameIndex, uint32_t threadIndex);
+
+		inline const uint32_t GetThreadCount() const { return m_threadCount; }
+
+		static Ref<ThreadCommandPools> Create(uint32_t threadCount, uint32_t frameCount, QueueType queueType = QueueType::Graphics);
+
+	private:
+		struct PerThreadPool
+		{
+			VkCommandPool commandPool = nullptr;
+			std::vector<VkCommandBuffer> commandBuffers;
+			uint32_t usedCount = 0;
+		};
+
+		std::vector<std::vector<PerThreadPool>> m_pools; // frame -> thread -> pool
+		uint32_t m_threadCount = 0;
+	};
+}
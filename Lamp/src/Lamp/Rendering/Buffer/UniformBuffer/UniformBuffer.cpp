@@ -3,6 +3,7 @@
 
 #include "Lamp/Core/Graphics/GraphicsContext.h"
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
 #include "Lamp/Log/Log.h"
 
 #include "Lamp/Rendering/Shader/ShaderUtility.h"
@@ -12,19 +13,7 @@ namespace Lamp
 	UniformBuffer::UniformBuffer(const void* data, uint32_t size)
 		: m_size(size), m_totalSize(size)
 	{
-		const VkDeviceSize bufferSize = size;
-		VulkanAllocator allocator{ "UniformBuffer - Create" };
-
-		// Create buffer
-		{
-			VkBufferCreateInfo bufferInfo{};
-			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferInfo.size = bufferSize;
-			bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-			m_bufferAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, m_buffer);
-		}
+		CreateBuffer();
 
 		if (data)
 		{
@@ -47,19 +36,7 @@ namespace Lamp
 		m_size = alignedSize;
 		m_totalSize = alignedSize * objectCount;
 
-		const VkDeviceSize bufferSize = m_totalSize;
-		VulkanAllocator allocator{ "UniformBuffer - Create" };
-
-		// Create buffer
-		{
-			VkBufferCreateInfo bufferInfo{};
-			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferInfo.size = bufferSize;
-			bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-			m_bufferAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, m_buffer);
-		}
+		CreateBuffer();
 	}
 
 	UniformBuffer::~UniformBuffer()
@@ -72,18 +49,56 @@ namespace Lamp
 	{
 		LP_CORE_ASSERT(m_size >= dataSize, "Unable to set data of larger size than buffer!");
 
-		VkDeviceSize bufferSize = dataSize;
-		VulkanAllocator allocator{ "UniformBuffer - SetData" };
+		memcpy_s(m_mappedData, m_size, data, dataSize);
+	}
+
+	void UniformBuffer::SetObjectCount(uint32_t objectCount)
+	{
+		LP_PROFILE_FUNCTION();
+		LP_CORE_ASSERT(m_isDynamic, "Only dynamic uniform buffers have an object count!");
+
+		if (objectCount == GetObjectCount())
+		{
+			return;
+		}
+
+		// Frames still in flight might be reading the old buffer
+		DeletionQueue::RetireBuffer(m_buffer, m_bufferAllocation);
+
+		m_buffer = nullptr;
+		m_bufferAllocation = nullptr;
+		m_mappedData = nullptr;
+
+		m_totalSize = m_size * objectCount;
+		m_allocatedSize = 0;
+
+		CreateBuffer();
+	}
+
+	void* UniformBuffer::Allocate(uint32_t& outOffset)
+	{
+		LP_CORE_ASSERT(m_isDynamic, "Only dynamic uniform buffers can be sub allocated!");
+		LP_CORE_ASSERT(m_allocatedSize + m_size <= m_totalSize, "Dynamic uniform buffer is full!");
 
-		void* bufferData = allocator.MapMemory<void*>(m_bufferAllocation);
-		memcpy_s(bufferData, m_size, data, dataSize);
-		allocator.UnmapMemory(m_bufferAllocation);
+		outOffset = m_allocatedSize;
+		m_allocatedSize += m_size;
+
+		return m_mappedData + outOffset;
 	}
 
-	void UniformBuffer::Unmap()
+	void UniformBuffer::CreateBuffer()
 	{
-		VulkanAllocator allocator{};
-		allocator.UnmapMemory(m_bufferAllocation);
+		VulkanAllocator allocator{ "UniformBuffer - Create", MemoryCategory::SceneBuffer };
+
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = m_totalSize;
+		bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		void* mappedData = nullptr;
+		m_bufferAllocation = allocator.AllocateMappedBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU, m_buffer, mappedData);
+		m_mappedData = (uint8_t*)mappedData;
 	}
 
 	Ref<UniformBuffer> UniformBuffer::Create(const void* data, uint32_t size)
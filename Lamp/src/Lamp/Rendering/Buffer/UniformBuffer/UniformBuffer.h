@@ -16,30 +16,50 @@ namespace Lamp
 		inline const uint32_t GetTotalSize() const { return m_totalSize; }
 
 		inline const bool IsDynamic() const { return m_isDynamic; }
+		inline const uint32_t GetObjectCount() const { return m_totalSize / m_size; }
 
 		void SetData(const void* data, uint32_t size);
+
+		// Reallocates a dynamic buffer, the old one is released once the frames using it have retired. The contents are not kept
+		void SetObjectCount(uint32_t objectCount);
 		
+		// The buffer is persistently mapped, so this only returns the mapped pointer
 		template<typename T>
 		T* Map();
-		void Unmap();
+
+		// Dynamic buffers hand out their slots linearly, and are reset when their frame starts again
+		void* Allocate(uint32_t& outOffset);
+		inline void Reset() { m_allocatedSize = 0; }
+
+		template<typename T>
+		T* Allocate(uint32_t& outOffset);
 
 		static Ref<UniformBuffer> Create(const void* data, uint32_t size);
 		static Ref<UniformBuffer> Create(uint32_t sizePerObject, uint32_t objectCount);
 
 	private:
+		void CreateBuffer();
+
 		uint32_t m_size{};
 		uint32_t m_totalSize{};
+		uint32_t m_allocatedSize = 0;
 		bool m_isDynamic = false;
 
 		VkBuffer m_buffer = nullptr;
 		VmaAllocation m_bufferAllocation = nullptr;
+		uint8_t* m_mappedData = nullptr;
 	};
 	
 	template<typename T>
 	inline T* UniformBuffer::Map()
 	{
-		VulkanAllocator allocator{};
-		return allocator.MapMemory<T>(m_bufferAllocation);
+		return reinterpret_cast<T*>(m_mappedData);
+	}
+
+	template<typename T>
+	inline T* UniformBuffer::Allocate(uint32_t& outOffset)
+	{
+		return reinterpret_cast<T*>(Allocate(outOffset));
 	}
 
 }
\ No newline at end of file
@@ -35,6 +35,14 @@ namespace Lamp
 		m_uniformBuffers.clear();
 	}
 
+	void UniformBufferSet::SetObjectCount(uint32_t objectCount)
+	{
+		for (const auto& uniformBuffer : m_uniformBuffers)
+		{
+			uniformBuffer->SetObjectCount(objectCount);
+		}
+	}
+
 	Ref<UniformBufferSet> UniformBufferSet::Create(const void* data, uint32_t size, uint32_t bufferCount)
 	{
 		return CreateRef<UniformBufferSet>(data, size, bufferCount);
@@ -17,6 +17,8 @@ namespace Lamp
 		UniformBufferSet(uint32_t sizePerObject, uint32_t objectCount, uint32_t bufferCount);
 		~UniformBufferSet();
 
+		void SetObjectCount(uint32_t objectCount);
+
 		inline const Ref<UniformBuffer> Get(uint32_t index) const { return m_uniformBuffers[index]; }
 
 		static Ref<UniformBufferSet> Create(const void* data, uint32_t size, uint32_t bufferCount);
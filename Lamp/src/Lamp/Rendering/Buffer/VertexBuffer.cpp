@@ -3,6 +3,10 @@
 
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
 #include "Lamp/Core/Graphics/GraphicsContext.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
+
+#include "Lamp/Rendering/RenderPipeline/PipelineCommon.h"
 
 namespace Lamp
 {
@@ -18,53 +22,21 @@ namespace Lamp
 
 	VertexBuffer::~VertexBuffer()
 	{
-		if (m_buffer != VK_NULL_HANDLE)
-		{
-			VulkanAllocator allocator{ "VertexBuffer - Destroy" };
-			allocator.DestroyBuffer(m_buffer, m_bufferAllocation);
-		}
+		// Frames still in flight might be reading the buffer
+		DeletionQueue::RetireBuffer(m_buffer, m_bufferAllocation);
 	}
 
 	void VertexBuffer::SetData(const void* data, uint32_t size)
 	{
-		auto device = GraphicsContext::GetDevice();
-
-		VkBuffer stagingBuffer;
-		VmaAllocation stagingAllocation;
-		VkDeviceSize bufferSize = size;
-		VulkanAllocator allocator{ "VertexBuffer - Create" };
+		VulkanAllocator allocator{ "VertexBuffer - Create", MemoryCategory::Mesh };
 
-		if (m_buffer != VK_NULL_HANDLE)
-		{
-			allocator.DestroyBuffer(m_buffer, m_bufferAllocation);
-		}
-
-		if (data != nullptr)
-		{
-			// Create staging buffer
-			{
-				VkBufferCreateInfo bufferInfo{};
-				bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-				bufferInfo.size = bufferSize;
-				bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-				bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-				stagingAllocation = allocator.AllocateBuffer(bufferInfo, VMA_MEMORY_USAGE_CPU_ONLY, stagingBuffer);
-			}
-
-			// Copy to staging buffer
-			{
-				void* buffData = allocator.MapMemory<void>(stagingAllocation);
-				memcpy_s(buffData, size, data, size);
-				allocator.UnmapMemory(stagingAllocation);
-			}
-		}
+		DeletionQueue::RetireBuffer(m_buffer, m_bufferAllocation);
 
 		// Create GPU buffer
 		{
 			VkBufferCreateInfo bufferInfo{};
 			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			bufferInfo.size = bufferSize;
+			bufferInfo.size = size;
 			bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
@@ -73,20 +45,7 @@ namespace Lamp
 
 		if (data != nullptr)
 		{
-			// Copy from staging buffer to GPU buffer
-			{
-				VkCommandBuffer cmdBuffer = device->GetThreadSafeCommandBuffer(true);
-
-				VkBufferCopy copy{};
-				copy.srcOffset = 0;
-				copy.dstOffset = 0;
-				copy.size = bufferSize;
-
-				vkCmdCopyBuffer(cmdBuffer, stagingBuffer, m_buffer, 1, &copy);
-				device->FlushThreadSafeCommandBuffer(cmdBuffer);
-			}
-			
-			allocator.DestroyBuffer(stagingBuffer, stagingAllocation);
+			m_uploadTicket = UploadManager::UploadBuffer(m_buffer, data, size);
 		}
 	}
 
@@ -98,6 +57,19 @@ namespace Lamp
 		vkCmdBindVertexBuffers(commandBuffer, binding, 1, &m_buffer, &offset);
 	}
 
+	void VertexBuffer::Bind(VkCommandBuffer commandBuffer, PipelineBindState& bindState) const
+	{
+		if (bindState.vertexBuffer == m_buffer)
+		{
+			bindState.statistics.skippedCalls++;
+			return;
+		}
+
+		Bind(commandBuffer);
+		bindState.vertexBuffer = m_buffer;
+		bindState.statistics.vertexBufferBinds++;
+	}
+
 	Ref<VertexBuffer> VertexBuffer::Create(const std::vector<Vertex>& vertices, uint32_t size)
 	{
 		return CreateRef<VertexBuffer>(vertices, size);
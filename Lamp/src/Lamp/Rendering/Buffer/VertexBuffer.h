@@ -1,12 +1,14 @@
 #pragma once
 
 #include "Lamp/Core/Graphics/VulkanAllocator.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
 #include "Lamp/Rendering/Vertex.h"
 
 #include <vector>
 
 namespace Lamp
 {
+	struct PipelineBindState;
 	class VertexBuffer
 	{
 	public:
@@ -16,6 +18,9 @@ namespace Lamp
 
 		void SetData(const void* data, uint32_t size);
 		void Bind(VkCommandBuffer commandBuffer, uint32_t binding = 0) const;
+		void Bind(VkCommandBuffer commandBuffer, PipelineBindState& bindState) const; // binding 0, skipped if already bound
+
+		inline const UploadTicket GetUploadTicket() const { return m_uploadTicket; }
 
 		static Ref<VertexBuffer> Create(const std::vector<Vertex>& vertices, uint32_t size);
 		static Ref<VertexBuffer> Create(uint32_t size);
@@ -23,5 +28,7 @@ namespace Lamp
 	private:
 		VkBuffer m_buffer = nullptr;
 		VmaAllocation m_bufferAllocation = nullptr;
+
+		UploadTicket m_uploadTicket = 0;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,768 @@
+#include "lppch.h"
+#include "FrameGraph.h"
+
+#include "Lamp/Core/Graphics/VulkanAllocator.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
+#include "Lamp/Log/Log.h"
+
+#include "Lamp/Rendering/Texture/Image2D.h"
+
+#include "Lamp/Utility/ImageUtility.h"
+
+#include <sstream>
+
+namespace Lamp
+{
+	namespace Utility
+	{
+		struct FrameGraphAccessInfo
+		{
+			VkPipelineStageFlags2 stage = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 access = VK_ACCESS_2_NONE;
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			bool read = false;
+			bool write = false;
+		};
+
+		static FrameGraphAccessInfo GetFrameGraphAccessInfo(FrameGraphAccess access, FrameGraphPassType passType)
+		{
+			VkPipelineStageFlags2 shaderStage = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			if (passType == FrameGraphPassType::Compute)
+			{
+				shaderStage = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			}
+			else if (passType == FrameGraphPassType::Transfer)
+			{
+				shaderStage = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+			}
+
+			constexpr VkPipelineStageFlags2 depthStages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+
+			switch (access)
+			{
+				case FrameGraphAccess::ColorAttachmentWrite: return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, false, true };
+				case FrameGraphAccess::ColorAttachmentReadWrite: return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true, true };
+				case FrameGraphAccess::DepthAttachmentWrite: return { depthStages, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, false, true };
+				case FrameGraphAccess::DepthAttachmentReadWrite: return { depthStages, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, true, true };
+				case FrameGraphAccess::DepthRead: return { depthStages | shaderStage, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL, true, false };
+				case FrameGraphAccess::SampledRead: return { shaderStage, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, true, false };
+				case FrameGraphAccess::StorageRead: return { shaderStage, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, true, false };
+
+				// Storage targets may be cleared with a transfer before they are written
+				case FrameGraphAccess::StorageWrite: return { shaderStage | VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, false, true };
+				case FrameGraphAccess::TransferRead: return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, true, false };
+				case FrameGraphAccess::TransferWrite: return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, false, true };
+				case FrameGraphAccess::IndirectRead: return { VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, true, false };
+			}
+
+			LP_CORE_ASSERT(false, "Frame graph access not supported!");
+			return {};
+		}
+
+		static std::pair<VkPipelineStageFlags2, VkAccessFlags2> GetFinalStageAndAccess(VkImageLayout finalLayout)
+		{
+			switch (finalLayout)
+			{
+				case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT };
+				case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT };
+				case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE };
+			}
+
+			return { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT };
+		}
+
+		static const char* ImageLayoutToString(VkImageLayout layout)
+		{
+			switch (layout)
+			{
+				case VK_IMAGE_LAYOUT_UNDEFINED: return "Undefined";
+				case VK_IMAGE_LAYOUT_GENERAL: return "General";
+				case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: return "ColorAttachment";
+				case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL: return "DepthStencilAttachment";
+				case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL: return "DepthStencilReadOnly";
+				case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return "ShaderReadOnly";
+				case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return "TransferSrc";
+				case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL: return "TransferDst";
+				case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL: return "DepthAttachment";
+				case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL: return "DepthReadOnly";
+				case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: return "PresentSrc";
+			}
+
+			return "Unknown";
+		}
+
+		static const char* FrameGraphPassTypeToString(FrameGraphPassType type)
+		{
+			switch (type)
+			{
+				case FrameGraphPassType::Graphics: return "Graphics";
+				case FrameGraphPassType::Compute: return "Compute";
+				case FrameGraphPassType::Transfer: return "Transfer";
+			}
+
+			return "Unknown";
+		}
+
+		// Combined depth stencil images have to be transitioned with both aspects
+		static VkImageLayout GetDepthStencilLayout(VkImageLayout layout)
+		{
+			switch (layout)
+			{
+				case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL: return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+				case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL: return VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+			}
+
+			return layout;
+		}
+	}
+
+	FrameGraph::~FrameGraph()
+	{
+		ReleaseTransientMemory();
+	}
+
+	FrameGraphResource FrameGraph::ImportImage(const std::string& name, Ref<Image2D> image, bool transient)
+	{
+		LP_CORE_ASSERT(image, "Unable to import null image!");
+
+		Resource resource{};
+		resource.name = name;
+		resource.image = image;
+		resource.specification = image->GetSpecification();
+		resource.transient = transient;
+
+		return AddResource(std::move(resource));
+	}
+
+	FrameGraphResource FrameGraph::ImportBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize size)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.isImage = false;
+		resource.buffer = buffer;
+		resource.size = size;
+
+		return AddResource(std::move(resource));
+	}
+
+	FrameGraphResource FrameGraph::DeclareImage(const std::string& name, const ImageSpecification& specification, bool transient)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.specification = specification;
+		resource.transient = transient;
+
+		return AddResource(std::move(resource));
+	}
+
+	FrameGraphResource FrameGraph::DeclareBuffer(const std::string& name, VkDeviceSize size)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.isImage = false;
+		resource.size = size;
+
+		return AddResource(std::move(resource));
+	}
+
+	void FrameGraph::MarkOutput(FrameGraphResource resource, VkImageLayout finalLayout)
+	{
+		LP_CORE_ASSERT(resource < (FrameGraphResource)m_resources.size(), "Resource out of range!");
+
+		auto& output = m_resources[resource];
+		output.output = true;
+		output.transient = false;
+		output.finalLayout = output.isImage ? finalLayout : VK_IMAGE_LAYOUT_UNDEFINED;
+	}
+
+	FrameGraphPass FrameGraph::AddPass(const std::string& name, FrameGraphPassType type, std::function<void(VkCommandBuffer)>&& execute, bool neverCull)
+	{
+		auto& pass = m_passes.emplace_back();
+		pass.name = name;
+		pass.type = type;
+		pass.execute = std::move(execute);
+		pass.neverCull = neverCull;
+
+		return (FrameGraphPass)(m_passes.size() - 1);
+	}
+
+	void FrameGraph::Read(FrameGraphPass pass, FrameGraphResource resource, FrameGraphAccess access)
+	{
+		LP_CORE_ASSERT(pass < (FrameGraphPass)m_passes.size(), "Pass out of range!");
+		LP_CORE_ASSERT(resource < (FrameGraphResource)m_resources.size(), "Resource out of range!");
+		LP_CORE_ASSERT(Utility::GetFrameGraphAccessInfo(access, m_passes[pass].type).read, "Access does not read the resource!");
+
+		m_passes[pass].uses.push_back({ resource, access });
+	}
+
+	void FrameGraph::Write(FrameGraphPass pass, FrameGraphResource resource, FrameGraphAccess access)
+	{
+		LP_CORE_ASSERT(pass < (FrameGraphPass)m_passes.size(), "Pass out of range!");
+		LP_CORE_ASSERT(resource < (FrameGraphResource)m_resources.size(), "Resource out of range!");
+		LP_CORE_ASSERT(Utility::GetFrameGraphAccessInfo(access, m_passes[pass].type).write, "Access does not write the resource!");
+
+		m_passes[pass].uses.push_back({ resource, access });
+	}
+
+	void FrameGraph::Compile()
+	{
+		LP_PROFILE_FUNCTION();
+
+		// Group assignments change, the images are returned to dedicated memory until realized again
+		ReleaseTransientMemory();
+
+		m_schedule.clear();
+		m_finalBarriers.clear();
+		m_culledPasses.clear();
+		m_statistics = {};
+
+		for (auto& resource : m_resources)
+		{
+			resource.aliasGroup = -1;
+
+			if (!resource.isImage)
+			{
+				continue;
+			}
+
+			if (resource.image && resource.image->GetHandle())
+			{
+				resource.memoryRequirements = resource.image->GetMemoryRequirements();
+			}
+			else
+			{
+				// Without a device the size is estimated, any memory type will do
+				resource.memoryRequirements.size = (VkDeviceSize)resource.specification.width * resource.specification.height * resource.specification.layers * Utility::PerPixelSizeFromFormat(resource.specification.format);
+				resource.memoryRequirements.alignment = 1;
+				resource.memoryRequirements.memoryTypeBits = ~0u;
+			}
+		}
+
+		// Dependencies are inferred in declaration order, so the surviving passes in declaration order already are a valid execution order
+		const std::vector<bool> alivePasses = CullPasses();
+
+		std::vector<FrameGraphPass> order;
+		for (FrameGraphPass pass = 0; pass < (FrameGraphPass)m_passes.size(); pass++)
+		{
+			if (alivePasses[pass])
+			{
+				order.emplace_back(pass);
+			}
+			else
+			{
+				m_culledPasses.emplace_back(pass);
+			}
+		}
+
+		std::vector<uint32_t> firstUse(m_resources.size(), UINT32_MAX);
+		std::vector<uint32_t> lastUse(m_resources.size(), 0);
+
+		for (uint32_t index = 0; index < (uint32_t)order.size(); index++)
+		{
+			for (const auto& use : m_passes[order[index]].uses)
+			{
+				firstUse[use.resource] = std::min(firstUse[use.resource], index);
+				lastUse[use.resource] = index;
+			}
+		}
+
+		AssignAliasGroups(firstUse, lastUse);
+		BuildBarriers(order);
+
+		m_statistics.passCount = (uint32_t)order.size();
+		m_statistics.culledPassCount = (uint32_t)m_culledPasses.size();
+		m_statistics.aliasGroupCount = (uint32_t)m_aliasGroups.size();
+		m_statistics.barrierCount = (uint32_t)m_finalBarriers.size();
+
+		for (const auto& compiledPass : m_schedule)
+		{
+			m_statistics.barrierCount += (uint32_t)compiledPass.barriers.size();
+		}
+
+		for (const auto& group : m_aliasGroups)
+		{
+			m_statistics.aliasedBytes += group.memoryRequirements.size;
+			m_statistics.transientImageCount += (uint32_t)group.resources.size();
+
+			for (const auto& resource : group.resources)
+			{
+				m_statistics.transientBytes += m_resources[resource].memoryRequirements.size;
+			}
+		}
+	}
+
+	void FrameGraph::Execute(VkCommandBuffer commandBuffer)
+	{
+		LP_PROFILE_FUNCTION();
+
+		for (const auto& compiledPass : m_schedule)
+		{
+			RecordBarriers(commandBuffer, compiledPass.barriers);
+
+			const auto& pass = m_passes[compiledPass.pass];
+			if (pass.execute)
+			{
+				pass.execute(commandBuffer);
+			}
+		}
+
+		RecordBarriers(commandBuffer, m_finalBarriers);
+	}
+
+	bool FrameGraph::Realize()
+	{
+		LP_PROFILE_FUNCTION();
+
+		ReleaseTransientMemory();
+		bool aliased = false;
+
+		VulkanAllocator allocator{ "FrameGraph - Transient", MemoryCategory::RenderTarget };
+
+		for (auto& group : m_aliasGroups)
+		{
+			// A single image gains nothing from aliasing, it keeps its dedicated allocation
+			if (group.resources.size() < 2)
+			{
+				continue;
+			}
+
+			const bool hasBacking = std::all_of(group.resources.begin(), group.resources.end(), [&](FrameGraphResource resource) { return m_resources[resource].image != nullptr; });
+			if (!hasBacking)
+			{
+				continue;
+			}
+
+			group.allocation = allocator.AllocateMemory(group.memoryRequirements, VMA_MEMORY_USAGE_GPU_ONLY);
+
+			for (const auto& resource : group.resources)
+			{
+				m_resources[resource].image->SetAliasedMemory(group.allocation);
+			}
+
+			aliased = true;
+		}
+
+		return aliased;
+	}
+
+	void FrameGraph::ReleaseTransientMemory()
+	{
+		for (auto& group : m_aliasGroups)
+		{
+			if (!group.allocation)
+			{
+				continue;
+			}
+
+			for (const auto& resource : group.resources)
+			{
+				m_resources[resource].image->SetAliasedMemory(nullptr);
+			}
+
+			// Images still placed in the memory are retired before it
+			DeletionQueue::RetireAllocation(group.allocation);
+			group.allocation = nullptr;
+		}
+	}
+
+	std::string FrameGraph::DumpSchedule() const
+	{
+		std::stringstream stream;
+		stream << "FrameGraph: " << m_statistics.passCount << " passes, " << m_statistics.culledPassCount << " culled, " << m_statistics.barrierCount << " barriers\n";
+
+		auto dumpBarrier = [&](const Barrier& barrier)
+		{
+			stream << "    " << m_resources[barrier.resource].name << ": ";
+
+			if (m_resources[barrier.resource].isImage)
+			{
+				stream << Utility::ImageLayoutToString(barrier.oldLayout) << " -> " << Utility::ImageLayoutToString(barrier.newLayout) << ", ";
+			}
+
+			stream << std::hex << "stages 0x" << barrier.srcStage << " -> 0x" << barrier.dstStage << ", access 0x" << barrier.srcAccess << " -> 0x" << barrier.dstAccess << std::dec;
+
+			if (barrier.discard)
+			{
+				stream << " (discard)";
+			}
+
+			if (barrier.conditional)
+			{
+				stream << " (if not in layout)";
+			}
+
+			stream << "\n";
+		};
+
+		for (uint32_t index = 0; const auto& compiledPass : m_schedule)
+		{
+			const auto& pass = m_passes[compiledPass.pass];
+			stream << "[" << index++ << "] " << pass.name << " (" << Utility::FrameGraphPassTypeToString(pass.type) << ")\n";
+
+			for (const auto& barrier : compiledPass.barriers)
+			{
+				dumpBarrier(barrier);
+			}
+		}
+
+		if (!m_finalBarriers.empty())
+		{
+			stream << "Final\n";
+			for (const auto& barrier : m_finalBarriers)
+			{
+				dumpBarrier(barrier);
+			}
+		}
+
+		for (const auto& pass : m_culledPasses)
+		{
+			stream << "Culled: " << m_passes[pass].name << "\n";
+		}
+
+		for (uint32_t index = 0; const auto& group : m_aliasGroups)
+		{
+			stream << "Alias group " << index++ << " (" << group.memoryRequirements.size << " bytes):";
+			for (const auto& resource : group.resources)
+			{
+				stream << " " << m_resources[resource].name;
+			}
+
+			stream << "\n";
+		}
+
+		return stream.str();
+	}
+
+	Ref<FrameGraph> FrameGraph::Create()
+	{
+		return CreateRef<FrameGraph>();
+	}
+
+	FrameGraphResource FrameGraph::AddResource(Resource&& resource)
+	{
+		m_resources.emplace_back(std::move(resource));
+		return (FrameGraphResource)(m_resources.size() - 1);
+	}
+
+	std::vector<bool> FrameGraph::CullPasses() const
+	{
+		std::vector<bool> alivePasses(m_passes.size(), false);
+		std::vector<FrameGraphPass> passStack;
+
+		for (FrameGraphPass pass = 0; pass < (FrameGraphPass)m_passes.size(); pass++)
+		{
+			bool writesOutput = false;
+			for (const auto& use : m_passes[pass].uses)
+			{
+				if (m_resources[use.resource].output && Utility::GetFrameGraphAccessInfo(use.access, m_passes[pass].type).write)
+				{
+					writesOutput = true;
+					break;
+				}
+			}
+
+			if (writesOutput || m_passes[pass].neverCull)
+			{
+				alivePasses[pass] = true;
+				passStack.emplace_back(pass);
+			}
+		}
+
+		// Keep the producers of everything read by a pass which is kept
+		while (!passStack.empty())
+		{
+			const FrameGraphPass pass = passStack.back();
+			passStack.pop_back();
+
+			for (const auto& use : m_passes[pass].uses)
+			{
+				if (!Utility::GetFrameGraphAccessInfo(use.access, m_passes[pass].type).read)
+				{
+					continue;
+				}
+
+				for (int32_t producer = (int32_t)pass - 1; producer >= 0; producer--)
+				{
+					const auto& producerUses = m_passes[producer].uses;
+					const bool writes = std::any_of(producerUses.begin(), producerUses.end(), [&](const ResourceUse& producerUse)
+						{
+							return producerUse.resource == use.resource && Utility::GetFrameGraphAccessInfo(producerUse.access, m_passes[producer].type).write;
+						});
+
+					if (!writes)
+					{
+						continue;
+					}
+
+					if (!alivePasses[producer])
+					{
+						alivePasses[producer] = true;
+						passStack.emplace_back((FrameGraphPass)producer);
+					}
+
+					break;
+				}
+			}
+		}
+
+		return alivePasses;
+	}
+
+	void FrameGraph::AssignAliasGroups(const std::vector<uint32_t>& firstUse, const std::vector<uint32_t>& lastUse)
+	{
+		m_aliasGroups.clear();
+
+		std::vector<FrameGraphResource> transientImages;
+		for (FrameGraphResource resource = 0; resource < (FrameGraphResource)m_resources.size(); resource++)
+		{
+			if (m_resources[resource].isImage && m_resources[resource].transient && firstUse[resource] != UINT32_MAX)
+			{
+				transientImages.emplace_back(resource);
+			}
+		}
+
+		std::sort(transientImages.begin(), transientImages.end(), [&](FrameGraphResource lhs, FrameGraphResource rhs) { return firstUse[lhs] < firstUse[rhs]; });
+
+		std::vector<uint32_t> groupLastUse;
+
+		for (const auto& resource : transientImages)
+		{
+			const auto& requirements = m_resources[resource].memoryRequirements;
+
+			// Best fit among the groups whose last image is dead before this one is first used
+			int32_t bestGroup = -1;
+			VkDeviceSize bestWaste = UINT64_MAX;
+
+			for (int32_t group = 0; group < (int32_t)m_aliasGroups.size(); group++)
+			{
+				const auto& groupRequirements = m_aliasGroups[group].memoryRequirements;
+				if (groupLastUse[group] >= firstUse[resource] || (groupRequirements.memoryTypeBits & requirements.memoryTypeBits) == 0)
+				{
+					continue;
+				}
+
+				const VkDeviceSize waste = groupRequirements.size > requirements.size ? groupRequirements.size - requirements.size : requirements.size - groupRequirements.size;
+				if (waste < bestWaste)
+				{
+					bestWaste = waste;
+					bestGroup = group;
+				}
+			}
+
+			if (bestGroup == -1)
+			{
+				auto& group = m_aliasGroups.emplace_back();
+				group.memoryRequirements = requirements;
+
+				groupLastUse.emplace_back(0);
+				bestGroup = (int32_t)m_aliasGroups.size() - 1;
+			}
+			else
+			{
+				auto& groupRequirements = m_aliasGroups[bestGroup].memoryRequirements;
+				groupRequirements.size = std::max(groupRequirements.size, requirements.size);
+				groupRequirements.alignment = std::max(groupRequirements.alignment, requirements.alignment);
+				groupRequirements.memoryTypeBits &= requirements.memoryTypeBits;
+			}
+
+			m_aliasGroups[bestGroup].resources.emplace_back(resource);
+			m_resources[resource].aliasGroup = bestGroup;
+			groupLastUse[bestGroup] = lastUse[resource];
+		}
+	}
+
+	void FrameGraph::BuildBarriers(const std::vector<FrameGraphPass>& order)
+	{
+		std::vector<ResourceState> states(m_resources.size());
+
+		// The frame is simulated twice, the first run yields the state the previous frame leaves the resources in
+		for (uint32_t run = 0; run < 2; run++)
+		{
+			const bool record = run == 1;
+			std::vector<bool> touched(m_resources.size(), false);
+
+			for (const auto& passIndex : order)
+			{
+				const auto& pass = m_passes[passIndex];
+				CompiledPass compiledPass{ passIndex };
+
+				for (const auto& use : pass.uses)
+				{
+					const auto& resource = m_resources[use.resource];
+					auto& state = states[use.resource];
+
+					const bool firstUse = !touched[use.resource];
+					const bool discard = firstUse && resource.transient;
+					touched[use.resource] = true;
+
+					// Aliased memory has to wait for the image in the group used before this one, which is the last one of the previous frame for the first image
+					if (discard && resource.aliasGroup != -1)
+					{
+						const auto& groupResources = m_aliasGroups[resource.aliasGroup].resources;
+						auto it = std::find(groupResources.begin(), groupResources.end(), use.resource);
+						const FrameGraphResource previous = it == groupResources.begin() ? groupResources.back() : *(it - 1);
+
+						if (previous != use.resource)
+						{
+							const auto& previousState = states[previous];
+							state.writeStages = previousState.writeStages;
+							state.writeAccess = previousState.writeAccess;
+							state.readStages = previousState.readStages;
+							state.visibleStages = 0;
+						}
+					}
+
+					const VkImageLayout expectedLayout = state.layout;
+
+					Barrier barrier{};
+					barrier.resource = use.resource;
+
+					const bool needsBarrier = ProcessUse(state, resource, use, pass.type, discard, barrier);
+					if (!record)
+					{
+						continue;
+					}
+
+					if (needsBarrier)
+					{
+						compiledPass.barriers.emplace_back(barrier);
+					}
+					else if (firstUse && resource.isImage)
+					{
+						// Layouts are reset when images are recreated, which the compiled schedule can not know about
+						barrier.srcStage = VK_PIPELINE_STAGE_2_NONE;
+						barrier.dstStage = Utility::GetFrameGraphAccessInfo(use.access, pass.type).stage;
+						barrier.dstAccess = Utility::GetFrameGraphAccessInfo(use.access, pass.type).access;
+						barrier.oldLayout = expectedLayout;
+						barrier.newLayout = expectedLayout;
+						barrier.conditional = true;
+
+						compiledPass.barriers.emplace_back(barrier);
+					}
+				}
+
+				if (record)
+				{
+					m_schedule.emplace_back(std::move(compiledPass));
+				}
+			}
+
+			for (FrameGraphResource resource = 0; resource < (FrameGraphResource)m_resources.size(); resource++)
+			{
+				const auto& output = m_resources[resource];
+				auto& state = states[resource];
+
+				if (!output.output || !output.isImage || !touched[resource] || output.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || state.layout == output.finalLayout)
+				{
+					continue;
+				}
+
+				const auto [finalStage, finalAccess] = Utility::GetFinalStageAndAccess(output.finalLayout);
+
+				Barrier barrier{};
+				barrier.resource = resource;
+				barrier.srcStage = state.writeStages | state.readStages;
+				barrier.srcAccess = state.writeAccess;
+				barrier.dstStage = finalStage;
+				barrier.dstAccess = finalAccess;
+				barrier.oldLayout = state.layout;
+				barrier.newLayout = output.finalLayout;
+
+				// Whatever reads the output after the graph has to be waited for by the next frame
+				state.layout = output.finalLayout;
+				state.readStages |= finalStage;
+				state.visibleStages |= finalStage;
+
+				if (record)
+				{
+					m_finalBarriers.emplace_back(barrier);
+				}
+			}
+		}
+	}
+
+	bool FrameGraph::ProcessUse(ResourceState& state, const Resource& resource, const ResourceUse& use, FrameGraphPassType type, bool discard, Barrier& outBarrier) const
+	{
+		const auto info = Utility::GetFrameGraphAccessInfo(use.access, type);
+
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if (resource.isImage)
+		{
+			layout = resource.specification.format == ImageFormat::DEPTH24STENCIL8 ? Utility::GetDepthStencilLayout(info.layout) : info.layout;
+		}
+
+		// Reads of a write which has already been made visible to the stage, in the same layout, need nothing
+		const bool transition = resource.isImage && (discard || layout != state.layout);
+		const bool hazard = info.write || (state.writeStages != 0 && (info.stage & ~state.visibleStages) != 0);
+		const bool needsBarrier = transition || hazard;
+
+		if (needsBarrier)
+		{
+			outBarrier.srcStage = state.writeStages | state.readStages;
+			outBarrier.srcAccess = state.writeAccess;
+			outBarrier.dstStage = info.stage;
+			outBarrier.dstAccess = info.access;
+			outBarrier.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+			outBarrier.newLayout = layout;
+			outBarrier.discard = discard;
+		}
+
+		if (info.write)
+		{
+			state.writeStages = info.stage;
+			state.writeAccess = info.access;
+			state.readStages = 0;
+			state.visibleStages = 0;
+		}
+		else
+		{
+			state.readStages |= info.stage;
+			if (needsBarrier)
+			{
+				state.visibleStages |= info.stage;
+			}
+		}
+
+		state.layout = layout;
+		return needsBarrier;
+	}
+
+	void FrameGraph::RecordBarriers(VkCommandBuffer commandBuffer, const std::vector<Barrier>& barriers)
+	{
+		for (const auto& barrier : barriers)
+		{
+			const auto& resource = m_resources[barrier.resource];
+
+			if (resource.isImage)
+			{
+				if (!resource.image)
+				{
+					continue;
+				}
+
+				const VkImageLayout currentLayout = resource.image->GetLayout();
+				if (barrier.conditional && currentLayout == barrier.newLayout)
+				{
+					continue;
+				}
+
+				m_barrierBatch.AddImageBarrier(resource.image->GetHandle(), barrier.srcStage, barrier.srcAccess, barrier.dstStage, barrier.dstAccess, barrier.discard ? VK_IMAGE_LAYOUT_UNDEFINED : currentLayout, barrier.newLayout, resource.image->GetSubresourceRange());
+
+				// Keeps the tracking in sync for work recorded outside of the graph
+				resource.image->SetState(barrier.newLayout, barrier.dstStage, barrier.dstAccess);
+			}
+			else
+			{
+				if (!resource.buffer)
+				{
+					continue;
+				}
+
+				m_barrierBatch.AddBufferBarrier(resource.buffer, barrier.srcStage, barrier.srcAccess, barrier.dstStage, barrier.dstAccess);
+			}
+		}
+
+		m_barrierBatch.Flush(commandBuffer);
+	}
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+#include "Lamp/Core/Graphics/BarrierBatch.h"
+#include "Lamp/Rendering/Texture/ImageCommon.h"
+
+#include <vulkan/vulkan.h>
+#include <vma/VulkanMemoryAllocator.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Lamp
+{
+	using FrameGraphResource = uint32_t;
+	using FrameGraphPass = uint32_t;
+
+	enum class FrameGraphPassType : uint32_t
+	{
+		Graphics = 0,
+		Compute,
+		Transfer
+	};
+
+	enum class FrameGraphAccess : uint32_t
+	{
+		ColorAttachmentWrite = 0,
+		ColorAttachmentReadWrite, // loaded before being written
+		DepthAttachmentWrite,
+		DepthAttachmentReadWrite,
+		DepthRead,
+		SampledRead,
+		StorageRead,
+		StorageWrite,
+		TransferRead,
+		TransferWrite,
+		IndirectRead
+	};
+
+	class Image2D;
+	class FrameGraph
+	{
+	public:
+		struct Barrier
+		{
+			FrameGraphResource resource = 0;
+
+			VkPipelineStageFlags2 srcStage = VK_PIPELINE_STAGE_2_NONE;
+			VkPipelineStageFlags2 dstStage = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 srcAccess = VK_ACCESS_2_NONE;
+			VkAccessFlags2 dstAccess = VK_ACCESS_2_NONE;
+
+			VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			bool discard = false; // contents are not needed, the transition starts from undefined
+			bool conditional = false; // only recorded when the image is not in the expected layout, e.g. after a resize
+		};
+
+		struct CompiledPass
+		{
+			FrameGraphPass pass = 0;
+			std::vector<Barrier> barriers; // recorded with a single vkCmdPipelineBarrier2 before the pass
+		};
+
+		struct AliasGroup
+		{
+			std::vector<FrameGraphResource> resources; // ordered by first use, lifetimes do not overlap
+			VkMemoryRequirements memoryRequirements{};
+			VmaAllocation allocation = nullptr;
+		};
+
+		struct Statistics
+		{
+			uint32_t passCount = 0;
+			uint32_t culledPassCount = 0;
+			uint32_t barrierCount = 0;
+
+			uint32_t transientImageCount = 0;
+			uint32_t aliasGroupCount = 0;
+
+			uint64_t transientBytes = 0; // without aliasing
+			uint64_t aliasedBytes = 0; // with aliasing
+		};
+
+		FrameGraph() = default;
+		~FrameGraph();
+
+		// Imported images keep their contents between frames unless they are transient, transient memory may be shared with other transient images
+		FrameGraphResource ImportImage(const std::string& name, Ref<Image2D> image, bool transient = false);
+		FrameGraphResource ImportBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize size);
+
+		// Resources without backing, only used for compiling and dumping the schedule without a device
+		FrameGraphResource DeclareImage(const std::string& name, const ImageSpecification& specification, bool transient = true);
+		FrameGraphResource DeclareBuffer(const std::string& name, VkDeviceSize size);
+
+		// Passes which do not contribute to an output are culled
+		void MarkOutput(FrameGraphResource resource, VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		FrameGraphPass AddPass(const std::string& name, FrameGraphPassType type, std::function<void(VkCommandBuffer)>&& execute = nullptr, bool neverCull = false);
+		void Read(FrameGraphPass pass, FrameGraphResource resource, FrameGraphAccess access);
+		void Write(FrameGraphPass pass, FrameGraphResource resource, FrameGraphAccess access);
+
+		void Compile();
+		void Execute(VkCommandBuffer commandBuffer);
+
+		// Places transient images sharing an alias group in the same memory, the images have to be invalidated afterwards
+		bool Realize();
+		void ReleaseTransientMemory();
+
+		std::string DumpSchedule() const;
+
+		inline const std::vector<CompiledPass>& GetSchedule() const { return m_schedule; }
+		inline const std::vector<AliasGroup>& GetAliasGroups() const { return m_aliasGroups; }
+		inline const Statistics& GetStatistics() const { return m_statistics; }
+
+		static Ref<FrameGraph> Create();
+
+	private:
+		struct Resource
+		{
+			std::string name;
+			bool isImage = true;
+
+			Ref<Image2D> image;
+			ImageSpecification specification;
+
+			VkBuffer buffer = nullptr;
+			VkDeviceSize size = 0;
+
+			VkMemoryRequirements memoryRequirements{};
+
+			bool transient = false;
+			bool output = false;
+			VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			int32_t aliasGroup = -1;
+		};
+
+		struct ResourceUse
+		{
+			FrameGraphResource resource;
+			FrameGraphAccess access;
+		};
+
+		struct Pass
+		{
+			std::string name;
+			FrameGraphPassType type;
+			std::function<void(VkCommandBuffer)> execute;
+
+			std::vector<ResourceUse> uses;
+			bool neverCull = false;
+		};
+
+		struct ResourceState
+		{
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			VkPipelineStageFlags2 writeStages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 writeAccess = VK_ACCESS_2_NONE;
+
+			VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_NONE; // reads since the last write, the next write has to wait for them
+			VkPipelineStageFlags2 visibleStages = VK_PIPELINE_STAGE_2_NONE; // stages the last write has been made visible to
+		};
+
+		FrameGraphResource AddResource(Resource&& resource);
+
+		std::vector<bool> CullPasses() const;
+		void AssignAliasGroups(const std::vector<uint32_t>& firstUse, const std::vector<uint32_t>& lastUse);
+		void BuildBarriers(const std::vector<FrameGraphPass>& order);
+		bool ProcessUse(ResourceState& state, const Resource& resource, const ResourceUse& use, FrameGraphPassType type, bool discard, Barrier& outBarrier) const;
+		void RecordBarriers(VkCommandBuffer commandBuffer, const std::vector<Barrier>& barriers);
+
+		std::vector<Resource> m_resources;
+		std::vector<Pass> m_passes;
+
+		std::vector<CompiledPass> m_schedule;
+		std::vector<Barrier> m_finalBarriers; // outputs are transitioned to their final layout after the last pass
+		std::vector<FrameGraphPass> m_culledPasses;
+		std::vector<AliasGroup> m_aliasGroups;
+
+		BarrierBatch m_barrierBatch; // reused between passes
+
+		Statistics m_statistics;
+	};
+}
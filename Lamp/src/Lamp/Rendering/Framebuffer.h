@@ -84,6 +84,9 @@ namespace Lamp
 		inline const std::vector<VkRenderingAttachmentInfo>& GetColorAttachmentInfos() const { return m_colorAttachmentInfos; }
 		inline const VkRenderingAttachmentInfo& GetDepthAttachmentInfo() const { return m_depthAttachmentInfo; }
 
+		inline const std::vector<VkFormat>& GetColorFormats() const { return m_colorFormats; }
+		inline const VkFormat GetDepthFormat() const { return m_depthFormat; }
+
 		inline const uint32_t GetWidth() const { return m_width; }
 		inline const uint32_t GetHeight() const { return m_height; }
 		
@@ -13,11 +13,7 @@ namespace Lamp
 	public:
 		void Push(std::function<void()> function)
 		{
-#ifdef LP_DEBUG
-			LP_CORE_INFO("Pushed to function queue function!");
-#endif
-
-			m_queue.emplace_back(function);
+			m_queue.emplace_back(std::move(function));
 		}
 
 		void Flush()
@@ -32,6 +28,8 @@ namespace Lamp
 			m_queue.clear();
 		}
 
+		inline const bool IsEmpty() const { return m_queue.empty(); }
+
 	private:
 		std::deque<std::function<void()>> m_queue;
 	};
@@ -4,6 +4,8 @@
 
 #include "Lamp/Asset/Asset.h"
 
+#include <unordered_set>
+
 namespace Lamp
 {
 	class Framebuffer;
@@ -43,7 +45,7 @@ namespace Lamp
 		size_t exclusivePipelineHash = 0;
 
 		std::vector<std::string> excludedPipelineNames;
-		std::vector<size_t> excludedPipelineHashes;
+		std::unordered_set<size_t> excludedPipelineHashes; // looked up for every batch of the pass
 
 		size_t hash = 0;
 		DrawType drawType = DrawType::Opaque;
@@ -70,7 +70,7 @@ namespace Lamp
 					Ref<RenderPipelineAsset> excludedPipeline = RenderPipelineRegistry::Get(name);
 					if (excludedPipeline && excludedPipeline->GetPipelineType() == PipelineType::Graphics)
 					{
-						pass->excludedPipelineHashes.emplace_back(excludedPipeline->GetGraphicsPipeline()->GetHash());
+						pass->excludedPipelineHashes.emplace(excludedPipeline->GetGraphicsPipeline()->GetHash());
 					}
 					else
 					{
@@ -3,6 +3,10 @@
 #include "Lamp/Core/Base.h"
 #include "Lamp/Rendering/Buffer/BufferLayout.h"
 
+#include <vulkan/vulkan.h>
+
+#include <array>
+
 namespace Lamp
 {
 	class Framebuffer;
@@ -77,4 +81,42 @@ namespace Lamp
 
 		std::vector<FramebufferInput> framebufferInputs;
 	};
+
+	// What is currently bound on a command buffer. Sets stay bound across pipelines with compatible layouts, everything stays bound across render passes
+	struct PipelineBindState
+	{
+		static constexpr uint32_t MAX_SETS = 8;
+
+		struct Statistics
+		{
+			uint32_t pipelineBinds = 0;
+			uint32_t descriptorSetBinds = 0;
+			uint32_t vertexBufferBinds = 0;
+			uint32_t indexBufferBinds = 0;
+
+			uint32_t skippedCalls = 0; // binds filtered because the state was already current
+		};
+
+		VkPipeline pipeline = nullptr;
+		VkPipelineLayout pipelineLayout = nullptr;
+		VkExtent2D viewportExtent{};
+
+		std::vector<VkPushConstantRange> pushConstantRanges;
+		std::array<VkDescriptorSetLayout, MAX_SETS> setLayouts{}; // set -> layout
+		std::array<VkDescriptorSet, MAX_SETS> descriptorSets{}; // set -> bound descriptor set
+		std::array<uint32_t, MAX_SETS> descriptorSetPasses{}; // set -> pass index the dynamic offsets were bound with
+
+		VkBuffer vertexBuffer = nullptr;
+		VkBuffer indexBuffer = nullptr;
+
+		Statistics statistics;
+
+		// Forgets what is bound, e.g. when the command buffer begins recording again. The statistics are kept
+		inline void Reset()
+		{
+			const Statistics keptStatistics = statistics;
+			*this = PipelineBindState{};
+			statistics = keptStatistics;
+		}
+	};
 }
\ No newline at end of file
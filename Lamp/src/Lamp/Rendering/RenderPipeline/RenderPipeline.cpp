@@ -2,6 +2,7 @@
 #include "RenderPipeline.h"
 
 #include "Lamp/Core/Graphics/GraphicsContext.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
 #include "Lamp/Log/Log.h"
 #include "Lamp/Asset/Mesh/Material.h"
 
@@ -10,10 +11,11 @@
 #include "Lamp/Rendering/Shader/Shader.h"
 #include "Lamp/Rendering/Shader/ShaderUtility.h"
 #include "Lamp/Rendering/RenderPass/RenderPass.h"
-#include "Lamp/Rendering/Renderer.h"
 
 #include "Lamp/Utility/ImageUtility.h"
 
+#include <array>
+
 namespace Lamp
 {
 	namespace Utility
@@ -216,19 +218,8 @@ namespace Lamp
 
 		auto device = GraphicsContext::GetDevice();
 
-		// Pipeline layout
-		{
-			const auto& resources = m_specification.shader->GetResources();
-
-			VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-			pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-			pipelineLayoutInfo.setLayoutCount = (uint32_t)resources.paddedSetLayouts.size();
-			pipelineLayoutInfo.pSetLayouts = resources.paddedSetLayouts.data();
-			pipelineLayoutInfo.pushConstantRangeCount = (uint32_t)resources.pushConstantRanges.size();
-			pipelineLayoutInfo.pPushConstantRanges = resources.pushConstantRanges.data();
-
-			LP_VK_CHECK(vkCreatePipelineLayout(device->GetHandle(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout));
-		}
+		// Pipeline layouts are shared between all pipelines with the same shader interface
+		m_pipelineLayout = m_specification.shader->GetResources().pipelineLayout;
 
 		// Pipeline
 		{
@@ -398,23 +389,75 @@ namespace Lamp
 		vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
 	}
 
-	void RenderPipeline::BindDescriptorSet(VkCommandBuffer cmdBuffer, VkDescriptorSet descriptorSet, uint32_t set, uint32_t passIndex) const
+	void RenderPipeline::Bind(VkCommandBuffer cmdBuffer, PipelineBindState& bindState)
 	{
 		LP_PROFILE_FUNCTION();
-		
-		std::vector<uint32_t> resultOffsets;
+
+		const VkExtent2D extent = { m_specification.framebuffer->GetWidth(), m_specification.framebuffer->GetHeight() };
+		const bool sameExtent = bindState.viewportExtent.width == extent.width && bindState.viewportExtent.height == extent.height;
+
+		if (bindState.pipeline == m_pipeline && sameExtent)
+		{
+			bindState.statistics.skippedCalls++;
+			return;
+		}
+
+		// The viewport and scissor are set together with the pipeline, they only change with the target size
+		Bind(cmdBuffer);
+		bindState.pipeline = m_pipeline;
+		bindState.viewportExtent = extent;
+		bindState.statistics.pipelineBinds++;
+
+		if (bindState.pipelineLayout == m_pipelineLayout)
+		{
+			return;
+		}
+
+		// Bound sets are disturbed from the first set whose layout differs, or all of them if the push constant ranges differ
 		const auto& resources = m_specification.shader->GetResources();
-		
-		if (resources.dynamicBufferOffsets.find(set) != resources.dynamicBufferOffsets.end())
+		const auto& setLayouts = resources.paddedSetLayouts;
+
+		const bool samePushConstants = std::equal(resources.pushConstantRanges.begin(), resources.pushConstantRanges.end(), bindState.pushConstantRanges.begin(), bindState.pushConstantRanges.end(),
+			[](const VkPushConstantRange& lhs, const VkPushConstantRange& rhs) { return lhs.stageFlags == rhs.stageFlags && lhs.offset == rhs.offset && lhs.size == rhs.size; });
+
+		uint32_t compatibleSets = 0;
+		if (samePushConstants)
 		{
-			const auto& offsets = resources.dynamicBufferOffsets.at(set);
-			for (const auto& offset : offsets)
+			while (compatibleSets < (uint32_t)setLayouts.size() && compatibleSets < PipelineBindState::MAX_SETS && bindState.setLayouts[compatibleSets] == setLayouts[compatibleSets])
 			{
-				resultOffsets.emplace_back(offset.offset * passIndex);
+				compatibleSets++;
 			}
 		}
 
-		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, set, 1, &descriptorSet, (uint32_t)resultOffsets.size(), resultOffsets.data());
+		for (uint32_t set = compatibleSets; set < PipelineBindState::MAX_SETS; set++)
+		{
+			bindState.setLayouts[set] = set < (uint32_t)setLayouts.size() ? setLayouts[set] : nullptr;
+			bindState.descriptorSets[set] = nullptr;
+		}
+
+		bindState.pipelineLayout = m_pipelineLayout;
+		bindState.pushConstantRanges = resources.pushConstantRanges;
+	}
+
+	void RenderPipeline::BindDescriptorSet(VkCommandBuffer cmdBuffer, VkDescriptorSet descriptorSet, uint32_t set, uint32_t passIndex) const
+	{
+		LP_PROFILE_FUNCTION();
+		
+		constexpr uint32_t MAX_DYNAMIC_OFFSETS = 32;
+
+		std::array<uint32_t, MAX_DYNAMIC_OFFSETS> resultOffsets;
+		uint32_t offsetCount = 0;
+
+		const auto& resources = m_specification.shader->GetResources();
+		const auto [begin, end] = Shader::ShaderResources::FindSet(resources.dynamicBufferOffsets, set);
+
+		for (auto it = begin; it != end; ++it)
+		{
+			LP_CORE_ASSERT(offsetCount < MAX_DYNAMIC_OFFSETS, "Too many dynamic offsets in descriptor set!");
+			resultOffsets[offsetCount++] = it->offset * passIndex;
+		}
+
+		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, set, 1, &descriptorSet, offsetCount, resultOffsets.data());
 	}
 
 	void RenderPipeline::BindDescriptorSets(VkCommandBuffer cmdBuffer, const std::vector<VkDescriptorSet>& descriptorSets, uint32_t firstSet, uint32_t passIndex) const
@@ -440,6 +483,12 @@ namespace Lamp
 		vkCmdPushConstants(cmdBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offset, size, data);
 	}
 
+	bool RenderPipeline::HasDynamicOffsets(uint32_t set) const
+	{
+		const auto [begin, end] = Shader::ShaderResources::FindSet(m_specification.shader->GetResources().dynamicBufferOffsets, set);
+		return begin != end;
+	}
+
 	void RenderPipeline::AddReference(Material* material)
 	{
 		if (auto it = std::find(m_materialReferences.begin(), m_materialReferences.end(), material); it != m_materialReferences.end())
@@ -465,14 +514,6 @@ namespace Lamp
 
 	void RenderPipeline::Release()
 	{
-		Renderer::SubmitResourceFree([pipeline = m_pipeline, pipelineLayout = m_pipelineLayout]()
-			{
-				if (pipeline != VK_NULL_HANDLE)
-				{
-					auto device = GraphicsContext::GetDevice();
-					vkDestroyPipelineLayout(device->GetHandle(), pipelineLayout, nullptr);
-					vkDestroyPipeline(device->GetHandle(), pipeline, nullptr);
-				}
-			});
+		DeletionQueue::RetirePipeline(m_pipeline);
 	}
 }
\ No newline at end of file
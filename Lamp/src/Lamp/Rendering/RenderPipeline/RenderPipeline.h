@@ -20,10 +20,12 @@ namespace Lamp
 		void InvalidateMaterials();
 
 		void Bind(VkCommandBuffer cmdBuffer);
+		void Bind(VkCommandBuffer cmdBuffer, PipelineBindState& bindState);
 		void BindDescriptorSet(VkCommandBuffer cmdBuffer, VkDescriptorSet descriptorSet, uint32_t set, uint32_t passIndex = 0) const;
 		void BindDescriptorSets(VkCommandBuffer cmdBuffer, const std::vector<VkDescriptorSet>& descriptorSets, uint32_t firstSet, uint32_t passIndex = 0) const;
 
 		void SetPushConstant(VkCommandBuffer cmdBuffer, uint32_t offset, uint32_t size, const void* data) const;
+		bool HasDynamicOffsets(uint32_t set) const;
 		void SetShader(Ref<Shader> shader);
 		void SetRenderPass(Ref<RenderPass> renderPass);
 
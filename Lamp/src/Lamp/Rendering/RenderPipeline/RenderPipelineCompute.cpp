@@ -3,6 +3,8 @@
 
 #include "Lamp/Core/Graphics/GraphicsContext.h"
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/DescriptorAllocator.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
 #include "Lamp/Log/Log.h"
 
 #include "Lamp/Rendering/Buffer/UniformBuffer/UniformBuffer.h"
@@ -31,15 +33,14 @@ namespace Lamp
 
 	RenderPipelineCompute::~RenderPipelineCompute()
 	{
-		Renderer::SubmitResourceFree([pipelineLayout = m_pipelineLayout, pipelineCache = m_pipelineCache, pipeline = m_pipeline, descriptorPool = m_descriptorPool]()
-			{
-				auto device = GraphicsContext::GetDevice();
+		const uint32_t setCount = m_frameDescriptorSets.empty() ? 0u : (uint32_t)m_frameDescriptorSets[0].size();
+		for (const auto& descriptorPool : m_descriptorPools)
+		{
+			DeletionQueue::RetireDescriptorSets(descriptorPool, setCount);
+		}
 
-				vkDestroyDescriptorPool(device->GetHandle(), descriptorPool, nullptr);
-				vkDestroyPipelineCache(device->GetHandle(), pipelineCache, nullptr);
-				vkDestroyPipeline(device->GetHandle(), pipeline, nullptr);
-				vkDestroyPipelineLayout(device->GetHandle(), pipelineLayout, nullptr);
-			});
+		DeletionQueue::RetirePipelineCache(m_pipelineCache);
+		DeletionQueue::RetirePipeline(m_pipeline);
 	}
 
 	void RenderPipelineCompute::Bind(VkCommandBuffer commandBuffer, uint32_t frameIndex)
@@ -47,91 +48,113 @@ namespace Lamp
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
 	}
 
-	void RenderPipelineCompute::InsertBarrier(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkPipelineStageFlags pipelineStage)
+	void RenderPipelineCompute::InsertBarrier(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkPipelineStageFlags2 pipelineStage)
 	{
-		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, pipelineStage, 0, 0, nullptr,
-			(uint32_t)m_bufferBarriers[frameIndex].size(), m_bufferBarriers[frameIndex].data(),
-			(uint32_t)m_imageBarriers[frameIndex].size(), m_imageBarriers[frameIndex].data());
+		for (const auto& barrier : m_bufferBarriers[frameIndex])
+		{
+			m_barrierBatch.AddBufferBarrier(barrier.buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, barrier.srcAccessMask, pipelineStage, barrier.dstAccessMask, barrier.offset, barrier.size);
+		}
 
 		for (const auto& [set, bindings] : m_imageBarrierMap)
 		{
 			for (const auto& [binding, index] : bindings)
 			{
-				m_images[set][binding]->m_imageLayout = m_imageBarriers.at(frameIndex).at(index).newLayout;
+				const auto& barrier = m_imageBarriers.at(frameIndex).at(index);
+				const Ref<Image2D> image = m_images[set][binding];
+				if (!image)
+				{
+					continue;
+				}
+
+				// An undefined target keeps the image in its current layout
+				const VkImageLayout newLayout = barrier.newLayout == VK_IMAGE_LAYOUT_UNDEFINED ? image->GetLayout(barrier.subresourceRange.baseMipLevel) : barrier.newLayout;
+				m_barrierBatch.TransitionImage(*image, newLayout, pipelineStage, barrier.dstAccessMask, barrier.subresourceRange);
 			}
 		}
+
+		m_barrierBatch.Flush(commandBuffer);
 	}
 
-	void RenderPipelineCompute::InsertExecutionBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags pipelineStage, uint32_t frameIndex)
+	void RenderPipelineCompute::InsertExecutionBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags2 pipelineStage, uint32_t frameIndex)
 	{
-		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, pipelineStage, 0, 0, nullptr,
-			0, nullptr, 0, nullptr);
+		m_barrierBatch.AddMemoryBarrier(VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_NONE, pipelineStage, VK_ACCESS_2_NONE);
+		m_barrierBatch.Flush(commandBuffer);
 	}
 
 	void RenderPipelineCompute::Dispatch(VkCommandBuffer commandBuffer, uint32_t index, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ, uint32_t passIndex)
 	{
+		if (!m_hasDescriptorSets)
+		{
+			return;
+		}
+
 		WriteAndBindDescriptors(commandBuffer, index, passIndex);
 		vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
 	}
 
 	void RenderPipelineCompute::DispatchNoUpdate(VkCommandBuffer commandBuffer, uint32_t index, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ, uint32_t passIndex)
 	{
-		const auto& resources = m_shaderResources[index];
+		if (!m_hasDescriptorSets)
+		{
+			return;
+		}
 
-		std::vector<uint32_t> resultOffsets;
-		for (uint32_t set = 0; set < (uint32_t)m_frameDescriptorSets.at(index).size(); set++)
+		// Offsets are read from the shader, they change when dynamic registry buffers are resized
+		const auto& resources = m_shader->GetResources();
+
+		m_dynamicOffsets.clear();
+		for (const auto& offset : resources.dynamicBufferOffsets)
 		{
-			if (resources.dynamicBufferOffsets.find(set) != resources.dynamicBufferOffsets.end())
-			{
-				const auto& offsets = resources.dynamicBufferOffsets.at(set);
-				for (const auto& offset : offsets)
-				{
-					resultOffsets.emplace_back(offset.offset * passIndex);
-				}
-			}
+			m_dynamicOffsets.emplace_back(offset.offset * passIndex);
 		}
 
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, (uint32_t)m_frameDescriptorSets[index].size(), m_frameDescriptorSets[index].data(), (uint32_t)resultOffsets.size(), resultOffsets.data());
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, (uint32_t)m_frameDescriptorSets[index].size(), m_frameDescriptorSets[index].data(), (uint32_t)m_dynamicOffsets.size(), m_dynamicOffsets.data());
 		vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
 	}
 
 	void RenderPipelineCompute::SetUniformBuffer(Ref<UniformBufferSet> uniformBuffer, uint32_t set, uint32_t binding)
 	{
-		if (m_shaderResources[0].uniformBuffersInfos.find(set) == m_shaderResources[0].uniformBuffersInfos.end() ||
-			m_shaderResources[0].uniformBuffersInfos.at(set).find(binding) == m_shaderResources[0].uniformBuffersInfos.at(set).end())
+		const auto* bufferInfo = Shader::ShaderResources::Find(m_shaderResources.uniformBuffersInfos, set, binding);
+		if (!bufferInfo)
 		{
 			LP_CORE_ERROR("[RenderPipelineCompute] Unable to set buffer at set {0} and binding {1}", set, binding);
 			return;
 		}
 
-		for (uint32_t i = 0; i < (uint32_t)m_shaderResources.size(); i++)
+		const size_t infoIndex = bufferInfo - m_shaderResources.uniformBuffersInfos.data();
+
+		for (uint32_t i = 0; i < m_count; i++)
 		{
-			auto& info = m_shaderResources[i].uniformBuffersInfos[set][binding];
+			auto& info = m_descriptorInfos[i].uniformBuffers[infoIndex];
 
 			Ref<UniformBuffer> ubo = uniformBuffer->Get(i);
-			info.info.buffer = ubo->GetHandle();
-			info.info.range = ubo->GetSize();
+			info.buffer = ubo->GetHandle();
+			info.range = ubo->GetSize();
 		}
+
+		m_uniformBufferSets[set][binding] = uniformBuffer;
 	}
 
-	void RenderPipelineCompute::SetStorageBuffer(Ref<ShaderStorageBufferSet> storageBuffer, uint32_t set, uint32_t binding, VkAccessFlags accessFlags)
+	void RenderPipelineCompute::SetStorageBuffer(Ref<ShaderStorageBufferSet> storageBuffer, uint32_t set, uint32_t binding, VkAccessFlags2 accessFlags)
 	{
-		if (m_shaderResources[0].storageBuffersInfos.find(set) == m_shaderResources[0].storageBuffersInfos.end() ||
-			m_shaderResources[0].storageBuffersInfos.at(set).find(binding) == m_shaderResources[0].storageBuffersInfos.at(set).end())
+		const auto* bufferInfo = Shader::ShaderResources::Find(m_shaderResources.storageBuffersInfos, set, binding);
+		if (!bufferInfo)
 		{
 			LP_CORE_ERROR("[RenderPipelineCompute] Unable to set buffer at set {0} and binding {1}", set, binding);
 			return;
 		}
 
-		for (uint32_t i = 0; i < (uint32_t)m_shaderResources.size(); i++)
+		const size_t infoIndex = bufferInfo - m_shaderResources.storageBuffersInfos.data();
+
+		for (uint32_t i = 0; i < m_count; i++)
 		{
-			auto& info = m_shaderResources[i].storageBuffersInfos[set][binding];
+			auto& info = m_descriptorInfos[i].storageBuffers[infoIndex];
 
 			Ref<ShaderStorageBuffer> ssbo = storageBuffer->Get(i);
-			info.info.buffer = ssbo->GetHandle();
-			info.info.range = ssbo->GetSize();
+			info.buffer = ssbo->GetHandle();
+			info.range = ssbo->GetSize();
 
-			if (info.writeable)
+			if (bufferInfo->writeable)
 			{
 				auto& barrier = m_bufferBarriers[i].at(m_bufferBarrierMap.at(set).at(binding));
 				barrier.buffer = ssbo->GetHandle();
@@ -143,6 +166,43 @@ namespace Lamp
 		m_storageBufferSets[set][binding] = storageBuffer;
 	}
 
+	void RenderPipelineCompute::RefreshBuffers()
+	{
+		for (const auto& [set, bindings] : m_uniformBufferSets)
+		{
+			for (const auto& [binding, uniformBuffer] : bindings)
+			{
+				SetUniformBuffer(uniformBuffer, set, binding);
+			}
+		}
+
+		// The barrier access flags are kept
+		for (const auto& [set, bindings] : m_storageBufferSets)
+		{
+			for (const auto& [binding, storageBuffer] : bindings)
+			{
+				const auto* bufferInfo = Shader::ShaderResources::Find(m_shaderResources.storageBuffersInfos, set, binding);
+				const size_t infoIndex = bufferInfo - m_shaderResources.storageBuffersInfos.data();
+
+				for (uint32_t i = 0; i < m_count; i++)
+				{
+					auto& info = m_descriptorInfos[i].storageBuffers[infoIndex];
+
+					Ref<ShaderStorageBuffer> ssbo = storageBuffer->Get(i);
+					info.buffer = ssbo->GetHandle();
+					info.range = ssbo->GetSize();
+
+					if (bufferInfo->writeable)
+					{
+						auto& barrier = m_bufferBarriers[i].at(m_bufferBarrierMap.at(set).at(binding));
+						barrier.buffer = ssbo->GetHandle();
+						barrier.size = ssbo->GetSize();
+					}
+				}
+			}
+		}
+	}
+
 	void RenderPipelineCompute::SetPushConstant(VkCommandBuffer cmdBuffer, uint32_t size, const void* data, uint32_t offset) const
 	{
 		vkCmdPushConstants(cmdBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, offset, size, data);
@@ -153,7 +213,7 @@ namespace Lamp
 		UpdateImage(texture->GetImage(), dstSet, dstBinding, srcMip, ImageUsage::Texture);
 	}
 
-	void RenderPipelineCompute::SetImage(Ref<Image2D> image, uint32_t dstSet, uint32_t dstBinding, uint32_t srcMip, VkAccessFlags dstAccessFlags, VkImageLayout targetLayout)
+	void RenderPipelineCompute::SetImage(Ref<Image2D> image, uint32_t dstSet, uint32_t dstBinding, uint32_t srcMip, VkAccessFlags2 dstAccessFlags, VkImageLayout targetLayout)
 	{
 		UpdateImage(image, dstSet, dstBinding, srcMip, ImageUsage::Storage, dstAccessFlags, targetLayout);
 	}
@@ -163,48 +223,55 @@ namespace Lamp
 		UpdateImage(image, dstSet, dstBinding, srcMip, ImageUsage::Texture);
 	}
 
-	void RenderPipelineCompute::UpdateImage(Ref<Image2D> image, uint32_t dstSet, uint32_t dstBinding, uint32_t srcMip, ImageUsage usage, VkAccessFlags dstAccessFlags, VkImageLayout targetLayout)
+	void RenderPipelineCompute::UpdateImage(Ref<Image2D> image, uint32_t dstSet, uint32_t dstBinding, uint32_t srcMip, ImageUsage usage, VkAccessFlags2 dstAccessFlags, VkImageLayout targetLayout)
 	{
 		if (usage == ImageUsage::Texture)
 		{
-			if (m_shaderResources[0].imageInfos.find(dstSet) == m_shaderResources[0].imageInfos.end() ||
-				m_shaderResources[0].imageInfos.at(dstSet).find(dstBinding) == m_shaderResources[0].imageInfos.at(dstSet).end())
+			const auto* imageInfo = Shader::ShaderResources::Find(m_shaderResources.imageInfos, dstSet, dstBinding);
+			if (!imageInfo)
 			{
 				LP_CORE_ERROR("[RenderPipelineCompute] Unable to set texture at set {0} and binding {1}", dstSet, dstBinding);
 				return;
 			}
 
-			for (auto& shaderResource : m_shaderResources)
+			const size_t infoIndex = imageInfo - m_shaderResources.imageInfos.data();
+
+			for (auto& descriptorInfos : m_descriptorInfos)
 			{
-				auto& info = shaderResource.imageInfos[dstSet][dstBinding].info;
+				auto& info = descriptorInfos.images[infoIndex];
 				info.imageView = image->GetView(srcMip);
 				info.sampler = image->GetSampler();
 			}
 		}
 		else if (usage == ImageUsage::Storage)
 		{
-			if (m_shaderResources[0].storageImagesInfos.find(dstSet) == m_shaderResources[0].storageImagesInfos.end() ||
-				m_shaderResources[0].storageImagesInfos.at(dstSet).find(dstBinding) == m_shaderResources[0].storageImagesInfos.at(dstSet).end())
+			const auto* imageInfo = Shader::ShaderResources::Find(m_shaderResources.storageImagesInfos, dstSet, dstBinding);
+			if (!imageInfo)
 			{
 				LP_CORE_ERROR("[RenderPipelineCompute] Unable to set image at set {0} and binding {1}", dstSet, dstBinding);
 				return;
 			}
 
-			for (uint32_t i = 0; i < (uint32_t)m_shaderResources.size(); i++)
+			const size_t infoIndex = imageInfo - m_shaderResources.storageImagesInfos.data();
+
+			for (uint32_t i = 0; i < m_count; i++)
 			{
-				auto& info = m_shaderResources[i].storageImagesInfos[dstSet][dstBinding];
-				info.info.imageView = image->GetView(srcMip);
-				info.info.sampler = image->GetSampler();
+				auto& info = m_descriptorInfos[i].storageImages[infoIndex];
+				info.imageView = image->GetView(srcMip);
+				info.sampler = image->GetSampler();
 
-				if (info.writeable)
+				if (imageInfo->writeable)
 				{
 					auto& barrier = m_imageBarriers[i].at(m_imageBarrierMap.at(dstSet).at(dstBinding));
 
 					barrier.image = image->GetHandle();
-					barrier.oldLayout = image->GetLayout();
-					barrier.newLayout = targetLayout == VK_IMAGE_LAYOUT_UNDEFINED ? image->GetLayout() : targetLayout;
+					barrier.newLayout = targetLayout;
 					barrier.dstAccessMask = dstAccessFlags;
 					barrier.subresourceRange.aspectMask = Utility::IsDepthFormat(image->GetFormat()) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+
+					// Mip views only cover their own mip
+					barrier.subresourceRange.baseMipLevel = srcMip;
+					barrier.subresourceRange.levelCount = srcMip == 0 ? VK_REMAINING_MIP_LEVELS : 1;
 				}
 			}
 
@@ -221,19 +288,34 @@ namespace Lamp
 	{
 		auto device = GraphicsContext::GetDevice();
 
-		for (uint32_t i = 0; i < m_count; i++)
+		// The tables are shared by all indices, only the descriptor payloads differ
+		m_shaderResources = m_shader->GetResources();
+		m_descriptorInfos.resize(m_count);
+
+		for (auto& descriptorInfos : m_descriptorInfos)
 		{
-			m_shaderResources.emplace_back(m_shader->GetResources());
-		}
+			for (const auto& info : m_shaderResources.uniformBuffersInfos)
+			{
+				descriptorInfos.uniformBuffers.emplace_back(info.info);
+			}
+
+			for (const auto& info : m_shaderResources.storageBuffersInfos)
+			{
+				descriptorInfos.storageBuffers.emplace_back(info.info);
+			}
+
+			for (const auto& info : m_shaderResources.storageImagesInfos)
+			{
+				descriptorInfos.storageImages.emplace_back(info.info);
+			}
 
-		VkPipelineLayoutCreateInfo layoutInfo{};
-		layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		layoutInfo.setLayoutCount = (uint32_t)m_shaderResources[0].paddedSetLayouts.size();
-		layoutInfo.pSetLayouts = m_shaderResources[0].paddedSetLayouts.data();
-		layoutInfo.pushConstantRangeCount = (uint32_t)m_shaderResources[0].pushConstantRanges.size();
-		layoutInfo.pPushConstantRanges = m_shaderResources[0].pushConstantRanges.data();
+			for (const auto& info : m_shaderResources.imageInfos)
+			{
+				descriptorInfos.images.emplace_back(info.info);
+			}
+		}
 
-		LP_VK_CHECK(vkCreatePipelineLayout(device->GetHandle(), &layoutInfo, nullptr, &m_pipelineLayout));
+		m_pipelineLayout = m_shaderResources.pipelineLayout;
 
 		VkComputePipelineCreateInfo pipelineInfo{};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
@@ -246,20 +328,6 @@ namespace Lamp
 
 		LP_VK_CHECK(vkCreatePipelineCache(device->GetHandle(), &pipelineCacheInfo, nullptr, &m_pipelineCache));
 		LP_VK_CHECK(vkCreateComputePipelines(device->GetHandle(), m_pipelineCache, 1, &pipelineInfo, nullptr, &m_pipeline));
-
-		CreateDescriptorPool();
-	}
-
-	void RenderPipelineCompute::CreateDescriptorPool()
-	{
-		VkDescriptorPoolCreateInfo poolInfo{};
-		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.flags = 0;
-		poolInfo.maxSets = 100;
-		poolInfo.poolSizeCount = (uint32_t)m_shaderResources[0].poolSizes.size();
-		poolInfo.pPoolSizes = m_shaderResources[0].poolSizes.data();
-
-		LP_VK_CHECK(vkCreateDescriptorPool(GraphicsContext::GetDevice()->GetHandle(), &poolInfo, nullptr, &m_descriptorPool));
 	}
 
 	void RenderPipelineCompute::AllocateAndSetupDescriptorsAndBarriers()
@@ -270,43 +338,51 @@ namespace Lamp
 		m_imageBarriers.resize(m_count);
 
 		m_frameDescriptorSets.resize(m_count);
-		m_descriptorSetBindings.resize(m_count);
+		m_descriptorPools.resize(m_count);
 		m_writeDescriptors.resize(m_count);
 
+		const auto& shaderResources = m_shaderResources;
+
 		for (uint32_t i = 0; i < m_count; i++)
 		{
 			auto& sets = m_frameDescriptorSets[i];
-			auto& shaderResources = m_shaderResources[i];
-
-			VkDescriptorSetAllocateInfo allocInfo = shaderResources.setAllocInfo;
-			allocInfo.descriptorPool = m_descriptorPool;
-			sets.resize(allocInfo.descriptorSetCount);
+			auto& descriptorInfos = m_descriptorInfos[i];
 
-			vkAllocateDescriptorSets(device->GetHandle(), &allocInfo, sets.data());
+			sets.resize(shaderResources.setAllocInfo.descriptorSetCount);
+			m_descriptorPools[i] = DescriptorAllocator::Allocate(shaderResources.setAllocInfo, sets.data());
+			if (!m_descriptorPools[i] && !sets.empty())
+			{
+				LP_CORE_ERROR("[RenderPipelineCompute] Unable to allocate the descriptor sets of {0}, it will not be dispatched!", m_shader->GetName());
+				m_hasDescriptorSets = false;
+			}
 
-			uint32_t index = 0;
-			for (auto& [set, bindings] : shaderResources.writeDescriptors)
+			for (const auto& descriptor : shaderResources.writeDescriptors)
 			{
-				for (auto& [binding, write] : bindings)
-				{
-					auto& writeDescriptor = m_writeDescriptors[i].emplace_back(write);
+				const uint32_t set = Shader::ShaderResources::GetSet(descriptor.key);
+				const uint32_t binding = Shader::ShaderResources::GetBinding(descriptor.key);
+
+				auto& writeDescriptor = m_writeDescriptors[i].emplace_back(descriptor.write);
 
-					if (shaderResources.uniformBuffersInfos[set].find(binding) != shaderResources.uniformBuffersInfos[set].end())
+				switch (descriptor.type)
+				{
+					case Shader::ResourceType::UniformBuffer:
 					{
-						writeDescriptor.pBufferInfo = &shaderResources.uniformBuffersInfos[set].at(binding).info;
+						writeDescriptor.pBufferInfo = &descriptorInfos.uniformBuffers[descriptor.resourceIndex];
+						break;
 					}
-					else if (shaderResources.storageBuffersInfos[set].find(binding) != shaderResources.storageBuffersInfos[set].end())
+
+					case Shader::ResourceType::StorageBuffer:
 					{
-						writeDescriptor.pBufferInfo = &shaderResources.storageBuffersInfos[set].at(binding).info;
+						writeDescriptor.pBufferInfo = &descriptorInfos.storageBuffers[descriptor.resourceIndex];
 
-						if (shaderResources.storageBuffersInfos[set].at(binding).writeable)
+						if (shaderResources.storageBuffersInfos[descriptor.resourceIndex].writeable)
 						{
 							const uint32_t barrierIndex = (uint32_t)m_bufferBarriers[i].size();
 							auto& bufferBarrier = m_bufferBarriers[i].emplace_back();
-							bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+							bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
 							bufferBarrier.pNext = nullptr;
-							bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-							bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+							bufferBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+							bufferBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
 							bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 							bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 							bufferBarrier.buffer = nullptr;
@@ -315,19 +391,21 @@ namespace Lamp
 
 							m_bufferBarrierMap[set][binding] = barrierIndex;
 						}
+						break;
 					}
-					else if (shaderResources.storageImagesInfos[set].find(binding) != shaderResources.storageImagesInfos[set].end())
+
+					case Shader::ResourceType::StorageImage:
 					{
-						writeDescriptor.pImageInfo = &shaderResources.storageImagesInfos[set].at(binding).info;
+						writeDescriptor.pImageInfo = &descriptorInfos.storageImages[descriptor.resourceIndex];
 
-						if (shaderResources.storageImagesInfos[set].at(binding).writeable)
+						if (shaderResources.storageImagesInfos[descriptor.resourceIndex].writeable)
 						{
 							const uint32_t barrierIndex = (uint32_t)m_imageBarriers[i].size();
 							auto& imageBarrier = m_imageBarriers[i].emplace_back();
-							imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+							imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
 							imageBarrier.pNext = nullptr;
-							imageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-							imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+							imageBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+							imageBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
 							imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 							imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 							imageBarrier.image = nullptr;
@@ -340,77 +418,78 @@ namespace Lamp
 
 							m_imageBarrierMap[set][binding] = barrierIndex;
 						}
+						break;
 					}
-					else if (shaderResources.imageInfos[set].find(binding) != shaderResources.imageInfos[set].end())
+
+					case Shader::ResourceType::SampledImage:
 					{
-						auto* imageInfo = &shaderResources.imageInfos[set].at(binding).info;
-						writeDescriptor.pImageInfo = imageInfo;
+						writeDescriptor.pImageInfo = &descriptorInfos.images[descriptor.resourceIndex];
+						break;
 					}
-
-					writeDescriptor.dstSet = m_frameDescriptorSets[i][index];
-					m_descriptorSetBindings[i].emplace_back(set);
 				}
 
-				index++;
+				writeDescriptor.dstSet = sets[descriptor.setIndex];
 			}
 		}
 	}
 
 	void RenderPipelineCompute::SetupPipelineFromShader()
 	{
-		for (uint32_t i = 0; i < (uint32_t)m_shaderResources.size(); i++)
+		for (uint32_t i = 0; i < m_count; i++)
 		{
-			for (auto& [set, bindings] : m_shaderResources[i].uniformBuffersInfos)
+			auto& descriptorInfos = m_descriptorInfos[i];
+
+			for (size_t infoIndex = 0; infoIndex < m_shaderResources.uniformBuffersInfos.size(); infoIndex++)
 			{
-				for (auto& [binding, info] : bindings)
+				const uint32_t key = m_shaderResources.uniformBuffersInfos[infoIndex].key;
+
+				Ref<UniformBufferSet> ubo = UniformBufferRegistry::Get(Shader::ShaderResources::GetSet(key), Shader::ShaderResources::GetBinding(key));
+				if (ubo)
 				{
-					Ref<UniformBufferSet> ubo = UniformBufferRegistry::Get(set, binding);
-					if (ubo)
-					{
-						auto buffer = ubo->Get(i);
+					auto buffer = ubo->Get(i);
 
-						info.info.buffer = buffer->GetHandle();
-						info.info.range = buffer->GetSize();
-					}
+					descriptorInfos.uniformBuffers[infoIndex].buffer = buffer->GetHandle();
+					descriptorInfos.uniformBuffers[infoIndex].range = buffer->GetSize();
 				}
 			}
 
-			for (auto& [set, bindings] : m_shaderResources[i].storageBuffersInfos)
+			for (size_t infoIndex = 0; infoIndex < m_shaderResources.storageBuffersInfos.size(); infoIndex++)
 			{
-				for (auto& [binding, info] : bindings)
+				const uint32_t key = m_shaderResources.storageBuffersInfos[infoIndex].key;
+
+				Ref<ShaderStorageBufferSet> ssb = ShaderStorageBufferRegistry::Get(Shader::ShaderResources::GetSet(key), Shader::ShaderResources::GetBinding(key));
+				if (ssb)
 				{
-					Ref<ShaderStorageBufferSet> ssb = ShaderStorageBufferRegistry::Get(set, binding);
-					if (ssb)
-					{
-						auto buffer = ssb->Get(i);
+					auto buffer = ssb->Get(i);
 
-						info.info.buffer = buffer->GetHandle();
-						info.info.range = buffer->GetSize();
-					}
+					descriptorInfos.storageBuffers[infoIndex].buffer = buffer->GetHandle();
+					descriptorInfos.storageBuffers[infoIndex].range = buffer->GetSize();
 				}
 			}
 
-			for (auto& [set, bindings] : m_shaderResources[i].imageInfos)
+			for (size_t infoIndex = 0; infoIndex < m_shaderResources.imageInfos.size(); infoIndex++)
 			{
-				if (set != (uint32_t)DescriptorSetType::PerMaterial)
+				const auto& image = m_shaderResources.imageInfos[infoIndex];
+				auto& info = descriptorInfos.images[infoIndex];
+
+				if (Shader::ShaderResources::GetSet(image.key) == (uint32_t)DescriptorSetType::PerMaterial)
 				{
-					for (auto& [binding, info] : bindings)
-					{
-						if (info.dimension == ImageDimension::Dim2D)
-						{
-							auto defaultTexture = Renderer::GetDefaultData().whiteTexture;
+					continue;
+				}
 
-							info.info.imageView = defaultTexture->GetImage()->GetView();
-							info.info.sampler = defaultTexture->GetImage()->GetSampler();
-						}
-						else if (info.dimension == ImageDimension::DimCube)
-						{
-							auto defaultTexture = Renderer::GetDefaultData().blackCubeImage;
+				if (image.dimension == ImageDimension::Dim2D)
+				{
+					auto defaultTexture = Renderer::GetDefaultData().whiteTexture;
 
-							info.info.imageView = defaultTexture->GetView();
-							info.info.sampler = defaultTexture->GetSampler();
-						}
-					}
+					info.imageView = defaultTexture->GetImage()->GetView();
+					info.sampler = defaultTexture->GetImage()->GetSampler();
+				}
+				else if (image.dimension == ImageDimension::DimCube)
+				{
+					auto defaultTexture = Renderer::GetDefaultData().blackCubeImage;
+
+					info.imageView = defaultTexture->GetView();
+					info.sampler = defaultTexture->GetSampler();
 				}
 			}
 		}
@@ -418,25 +497,23 @@ namespace Lamp
 
 	void RenderPipelineCompute::WriteAndBindDescriptors(VkCommandBuffer cmdBuffer, uint32_t index, uint32_t passIndex)
 	{
+		if (!m_hasDescriptorSets)
+		{
+			return;
+		}
+
 		auto device = GraphicsContext::GetDevice();
 		vkUpdateDescriptorSets(device->GetHandle(), (uint32_t)m_writeDescriptors[index].size(), m_writeDescriptors[index].data(), 0, nullptr);
 
-		const auto& resources = m_shaderResources[index];
-
-		std::vector<uint32_t> resultOffsets;
+		// Offsets are read from the shader, they change when dynamic registry buffers are resized
+		const auto& resources = m_shader->GetResources();
 
-		for (uint32_t set = 0; set < (uint32_t)m_frameDescriptorSets.at(index).size(); set++)
+		m_dynamicOffsets.clear();
+		for (const auto& offset : resources.dynamicBufferOffsets)
 		{
-			if (resources.dynamicBufferOffsets.find(set) != resources.dynamicBufferOffsets.end())
-			{
-				const auto& offsets = resources.dynamicBufferOffsets.at(set);
-				for (const auto& offset : offsets)
-				{
-					resultOffsets.emplace_back(offset.offset * passIndex);
-				}
-			}
+			m_dynamicOffsets.emplace_back(offset.offset * passIndex);
 		}
 
-		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, (uint32_t)m_frameDescriptorSets[index].size(), m_frameDescriptorSets[index].data(), (uint32_t)resultOffsets.size(), resultOffsets.data());
+		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, (uint32_t)m_frameDescriptorSets[index].size(), m_frameDescriptorSets[index].data(), (uint32_t)m_dynamicOffsets.size(), m_dynamicOffsets.data());
 	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "PipelineCommon.h"
 
 #include "Lamp/Core/Base.h"
+#include "Lamp/Core/Graphics/BarrierBatch.h"
 #include "Lamp/Rendering/Shader/Shader.h"
 #include "Lamp/Rendering/Texture/ImageCommon.h"
 
@@ -24,22 +25,27 @@ namespace Lamp
 
 		void Bind(VkCommandBuffer commandBuffer, uint32_t frameIndex = 0);
 		
-		void InsertBarrier(VkCommandBuffer commandBuffer, uint32_t frameIndex = 0, VkPipelineStageFlags pipelineStage = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
-		void InsertExecutionBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags pipelineStage, uint32_t frameIndex = 0);
+		// Makes the writes of the dispatch visible to the stage, images are only transitioned for the mips bound to the pipeline
+		void InsertBarrier(VkCommandBuffer commandBuffer, uint32_t frameIndex = 0, VkPipelineStageFlags2 pipelineStage = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+		void InsertExecutionBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags2 pipelineStage, uint32_t frameIndex = 0);
 
 		void Dispatch(VkCommandBuffer commandBuffer, uint32_t index, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ, uint32_t passIndex = 0);
 		void DispatchNoUpdate(VkCommandBuffer commandBuffer, uint32_t index, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ, uint32_t passIndex = 0);
 		void WriteAndBindDescriptors(VkCommandBuffer cmdBuffer, uint32_t index = 0, uint32_t passIndex = 0);
 
 		void SetUniformBuffer(Ref<UniformBufferSet> uniformBuffer, uint32_t set, uint32_t binding);
-		void SetStorageBuffer(Ref<ShaderStorageBufferSet> storageBuffer, uint32_t set, uint32_t binding, VkAccessFlags dstAccessFlags = VK_ACCESS_SHADER_READ_BIT);
+		void SetStorageBuffer(Ref<ShaderStorageBufferSet> storageBuffer, uint32_t set, uint32_t binding, VkAccessFlags2 dstAccessFlags = VK_ACCESS_2_SHADER_READ_BIT);
 		void SetTexture(Ref<Texture2D> texture, uint32_t dstSet, uint32_t dstBinding, uint32_t srcMip = 0);
-		void SetImage(Ref<Image2D> image, uint32_t dstSet, uint32_t dstBinding, uint32_t srcMip, VkAccessFlags dstAccessFlags, VkImageLayout targetLayout);
+		void SetImage(Ref<Image2D> image, uint32_t dstSet, uint32_t dstBinding, uint32_t srcMip, VkAccessFlags2 dstAccessFlags, VkImageLayout targetLayout);
 		void SetImage(Ref<Image2D> image, uint32_t dstSet, uint32_t dstBinding, uint32_t srcMip = 0);
 		void SetPushConstant(VkCommandBuffer cmdBuffer, uint32_t size, const void* data, uint32_t offset = 0) const;
 
+		// Re-reads the handles of the buffer sets set on the pipeline after they have been reallocated, the descriptors are written on the next dispatch of each frame
+		void RefreshBuffers();
+
 		static Ref<RenderPipelineCompute> Create(Ref<Shader> computeShader, uint32_t count = 1);
 
+		inline const Ref<Shader> GetShader() const { return m_shader; }
 		inline const std::vector<FramebufferInput>& GetFramebufferInputs() const { return m_framebufferInputs; }
 		inline const std::string& GetRenderPass() const { return m_renderPassName; }
 
@@ -47,24 +53,35 @@ namespace Lamp
 		friend class RenderPipelineAsset;
 
 		void CreatePipeline();
-		void CreateDescriptorPool();
 		void AllocateAndSetupDescriptorsAndBarriers();
 		void SetupPipelineFromShader();
 
-		void UpdateImage(Ref<Image2D> image, uint32_t dstSet, uint32_t dstBinding, uint32_t srcMip, ImageUsage usage, VkAccessFlags dstAccessFlags = VK_ACCESS_SHADER_READ_BIT, VkImageLayout targetLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+		void UpdateImage(Ref<Image2D> image, uint32_t dstSet, uint32_t dstBinding, uint32_t srcMip, ImageUsage usage, VkAccessFlags2 dstAccessFlags = VK_ACCESS_2_SHADER_READ_BIT, VkImageLayout targetLayout = VK_IMAGE_LAYOUT_UNDEFINED);
 		
+		// Descriptor payloads of one index, parallel to the resource tables of the shader
+		struct DescriptorInfos
+		{
+			std::vector<VkDescriptorBufferInfo> uniformBuffers;
+			std::vector<VkDescriptorBufferInfo> storageBuffers;
+			std::vector<VkDescriptorImageInfo> storageImages;
+			std::vector<VkDescriptorImageInfo> images;
+		};
+
 		Ref<Shader> m_shader;
 		uint32_t m_count;
-		std::vector<Shader::ShaderResources> m_shaderResources;
-		std::vector<std::vector<uint32_t>> m_descriptorSetBindings;
+		Shader::ShaderResources m_shaderResources;
+		std::vector<DescriptorInfos> m_descriptorInfos; // index -> infos
+		std::vector<uint32_t> m_dynamicOffsets; // reused by every dispatch, recording is single threaded
 		std::vector<std::vector<VkDescriptorSet>> m_frameDescriptorSets;
 		std::vector<std::vector<VkWriteDescriptorSet>> m_writeDescriptors;
 
+		std::unordered_map<uint32_t, std::unordered_map<uint32_t, Ref<UniformBufferSet>>> m_uniformBufferSets; // set -> binding -> uniform buffer
 		std::unordered_map<uint32_t, std::unordered_map<uint32_t, Ref<ShaderStorageBufferSet>>> m_storageBufferSets; // set -> binding -> storage buffer
 		std::unordered_map<uint32_t, std::unordered_map<uint32_t, Ref<Image2D>>> m_images; // set -> binding -> image
 
-		std::vector<std::vector<VkBufferMemoryBarrier>> m_bufferBarriers;
-		std::vector<std::vector<VkImageMemoryBarrier>> m_imageBarriers;
+		std::vector<std::vector<VkBufferMemoryBarrier2>> m_bufferBarriers;
+		std::vector<std::vector<VkImageMemoryBarrier2>> m_imageBarriers;
+		BarrierBatch m_barrierBatch;
 
 		std::unordered_map<uint32_t, std::unordered_map<uint32_t, uint32_t>> m_imageBarrierMap; // set -> binding -> index
 		std::unordered_map<uint32_t, std::unordered_map<uint32_t, uint32_t>> m_bufferBarrierMap; // set -> binding -> index
@@ -76,6 +93,7 @@ namespace Lamp
 		VkPipelineCache m_pipelineCache = nullptr;
 		VkPipeline m_pipeline = nullptr;
 
-		VkDescriptorPool m_descriptorPool = nullptr;
+		std::vector<VkDescriptorPool> m_descriptorPools; // index -> pool the sets were allocated from
+		bool m_hasDescriptorSets = true; // false if the allocation failed, nothing is dispatched then
 	};
 }
\ No newline at end of file
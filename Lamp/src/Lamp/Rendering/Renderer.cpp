@@ -5,16 +5,24 @@
 #include "Lamp/Asset/Mesh/Material.h"
 #include "Lamp/Asset/Mesh/Mesh.h"
 #include "Lamp/Asset/AssetManager.h"
+#include "Lamp/Asset/ResidencyManager.h"
+#include "Lamp/Asset/RenderPipelineAsset.h"
 
 #include "Lamp/Core/Application.h"
 #include "Lamp/Core/Window.h"
+#include "Lamp/Core/ThreadPool.h"
 #include "Lamp/Core/Graphics/Swapchain.h"
 #include "Lamp/Core/Graphics/GraphicsContext.h"
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/DescriptorAllocator.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
+#include "Lamp/Core/Graphics/UploadManager.h"
+#include "Lamp/Core/Graphics/VulkanAllocator.h"
 
 #include "Lamp/Log/Log.h"
 
 #include "Lamp/Rendering/Buffer/CommandBuffer.h"
+#include "Lamp/Rendering/Buffer/ThreadCommandPools.h"
 #include "Lamp/Rendering/RenderPass/RenderPass.h"
 #include "Lamp/Rendering/Framebuffer.h"
 
@@ -34,14 +42,16 @@
 #include "Lamp/Rendering/Texture/Texture2D.h"
 
 #include "Lamp/Rendering/Shader/ShaderRegistry.h"
+#include "Lamp/Rendering/Shader/ShaderUtility.h"
 
 #include "Lamp/Rendering/RenderPipeline/RenderPipelineCompute.h"
 #include "Lamp/Rendering/RenderPipeline/RenderPipeline.h"
+#include "Lamp/Rendering/RenderPipeline/RenderPipelineRegistry.h"
 
 #include "Lamp/Rendering/RenderPass/RenderPassRegistry.h"
 #include "Lamp/Rendering/RenderPass/RenderPass.h"
 
-#include "Lamp/Rendering/DependencyGraph.h"
+#include "Lamp/Rendering/FrameGraph.h"
 
 #include "Lamp/Utility/Math.h"
 #include "Lamp/Utility/ImageUtility.h"
@@ -57,45 +67,112 @@
 
 namespace Lamp
 {
+	// Passes with fewer batches are recorded directly into the frame's command buffer
+	static constexpr uint32_t PARALLEL_RECORD_MIN_BATCHES = 256;
+	static constexpr uint32_t MIN_BATCHES_PER_CHUNK = 64;
+	static constexpr uint32_t CHUNKS_PER_THREAD = 2; // evens out chunks with expensive batches
+	static constexpr uint32_t MAX_RECORD_THREADS = 8;
+
+	namespace Utility
+	{
+		// Only the parameters defining the visible set, the draw count and output offset are the same for every view
+		static size_t HashCullView(const CullData& cullData)
+		{
+			size_t hash = 0;
+			auto hashFloat = [&hash](float value)
+			{
+				hash = HashCombine(hash, std::hash<float>()(value));
+			};
+
+			for (uint32_t column = 0; column < 4; column++)
+			{
+				for (uint32_t row = 0; row < 4; row++)
+				{
+					hashFloat(cullData.view[column][row]);
+				}
+			}
+
+			hashFloat(cullData.P00);
+			hashFloat(cullData.P11);
+			hashFloat(cullData.zNear);
+			hashFloat(cullData.zFar);
+
+			for (const float plane : cullData.frustum)
+			{
+				hashFloat(plane);
+			}
+
+			hash = HashCombine(hash, std::hash<int>()(cullData.cullingEnabled));
+			hash = HashCombine(hash, std::hash<int>()(cullData.distCull));
+
+			return hash;
+		}
+
+		inline static uint32_t GetVisibilityWordCount(uint32_t drawCount)
+		{
+			return (drawCount + 31) / 32;
+		}
+	}
+
+	// Graphics begin and end, compute begin and end
+	static constexpr uint32_t TIMESTAMPS_PER_FRAME = 4;
+
+	// Stages reading the cull results, the graphics queue waits for the compute queue before them
+	static constexpr VkPipelineStageFlags2 CULL_CONSUMER_STAGES = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+
 	void Renderer::Initialize()
 	{
 		const uint32_t framesInFlight = Application::Get().GetWindow()->GetSwapchain().GetFramesInFlight();
 		s_rendererData->commandBuffer = CommandBuffer::Create(framesInFlight, false);
+		s_rendererData->computeCommandBuffer = CommandBuffer::Create(framesInFlight, false, QueueType::Compute);
+
+		// The main thread waits while the workers record, so it does not count towards the cores used
+		{
+			const uint32_t threadCount = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_RECORD_THREADS);
+
+			s_rendererData->recordThreadPool = ThreadPool::Create(threadCount);
+			s_rendererData->threadCommandPools = ThreadCommandPools::Create(threadCount, framesInFlight);
+		}
+
+		// Capabilities
+		{
+			auto physicalDevice = GraphicsContext::GetPhysicalDevice();
+
+			s_rendererData->capabilities.asyncCompute = physicalDevice->GetQueueIndices().HasAsyncCompute();
+			s_rendererData->capabilities.gpuTimestamps = physicalDevice->GetCapabilities().hasQueueTimestamps;
+			s_rendererData->asyncComputeEnabled = s_rendererData->capabilities.asyncCompute;
+		}
+
+		if (s_rendererData->capabilities.gpuTimestamps)
+		{
+			VkQueryPoolCreateInfo queryPoolInfo{};
+			queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolInfo.queryCount = framesInFlight * TIMESTAMPS_PER_FRAME;
+
+			LP_VK_CHECK(vkCreateQueryPool(GraphicsContext::GetDevice()->GetHandle(), &queryPoolInfo, nullptr, &s_rendererData->timestampPool));
+			s_rendererData->timestampFrames.resize(framesInFlight);
+		}
 
 		CreateDefaultData();
-		CreateDescriptorPools();
 
 		s_rendererData->skyboxData.irradianceMap = s_defaultData->blackCubeImage;
 		s_rendererData->skyboxData.radianceMap = s_defaultData->blackCubeImage;
+
+		s_rendererData->submitPacket = CreateScope<FramePacket>();
+		s_rendererData->submitPacket->environment = s_rendererData->skyboxData;
 	}
 
 	void Renderer::InitializeBuffers()
 	{
 		const uint32_t framesInFlight = Application::Get().GetWindow()->GetSwapchain().GetFramesInFlight();
-		constexpr uint32_t MAX_OBJECT_COUNT = 20000;
-		constexpr uint32_t PASS_COUNT = 3;
-
-		s_rendererData = CreateScope<RendererData>();
-		s_frameDeletionQueues.resize(framesInFlight);
-		s_invalidationQueues.resize(framesInFlight);
-
-		UniformBufferRegistry::Register(0, 1, UniformBufferSet::Create(sizeof(DirectionalLightData), framesInFlight));
 
-		UniformBufferRegistry::Register(1, 0, UniformBufferSet::Create(sizeof(CameraData), PASS_COUNT, framesInFlight));
-		UniformBufferRegistry::Register(1, 1, UniformBufferSet::Create(sizeof(TargetData), PASS_COUNT, framesInFlight));
-		UniformBufferRegistry::Register(1, 2, UniformBufferSet::Create(sizeof(PassData), PASS_COUNT, framesInFlight));
+		CreateRendererData(framesInFlight);
 
-		ShaderStorageBufferRegistry::Register(0, 3, ShaderStorageBufferSet::Create(sizeof(ObjectData) * MAX_OBJECT_COUNT, framesInFlight));
-		ShaderStorageBufferRegistry::Register(1, 4, ShaderStorageBufferSet::Create(sizeof(uint32_t) * MAX_OBJECT_COUNT, PASS_COUNT, framesInFlight));
-
-		s_rendererData->indirectDrawBuffer = ShaderStorageBufferSet::Create(sizeof(GPUIndirectObject) * MAX_OBJECT_COUNT, framesInFlight, true);
-		s_rendererData->indirectCountBuffer = ShaderStorageBufferSet::Create(sizeof(uint32_t) * MAX_OBJECT_COUNT, framesInFlight, true);
 		s_rendererData->indirectCullPipeline = RenderPipelineCompute::Create(Shader::Create("ComputeCull", { "Engine/Shaders/GLSL/cull_cs.glsl" }), framesInFlight);
+		s_rendererData->indirectCompactPipeline = RenderPipelineCompute::Create(Shader::Create("ComputeCompact", { "Engine/Shaders/GLSL/compact_cs.glsl" }), framesInFlight);
 
-		s_rendererData->indirectCullPipeline->SetStorageBuffer(s_rendererData->indirectDrawBuffer, 0, 1, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
-		s_rendererData->indirectCullPipeline->SetStorageBuffer(s_rendererData->indirectCountBuffer, 0, 2, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
-		s_rendererData->indirectCullPipeline->SetStorageBuffer(ShaderStorageBufferRegistry::Get(0, 3), 0, 4, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
-		s_rendererData->indirectCullPipeline->SetStorageBuffer(ShaderStorageBufferRegistry::Get(1, 4), 1, 4, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+		SetCullBuffers();
 
 		s_defaultData = CreateScope<DefaultData>();
 
@@ -118,24 +195,33 @@ namespace Lamp
 			uint32_t whiteTextureData = 0xffffffff;
 			s_defaultData->whiteTexture = Texture2D::Create(ImageFormat::RGBA, 1, 1, &whiteTextureData);
 			s_defaultData->whiteTexture->handle = Asset::Null();
+
+			uint32_t placeholderTextureData = 0xff808080;
+			s_defaultData->placeholderTexture = Texture2D::Create(ImageFormat::RGBA, 1, 1, &placeholderTextureData);
+			s_defaultData->placeholderTexture->handle = Asset::Null();
 		}
 	}
 
+	void Renderer::InitializeHeadless()
+	{
+		// Sets without buffers, so the capacity updates run without allocating anything
+		CreateRendererData(0);
+		s_rendererData->submitPacket = CreateScope<FramePacket>();
+	}
+
 	void Renderer::Shutdowm()
 	{
-		for (auto& descriptorPool : s_rendererData->descriptorPools)
+		if (s_rendererData->timestampPool)
 		{
-			vkDestroyDescriptorPool(GraphicsContext::GetDevice()->GetHandle(), descriptorPool, nullptr);
+			vkDestroyQueryPool(GraphicsContext::GetDevice()->GetHandle(), s_rendererData->timestampPool, nullptr);
 		}
 
 		s_defaultData = nullptr;
 		s_rendererData = nullptr;
 
-		for (auto& s_frameDeletionQueue : s_frameDeletionQueues)
-		{
-			s_frameDeletionQueue.Flush();
-		}
+		DeletionQueue::Flush();
 
+		Material::ReleaseSharedDescriptorSets();
 		SamplerLibrary::Shutdown();
 	}
 
@@ -144,36 +230,135 @@ namespace Lamp
 		LP_PROFILE_FUNCTION();
 
 		const uint32_t currentFrame = Application::Get().GetWindow()->GetSwapchain().GetCurrentFrame();
-		LP_VK_CHECK(vkResetDescriptorPool(GraphicsContext::GetDevice()->GetHandle(), s_rendererData->descriptorPools[currentFrame], 0));
+		DescriptorAllocator::ResetFrame(currentFrame);
+		VulkanAllocator::Update();
+		ResidencyManager::Update();
+
+		UpdateObjectCapacity((uint32_t)s_rendererData->renderCommands.size());
 
 		s_rendererData->commandBuffer->Begin();
+		s_rendererData->bindState.Reset();
+
+		// Beginning the command buffer waited for the frame's last submission, which also executed its secondary buffers
+		s_rendererData->threadCommandPools->Reset(s_rendererData->commandBuffer->GetCurrentIndex());
+		s_rendererData->frameSecondaryCommandBuffers = 0;
+
+		s_rendererData->asyncComputeFrame = s_rendererData->asyncComputeEnabled;
+		if (s_rendererData->asyncComputeFrame)
+		{
+			s_rendererData->computeCommandBuffer->Begin();
+		}
+
+		ReadTimestamps();
+
+		if (s_rendererData->timestampPool)
+		{
+			const uint32_t firstQuery = s_rendererData->commandBuffer->GetCurrentIndex() * TIMESTAMPS_PER_FRAME;
+			const VkCommandBuffer graphicsCommandBuffer = s_rendererData->commandBuffer->GetCurrentCommandBuffer();
+
+			vkCmdResetQueryPool(graphicsCommandBuffer, s_rendererData->timestampPool, firstQuery, 2);
+			vkCmdWriteTimestamp2(graphicsCommandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, s_rendererData->timestampPool, firstQuery);
+
+			if (s_rendererData->asyncComputeFrame)
+			{
+				const VkCommandBuffer computeCommandBuffer = s_rendererData->computeCommandBuffer->GetCurrentCommandBuffer();
+
+				vkCmdResetQueryPool(computeCommandBuffer, s_rendererData->timestampPool, firstQuery + 2, 2);
+				vkCmdWriteTimestamp2(computeCommandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, s_rendererData->timestampPool, firstQuery + 2);
+			}
+		}
 
 		LP_PROFILE_GPU_EVENT("Rendering Begin");
-		s_rendererData->indirectCullPipeline->WriteAndBindDescriptors(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), currentFrame);
+		s_rendererData->indirectCullPipeline->WriteAndBindDescriptors(GetCullCommandBuffer(), currentFrame);
+		s_rendererData->indirectCompactPipeline->WriteAndBindDescriptors(GetCullCommandBuffer(), currentFrame);
 		s_rendererData->frameUpdatedMaterials.clear();
 		s_rendererData->passIndex = 0;
 
-		s_frameDeletionQueues[currentFrame].Flush();
-		s_invalidationQueues[currentFrame].Flush();
+		s_rendererData->cullViews.clear();
+		s_rendererData->frameCompactedPasses = 0;
+
+		// Camera, target and pass data
+		for (uint32_t binding = 0; binding < 3; binding++)
+		{
+			UniformBufferRegistry::Get(1, binding)->Get(s_rendererData->commandBuffer->GetCurrentIndex())->Reset();
+		}
+
+		FlushDeletionQueues();
+
+		// Flushed outside of the lock so that invalidations can submit new ones
+		{
+			FunctionQueue invalidations;
+			{
+				std::scoped_lock lock{ s_invalidationMutex };
+				std::swap(invalidations, s_invalidationQueues[currentFrame]);
+			}
 
-		SortRenderCommands();
-		PrepareForIndirectDraw(s_rendererData->renderCommands);
+			invalidations.Flush();
+		}
+
+		PrepareForIndirectDraw(s_rendererData->renderCommands, s_rendererData->indirectBatches);
 		UploadRenderCommands();
 		UpdatePerFrameBuffers();
+
+		// Copy the staged data into device local memory when it is not mapped directly, the cull inputs are uploaded on the queue culling runs on
+		{
+			const VkCommandBuffer cullCommandBuffer = GetCullCommandBuffer();
+			const VkPipelineStageFlags2 dstStage = s_rendererData->asyncComputeFrame ? VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			const uint64_t commandCount = (uint64_t)s_rendererData->renderCommands.size();
+
+			ShaderStorageBufferRegistry::Get(0, 3)->Get(currentFrame)->Upload(cullCommandBuffer, sizeof(ObjectData) * commandCount, dstStage);
+			s_rendererData->indirectDrawBuffer->Get(currentFrame)->Upload(cullCommandBuffer, sizeof(GPUIndirectObject) * commandCount, dstStage);
+			s_rendererData->meshBoundsBuffer->Get(currentFrame)->Upload(cullCommandBuffer, sizeof(glm::vec4) * s_rendererData->meshBoundsIndices.size(), dstStage);
+		}
 	}
 
 	void Renderer::End()
 	{
 		LP_PROFILE_FUNCTION();
 		LP_PROFILE_GPU_EVENT("Rendering Begin");
-		s_rendererData->commandBuffer->End();
+
+		const uint32_t frameIndex = s_rendererData->commandBuffer->GetCurrentIndex();
+		const uint32_t firstQuery = frameIndex * TIMESTAMPS_PER_FRAME;
+
+		std::vector<QueueWait> queueWaits;
+
+		if (s_rendererData->asyncComputeFrame)
+		{
+			const VkCommandBuffer computeCommandBuffer = s_rendererData->computeCommandBuffer->GetCurrentCommandBuffer();
+
+			if (s_rendererData->timestampPool)
+			{
+				vkCmdWriteTimestamp2(computeCommandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, s_rendererData->timestampPool, firstQuery + 3);
+				s_rendererData->timestampFrames[frameIndex].computeWritten = true;
+			}
+
+			s_rendererData->computeCommandBuffer->End();
+
+			// The submit info takes synchronization 1 stages, which share their values with the synchronization 2 stages used here
+			auto& queueWait = queueWaits.emplace_back();
+			queueWait.queue = s_rendererData->computeCommandBuffer->GetQueue();
+			queueWait.value = s_rendererData->computeCommandBuffer->GetLastSubmitValue();
+			queueWait.stage = (VkPipelineStageFlags)CULL_CONSUMER_STAGES;
+		}
+
+		if (s_rendererData->timestampPool)
+		{
+			vkCmdWriteTimestamp2(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, s_rendererData->timestampPool, firstQuery + 1);
+			s_rendererData->timestampFrames[frameIndex].graphicsWritten = true;
+		}
+
+		s_rendererData->commandBuffer->End(queueWaits);
 		s_rendererData->renderCommands.clear();
+
+		s_rendererData->statistics.culledViews = (uint32_t)s_rendererData->cullViews.size();
+		s_rendererData->statistics.compactedPasses = s_rendererData->frameCompactedPasses;
+		s_rendererData->statistics.binds = s_rendererData->bindState.statistics;
+		s_rendererData->statistics.secondaryCommandBuffers = s_rendererData->frameSecondaryCommandBuffers;
+		s_rendererData->bindState.statistics = {};
 	}
 
 	void Renderer::ExecuteComputePass()
 	{
-		UpdatePerPassBuffers();
-
 		const Ref<RenderPass> currentPass = s_rendererData->currentPass;
 		const uint32_t currentFrame = Application::Get().GetWindow()->GetSwapchain().GetCurrentFrame();
 		const VkCommandBuffer currentCommandBuffer = s_rendererData->commandBuffer->GetCurrentCommandBuffer();
@@ -199,31 +384,51 @@ namespace Lamp
 
 		currentPass->framebuffer->Clear(currentCommandBuffer);
 
-		currentPass->computePipeline->SetImage(currentPass->framebuffer->GetColorAttachment(0), 2, 6, 0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL);
+		// The dispatch writes the cleared attachments
+		s_rendererData->barrierBatch.AddMemoryBarrier(VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+		s_rendererData->barrierBatch.Flush(currentCommandBuffer);
+
+		currentPass->computePipeline->SetImage(currentPass->framebuffer->GetColorAttachment(0), 2, 6, 0, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL);
 		currentPass->computePipeline->Dispatch(currentCommandBuffer, currentFrame, groupX, groupY, 1, s_rendererData->passIndex);
+	}
 
-		currentPass->computePipeline->InsertExecutionBarrier(currentCommandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, currentFrame);
+	void Renderer::ExecuteFrameGraph(Ref<FrameGraph> frameGraph)
+	{
+		LP_PROFILE_FUNCTION();
+		frameGraph->Execute(s_rendererData->commandBuffer->GetCurrentCommandBuffer());
 	}
 
-	void Renderer::BeginPass(Ref<RenderPass> renderPass, Ref<Camera> camera, Ref<DependencyGraph> dependencyGraph)
+	void Renderer::BeginPass(Ref<RenderPass> renderPass, Ref<Camera> camera)
 	{
 		LP_PROFILE_FUNCTION();
 		LP_PROFILE_GPU_EVENT(std::string("Begin " + renderPass->name).c_str());
 		s_rendererData->passCamera = camera;
 		s_rendererData->currentPass = renderPass;
 
+		LP_CORE_ASSERT(s_rendererData->passIndex < s_rendererData->reservedViewCount, "More passes begun than reserved with ReserveViews!");
+
+		// Growing now would rewrite descriptor sets the recorded passes have bound, so a missing reservation is fatal in every configuration
+		if (s_rendererData->passIndex >= s_rendererData->viewCapacity.Get())
+		{
+			LP_CORE_ERROR("Pass {0} exceeds the view capacity of {1}, reserve every view with ReserveViews before Begin!", renderPass->name, s_rendererData->viewCapacity.Get());
+			throw std::runtime_error("Pass exceeds the reserved view capacity!");
+		}
+
 		UpdatePerPassBuffers();
-		dependencyGraph->InsertBarriersPrePass(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), renderPass->hash);
 
 		// Begin RenderPass
 		if (!renderPass->computePipeline)
 		{
+			UpdatePassBatchMask();
 			CullRenderCommands();
 
+			s_rendererData->recordParallel = s_rendererData->passBatchCount >= PARALLEL_RECORD_MIN_BATCHES && s_rendererData->recordThreadPool->GetThreadCount() > 1;
+
 			auto framebuffer = renderPass->framebuffer;
 
 			VkRenderingInfo renderingInfo{};
 			renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+			renderingInfo.flags = s_rendererData->recordParallel ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0;
 			renderingInfo.renderArea = { 0, 0, framebuffer->GetWidth(), framebuffer->GetHeight() };
 			renderingInfo.layerCount = 1;
 			renderingInfo.colorAttachmentCount = (uint32_t)framebuffer->GetColorAttachmentInfos().size();
@@ -242,7 +447,7 @@ namespace Lamp
 		}
 	}
 
-	void Renderer::EndPass(Ref<DependencyGraph> dependencyGraph)
+	void Renderer::EndPass()
 	{
 		LP_PROFILE_FUNCTION();
 		LP_PROFILE_GPU_EVENT(std::string("End " + s_rendererData->currentPass->name).c_str());
@@ -252,19 +457,35 @@ namespace Lamp
 			vkCmdEndRendering(s_rendererData->commandBuffer->GetCurrentCommandBuffer());
 		}
 
-		dependencyGraph->InsertBarriersPostPass(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), s_rendererData->currentPass->hash);
-
+		s_rendererData->recordParallel = false;
 		s_rendererData->currentPass = nullptr;
 		s_rendererData->passCamera = nullptr;
 		s_rendererData->passIndex++;
 	}
 
+	void Renderer::ReserveViews(uint32_t viewCount)
+	{
+		// The buffers can not be reallocated while the frame is recorded, so they grow to every view of the frame before it begins
+		s_rendererData->reservedViewCount = viewCount;
+		UpdateViewCapacity(viewCount);
+	}
+
 	void Renderer::Submit(Ref<Mesh> mesh, const glm::mat4& transform)
 	{
 		LP_PROFILE_FUNCTION();
+
+		// Evicted meshes are skipped until they have been reloaded
+		ResidencyManager::MarkUsed(*mesh);
+		if (!mesh->IsResident())
+		{
+			return;
+		}
+
+		auto& submitBuffer = s_rendererData->submitBuffers.Get();
+
 		for (const auto& subMesh : mesh->GetSubMeshes())
 		{
-			auto& cmd = s_rendererData->renderCommands.emplace_back();
+			auto& cmd = submitBuffer.emplace_back();
 			cmd.mesh = mesh;
 			cmd.material = mesh->GetMaterial()->GetMaterials().at(subMesh.materialIndex);
 			cmd.subMesh = subMesh;
@@ -275,22 +496,58 @@ namespace Lamp
 	void Renderer::SubmitDirectionalLight(const glm::mat4& transform, const glm::vec3& color, const float intensity)
 	{
 		const glm::vec3 direction = glm::normalize(glm::mat3(transform) * glm::vec3(1.f)) * -1.f;
-		s_rendererData->directionalLight.direction = { direction.x, direction.y, direction.z, 0.f };
-		s_rendererData->directionalLight.colorIntensity = { color, intensity };
+		s_rendererData->submitPacket->directionalLight.direction = { direction.x, direction.y, direction.z, 0.f };
+		s_rendererData->submitPacket->directionalLight.colorIntensity = { color, intensity };
 	}
 
 	void Renderer::SubmitEnvironment(const Skybox& environment)
 	{
-		s_rendererData->skyboxData = environment;
-		if (!s_rendererData->skyboxData.radianceMap)
+		Skybox& skybox = s_rendererData->submitPacket->environment;
+
+		skybox = environment;
+		if (!skybox.radianceMap)
+		{
+			skybox.radianceMap = s_defaultData->blackCubeImage;
+		}
+
+		if (!skybox.irradianceMap)
 		{
-			s_rendererData->skyboxData.radianceMap = s_defaultData->blackCubeImage;
+			skybox.irradianceMap = s_defaultData->blackCubeImage;
 		}
+	}
+
+	void Renderer::SubmitRenderJob(std::function<void()>&& job)
+	{
+		s_rendererData->submitPacket->renderJobs.emplace_back(std::move(job));
+	}
+
+	Scope<FramePacket> Renderer::TakeFramePacket()
+	{
+		Scope<FramePacket> packet = std::move(s_rendererData->submitPacket);
+		MergeSubmitBuffers(packet->renderCommands);
+
+		s_rendererData->submitPacket = CreateScope<FramePacket>();
+		s_rendererData->submitPacket->directionalLight = packet->directionalLight;
+		s_rendererData->submitPacket->environment = packet->environment;
+
+		return packet;
+	}
+
+	void Renderer::RenderFramePacket(FramePacket& packet)
+	{
+		LP_PROFILE_FUNCTION();
+
+		s_rendererData->renderCommands = std::move(packet.renderCommands);
+		s_rendererData->directionalLight = packet.directionalLight;
+		s_rendererData->skyboxData = packet.environment;
 
-		if (!s_rendererData->skyboxData.irradianceMap)
+		for (const auto& job : packet.renderJobs)
 		{
-			s_rendererData->skyboxData.irradianceMap = s_defaultData->blackCubeImage;
+			job();
 		}
+
+		// Commands of a packet without a scene render are dropped with it
+		s_rendererData->renderCommands.clear();
 	}
 
 	void Renderer::DispatchRenderCommands()
@@ -301,70 +558,155 @@ namespace Lamp
 			return;
 		}
 
+		PrepareMaterials();
+
+		if (s_rendererData->recordParallel)
+		{
+			RecordBatchesParallel();
+			return;
+		}
+
+		RecordBatches(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), s_rendererData->bindState, 0, (uint32_t)s_rendererData->indirectBatches.size());
+	}
+
+	void Renderer::PrepareMaterials()
+	{
+		LP_PROFILE_FUNCTION();
+
 		const uint32_t currentFrame = s_rendererData->commandBuffer->GetCurrentIndex();
+		const auto& draws = s_rendererData->indirectBatches;
 
-		// Draw
+		// Descriptors are written and residency is tracked on the thread recording the frame, the recording workers only read the materials
+		Material* lastMaterial = nullptr;
+		for (uint32_t i = 0; i < (uint32_t)draws.size(); i++)
 		{
-			std::vector<IndirectBatch>& draws = s_rendererData->indirectBatches;
-			for (uint32_t i = 0; i < draws.size(); i++)
+			if ((s_rendererData->passBatchMask[i / 32] & (1u << (i % 32))) == 0 || draws[i].material.get() == lastMaterial || !draws[i].material->HasDescriptorSets())
 			{
-				LP_PROFILE_GPU_EVENT("DrawIndirect");
-
-				{
-					LP_PROFILE_SCOPE("Pipeline check");
-
-					if (!s_rendererData->currentPass->excludedPipelineHashes.empty())
-					{
-						auto it = std::find(s_rendererData->currentPass->excludedPipelineHashes.begin(), s_rendererData->currentPass->excludedPipelineHashes.end(), draws[i].material->GetPipelineHash());
-						if (it != s_rendererData->currentPass->excludedPipelineHashes.end())
-						{
-							continue;
-						}
-					}
-
-					if (s_rendererData->currentPass->exclusivePipelineHash != 0 && draws[i].material->GetPipelineHash() != s_rendererData->currentPass->exclusivePipelineHash)
-					{
-						continue;
-					}
-				}
+				continue;
+			}
 
-				if (i == 0 || (i > 0 && draws[i].material != draws[i - 1].material))
-				{
-					draws[i].material->UpdateInternalTexture(DEFAULT_IRRADIANCE_SET, DEFAULT_IRRADIANCE_BINDING, currentFrame, s_rendererData->skyboxData.irradianceMap);
-					draws[i].material->UpdateInternalTexture(DEFAULT_RADIANCE_SET, DEFAULT_RADIANCE_BINDING, currentFrame, s_rendererData->skyboxData.radianceMap);
-					draws[i].material->UpdateInternalTexture(DEFAULT_BRDF_SET, DEFAULT_BRDF_BINDING, currentFrame, s_defaultData->brdfLut);
+			lastMaterial = draws[i].material.get();
 
-					draws[i].material->Bind(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), currentFrame, s_rendererData->passIndex);
-				}
+			draws[i].material->MarkTexturesUsed();
+			draws[i].material->RefreshTextures(currentFrame);
+			draws[i].material->UpdateInternalTexture(DEFAULT_IRRADIANCE_SET, DEFAULT_IRRADIANCE_BINDING, currentFrame, s_rendererData->skyboxData.irradianceMap);
+			draws[i].material->UpdateInternalTexture(DEFAULT_RADIANCE_SET, DEFAULT_RADIANCE_BINDING, currentFrame, s_rendererData->skyboxData.radianceMap);
+			draws[i].material->UpdateInternalTexture(DEFAULT_BRDF_SET, DEFAULT_BRDF_BINDING, currentFrame, s_defaultData->brdfLut);
+		}
+	}
 
-				if (i == 0 || (i > 0 && draws[i].mesh != draws[i - 1].mesh))
-				{
-					draws[i].mesh->GetVertexBuffer()->Bind(s_rendererData->commandBuffer->GetCurrentCommandBuffer());
-					draws[i].mesh->GetIndexBuffer()->Bind(s_rendererData->commandBuffer->GetCurrentCommandBuffer());
-				}
+	void Renderer::RecordBatches(VkCommandBuffer commandBuffer, PipelineBindState& bindState, uint32_t firstBatch, uint32_t lastBatch)
+	{
+		LP_PROFILE_FUNCTION();
 
-				const VkDeviceSize drawOffset = draws[i].first * sizeof(GPUIndirectObject);
-				const VkDeviceSize countOffset = i * sizeof(uint32_t);
-				const uint32_t drawStride = sizeof(GPUIndirectObject);
+		const uint32_t currentFrame = s_rendererData->commandBuffer->GetCurrentIndex();
+		const uint32_t passIndex = s_rendererData->passIndex;
 
-				const Ref<ShaderStorageBuffer> currentIndirectBuffer = s_rendererData->indirectDrawBuffer->Get(currentFrame);
-				const Ref<ShaderStorageBuffer> currentCountBuffer = s_rendererData->indirectCountBuffer->Get(currentFrame);
+		const Ref<ShaderStorageBuffer> currentIndirectBuffer = s_rendererData->indirectDrawBuffer->Get(currentFrame);
+		const Ref<ShaderStorageBuffer> currentCountBuffer = s_rendererData->indirectCountBuffer->Get(currentFrame);
 
-				vkCmdDrawIndexedIndirectCount(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), currentIndirectBuffer->GetHandle(), drawOffset, currentCountBuffer->GetHandle(), countOffset, draws[i].count, drawStride);
+		const auto& draws = s_rendererData->indirectBatches;
+		for (uint32_t i = firstBatch; i < lastBatch; i++)
+		{
+			// Batches the pass does not draw have no draws in its list either
+			if ((s_rendererData->passBatchMask[i / 32] & (1u << (i % 32))) == 0 || !draws[i].material->HasDescriptorSets())
+			{
+				continue;
 			}
+
+			// Redundant binds are filtered by the bound state
+			draws[i].material->Bind(commandBuffer, currentFrame, passIndex, bindState);
+			draws[i].mesh->GetVertexBuffer()->Bind(commandBuffer, bindState);
+			draws[i].mesh->GetIndexBuffer()->Bind(commandBuffer, bindState);
+
+			const VkDeviceSize drawOffset = draws[i].first * sizeof(GPUIndirectObject);
+			const VkDeviceSize countOffset = currentCountBuffer->GetOffsetSize() * passIndex + i * sizeof(uint32_t);
+			const uint32_t drawStride = sizeof(GPUIndirectObject);
+
+			vkCmdDrawIndexedIndirectCount(commandBuffer, currentIndirectBuffer->GetHandle(), drawOffset, currentCountBuffer->GetHandle(), countOffset, draws[i].count, drawStride);
 		}
 	}
 
-	void Renderer::SubmitResourceFree(std::function<void()>&& function)
+	void Renderer::RecordBatchesParallel()
 	{
-		const uint32_t currentFrame = Application::Get().GetWindow()->GetSwapchain().GetCurrentFrame();
-		s_frameDeletionQueues[currentFrame].Push(function);
+		LP_PROFILE_FUNCTION();
+
+		const uint32_t currentFrame = s_rendererData->commandBuffer->GetCurrentIndex();
+		const uint32_t batchCount = (uint32_t)s_rendererData->indirectBatches.size();
+		const Ref<Framebuffer> framebuffer = s_rendererData->currentPass->framebuffer;
+
+		// Chunks split the batch range evenly, masked out batches are skipped inside the chunks
+		const uint32_t threadCount = s_rendererData->recordThreadPool->GetThreadCount();
+		const uint32_t maxChunkCount = std::max((s_rendererData->passBatchCount + MIN_BATCHES_PER_CHUNK - 1) / MIN_BATCHES_PER_CHUNK, 1u);
+		const uint32_t chunkCount = std::min(threadCount * CHUNKS_PER_THREAD, maxChunkCount);
+		const uint32_t batchesPerChunk = (batchCount + chunkCount - 1) / chunkCount;
+
+		VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{};
+		inheritanceRenderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+		inheritanceRenderingInfo.colorAttachmentCount = (uint32_t)framebuffer->GetColorFormats().size();
+		inheritanceRenderingInfo.pColorAttachmentFormats = framebuffer->GetColorFormats().data();
+		inheritanceRenderingInfo.depthAttachmentFormat = framebuffer->GetDepthAttachment() ? framebuffer->GetDepthFormat() : VK_FORMAT_UNDEFINED;
+		inheritanceRenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+		inheritanceRenderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.pNext = &inheritanceRenderingInfo;
+
+		auto& chunkCommandBuffers = s_rendererData->chunkCommandBuffers;
+		auto& chunkStatistics = s_rendererData->chunkStatistics;
+
+		chunkCommandBuffers.assign(chunkCount, nullptr);
+		chunkStatistics.assign(chunkCount, {});
+
+		s_rendererData->recordThreadPool->ParallelFor(chunkCount, [&](uint32_t chunkIndex, uint32_t threadIndex)
+			{
+				const uint32_t firstBatch = std::min(chunkIndex * batchesPerChunk, batchCount);
+				const uint32_t lastBatch = std::min(firstBatch + batchesPerChunk, batchCount);
+
+				const VkCommandBuffer commandBuffer = s_rendererData->threadCommandPools->Allocate(currentFrame, threadIndex);
+
+				VkCommandBufferBeginInfo beginInfo{};
+				beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+				beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+				beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+				LP_VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+				// Nothing is inherited from the primary buffer, every chunk binds its own state
+				PipelineBindState bindState{};
+				RecordBatches(commandBuffer, bindState, firstBatch, lastBatch);
+
+				LP_VK_CHECK(vkEndCommandBuffer(commandBuffer));
+
+				chunkCommandBuffers[chunkIndex] = commandBuffer;
+				chunkStatistics[chunkIndex] = bindState.statistics;
+			});
+
+		vkCmdExecuteCommands(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), chunkCount, chunkCommandBuffers.data());
+
+		// The state bound by the secondary buffers is undefined in the primary buffer afterwards
+		auto& bindState = s_rendererData->bindState;
+		bindState.Reset();
+
+		for (const auto& statistics : chunkStatistics)
+		{
+			bindState.statistics.pipelineBinds += statistics.pipelineBinds;
+			bindState.statistics.descriptorSetBinds += statistics.descriptorSetBinds;
+			bindState.statistics.vertexBufferBinds += statistics.vertexBufferBinds;
+			bindState.statistics.indexBufferBinds += statistics.indexBufferBinds;
+			bindState.statistics.skippedCalls += statistics.skippedCalls;
+		}
+
+		s_rendererData->frameSecondaryCommandBuffers += chunkCount;
 	}
 
 	void Renderer::SubmitInvalidation(std::function<void()>&& function)
 	{
+		std::scoped_lock lock{ s_invalidationMutex };
+
 		const uint32_t currentFrame = Application::Get().GetWindow()->GetSwapchain().GetCurrentFrame();
-		s_invalidationQueues[currentFrame].Push(function);
+		s_invalidationQueues[currentFrame].Push(std::move(function));
 	}
 
 	Skybox Renderer::GenerateEnvironmentMap(AssetHandle handle)
@@ -404,9 +746,9 @@ namespace Lamp
 
 			conversionPipeline->Bind(cmdBuffer);
 			conversionPipeline->SetTexture(equirectangularTexture, 0, 0);
-			conversionPipeline->SetImage(environmentUnfiltered, 0, 1, 0, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			conversionPipeline->SetImage(environmentUnfiltered, 0, 1, 0, VK_ACCESS_2_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 			conversionPipeline->Dispatch(cmdBuffer, 0, cubeMapSize / conversionThreadCount, cubeMapSize / conversionThreadCount, 6);
-			conversionPipeline->InsertBarrier(cmdBuffer, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			conversionPipeline->InsertBarrier(cmdBuffer, 0, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
 
 			device->FlushCommandBuffer(cmdBuffer);
 		}
@@ -451,10 +793,10 @@ namespace Lamp
 
 				filterPipeline->SetImage(environmentUnfiltered, 0, 0, 0);
 				filterPipeline->SetPushConstant(cmdBuffer, sizeof(float), &roughness);
-				filterPipeline->SetImage(environmentFiltered, 0, 1, i, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL);
+				filterPipeline->SetImage(environmentFiltered, 0, 1, i, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL);
 
 				filterPipeline->Dispatch(cmdBuffer, 0, numGroups, numGroups, 6);
-				filterPipeline->InsertBarrier(cmdBuffer, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+				filterPipeline->InsertBarrier(cmdBuffer, 0, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
 
 				device->FlushCommandBuffer(cmdBuffer);
 			}
@@ -483,13 +825,12 @@ namespace Lamp
 
 			irradiancePipeline->Bind(cmdBuffer);
 			irradiancePipeline->SetImage(environmentFiltered, 0, 0, 0);
-			irradiancePipeline->SetImage(irradianceMap, 0, 1, 0, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+			irradiancePipeline->SetImage(irradianceMap, 0, 1, 0, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 			irradiancePipeline->SetPushConstant(cmdBuffer, sizeof(uint32_t), &irradianceComputeSamples);
 			irradiancePipeline->Dispatch(cmdBuffer, 0, irradianceMapSize / conversionThreadCount, irradianceMapSize / conversionThreadCount, 6);
-			irradiancePipeline->InsertBarrier(cmdBuffer, 0, VK_PIPELINE_STAGE_TRANSFER_BIT);
+			irradiancePipeline->InsertBarrier(cmdBuffer, 0, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
 
-			irradianceMap->GenerateMips(false, cmdBuffer);
-			irradianceMap->TransitionToLayout(cmdBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			irradianceMap->GenerateMips(true, cmdBuffer);
 
 			device->FlushCommandBuffer(cmdBuffer);
 		}
@@ -501,17 +842,23 @@ namespace Lamp
 		return skybox;
 	}
 
+	void Renderer::SetAsyncComputeEnabled(bool enabled)
+	{
+		s_rendererData->asyncComputeEnabled = enabled && s_rendererData->capabilities.asyncCompute;
+	}
+
 	VkDescriptorSet Renderer::AllocateDescriptorSet(VkDescriptorSetAllocateInfo& allocInfo)
 	{
 		LP_PROFILE_FUNCTION();
 
-		auto device = GraphicsContext::GetDevice();
 		uint32_t currentFrame = Application::Get().GetWindow()->GetSwapchain().GetCurrentFrame();
 
-		allocInfo.descriptorPool = s_rendererData->descriptorPools[currentFrame];
-
-		VkDescriptorSet descriptorSet;
-		LP_VK_CHECK(vkAllocateDescriptorSets(device->GetHandle(), &allocInfo, &descriptorSet));
+		VkDescriptorSet descriptorSet = nullptr;
+		if (!DescriptorAllocator::AllocateFrame(allocInfo, currentFrame, &descriptorSet))
+		{
+			LP_CORE_ASSERT(false, "Unable to allocate a frame descriptor set!");
+			return nullptr;
+		}
 
 		return descriptorSet;
 	}
@@ -564,52 +911,19 @@ namespace Lamp
 		SamplerLibrary::Add(TextureFilter::Linear, TextureFilter::Linear, TextureFilter::Nearest, TextureWrap::Clamp, CompareOperator::None, AniostopyLevel::None);
 	}
 
-	void Renderer::CreateDescriptorPools()
-	{
-		VkDescriptorPoolSize poolSizes[] =
-		{
-			{ VK_DESCRIPTOR_TYPE_SAMPLER, 1000 },
-			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1000 },
-			{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1000 },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1000 },
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1000 },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 1000 },
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1000 },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1000 },
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1000 },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1000 },
-			{ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1000 }
-		};
-
-		VkDescriptorPoolCreateInfo poolInfo{};
-		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-		poolInfo.maxSets = 10000;
-		poolInfo.poolSizeCount = (uint32_t)ARRAYSIZE(poolSizes);
-		poolInfo.pPoolSizes = poolSizes;
-
-		const uint32_t framesInFlight = Application::Get().GetWindow()->GetSwapchain().GetFramesInFlight();
-
-		s_rendererData->descriptorPools.resize(framesInFlight);
-		auto device = GraphicsContext::GetDevice();
-
-		for (auto& descriptorPool : s_rendererData->descriptorPools)
-		{
-			LP_VK_CHECK(vkCreateDescriptorPool(device->GetHandle(), &poolInfo, nullptr, &descriptorPool));
-		}
-	}
-
-	void Renderer::PrepareForIndirectDraw(std::vector<RenderCommand>& renderCommands)
+	void Renderer::PrepareForIndirectDraw(std::vector<RenderCommand>& renderCommands, std::vector<IndirectBatch>& outBatches)
 	{
 		LP_PROFILE_FUNCTION();
 
+		outBatches.clear();
 		if (renderCommands.empty())
 		{
 			return;
 		}
 
-		s_rendererData->indirectBatches.clear();
-		auto& draws = s_rendererData->indirectBatches;
+		SortRenderCommands(renderCommands);
+
+		auto& draws = outBatches;
 
 		IndirectBatch& firstDraw = draws.emplace_back();
 		firstDraw.mesh = renderCommands[0].mesh;
@@ -617,6 +931,9 @@ namespace Lamp
 		firstDraw.subMesh = renderCommands[0].subMesh;
 		firstDraw.first = 0;
 		firstDraw.count = 1;
+		firstDraw.id = 0;
+
+		renderCommands[0].batchId = 0;
 
 		for (uint32_t i = 1; i < renderCommands.size(); i++)
 		{
@@ -638,6 +955,8 @@ namespace Lamp
 				newDraw.count = 1;
 				newDraw.id = uint32_t(draws.size() - 1);
 			}
+
+			renderCommands[i].batchId = draws.back().id;
 		}
 	}
 
@@ -647,50 +966,41 @@ namespace Lamp
 
 		const uint32_t currentFrame = s_rendererData->commandBuffer->GetCurrentIndex();
 
+		// Pass data is allocated linearly, one slot per pass in pass order, which matches the pass index based dynamic offsets used when binding
 		// Update camera data
 		{
 			auto currentCameraBuffer = UniformBufferRegistry::Get(1, 0)->Get(currentFrame);
-			uint8_t* bytePtr = currentCameraBuffer->Map<uint8_t>();
-
-			const uint32_t ptrOffset = currentCameraBuffer->GetSize() * s_rendererData->passIndex;
-			bytePtr += ptrOffset;
 
-			CameraData* cameraData = (CameraData*)bytePtr;
+			uint32_t offset = 0;
+			CameraData* cameraData = currentCameraBuffer->Allocate<CameraData>(offset);
+			LP_CORE_ASSERT(offset == currentCameraBuffer->GetSize() * s_rendererData->passIndex, "Pass data allocated out of order!");
 
 			cameraData->proj = s_rendererData->passCamera->GetProjection();
 			cameraData->view = s_rendererData->passCamera->GetView();
 			cameraData->position = glm::vec4(s_rendererData->passCamera->GetPosition(), 1.f);
 			cameraData->viewProj = cameraData->proj * cameraData->view;
-
-			currentCameraBuffer->Unmap();
 		}
 
 		// Update target data
 		{
 			auto currentTargetBuffer = UniformBufferRegistry::Get(1, 1)->Get(currentFrame);
-			uint8_t* bytePtr = currentTargetBuffer->Map<uint8_t>();
 
-			const uint32_t ptrOffset = currentTargetBuffer->GetSize() * s_rendererData->passIndex;
-			bytePtr += ptrOffset;
+			uint32_t offset = 0;
+			TargetData* targetData = currentTargetBuffer->Allocate<TargetData>(offset);
+			LP_CORE_ASSERT(offset == currentTargetBuffer->GetSize() * s_rendererData->passIndex, "Pass data allocated out of order!");
 
-			TargetData* targetData = (TargetData*)bytePtr;
 			targetData->targetSize = { s_rendererData->currentPass->framebuffer->GetWidth(), s_rendererData->currentPass->framebuffer->GetHeight() };
-
-			currentTargetBuffer->Unmap();
 		}
 
 		// Update pass data
 		{
 			auto currentPassBuffer = UniformBufferRegistry::Get(1, 2)->Get(currentFrame);
-			uint8_t* bytePtr = currentPassBuffer->Map<uint8_t>();
 
-			const uint32_t ptrOffset = currentPassBuffer->GetSize() * s_rendererData->passIndex;
-			bytePtr += ptrOffset;
+			uint32_t offset = 0;
+			PassData* passData = currentPassBuffer->Allocate<PassData>(offset);
+			LP_CORE_ASSERT(offset == currentPassBuffer->GetSize() * s_rendererData->passIndex, "Pass data allocated out of order!");
 
-			PassData* passData = (PassData*)bytePtr;
 			passData->passIndex = s_rendererData->passIndex;
-
-			currentPassBuffer->Unmap();
 		}
 	}
 
@@ -700,27 +1010,6 @@ namespace Lamp
 
 		const uint32_t currentFrame = s_rendererData->commandBuffer->GetCurrentIndex();
 
-		// Update object data
-		{
-			auto currentObjectBuffer = ShaderStorageBufferRegistry::Get(0, 3)->Get(currentFrame);
-			auto* objectData = currentObjectBuffer->Map<ObjectData>();
-
-			for (uint32_t i = 0; i < s_rendererData->renderCommands.size(); i++)
-			{
-				const BoundingSphere& boundingSphere = s_rendererData->renderCommands[i].mesh->GetBoundingSphere();
-
-				const glm::mat4 transform = s_rendererData->renderCommands[i].transform;
-				const glm::vec3 globalScale = { glm::length(transform[0]), glm::length(transform[1]), glm::length(transform[2]) };
-				const glm::vec3 globalCenter = transform * glm::vec4(boundingSphere.center, 1.f);
-				const float maxScale = std::max(globalScale.x, std::max(globalScale.y, globalScale.z));
-
-				objectData[i].transform = transform;
-				objectData[i].sphereBounds = glm::vec4(globalCenter, boundingSphere.radius * maxScale * 0.5f);
-			}
-
-			currentObjectBuffer->Unmap();
-		}
-
 		// Update directional light
 		{
 			auto currentBuffer = UniformBufferRegistry::Get(0, 1)->Get(currentFrame);
@@ -728,10 +1017,16 @@ namespace Lamp
 		}
 	}
 
-	void Renderer::SortRenderCommands()
+	void Renderer::MergeSubmitBuffers(std::vector<RenderCommand>& outRenderCommands)
 	{
 		LP_PROFILE_FUNCTION();
-		std::sort(s_rendererData->renderCommands.begin(), s_rendererData->renderCommands.end(), [](const RenderCommand& lhs, const RenderCommand& rhs)
+		s_rendererData->submitBuffers.MoveInto(outRenderCommands);
+	}
+
+	void Renderer::SortRenderCommands(std::vector<RenderCommand>& renderCommands)
+	{
+		LP_PROFILE_FUNCTION();
+		std::sort(renderCommands.begin(), renderCommands.end(), [](const RenderCommand& lhs, const RenderCommand& rhs)
 			{
 				if (lhs.material < rhs.material)
 				{
@@ -751,7 +1046,13 @@ namespace Lamp
 					return false;
 				}
 
-				return false;
+				// The order is total, so the draws do not depend on which thread submitted first
+				if (lhs.mesh != rhs.mesh)
+				{
+					return lhs.mesh < rhs.mesh;
+				}
+
+				return memcmp(&lhs.transform, &rhs.transform, sizeof(glm::mat4)) < 0;
 			});
 	}
 
@@ -765,99 +1066,288 @@ namespace Lamp
 		}
 
 		const uint32_t currentFrame = s_rendererData->commandBuffer->GetCurrentIndex();
-		std::vector<IndirectBatch>& draws = s_rendererData->indirectBatches;
 
-		// Fill indirect commands
+		auto* drawCommands = s_rendererData->indirectDrawBuffer->Get(currentFrame)->Map<GPUIndirectObject>();
+		auto* meshBounds = s_rendererData->meshBoundsBuffer->Get(currentFrame)->Map<glm::vec4>();
+		auto* objectData = ShaderStorageBufferRegistry::Get(0, 3)->Get(currentFrame)->Map<ObjectData>();
+
+		WriteRenderCommands(s_rendererData->renderCommands, s_rendererData->indirectBatches, s_rendererData->meshBoundsIndices, drawCommands, meshBounds, objectData);
+	}
+
+	void Renderer::WriteRenderCommands(const std::vector<RenderCommand>& renderCommands, const std::vector<IndirectBatch>& batches, std::unordered_map<Mesh*, uint32_t>& meshBoundsIndices,
+		GPUIndirectObject* outDrawCommands, glm::vec4* outMeshBounds, ObjectData* outObjectData)
+	{
+		LP_PROFILE_FUNCTION();
+
+		meshBoundsIndices.clear();
+
+		for (uint32_t i = 0; i < renderCommands.size(); i++)
 		{
-			auto* drawCommands = s_rendererData->indirectDrawBuffer->Get(currentFrame)->Map<GPUIndirectObject>();
+			auto& cmd = renderCommands[i];
 
-			for (uint32_t i = 0; i < s_rendererData->renderCommands.size(); i++)
+			auto [boundsIt, inserted] = meshBoundsIndices.try_emplace(cmd.mesh.get(), (uint32_t)meshBoundsIndices.size());
+			if (inserted)
 			{
-				auto& cmd = s_rendererData->renderCommands[i];
+				const BoundingSphere& boundingSphere = cmd.mesh->GetBoundingSphere();
+				outMeshBounds[boundsIt->second] = glm::vec4(boundingSphere.center, boundingSphere.radius);
+			}
 
-				drawCommands[i].command.indexCount = cmd.subMesh.indexCount;
-				drawCommands[i].command.firstIndex = cmd.subMesh.indexStartOffset;
-				drawCommands[i].command.vertexOffset = cmd.subMesh.vertexStartOffset;
-				drawCommands[i].command.instanceCount = 1;
-				drawCommands[i].objectId = i;
+			outDrawCommands[i].boundsIndex = boundsIt->second;
 
-				// TODO: this is probably not performant
-				auto it = std::find_if(draws.begin(), draws.end(), [&cmd](const IndirectBatch& batch)
-					{
-						return batch.mesh == cmd.mesh && batch.material == cmd.material && batch.subMesh == cmd.subMesh;
-					});
+			outDrawCommands[i].command.indexCount = cmd.subMesh.indexCount;
+			outDrawCommands[i].command.firstIndex = cmd.subMesh.indexStartOffset;
+			outDrawCommands[i].command.vertexOffset = cmd.subMesh.vertexStartOffset;
+			outDrawCommands[i].command.instanceCount = 1;
+			outDrawCommands[i].objectId = i;
 
-				if (it != draws.end())
-				{
-					drawCommands[i].batchId = it->id;
-					drawCommands[i].command.firstInstance = it->first;
-				}
+			// The batch of each command is assigned when the batches are built
+			const IndirectBatch& batch = batches[cmd.batchId];
+			outDrawCommands[i].batchId = batch.id;
+			outDrawCommands[i].command.firstInstance = batch.first;
 
-			}
+			// Bounds are transformed by the cull shader
+			outObjectData[i].transform = glm::mat3x4(glm::transpose(cmd.transform));
+		}
+	}
+
+	CullData Renderer::CreateCullData(const Camera& camera, uint32_t drawCount)
+	{
+		CullData cullData{};
+
+		const glm::mat4& projection = camera.GetProjection();
+		const glm::mat4 projectionTrans = glm::transpose(projection);
+
+		const glm::vec4 frustumX = Math::NormalizePlane(projectionTrans[3] + projectionTrans[0]);
+		const glm::vec4 frustumY = Math::NormalizePlane(projectionTrans[3] + projectionTrans[1]);
 
-			s_rendererData->indirectDrawBuffer->Get(currentFrame)->Unmap();
+		cullData.view = camera.GetView();
+		cullData.P00 = projection[0][0];
+		cullData.P11 = projection[1][1];
+		cullData.zNear = camera.GetNearPlane();
+		cullData.zFar = camera.GetFarPlane();
+
+		cullData.frustum[0] = frustumX.x;
+		cullData.frustum[1] = frustumX.z;
+		cullData.frustum[2] = frustumY.y;
+		cullData.frustum[3] = frustumY.z;
+
+		cullData.drawCount = drawCount;
+
+		cullData.cullingEnabled = true;
+		cullData.lodEnabled = true;
+		cullData.distCull = 0;
+
+		return cullData;
+	}
+
+	void Renderer::CullRenderCommands()
+	{
+		const uint32_t currentFrame = s_rendererData->commandBuffer->GetCurrentIndex();
+		const VkCommandBuffer cullCommandBuffer = GetCullCommandBuffer();
+		const uint32_t drawCount = (uint32_t)s_rendererData->renderCommands.size();
+
+		const CullData cullData = CreateCullData(*s_rendererData->passCamera, drawCount);
+
+		// Reset the draw counts of this pass on the GPU
+		{
+			const auto& countBuffer = s_rendererData->indirectCountBuffer->Get(currentFrame);
+			const VkDeviceSize countOffset = countBuffer->GetOffsetSize() * s_rendererData->passIndex;
+			const VkDeviceSize countSize = sizeof(uint32_t) * std::max((VkDeviceSize)s_rendererData->indirectBatches.size(), (VkDeviceSize)1);
+
+			vkCmdFillBuffer(cullCommandBuffer, countBuffer->GetHandle(), countOffset, countSize, 0);
+			s_rendererData->barrierBatch.AddBufferBarrier(countBuffer->GetHandle(), VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, countOffset, countSize);
+		}
+
+		// A new view flushes the count reset with its visibility clear before the cull, this flush then only holds the cull results.
+		// Passes sharing a view reuse its visibility bits, then the count reset is the only barrier left for this flush
+		const uint32_t viewIndex = CullView(cullData, cullCommandBuffer);
+		s_rendererData->barrierBatch.Flush(cullCommandBuffer);
+
+		// Compact the draw list of the pass
+		{
+			CompactData compactData{};
+			compactData.drawCount = drawCount;
+			compactData.visibilityOffset = viewIndex * Utility::GetVisibilityWordCount(s_rendererData->objectCapacity.Get());
+
+			const uint32_t dispatchCount = drawCount / 256 + 1;
+
+			s_rendererData->indirectCompactPipeline->Bind(cullCommandBuffer, currentFrame);
+			s_rendererData->indirectCompactPipeline->SetPushConstant(cullCommandBuffer, sizeof(CompactData), &compactData);
+			s_rendererData->indirectCompactPipeline->DispatchNoUpdate(cullCommandBuffer, currentFrame, dispatchCount, 1, 1, s_rendererData->passIndex);
+
+			s_rendererData->frameCompactedPasses++;
+		}
+
+		// On the compute queue the results are handed over when the frame ends
+		if (!s_rendererData->asyncComputeFrame)
+		{
+			s_rendererData->indirectCompactPipeline->InsertBarrier(cullCommandBuffer, currentFrame, CULL_CONSUMER_STAGES);
 		}
+	}
+
+	uint32_t Renderer::CullView(const CullData& cullData, VkCommandBuffer commandBuffer)
+	{
+		const size_t viewHash = Utility::HashCullView(cullData);
+
+		auto it = s_rendererData->cullViews.find(viewHash);
+		if (it != s_rendererData->cullViews.end())
+		{
+			return it->second;
+		}
+
+		const uint32_t viewIndex = (uint32_t)s_rendererData->cullViews.size();
+		LP_CORE_ASSERT(viewIndex < s_rendererData->viewCapacity.Get(), "Too many views culled in one frame!");
+
+		s_rendererData->cullViews.emplace(viewHash, viewIndex);
+
+		const uint32_t currentFrame = s_rendererData->commandBuffer->GetCurrentIndex();
+		const VkBuffer visibilityBuffer = s_rendererData->visibilityBuffer->Get(currentFrame)->GetHandle();
+
+		const uint32_t wordCount = Utility::GetVisibilityWordCount(s_rendererData->objectCapacity.Get());
+		const VkDeviceSize visibilityOffset = (VkDeviceSize)viewIndex * wordCount * sizeof(uint32_t);
+		const VkDeviceSize visibilitySize = (VkDeviceSize)wordCount * sizeof(uint32_t);
+
+		// The bits are only ever set by the cull. The pending count reset of the pass goes into the same barrier
+		{
+			auto& barriers = s_rendererData->barrierBatch;
+
+			vkCmdFillBuffer(commandBuffer, visibilityBuffer, visibilityOffset, visibilitySize, 0);
+			barriers.AddBufferBarrier(visibilityBuffer, VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, visibilityOffset, visibilitySize);
+			barriers.Flush(commandBuffer);
+		}
+
+		CullData viewCullData = cullData;
+		viewCullData.visibilityOffset = viewIndex * wordCount;
+
+		const uint32_t dispatchCount = cullData.drawCount / 256 + 1;
+
+		s_rendererData->indirectCullPipeline->Bind(commandBuffer, currentFrame);
+		s_rendererData->indirectCullPipeline->SetPushConstant(commandBuffer, sizeof(CullData), &viewCullData);
+		s_rendererData->indirectCullPipeline->DispatchNoUpdate(commandBuffer, currentFrame, dispatchCount, 1, 1);
+
+		// Read by the compaction of every pass drawing the view
+		s_rendererData->barrierBatch.AddBufferBarrier(visibilityBuffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, visibilityOffset, visibilitySize);
+
+		return viewIndex;
+	}
+
+	void Renderer::UpdatePassBatchMask()
+	{
+		LP_PROFILE_FUNCTION();
 
+		const Ref<RenderPass> currentPass = s_rendererData->currentPass;
+		const auto& draws = s_rendererData->indirectBatches;
+
+		auto& mask = s_rendererData->passBatchMask;
+		s_rendererData->passBatchCount = 0;
+		mask.assign(Utility::GetVisibilityWordCount(std::max((uint32_t)draws.size(), 1u)), 0);
+
+		for (uint32_t i = 0; i < (uint32_t)draws.size(); i++)
 		{
-			auto* ids = ShaderStorageBufferRegistry::Get(1, 4)->Get(currentFrame)->Map<uint32_t>();
+			const size_t pipelineHash = draws[i].material->GetPipelineHash();
+
+			if (currentPass->exclusivePipelineHash != 0 && pipelineHash != currentPass->exclusivePipelineHash)
+			{
+				continue;
+			}
 
-			for (uint32_t i = 0; i < s_rendererData->renderCommands.size(); i++)
+			if (currentPass->excludedPipelineHashes.contains(pipelineHash))
 			{
-				ids[i] = 0;
+				continue;
 			}
 
-			ShaderStorageBufferRegistry::Get(1, 4)->Get(currentFrame)->Unmap();
+			mask[i / 32] |= 1u << (i % 32);
+			s_rendererData->passBatchCount++;
 		}
+
+		// The mask buffer is host visible, the writes are visible to the frame's submit
+		const uint32_t currentFrame = s_rendererData->commandBuffer->GetCurrentIndex();
+		const Ref<ShaderStorageBuffer> maskBuffer = s_rendererData->passBatchMaskBuffer->Get(currentFrame);
+
+		uint8_t* passMask = maskBuffer->Map<uint8_t>() + maskBuffer->GetOffsetSize() * s_rendererData->passIndex;
+		memcpy_s(passMask, maskBuffer->GetOffsetSize(), mask.data(), mask.size() * sizeof(uint32_t));
 	}
 
-	void Renderer::CullRenderCommands()
+	void Renderer::SetCullBuffers()
 	{
-		const uint32_t currentFrame = s_rendererData->commandBuffer->GetCurrentIndex();
+		const auto& cullPipeline = s_rendererData->indirectCullPipeline;
+		cullPipeline->SetStorageBuffer(s_rendererData->indirectDrawBuffer, 0, 1);
+		cullPipeline->SetStorageBuffer(ShaderStorageBufferRegistry::Get(0, 3), 0, 4);
+		cullPipeline->SetStorageBuffer(s_rendererData->meshBoundsBuffer, 0, 5);
+		cullPipeline->SetStorageBuffer(s_rendererData->visibilityBuffer, 0, 6);
+
+		const auto& compactPipeline = s_rendererData->indirectCompactPipeline;
+		compactPipeline->SetStorageBuffer(s_rendererData->indirectDrawBuffer, 0, 1, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+		compactPipeline->SetStorageBuffer(s_rendererData->visibilityBuffer, 0, 6);
+		compactPipeline->SetStorageBuffer(ShaderStorageBufferRegistry::Get(1, 4), 1, 4, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+		compactPipeline->SetStorageBuffer(s_rendererData->indirectCountBuffer, 1, 5, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+		compactPipeline->SetStorageBuffer(s_rendererData->passBatchMaskBuffer, 1, 6);
+	}
 
-		auto* drawCount = s_rendererData->indirectCountBuffer->Get(currentFrame)->Map<uint32_t>();
+	VkCommandBuffer Renderer::GetCullCommandBuffer()
+	{
+		return s_rendererData->asyncComputeFrame ? s_rendererData->computeCommandBuffer->GetCurrentCommandBuffer() : s_rendererData->commandBuffer->GetCurrentCommandBuffer();
+	}
+
+	void Renderer::ReadTimestamps()
+	{
+		if (!s_rendererData->timestampPool)
+		{
+			return;
+		}
 
-		std::vector<IndirectBatch>& draws = s_rendererData->indirectBatches;
+		// The slot is reused, so its previous frame has completed. The graphics queue waited for the compute work of that frame
+		const uint32_t frameIndex = s_rendererData->commandBuffer->GetCurrentIndex();
+		TimestampFrame& frame = s_rendererData->timestampFrames[frameIndex];
 
-		for (uint32_t i = 0; i < draws.size(); i++)
+		if (!frame.graphicsWritten)
 		{
-			drawCount[i] = 0;
+			return;
 		}
 
-		s_rendererData->indirectCountBuffer->Get(currentFrame)->Unmap();
-		s_rendererData->indirectCullPipeline->Bind(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), currentFrame);
+		std::array<uint64_t, TIMESTAMPS_PER_FRAME> timestamps{};
+		const uint32_t queryCount = frame.computeWritten ? TIMESTAMPS_PER_FRAME : 2;
 
-		// Set cull data
+		const VkResult result = vkGetQueryPoolResults(GraphicsContext::GetDevice()->GetHandle(), s_rendererData->timestampPool, frameIndex * TIMESTAMPS_PER_FRAME, queryCount, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
 		{
-			glm::mat4 projection = s_rendererData->passCamera->GetProjection();
-			glm::mat4 projectionTrans = glm::transpose(projection);
+			return;
+		}
+
+		const double tickToMs = (double)GraphicsContext::GetPhysicalDevice()->GetCapabilities().timestampPeriod / 1000000.0;
+		auto& statistics = s_rendererData->statistics;
 
-			glm::vec4 frustumX = Math::NormalizePlane(projectionTrans[3] + projectionTrans[0]);
-			glm::vec4 frustumY = Math::NormalizePlane(projectionTrans[3] + projectionTrans[1]);
+		statistics.asyncCompute = frame.computeWritten;
+		statistics.graphicsTime = (float)((double)(timestamps[1] - timestamps[0]) * tickToMs);
+		statistics.computeTime = 0.f;
+		statistics.overlapTime = 0.f;
+		statistics.overlapMeasured = false;
 
-			CullData cullData{};
-			cullData.view = s_rendererData->passCamera->GetView();
-			cullData.P00 = projection[0][0];
-			cullData.P11 = projection[1][1];
-			cullData.zNear = s_rendererData->passCamera->GetNearPlane();
-			cullData.zFar = s_rendererData->passCamera->GetFarPlane();
+		if (frame.computeWritten)
+		{
+			statistics.computeTime = (float)((double)(timestamps[3] - timestamps[2]) * tickToMs);
 
-			cullData.frustum[0] = frustumX.x;
-			cullData.frustum[1] = frustumX.z;
-			cullData.frustum[2] = frustumY.y;
-			cullData.frustum[3] = frustumY.z;
+			// Timestamps of different queues aren't guaranteed to be comparable, so both are placed on the host clock first
+			uint64_t calibrationDevice = 0;
+			uint64_t calibrationHost = 0;
 
-			cullData.drawCount = (uint32_t)s_rendererData->renderCommands.size();
+			if (GraphicsContext::GetDevice()->GetCalibratedTimestamps(calibrationDevice, calibrationHost))
+			{
+				const double tickToNs = (double)GraphicsContext::GetPhysicalDevice()->GetCapabilities().timestampPeriod;
+				auto toHostNs = [&](uint64_t timestamp)
+				{
+					return (double)calibrationHost - (double)(int64_t)(calibrationDevice - timestamp) * tickToNs;
+				};
 
-			cullData.cullingEnabled = true;
-			cullData.lodEnabled = true;
-			cullData.distCull = 0;
+				const double overlapBegin = std::max(toHostNs(timestamps[0]), toHostNs(timestamps[2]));
+				const double overlapEnd = std::min(toHostNs(timestamps[1]), toHostNs(timestamps[3]));
 
-			s_rendererData->indirectCullPipeline->SetPushConstant(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), sizeof(CullData), &cullData);
+				statistics.overlapTime = overlapEnd > overlapBegin ? (float)((overlapEnd - overlapBegin) / 1000000.0) : 0.f;
+				statistics.overlapMeasured = true;
+			}
 		}
 
-		const uint32_t dispatchCount = (uint32_t)(s_rendererData->renderCommands.size() / 256) + 1;
-		s_rendererData->indirectCullPipeline->DispatchNoUpdate(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), currentFrame, dispatchCount, 1, 1, s_rendererData->passIndex);
-		s_rendererData->indirectCullPipeline->InsertBarrier(s_rendererData->commandBuffer->GetCurrentCommandBuffer(), currentFrame, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+		frame = {};
 	}
 
 	void Renderer::GenerateBRDFLut()
@@ -880,10 +1370,156 @@ namespace Lamp
 		s_defaultData->brdfLut->TransitionToLayout(cmdBuffer, VK_IMAGE_LAYOUT_GENERAL);
 
 		brdfPipeline->Bind(cmdBuffer);
-		brdfPipeline->SetImage(s_defaultData->brdfLut, 0, 0, 0, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		brdfPipeline->SetImage(s_defaultData->brdfLut, 0, 0, 0, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 		brdfPipeline->Dispatch(cmdBuffer, 0, brdfSize / 32, brdfSize / 32, 1);
-		brdfPipeline->InsertBarrier(cmdBuffer, 0, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		brdfPipeline->InsertBarrier(cmdBuffer, 0, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
 
 		device->FlushCommandBuffer(cmdBuffer);
 	}
-}
\ No newline at end of file
+	void Renderer::FlushDeletionQueues()
+	{
+		LP_PROFILE_FUNCTION();
+
+		// Pending uploads have to be submitted first, so that the timeline value the retired resources are tagged with covers them
+		UploadManager::Update();
+		DeletionQueue::Update();
+	}
+
+	void Renderer::CreateRendererData(uint32_t framesInFlight)
+	{
+		s_rendererData = CreateScope<RendererData>();
+		s_rendererData->objectCapacity = BufferCapacity{ MIN_OBJECT_CAPACITY, OBJECT_SHRINK_FRAME_COUNT };
+		s_rendererData->viewCapacity = BufferCapacity{ MIN_VIEW_CAPACITY }; // the per-view buffers are small compared to the scene buffers, so they never shrink
+
+		const uint32_t objectCapacity = s_rendererData->objectCapacity.Get();
+		const uint32_t viewCapacity = s_rendererData->viewCapacity.Get();
+		s_invalidationQueues.resize(framesInFlight);
+
+		UniformBufferRegistry::Register(0, 1, UniformBufferSet::Create(sizeof(DirectionalLightData), framesInFlight));
+
+		// Per-view data is sliced from dynamic buffers with one element per view, the slice is picked with the pass index
+		UniformBufferRegistry::Register(1, 0, UniformBufferSet::Create(sizeof(CameraData), viewCapacity, framesInFlight));
+		UniformBufferRegistry::Register(1, 1, UniformBufferSet::Create(sizeof(TargetData), viewCapacity, framesInFlight));
+		UniformBufferRegistry::Register(1, 2, UniformBufferSet::Create(sizeof(PassData), viewCapacity, framesInFlight));
+
+		// Object data and draw commands are written by the CPU every frame, the object map and draw counts only by the cull shader
+		ShaderStorageBufferRegistry::Register(0, 3, ShaderStorageBufferSet::Create(sizeof(ObjectData) * objectCapacity, framesInFlight, false, StorageBufferMemory::DeviceUpload));
+		ShaderStorageBufferRegistry::Register(1, 4, ShaderStorageBufferSet::Create(sizeof(uint32_t) * objectCapacity, viewCapacity, framesInFlight, false, StorageBufferMemory::Device));
+		ShaderStorageBufferRegistry::Register(1, 5, ShaderStorageBufferSet::Create(sizeof(uint32_t) * objectCapacity, viewCapacity, framesInFlight, true, StorageBufferMemory::Device));
+		ShaderStorageBufferRegistry::Register(1, 6, ShaderStorageBufferSet::Create(sizeof(uint32_t) * Utility::GetVisibilityWordCount(objectCapacity), viewCapacity, framesInFlight, false, StorageBufferMemory::Host));
+
+		s_rendererData->indirectDrawBuffer = ShaderStorageBufferSet::Create(sizeof(GPUIndirectObject) * objectCapacity, framesInFlight, true, StorageBufferMemory::DeviceUpload);
+		s_rendererData->indirectCountBuffer = ShaderStorageBufferRegistry::Get(1, 5);
+		s_rendererData->meshBoundsBuffer = ShaderStorageBufferSet::Create(sizeof(glm::vec4) * objectCapacity, framesInFlight, false, StorageBufferMemory::DeviceUpload);
+		s_rendererData->visibilityBuffer = ShaderStorageBufferSet::Create(sizeof(uint32_t) * Utility::GetVisibilityWordCount(objectCapacity) * viewCapacity, framesInFlight, false, StorageBufferMemory::Device);
+		s_rendererData->passBatchMaskBuffer = ShaderStorageBufferRegistry::Get(1, 6);
+
+		s_rendererData->statistics.objectCapacity = objectCapacity;
+		s_rendererData->statistics.viewCapacity = viewCapacity;
+	}
+
+	void Renderer::UpdateObjectCapacity(uint32_t objectCount)
+	{
+		LP_PROFILE_FUNCTION();
+
+		const uint32_t oldCapacity = s_rendererData->objectCapacity.Get();
+		if (!s_rendererData->objectCapacity.Update(objectCount))
+		{
+			return;
+		}
+
+		const uint32_t newCapacity = s_rendererData->objectCapacity.Get();
+		LP_CORE_INFO("Resizing scene buffers from {0} to {1} objects", oldCapacity, newCapacity);
+
+		// The old buffers are kept alive by the deletion queue until the frames using them have retired
+		ShaderStorageBufferRegistry::Get(0, 3)->Resize(sizeof(ObjectData) * newCapacity);
+		ShaderStorageBufferRegistry::Get(1, 4)->Resize(sizeof(uint32_t) * newCapacity);
+
+		s_rendererData->indirectDrawBuffer->Resize(sizeof(GPUIndirectObject) * newCapacity);
+		s_rendererData->indirectCountBuffer->Resize(sizeof(uint32_t) * newCapacity);
+		s_rendererData->meshBoundsBuffer->Resize(sizeof(glm::vec4) * newCapacity);
+		s_rendererData->visibilityBuffer->Resize(sizeof(uint32_t) * Utility::GetVisibilityWordCount(newCapacity) * s_rendererData->viewCapacity.Get());
+		s_rendererData->passBatchMaskBuffer->Resize(sizeof(uint32_t) * Utility::GetVisibilityWordCount(newCapacity));
+
+		s_rendererData->statistics.objectCapacity = newCapacity;
+		s_rendererData->statistics.sceneBufferResizes++;
+
+		// The object map stride is a dynamic offset
+		for (const auto& [name, shader] : ShaderRegistry::GetAllShaders())
+		{
+			shader->UpdateStorageBufferOffsets();
+		}
+
+		if (s_rendererData->indirectCompactPipeline)
+		{
+			s_rendererData->indirectCompactPipeline->GetShader()->UpdateStorageBufferOffsets();
+		}
+
+		RefreshBufferBindings();
+	}
+
+	void Renderer::UpdateViewCapacity(uint32_t viewCount)
+	{
+		LP_PROFILE_FUNCTION();
+
+		const uint32_t oldCapacity = s_rendererData->viewCapacity.Get();
+		if (!s_rendererData->viewCapacity.Update(viewCount))
+		{
+			return;
+		}
+
+		const uint32_t newCapacity = s_rendererData->viewCapacity.Get();
+		LP_CORE_INFO("Resizing view buffers from {0} to {1} views", oldCapacity, newCapacity);
+
+		// The element sizes do not change, so the dynamic offsets stay the same
+		for (uint32_t binding = 0; binding < 3; binding++)
+		{
+			UniformBufferRegistry::Get(1, binding)->SetObjectCount(newCapacity);
+		}
+
+		ShaderStorageBufferRegistry::Get(1, 4)->SetElementCount(newCapacity);
+		s_rendererData->indirectCountBuffer->SetElementCount(newCapacity);
+		s_rendererData->passBatchMaskBuffer->SetElementCount(newCapacity);
+		s_rendererData->visibilityBuffer->Resize(sizeof(uint32_t) * Utility::GetVisibilityWordCount(s_rendererData->objectCapacity.Get()) * newCapacity);
+
+		s_rendererData->statistics.viewCapacity = newCapacity;
+		RefreshBufferBindings();
+	}
+
+	void Renderer::RefreshBufferBindings()
+	{
+		LP_PROFILE_FUNCTION();
+
+		s_rendererData->statistics.bufferBindingRefreshes++;
+
+		// A headless renderer has no pipelines or descriptor sets to re-point
+		if (!s_rendererData->indirectCullPipeline)
+		{
+			return;
+		}
+
+		s_rendererData->indirectCullPipeline->RefreshBuffers();
+		s_rendererData->indirectCompactPipeline->RefreshBuffers();
+
+		for (const auto& [name, pipeline] : RenderPipelineRegistry::GetAllPipelines())
+		{
+			if (pipeline->GetPipelineType() == PipelineType::Compute)
+			{
+				pipeline->GetComputePipeline()->RefreshBuffers();
+			}
+		}
+
+		// Descriptor sets of other frames may still be in use, they are re-pointed when their frame begins
+		const uint32_t currentFrame = Application::Get().GetWindow()->GetSwapchain().GetCurrentFrame();
+		Material::UpdateSharedBuffers(currentFrame);
+
+		std::scoped_lock lock{ s_invalidationMutex };
+		for (uint32_t i = 0; i < (uint32_t)s_invalidationQueues.size(); i++)
+		{
+			if (i != currentFrame)
+			{
+				s_invalidationQueues[i].Push([i]() { Material::UpdateSharedBuffers(i); });
+			}
+		}
+	}
+}
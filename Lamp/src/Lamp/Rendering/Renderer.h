@@ -1,14 +1,19 @@
 #pragma once
 
 #include "Lamp/Core/Base.h"
+#include "Lamp/Core/Graphics/BarrierBatch.h"
+#include "Lamp/Core/ThreadLocalBuffers.h"
 #include "Lamp/Asset/Mesh/SubMesh.h"
 #include "Lamp/Asset/Asset.h"
 
 #include "Lamp/Rendering/FunctionQueue.hpp"
 #include "Lamp/Rendering/RendererStructs.h"
+#include "Lamp/Rendering/Buffer/BufferCapacity.h"
+#include "Lamp/Rendering/RenderPipeline/PipelineCommon.h"
 
 #include <vulkan/vulkan.h>
 #include <functional>
+#include <mutex>
 
 namespace Lamp
 {
@@ -23,9 +28,11 @@ namespace Lamp
 	class Texture2D;
 	class Material;
 	class RenderPipelineCompute;
+	class ThreadPool;
+	class ThreadCommandPools;
 	class RenderPipeline;
 
-	class DependencyGraph;
+	class FrameGraph;
 
 	struct RenderCommand
 	{
@@ -48,6 +55,16 @@ namespace Lamp
 		uint32_t id;
 	};
 
+	// Everything submitted for a frame. It is built by the thread updating the application and only read by the thread recording the frame
+	struct FramePacket
+	{
+		std::vector<RenderCommand> renderCommands;
+		DirectionalLightData directionalLight;
+		Skybox environment;
+
+		std::vector<std::function<void()>> renderJobs; // record the frame, run in submission order
+	};
+
 	class Renderer
 	{
 	public:
@@ -57,15 +74,45 @@ namespace Lamp
 			Ref<MultiMaterial> defaultMaterial;
 
 			Ref<Texture2D> whiteTexture;
+			Ref<Texture2D> placeholderTexture; // bound in place of evicted textures while they reload
 			Ref<Image2D> blackCubeImage;
 			Ref<Image2D> brdfLut;
 		};
 
 		struct Capabilities
-		{};
+		{
+			bool asyncCompute = false; // culling can run on a dedicated compute queue
+			bool gpuTimestamps = false;
+		};
+
+		struct Statistics
+		{
+			bool asyncCompute = false; // the measured frame culled on the compute queue
+
+			// Milliseconds, measured on the last completed frame
+			float graphicsTime = 0.f;
+			float computeTime = 0.f;
+			float overlapTime = 0.f; // compute work running while the graphics queue was busy
+			bool overlapMeasured = false; // false without calibrated timestamps, the queues can't be compared then
+
+			// Recorded in the last frame, passes sharing a view share its cull
+			uint32_t culledViews = 0;
+			uint32_t compactedPasses = 0;
+			uint32_t viewCapacity = 0; // passes the per-view buffers currently have room for
+			uint32_t objectCapacity = 0; // draws the scene buffers currently have room for
+
+			// Since the renderer was initialized
+			uint32_t sceneBufferResizes = 0;
+			uint32_t bufferBindingRefreshes = 0;
+
+			// Issued in the last frame, the skipped calls were filtered by the bound state
+			PipelineBindState::Statistics binds;
+			uint32_t secondaryCommandBuffers = 0; // recorded on worker threads in the last frame
+		};
 
 		static void Initialize();
 		static void InitializeBuffers();
+		static void InitializeHeadless(); // only the submission and the capacity bookkeeping, for running without a device. Shut down with Shutdowm after DeletionQueue::Initialize
 
 		static void Shutdowm();
 
@@ -73,51 +120,126 @@ namespace Lamp
 		static void End();
 
 		static void ExecuteComputePass();
+		static void ExecuteFrameGraph(Ref<FrameGraph> frameGraph); // Barriers between the passes are recorded by the graph
+
+		// Every pass is a view with its own camera, target and draw lists. Has to be called before Begin with the number of passes the frame begins, the per-view buffers grow to it before recording
+		static void ReserveViews(uint32_t viewCount);
 
-		static void BeginPass(Ref<RenderPass> renderPass, Ref<Camera> camera, Ref<DependencyGraph> dependencyGraph);
-		static void EndPass(Ref<DependencyGraph> dependencyGraph);
+		static void BeginPass(Ref<RenderPass> renderPass, Ref<Camera> camera);
+		static void EndPass();
 
+		// Can be called from any thread, every thread appends to its own buffer. Submissions have to be finished before the frame packet is taken
 		static void Submit(Ref<Mesh> mesh, const glm::mat4& transform);
+
+		// Only from the thread taking the frame packets
 		static void SubmitDirectionalLight(const glm::mat4& transform, const glm::vec3& color, const float intensity);
 		static void SubmitEnvironment(const Skybox& environment);
 
 		static void DispatchRenderCommands();
 
-		static void SubmitResourceFree(std::function<void()>&& function);
+		// Jobs are run when the frame packet is rendered, they may only use what they capture and the submitted scene data
+		static void SubmitRenderJob(std::function<void()>&& job);
+
+		// Hands out the packet built since the last call with the commands of every submitting thread, the light and environment carry over into the next one
+		static Scope<FramePacket> TakeFramePacket();
+		static void RenderFramePacket(FramePacket& packet);
+
+		// The CPU side of the scene upload, Begin runs these on the frame's commands and writes into the mapped scene buffers.
+		// Orders the commands the way they are batched, the order is total so it does not depend on which thread submitted first
+		static void SortRenderCommands(std::vector<RenderCommand>& renderCommands);
+		// Sorts the commands and groups the ones sharing mesh, sub mesh and material into batches
+		static void PrepareForIndirectDraw(std::vector<RenderCommand>& renderCommands, std::vector<IndirectBatch>& outBatches);
+		// The arrays hold one element per command, the bounds one per mesh. The bounds indices are scratch space, cleared first
+		static void WriteRenderCommands(const std::vector<RenderCommand>& renderCommands, const std::vector<IndirectBatch>& batches, std::unordered_map<Mesh*, uint32_t>& meshBoundsIndices,
+			GPUIndirectObject* outDrawCommands, glm::vec4* outMeshBounds, ObjectData* outObjectData);
+		static CullData CreateCullData(const Camera& camera, uint32_t drawCount);
+		// Grows or shrinks the scene buffers to the frame's command count and re-points everything bound to them
+		static void UpdateObjectCapacity(uint32_t objectCount);
+
 		static void SubmitInvalidation(std::function<void()>&& function);
 
 		static Skybox GenerateEnvironmentMap(AssetHandle handle);
 
-		static VkDescriptorSet AllocateDescriptorSet(VkDescriptorSetAllocateInfo& allocInfo);
+		static VkDescriptorSet AllocateDescriptorSet(VkDescriptorSetAllocateInfo& allocInfo); // nullptr if the allocation failed
 		inline static const DefaultData& GetDefaultData() { return *s_defaultData; }
 
+		// Takes effect on the next frame, ignored when the device has no dedicated compute queue
+		static void SetAsyncComputeEnabled(bool enabled);
+		inline static const Capabilities& GetCapabilities() { return s_rendererData->capabilities; }
+		inline static const Statistics& GetStatistics() { return s_rendererData->statistics; }
+
 	private:
 		Renderer() = delete;
 		
 		static void CreateDefaultData();
 		static void CreateSamplers();
 
-		static void CreateDescriptorPools();
-		static void PrepareForIndirectDraw(std::vector<RenderCommand>& renderCommands);
-
 		static void UpdatePerPassBuffers();
 		static void UpdatePerFrameBuffers();
 
-		static void SortRenderCommands();
+		static void MergeSubmitBuffers(std::vector<RenderCommand>& outRenderCommands);
 		static void UploadRenderCommands();
 		static void CullRenderCommands();
+		static void PrepareMaterials();
+		static void RecordBatches(VkCommandBuffer commandBuffer, PipelineBindState& bindState, uint32_t firstBatch, uint32_t lastBatch);
+		static void RecordBatchesParallel();
+		static uint32_t CullView(const CullData& cullData, VkCommandBuffer commandBuffer);
+		static void UpdatePassBatchMask();
+		static void SetCullBuffers();
+		static VkCommandBuffer GetCullCommandBuffer();
+
+		static void ReadTimestamps();
 
 		static void GenerateBRDFLut();
+		static void FlushDeletionQueues();
+		static void CreateRendererData(uint32_t framesInFlight);
+		static void UpdateViewCapacity(uint32_t viewCount);
+		static void RefreshBufferBindings();
+
+		struct TimestampFrame
+		{
+			bool graphicsWritten = false;
+			bool computeWritten = false;
+		};
 
 		struct RendererData
 		{
 			Ref<CommandBuffer> commandBuffer;
+			Ref<CommandBuffer> computeCommandBuffer; // culling when async compute is used, submitted before the graphics work waiting on it
+
+			Capabilities capabilities;
+			Statistics statistics;
+
+			bool asyncComputeEnabled = false;
+			bool asyncComputeFrame = false; // whether the frame being recorded culls on the compute queue
+
+			VkQueryPool timestampPool = nullptr;
+			std::vector<TimestampFrame> timestampFrames;
 
 			Ref<ShaderStorageBufferSet> indirectDrawBuffer;
-			Ref<ShaderStorageBufferSet> indirectCountBuffer;
+			Ref<ShaderStorageBufferSet> indirectCountBuffer; // one slice per pass
 			Ref<ShaderStorageBufferSet> objectBuffer;
+			Ref<ShaderStorageBufferSet> meshBoundsBuffer; // local space bounding sphere per mesh drawn this frame
+			Ref<ShaderStorageBufferSet> visibilityBuffer; // one bit per draw for every view culled this frame
+			Ref<ShaderStorageBufferSet> passBatchMaskBuffer; // one bit per batch drawn by the pass
+
+			std::unordered_map<Mesh*, uint32_t> meshBoundsIndices; // mesh -> index into the bounds table
 
-			Ref<RenderPipelineCompute> indirectCullPipeline;
+			Ref<RenderPipelineCompute> indirectCullPipeline; // writes the visibility bits of a view
+			Ref<RenderPipelineCompute> indirectCompactPipeline; // builds the draw lists of a pass from the visibility bits
+
+			std::unordered_map<size_t, uint32_t> cullViews; // view hash -> visibility slice, reset every frame
+			std::vector<uint32_t> passBatchMask; // bits of the current pass
+			uint32_t frameCompactedPasses = 0;
+
+			BufferCapacity objectCapacity; // element count of the scene buffers
+
+			BufferCapacity viewCapacity; // element count of the per-view buffers
+			uint32_t reservedViewCount = 0;
+
+			Scope<FramePacket> submitPacket; // written by the submit functions, the rest of the data belongs to the frame being recorded
+
+			ThreadLocalBuffers<RenderCommand> submitBuffers; // one per thread which has submitted, registrations end with the renderer data
 
 			std::vector<RenderCommand> renderCommands;
 			std::vector<IndirectBatch> indirectBatches;
@@ -126,12 +248,20 @@ namespace Lamp
 			Ref<RenderPass> currentPass;
 			uint32_t passIndex = 0;
 
+			BarrierBatch barrierBatch;
+			PipelineBindState bindState; // graphics state of the frame's command buffer, kept across passes
+
+			Ref<ThreadPool> recordThreadPool;
+			Ref<ThreadCommandPools> threadCommandPools;
+			std::vector<VkCommandBuffer> chunkCommandBuffers; // secondary buffers of the current pass, in batch order
+			std::vector<PipelineBindState::Statistics> chunkStatistics;
+			uint32_t passBatchCount = 0; // batches drawn by the current pass
+			uint32_t frameSecondaryCommandBuffers = 0;
+			bool recordParallel = false; // the current pass is recorded into secondary command buffers
 			std::vector<Ref<Material>> frameUpdatedMaterials;
 			
 			Skybox skyboxData;
 
-			std::vector<VkDescriptorPool> descriptorPools;
-
 			/////Uniform data//////
 			DirectionalLightData directionalLight;
 			///////////////////////
@@ -139,7 +269,7 @@ namespace Lamp
 
 		inline static Scope<DefaultData> s_defaultData;
 		inline static Scope<RendererData> s_rendererData;
-		inline static std::vector<FunctionQueue> s_frameDeletionQueues;
 		inline static std::vector<FunctionQueue> s_invalidationQueues;
+		inline static std::mutex s_invalidationMutex; // invalidations can be submitted while the render thread flushes them
 	};
 }
\ No newline at end of file
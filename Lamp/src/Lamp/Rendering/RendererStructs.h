@@ -33,8 +33,7 @@ namespace Lamp
 
 	struct ObjectData
 	{
-		glm::mat4 transform;
-		glm::vec4 sphereBounds;
+		glm::mat3x4 transform; // transposed affine transform, the columns are the rows of the model matrix
 	};	
 
 	struct ObjectMapData
@@ -58,7 +57,7 @@ namespace Lamp
 		VkDrawIndexedIndirectCommand command;
 		uint32_t objectId;
 		uint32_t batchId;
-		uint32_t padding;
+		uint32_t boundsIndex; // index into the mesh bounds table
 	};
 
 	struct CullData
@@ -70,6 +69,7 @@ namespace Lamp
 		float pyramidWidth, pyramidHeight;
 
 		uint32_t drawCount;
+		uint32_t visibilityOffset; // first word of the view's visibility bits
 
 		int cullingEnabled;
 		int lodEnabled;
@@ -84,4 +84,10 @@ namespace Lamp
 		float aabbmax_y;
 		float aabbmax_z;
 	};
+
+	struct CompactData
+	{
+		uint32_t drawCount;
+		uint32_t visibilityOffset;
+	};
 }
\ No newline at end of file
@@ -9,7 +9,14 @@
 #include "Lamp/Rendering/RenderGraph.h"
 #include "Lamp/Rendering/RenderPass/RenderPass.h"
 #include "Lamp/Rendering/Framebuffer.h"
-#include "Lamp/Rendering/DependencyGraph.h"
+#include "Lamp/Rendering/FrameGraph.h"
+
+#include "Lamp/Rendering/RenderPipeline/RenderPipelineRegistry.h"
+#include "Lamp/Rendering/RenderPipeline/RenderPipelineCompute.h"
+#include "Lamp/Rendering/RenderPipeline/RenderPipeline.h"
+#include "Lamp/Asset/RenderPipelineAsset.h"
+
+#include "Lamp/Utility/ImageUtility.h"
 
 #include "Lamp/Components/Components.h"
 #include "Lamp/Scene/Scene.h"
@@ -18,11 +25,37 @@
 
 namespace Lamp
 {
+	namespace Utility
+	{
+		// Attachments of other passes sampled by the pipeline
+		inline static const std::vector<FramebufferInput>& GetFramebufferInputs(const Ref<RenderPipelineAsset>& pipeline)
+		{
+			if (pipeline->GetPipelineType() == PipelineType::Compute)
+			{
+				return pipeline->GetComputePipeline()->GetFramebufferInputs();
+			}
+
+			return pipeline->GetGraphicsPipeline()->GetSpecification().framebufferInputs;
+		}
+
+		inline static const std::string& GetPipelineRenderPass(const Ref<RenderPipelineAsset>& pipeline)
+		{
+			if (pipeline->GetPipelineType() == PipelineType::Compute)
+			{
+				return pipeline->GetComputePipeline()->GetRenderPass();
+			}
+
+			return pipeline->GetGraphicsPipeline()->GetSpecification().renderPass;
+		}
+	}
+
 	SceneRenderer::SceneRenderer(Ref<Scene> scene, const std::filesystem::path& renderGraphPath)
 		: m_scene(scene)
 	{
 		m_renderGraph = AssetManager::GetAsset<RenderGraph>(renderGraphPath);
-		m_dependencyGraph = DependencyGraph::Create(m_renderGraph);
+
+		BuildFrameGraph();
+		RealizeFrameGraph();
 
 		auto& registry = m_scene->GetRegistry();
 	}
@@ -36,18 +69,6 @@ namespace Lamp
 	{
 		LP_PROFILE_FUNCTION();
 
-		if (m_shouldResize)
-		{
-			m_shouldResize = false;
-			for (auto& pass : m_renderGraph->GetRenderPasses())
-			{
-				if (pass.renderPass->resizeable)
-				{
-					pass.renderPass->framebuffer->Resize(m_resizeSize.x, m_resizeSize.y);
-				}
-			}
-		}
-
 		auto& registry = m_scene->GetRegistry();
 
 		registry.ForEach<MeshComponent, TransformComponent>([](Wire::EntityId id, const MeshComponent& meshComp, TransformComponent& transformComp)
@@ -99,28 +120,46 @@ namespace Lamp
 				}
 			});
 
-		{
-			LP_PROFILE_SCOPE("SceneRenderer::Render");
+		// The frame is recorded when its packet is rendered, the camera may have moved on and the renderer may have been released by then
+		const bool shouldResize = m_shouldResize;
+		m_shouldResize = false;
+
+		Renderer::SubmitRenderJob([self = shared_from_this(), camera = CreateRef<Camera>(*camera), shouldResize, resizeSize = m_resizeSize]()
+			{
+				self->Render(camera, shouldResize, resizeSize);
+			});
+	}
+
+	void SceneRenderer::Render(Ref<Camera> camera, bool shouldResize, const glm::uvec2& resizeSize)
+	{
+		LP_PROFILE_FUNCTION();
 
-			Renderer::Begin();
+		// Framebuffers can only be resized by the thread recording them
+		if (shouldResize)
+		{
+			// The images are resized in dedicated memory first, the aliased memory is sized from their new requirements
+			m_frameGraph->ReleaseTransientMemory();
 
-			for (const auto& pass : m_renderGraph->GetRenderPasses())
+			for (auto& pass : m_renderGraph->GetRenderPasses())
 			{
-				Renderer::BeginPass(pass.renderPass, camera, m_dependencyGraph);
-				if (pass.renderPass->computePipeline)
-				{
-					Renderer::ExecuteComputePass();
-				}
-				else [[likely]]
+				if (pass.renderPass->resizeable)
 				{
-					Renderer::DispatchRenderCommands();
+					pass.renderPass->framebuffer->Resize(resizeSize.x, resizeSize.y);
 				}
-				Renderer::EndPass(m_dependencyGraph);
-
 			}
 
-			Renderer::End();
+			RealizeFrameGraph();
 		}
+
+		m_camera = camera;
+
+		// Every scheduled pass is a view
+		Renderer::ReserveViews((uint32_t)m_frameGraph->GetSchedule().size());
+		Renderer::Begin();
+		Renderer::ExecuteFrameGraph(m_frameGraph);
+		Renderer::End();
+
+		m_camera = nullptr;
 	}
 
 	void SceneRenderer::OnUpdate(float deltaTime)
@@ -137,4 +176,202 @@ namespace Lamp
 	{
 		m_scene = newScene;
 	}
+
+	void SceneRenderer::BuildFrameGraph()
+	{
+		m_frameGraph = FrameGraph::Create();
+
+		const std::unordered_set<Image2D*> persistentImages = FindPersistentImages();
+
+		std::unordered_map<Image2D*, FrameGraphResource> imageResources;
+		auto getImageResource = [&](Ref<Image2D> image, const std::string& name)
+		{
+			auto it = imageResources.find(image.get());
+			if (it != imageResources.end())
+			{
+				return it->second;
+			}
+
+			// Attachments are cleared or fully written every frame, so their memory can be shared once nothing in the graph reads them anymore
+			const FrameGraphResource resource = m_frameGraph->ImportImage(name, image, !persistentImages.contains(image.get()));
+			imageResources.emplace(image.get(), resource);
+
+			return resource;
+		};
+
+		for (const auto& container : m_renderGraph->GetRenderPasses())
+		{
+			const Ref<RenderPass> renderPass = container.renderPass;
+			const bool isCompute = renderPass->computePipeline != nullptr;
+
+			const FrameGraphPass pass = m_frameGraph->AddPass(renderPass->name, isCompute ? FrameGraphPassType::Compute : FrameGraphPassType::Graphics, [this, renderPass](VkCommandBuffer)
+				{
+					ExecutePass(renderPass);
+				});
+
+			// Attachments of other passes sampled by the pipelines drawn in this pass
+			for (const auto& [name, pipeline] : RenderPipelineRegistry::GetAllPipelines())
+			{
+				if (Utility::GetPipelineRenderPass(pipeline) != renderPass->name)
+				{
+					continue;
+				}
+
+				for (const auto& input : Utility::GetFramebufferInputs(pipeline))
+				{
+					const FrameGraphResource resource = getImageResource(input.framebuffer->GetColorAttachment(input.attachmentIndex), renderPass->name + ".input" + std::to_string(input.attachmentIndex));
+					m_frameGraph->Read(pass, resource, FrameGraphAccess::SampledRead);
+				}
+			}
+
+			const auto& framebuffer = renderPass->framebuffer;
+			const auto& specification = framebuffer->GetSpecification();
+
+			for (uint32_t index = 0; index < (uint32_t)specification.attachments.size(); index++)
+			{
+				if (Utility::IsDepthFormat(specification.attachments.at(index).format))
+				{
+					const bool existingDepth = specification.existingDepth != nullptr;
+					const FrameGraphResource resource = getImageResource(framebuffer->GetDepthAttachment(), renderPass->name + ".depth");
+
+					if (isCompute)
+					{
+						m_frameGraph->Write(pass, resource, FrameGraphAccess::StorageWrite);
+					}
+					else
+					{
+						m_frameGraph->Write(pass, resource, existingDepth ? FrameGraphAccess::DepthAttachmentReadWrite : FrameGraphAccess::DepthAttachmentWrite);
+					}
+				}
+				else
+				{
+					const bool existingImage = specification.existingImages.contains(index);
+					const FrameGraphResource resource = getImageResource(framebuffer->GetColorAttachment(index), renderPass->name + ".color" + std::to_string(index));
+
+					if (isCompute)
+					{
+						m_frameGraph->Write(pass, resource, FrameGraphAccess::StorageWrite);
+					}
+					else
+					{
+						m_frameGraph->Write(pass, resource, existingImage ? FrameGraphAccess::ColorAttachmentReadWrite : FrameGraphAccess::ColorAttachmentWrite);
+					}
+				}
+			}
+		}
+
+		// The final image is sampled by the editor after the graph has run
+		if (!m_renderGraph->GetRenderPasses().empty())
+		{
+			const Ref<Framebuffer> finalFramebuffer = GetFinalFramebuffer();
+			m_frameGraph->MarkOutput(getImageResource(finalFramebuffer->GetColorAttachment(0), "output"), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		}
+	}
+
+	std::unordered_set<Image2D*> SceneRenderer::FindPersistentImages() const
+	{
+		std::unordered_set<Image2D*> persistentImages;
+		std::unordered_set<Image2D*> writtenImages;
+		std::unordered_set<std::string> graphPasses;
+
+		for (const auto& container : m_renderGraph->GetRenderPasses())
+		{
+			graphPasses.emplace(container.renderPass->name);
+		}
+
+		// Read before a pass of the graph has written them, the contents come from outside of the graph
+		auto read = [&](const Ref<Image2D>& image)
+		{
+			if (!writtenImages.contains(image.get()))
+			{
+				persistentImages.emplace(image.get());
+			}
+		};
+
+		// Sampled by pipelines drawn outside of the graph
+		for (const auto& [name, pipeline] : RenderPipelineRegistry::GetAllPipelines())
+		{
+			if (graphPasses.contains(Utility::GetPipelineRenderPass(pipeline)))
+			{
+				continue;
+			}
+
+			for (const auto& input : Utility::GetFramebufferInputs(pipeline))
+			{
+				persistentImages.emplace(input.framebuffer->GetColorAttachment(input.attachmentIndex).get());
+			}
+		}
+
+		for (const auto& container : m_renderGraph->GetRenderPasses())
+		{
+			const Ref<RenderPass> renderPass = container.renderPass;
+
+			for (const auto& [name, pipeline] : RenderPipelineRegistry::GetAllPipelines())
+			{
+				if (Utility::GetPipelineRenderPass(pipeline) != renderPass->name)
+				{
+					continue;
+				}
+
+				for (const auto& input : Utility::GetFramebufferInputs(pipeline))
+				{
+					read(input.framebuffer->GetColorAttachment(input.attachmentIndex));
+				}
+			}
+
+			const auto& framebuffer = renderPass->framebuffer;
+			const auto& specification = framebuffer->GetSpecification();
+
+			for (uint32_t index = 0; index < (uint32_t)specification.attachments.size(); index++)
+			{
+				const bool isDepth = Utility::IsDepthFormat(specification.attachments.at(index).format);
+				const Ref<Image2D> image = isDepth ? framebuffer->GetDepthAttachment() : framebuffer->GetColorAttachment(index);
+
+				// Existing images are loaded
+				if (isDepth ? specification.existingDepth != nullptr : specification.existingImages.contains(index))
+				{
+					read(image);
+				}
+
+				writtenImages.emplace(image.get());
+			}
+		}
+
+		// The editor samples the final image after the graph has run
+		if (!m_renderGraph->GetRenderPasses().empty())
+		{
+			persistentImages.emplace(m_renderGraph->GetRenderPasses().back().renderPass->framebuffer->GetColorAttachment(0).get());
+		}
+
+		return persistentImages;
+	}
+
+	void SceneRenderer::RealizeFrameGraph()
+	{
+		m_frameGraph->Compile();
+		m_frameGraph->Realize();
+
+		// Compiling releases the previously aliased memory, so the images are always recreated
+		for (const auto& pass : m_renderGraph->GetRenderPasses())
+		{
+			pass.renderPass->framebuffer->Invalidate();
+		}
+
+		const auto& stats = m_frameGraph->GetStatistics();
+		LP_CORE_INFO("Frame graph compiled: {0} passes, {1} culled, {2} barriers, {3} transient bytes in {4} aliased bytes", stats.passCount, stats.culledPassCount, stats.barrierCount, stats.transientBytes, stats.aliasedBytes);
+	}
+
+	void SceneRenderer::ExecutePass(Ref<RenderPass> renderPass)
+	{
+		Renderer::BeginPass(renderPass, m_camera);
+		if (renderPass->computePipeline)
+		{
+			Renderer::ExecuteComputePass();
+		}
+		else [[likely]]
+		{
+			Renderer::DispatchRenderCommands();
+		}
+		Renderer::EndPass();
+	}
 }
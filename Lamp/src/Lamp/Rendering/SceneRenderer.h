@@ -3,6 +3,8 @@
 #include "Lamp/Core/Base.h"
 
 #include <filesystem>
+#include <memory>
+#include <unordered_set>
 
 
 namespace Lamp
@@ -11,12 +13,15 @@ namespace Lamp
 	class Camera;
 	class RenderGraph;
 	class Framebuffer;
-	class DependencyGraph;
-	class SceneRenderer
+	class FrameGraph;
+	class RenderPass;
+	class Image2D;
+	class SceneRenderer : public std::enable_shared_from_this<SceneRenderer>
 	{
 	public:
 		SceneRenderer(Ref<Scene> scene, const std::filesystem::path& renderGraphPath);
 
+		// Submits the scene and a job recording it with a copy of the camera
 		void OnRender(Ref<Camera> camera);
 		void OnUpdate(float deltaTime);
 
@@ -24,14 +29,21 @@ namespace Lamp
 		void SetScene(Ref<Scene> newScene);
 
 		Ref<Framebuffer> GetFinalFramebuffer();
+		inline const Ref<FrameGraph> GetFrameGraph() const { return m_frameGraph; }
 
 	private:
+		void Render(Ref<Camera> camera, bool shouldResize, const glm::uvec2& resizeSize);
+		void BuildFrameGraph();
+		std::unordered_set<Image2D*> FindPersistentImages() const; // attachments read outside of the graph, they are not aliased
+		void RealizeFrameGraph();
+		void ExecutePass(Ref<RenderPass> renderPass);
 
 		bool m_shouldResize = false;
 		glm::uvec2 m_resizeSize = { 1, 1 };
 
 		Ref<RenderGraph> m_renderGraph;
-		Ref<DependencyGraph> m_dependencyGraph;
+		Ref<FrameGraph> m_frameGraph;
 		Ref<Scene> m_scene;
+		Ref<Camera> m_camera; // camera of the frame being recorded
 	};
 }
\ No newline at end of file
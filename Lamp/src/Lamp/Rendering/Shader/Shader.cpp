@@ -5,6 +5,7 @@
 
 #include "Lamp/Core/Graphics/GraphicsContext.h"
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/DescriptorLayoutCache.h"
 
 #include "Lamp/Core/Application.h"
 #include "Lamp/Core/Window.h"
@@ -16,6 +17,7 @@
 #include "Lamp/Rendering/Buffer/ShaderStorageBuffer/ShaderStorageBufferSet.h"
 
 #include "ShaderCompiler.h"
+#include "ShaderModuleCache.h"
 
 #include <shaderc/shaderc.hpp>
 #include <file_includer.h>
@@ -29,18 +31,20 @@ namespace Lamp
 	/////ShaderResources/////
 	void Shader::ShaderResources::Clear()
 	{
-		for (const auto& set : paddedSetLayouts)
-		{
-			vkDestroyDescriptorSetLayout(GraphicsContext::GetDevice()->GetHandle(), set, nullptr);
-		}
-
+		// Layouts are owned by the descriptor layout cache
+		pipelineLayout = nullptr;
+		sharedSetMask = 0;
 		paddedSetLayouts.clear();
 		realSetLayouts.clear();
+		realSetNumbers.clear();
 		pushConstantRanges.clear();
+		poolSizes.clear();
 		uniformBuffersInfos.clear();
 		storageBuffersInfos.clear();
+		storageImagesInfos.clear();
 		imageInfos.clear();
 		writeDescriptors.clear();
+		dynamicBufferOffsets.clear();
 	}
 	/////////////////////////
 
@@ -115,6 +119,57 @@ namespace Lamp
 		m_renderPipelineReferences.erase(it);
 	}
 
+	void Shader::UpdateStorageBufferOffsets()
+	{
+		for (auto& info : m_resources.storageBuffersInfos)
+		{
+			if (!info.isDynamic)
+			{
+				continue;
+			}
+
+			const uint32_t set = ShaderResources::GetSet(info.key);
+			const uint32_t binding = ShaderResources::GetBinding(info.key);
+			const uint64_t dynamicAlignment = ShaderStorageBufferRegistry::Get(set, binding)->Get(0)->GetOffsetSize();
+
+			info.info.range = dynamicAlignment;
+
+			DynamicOffset* dynamicOffset = ShaderResources::Find(m_resources.dynamicBufferOffsets, set, binding);
+			if (dynamicOffset)
+			{
+				dynamicOffset->offset = (uint32_t)dynamicAlignment;
+			}
+		}
+	}
+
+	uint64_t Shader::GetCPUMemorySize() const
+	{
+		uint64_t size = sizeof(Shader);
+		for (const auto& [stage, source] : m_shaderSources)
+		{
+			size += source.capacity();
+		}
+
+		return size;
+	}
+
+	uint64_t Shader::ReleaseCPUData()
+	{
+		if (IsFlagSet(AssetFlag::RetainCPUData))
+		{
+			return 0;
+		}
+
+		uint64_t releasedBytes = 0;
+		for (const auto& [stage, source] : m_shaderSources)
+		{
+			releasedBytes += source.capacity();
+		}
+
+		m_shaderSources.clear();
+		return releasedBytes;
+	}
+
 	Ref<Shader> Shader::Create(const std::string& name, std::initializer_list<std::filesystem::path> paths, bool forceCompile)
 	{
 		return CreateRef<Shader>(name, paths, forceCompile);
@@ -148,13 +203,15 @@ namespace Lamp
 
 		for (const auto& stage : m_pipelineShaderStageInfos)
 		{
-			vkDestroyShaderModule(GraphicsContext::GetDevice()->GetHandle(), stage.module, nullptr);
+			ShaderModuleCache::Release(stage.module);
 		}
 
 		m_pipelineShaderStageInfos.clear();
 
 		m_perStageUBOCount.clear();
+		m_perStageDynamicUBOCount.clear();
 		m_perStageSSBOCount.clear();
+		m_perStageDynamicSSBOCount.clear();
 		m_perStageImageCount.clear();
 		m_perStageStorageImageCount.clear();
 	}
@@ -207,23 +264,14 @@ namespace Lamp
 
 	void Shader::LoadAndCreateShaders(const std::unordered_map<VkShaderStageFlagBits, std::vector<uint32_t>>& shaderData)
 	{
-		auto device = GraphicsContext::GetDevice();
 		m_pipelineShaderStageInfos.clear();
 
 		for (const auto& [stage, data] : shaderData)
 		{
-			VkShaderModuleCreateInfo moduleInfo{};
-			moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-			moduleInfo.codeSize = data.size() * sizeof(uint32_t);
-			moduleInfo.pCode = data.data();
-
-			VkShaderModule shaderModule;
-			LP_VK_CHECK(vkCreateShaderModule(device->GetHandle(), &moduleInfo, nullptr, &shaderModule));
-
 			VkPipelineShaderStageCreateInfo& shaderStage = m_pipelineShaderStageInfos.emplace_back();
 			shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 			shaderStage.stage = stage;
-			shaderStage.module = shaderModule;
+			shaderStage.module = ShaderModuleCache::GetOrCreate(data);
 			shaderStage.pName = "main";
 		}
 	}
@@ -268,7 +316,8 @@ namespace Lamp
 				layoutBinding.descriptorType = set == 1 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 				layoutBinding.stageFlags = stage;
 
-				UniformBuffer& bufferInfo = m_resources.uniformBuffersInfos[set][binding];
+				UniformBuffer& bufferInfo = m_resources.uniformBuffersInfos.emplace_back();
+				bufferInfo.key = ShaderResources::PackKey(set, binding);
 				bufferInfo.info.offset = 0;
 				bufferInfo.info.range = size;
 				bufferInfo.isDynamic = set == 1;
@@ -284,16 +333,9 @@ namespace Lamp
 					}
 
 					bufferInfo.info.range = dynamicAlignment;
-					m_resources.dynamicBufferOffsets[set].emplace_back(DynamicOffset{ dynamicAlignment, binding });
+					m_resources.dynamicBufferOffsets.emplace_back(DynamicOffset{ dynamicAlignment, bufferInfo.key });
 				}
 
-				VkWriteDescriptorSet& writeDescriptor = m_resources.writeDescriptors[set][binding];
-				writeDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				writeDescriptor.pNext = nullptr;
-				writeDescriptor.dstBinding = binding;
-				writeDescriptor.descriptorCount = 1;
-				writeDescriptor.descriptorType = set == 1 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-
 				if (bufferInfo.isDynamic)
 				{
 					m_perStageDynamicUBOCount[stage].count++;
@@ -328,7 +370,8 @@ namespace Lamp
 				layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 				layoutBinding.stageFlags = stage;
 
-				ShaderStorageBuffer& bufferInfo = m_resources.storageBuffersInfos[set][binding];
+				ShaderStorageBuffer& bufferInfo = m_resources.storageBuffersInfos.emplace_back();
+				bufferInfo.key = ShaderResources::PackKey(set, binding);
 				bufferInfo.info.offset = 0;
 				bufferInfo.info.range = size;
 				bufferInfo.writeable = !(bool)nonWritable;
@@ -341,16 +384,9 @@ namespace Lamp
 					const uint64_t dynamicAlignment = ShaderStorageBufferRegistry::Get(set, binding)->Get(0)->GetOffsetSize();
 
 					bufferInfo.info.range = dynamicAlignment;
-					m_resources.dynamicBufferOffsets[set].emplace_back(DynamicOffset{ (uint32_t)dynamicAlignment, binding });
+					m_resources.dynamicBufferOffsets.emplace_back(DynamicOffset{ (uint32_t)dynamicAlignment, bufferInfo.key });
 				}
 
-				VkWriteDescriptorSet& writeDescriptor = m_resources.writeDescriptors[set][binding];
-				writeDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				writeDescriptor.pNext = nullptr;
-				writeDescriptor.dstBinding = binding;
-				writeDescriptor.descriptorCount = 1;
-				writeDescriptor.descriptorType = set == 1 ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-
 				if (bufferInfo.isDynamic)
 				{
 					m_perStageDynamicSSBOCount[stage].count++;
@@ -405,17 +441,11 @@ namespace Lamp
 				layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 				layoutBinding.stageFlags = stage;
 
-				StorageImage& imageInfo = m_resources.storageImagesInfos[set][binding];
+				StorageImage& imageInfo = m_resources.storageImagesInfos.emplace_back();
+				imageInfo.key = ShaderResources::PackKey(set, binding);
 				imageInfo.info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
 				imageInfo.writeable = !(bool)nonWritable;
 
-				VkWriteDescriptorSet& writeDescriptor = m_resources.writeDescriptors[set][binding];
-				writeDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				writeDescriptor.pNext = nullptr;
-				writeDescriptor.dstBinding = binding;
-				writeDescriptor.descriptorCount = 1;
-				writeDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-
 				m_perStageStorageImageCount[stage].count++;
 			}
 			else
@@ -438,7 +468,8 @@ namespace Lamp
 				layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 				layoutBinding.stageFlags = stage;
 
-				SampledImage& imageInfo = m_resources.imageInfos[set][binding];
+				SampledImage& imageInfo = m_resources.imageInfos.emplace_back();
+				imageInfo.key = ShaderResources::PackKey(set, binding);
 
 				const auto& type = compiler.get_type(image.type_id);
 
@@ -455,13 +486,6 @@ namespace Lamp
 				VkDescriptorImageInfo& descriptorInfo = imageInfo.info;
 				descriptorInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-				VkWriteDescriptorSet& writeDescriptor = m_resources.writeDescriptors[set][binding];
-				writeDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				writeDescriptor.pNext = nullptr;
-				writeDescriptor.dstBinding = binding;
-				writeDescriptor.descriptorCount = 1;
-				writeDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-
 				m_perStageImageCount[stage].count++;
 			}
 			else
@@ -482,39 +506,99 @@ namespace Lamp
 	{
 		int32_t lastSet = -1;
 
-		for (auto& [set, offsets] : m_resources.dynamicBufferOffsets)
+		auto sortByKey = [](auto& table)
 		{
-			std::sort(offsets.begin(), offsets.end(), [](const DynamicOffset& lhs, const DynamicOffset& rhs)
-				{
-					return lhs.binding < rhs.binding;
-				});
-		}
+			std::sort(table.begin(), table.end(), [](const auto& lhs, const auto& rhs) { return lhs.key < rhs.key; });
+		};
+
+		sortByKey(m_resources.uniformBuffersInfos);
+		sortByKey(m_resources.storageBuffersInfos);
+		sortByKey(m_resources.storageImagesInfos);
+		sortByKey(m_resources.imageInfos);
+		sortByKey(m_resources.dynamicBufferOffsets);
 
 		for (const auto& [set, bindings] : setLayoutBindings)
 		{
 			while ((int32_t)set > lastSet + 1)
 			{
-				VkDescriptorSetLayoutCreateInfo layoutInfo{};
-				layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-				layoutInfo.pNext = nullptr;
-				layoutInfo.bindingCount = 0;
-				layoutInfo.pBindings = nullptr;
-
-				vkCreateDescriptorSetLayout(GraphicsContext::GetDevice()->GetHandle(), &layoutInfo, nullptr, &m_resources.paddedSetLayouts.emplace_back());
+				m_resources.paddedSetLayouts.emplace_back(DescriptorLayoutCache::GetOrCreateSetLayout({}));
 				lastSet++;
 			}
 
-			VkDescriptorSetLayoutCreateInfo layoutInfo{};
-			layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-			layoutInfo.pNext = nullptr;
-			layoutInfo.bindingCount = (uint32_t)bindings.size();
-			layoutInfo.pBindings = bindings.data();
-
-			vkCreateDescriptorSetLayout(GraphicsContext::GetDevice()->GetHandle(), &layoutInfo, nullptr, &m_resources.paddedSetLayouts.emplace_back());
+			m_resources.paddedSetLayouts.emplace_back(DescriptorLayoutCache::GetOrCreateSetLayout(bindings));
 			m_resources.realSetLayouts.emplace_back(m_resources.paddedSetLayouts.back());
+			m_resources.realSetNumbers.emplace_back(set);
 			lastSet = set;
 		}
 
+		m_resources.pipelineLayout = DescriptorLayoutCache::GetOrCreatePipelineLayout(m_resources.paddedSetLayouts, m_resources.pushConstantRanges);
+
+		// Write descriptors
+		{
+			auto addWrite = [&](uint32_t key, VkDescriptorType descriptorType, ResourceType type, uint32_t resourceIndex)
+			{
+				WriteDescriptor& writeDescriptor = m_resources.writeDescriptors.emplace_back();
+				writeDescriptor.key = key;
+				writeDescriptor.type = type;
+				writeDescriptor.resourceIndex = resourceIndex;
+
+				writeDescriptor.write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeDescriptor.write.pNext = nullptr;
+				writeDescriptor.write.dstBinding = ShaderResources::GetBinding(key);
+				writeDescriptor.write.descriptorCount = 1;
+				writeDescriptor.write.descriptorType = descriptorType;
+			};
+
+			for (uint32_t i = 0; i < (uint32_t)m_resources.uniformBuffersInfos.size(); i++)
+			{
+				const auto& info = m_resources.uniformBuffersInfos[i];
+				addWrite(info.key, info.isDynamic ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, ResourceType::UniformBuffer, i);
+			}
+
+			for (uint32_t i = 0; i < (uint32_t)m_resources.storageBuffersInfos.size(); i++)
+			{
+				const auto& info = m_resources.storageBuffersInfos[i];
+				addWrite(info.key, info.isDynamic ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, ResourceType::StorageBuffer, i);
+			}
+
+			for (uint32_t i = 0; i < (uint32_t)m_resources.storageImagesInfos.size(); i++)
+			{
+				addWrite(m_resources.storageImagesInfos[i].key, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, ResourceType::StorageImage, i);
+			}
+
+			for (uint32_t i = 0; i < (uint32_t)m_resources.imageInfos.size(); i++)
+			{
+				addWrite(m_resources.imageInfos[i].key, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, ResourceType::SampledImage, i);
+			}
+
+			std::sort(m_resources.writeDescriptors.begin(), m_resources.writeDescriptors.end(), [](const WriteDescriptor& lhs, const WriteDescriptor& rhs) { return lhs.key < rhs.key; });
+
+			for (auto& writeDescriptor : m_resources.writeDescriptors)
+			{
+				const uint32_t set = ShaderResources::GetSet(writeDescriptor.key);
+				auto it = std::lower_bound(m_resources.realSetNumbers.begin(), m_resources.realSetNumbers.end(), set);
+
+				writeDescriptor.setIndex = (uint32_t)std::distance(m_resources.realSetNumbers.begin(), it);
+			}
+
+			// Sets which only hold registry buffers look the same for every material using the layout, so they can be shared
+			for (uint32_t i = 0; i < (uint32_t)m_resources.realSetNumbers.size(); i++)
+			{
+				if (m_resources.realSetNumbers[i] != (uint32_t)DescriptorSetType::PerMaterial)
+				{
+					m_resources.sharedSetMask |= 1u << i;
+				}
+			}
+
+			for (const auto& writeDescriptor : m_resources.writeDescriptors)
+			{
+				if (writeDescriptor.type == ResourceType::StorageImage || writeDescriptor.type == ResourceType::SampledImage)
+				{
+					m_resources.sharedSetMask &= ~(1u << writeDescriptor.setIndex);
+				}
+			}
+		}
+
 		VkDescriptorSetAllocateInfo& allocInfo = m_resources.setAllocInfo;
 		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 		allocInfo.descriptorSetCount = (uint32_t)m_resources.realSetLayouts.size();
@@ -35,9 +35,18 @@ namespace Lamp
 			HLSL
 		};
 
+		enum class ResourceType : uint32_t
+		{
+			UniformBuffer,
+			StorageBuffer,
+			StorageImage,
+			SampledImage
+		};
+
 		struct ShaderStorageBuffer
 		{
 			VkDescriptorBufferInfo info{};
+			uint32_t key = 0;
 			bool writeable = true;
 			bool isDynamic = false;
 		};
@@ -45,48 +54,93 @@ namespace Lamp
 		struct UniformBuffer
 		{
 			VkDescriptorBufferInfo info{};
+			uint32_t key = 0;
 			bool isDynamic = false;
 		};
 
 		struct StorageImage
 		{
 			VkDescriptorImageInfo info{};
+			uint32_t key = 0;
 			bool writeable = true;
 		};
 
 		struct SampledImage
 		{
 			VkDescriptorImageInfo info{};
+			uint32_t key = 0;
 			ImageDimension dimension{};
 		};
 
 		struct DynamicOffset
 		{
 			uint32_t offset;
-			uint32_t binding;
+			uint32_t key;
+		};
+
+		struct WriteDescriptor
+		{
+			VkWriteDescriptorSet write{};
+			uint32_t key = 0;
+			uint32_t setIndex = 0; // index into realSetLayouts
+			uint32_t resourceIndex = 0; // index into the table of the resource type
+
+			ResourceType type = ResourceType::UniformBuffer;
 		};
 
+		// All resource tables are flat and sorted by their packed (set, binding) key
 		struct ShaderResources
 		{
 			std::unordered_map<uint32_t, std::string> shaderTextureDefinitions; // binding -> name
 
 			std::vector<VkDescriptorSetLayout> paddedSetLayouts;
 			std::vector<VkDescriptorSetLayout> realSetLayouts;
+			std::vector<uint32_t> realSetNumbers; // real set layout index -> set
+
+			VkPipelineLayout pipelineLayout = nullptr;
+			uint32_t sharedSetMask = 0; // bit per real set index, set if it only holds registry buffers
 
 			std::vector<VkPushConstantRange> pushConstantRanges;
 			std::vector<VkDescriptorPoolSize> poolSizes;
 			
-			std::map<uint32_t, std::map<uint32_t, UniformBuffer>> uniformBuffersInfos; // set -> binding -> infos
-			std::map<uint32_t, std::map<uint32_t, ShaderStorageBuffer>> storageBuffersInfos; // set -> binding -> infos
-			std::map<uint32_t, std::map<uint32_t, StorageImage>> storageImagesInfos; // set -> binding -> infos
-			std::map<uint32_t, std::map<uint32_t, SampledImage>> imageInfos; // set -> binding -> infos
-			std::map<uint32_t, std::map<uint32_t, VkWriteDescriptorSet>> writeDescriptors; // set -> binding -> write
+			std::vector<UniformBuffer> uniformBuffersInfos;
+			std::vector<ShaderStorageBuffer> storageBuffersInfos;
+			std::vector<StorageImage> storageImagesInfos;
+			std::vector<SampledImage> imageInfos;
+			std::vector<WriteDescriptor> writeDescriptors;
 
-			std::map<uint32_t, std::vector<DynamicOffset>> dynamicBufferOffsets; // set -> offsets
+			std::vector<DynamicOffset> dynamicBufferOffsets;
 
 			VkDescriptorSetAllocateInfo setAllocInfo{};
 			
 			void Clear();
+
+			static constexpr uint32_t PackKey(uint32_t set, uint32_t binding) { return (set << 16) | binding; }
+			static constexpr uint32_t GetSet(uint32_t key) { return key >> 16; }
+			static constexpr uint32_t GetBinding(uint32_t key) { return key & 0xFFFF; }
+
+			template<typename T>
+			static auto Find(T& table, uint32_t set, uint32_t binding) -> decltype(table.data())
+			{
+				const uint32_t key = PackKey(set, binding);
+				auto it = std::lower_bound(table.begin(), table.end(), key, [](const auto& lhs, uint32_t rhs) { return lhs.key < rhs; });
+				
+				if (it == table.end() || it->key != key)
+				{
+					return nullptr;
+				}
+
+				return &(*it);
+			}
+
+			template<typename T>
+			static auto FindSet(T& table, uint32_t set)
+			{
+				auto begin = std::lower_bound(table.begin(), table.end(), PackKey(set, 0), [](const auto& lhs, uint32_t rhs) { return lhs.key < rhs; });
+				auto end = std::lower_bound(begin, table.end(), PackKey(set + 1, 0), [](const auto& lhs, uint32_t rhs) { return lhs.key < rhs; });
+
+				return std::make_pair(begin, end);
+			}
 		};
 
 		Shader(const std::string& name, std::initializer_list<std::filesystem::path> paths, bool forceCompile);
@@ -97,6 +151,9 @@ namespace Lamp
 		bool Reload(bool forceCompile);
 		void AddReference(RenderPipeline* renderPipeline);
 		void RemoveReference(RenderPipeline* renderPipeline);
+
+		// Re-reads the offset sizes of dynamic registry storage buffers, needed after they have been resized
+		void UpdateStorageBufferOffsets();
 	
 		inline const std::vector<VkPipelineShaderStageCreateInfo>& GetStageInfos() const { return m_pipelineShaderStageInfos; }
 		inline const ShaderResources& GetResources() const { return m_resources; }
@@ -105,6 +162,8 @@ namespace Lamp
 
 		static AssetType GetStaticType() { return AssetType::Shader; }
 		AssetType GetType() override { return GetStaticType(); }
+		uint64_t GetCPUMemorySize() const override;
+		uint64_t ReleaseCPUData() override;
 
 		static Ref<Shader> Create(const std::string& name, std::initializer_list<std::filesystem::path> paths, bool forceCompile = false);
 		static Ref<Shader> Create(const std::string& name, std::vector<std::filesystem::path> paths, bool forceCompile = false);
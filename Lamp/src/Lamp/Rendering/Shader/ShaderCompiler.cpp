@@ -12,6 +12,10 @@
 
 #include <combaseapi.h>
 
+#ifdef LP_ENABLE_SHADER_OPTIMIZATION
+#include <spirv-tools/optimizer.hpp>
+#endif
+
 namespace Lamp
 {
 	namespace Utils
@@ -147,6 +151,11 @@ namespace Lamp
 			outShaderData = std::vector<uint32_t>(compileResult.cbegin(), compileResult.cend());
 		}
 
+		if (!OptimizeSPIRV(path, outShaderData))
+		{
+			LP_CORE_WARN("Failed to optimize shader {0}! Using unoptimized binary.", path.string().c_str());
+		}
+
 		// Cache shader
 		{
 			std::ofstream output(cachedPath, std::ios::binary | std::ios::out);
@@ -233,6 +242,11 @@ namespace Lamp
 			outShaderData.resize(size / sizeof(uint32_t));
 			memcpy_s(outShaderData.data(), size, result->GetBufferPointer(), size);
 			result->Release();
+
+			if (!OptimizeSPIRV(path, outShaderData))
+			{
+				LP_CORE_WARN("Failed to optimize shader {0}! Using unoptimized binary.", path.string().c_str());
+			}
 		}
 
 		// Cache shader
@@ -258,6 +272,35 @@ namespace Lamp
 		return true;
 	}
 
+	bool ShaderCompiler::OptimizeSPIRV(const std::filesystem::path& path, std::vector<uint32_t>& shaderData)
+	{
+#ifdef LP_ENABLE_SHADER_OPTIMIZATION
+		spvtools::Optimizer optimizer{ SPV_ENV_VULKAN_1_3 };
+		optimizer.SetMessageConsumer([&path](spv_message_level_t level, const char*, const spv_position_t&, const char* message)
+			{
+				if (level <= SPV_MSG_ERROR)
+				{
+					LP_CORE_ERROR("SPIR-V optimizer: {0} ({1})", message, path.string().c_str());
+				}
+			});
+
+		optimizer.RegisterPerformancePasses();
+		optimizer.RegisterPass(spvtools::CreateStripDebugInfoPass());
+		optimizer.RegisterPass(spvtools::CreateStripNonSemanticInfoPass());
+
+		std::vector<uint32_t> optimizedData;
+		if (!optimizer.Run(shaderData.data(), shaderData.size(), &optimizedData))
+		{
+			return false;
+		}
+
+		LP_CORE_TRACE("Optimized shader {0}: {1} -> {2} bytes", path.string().c_str(), shaderData.size() * sizeof(uint32_t), optimizedData.size() * sizeof(uint32_t));
+		shaderData = std::move(optimizedData);
+#endif
+
+		return true;
+	}
+
 	bool ShaderCompiler::PreprocessGLSL(const VkShaderStageFlagBits stage, const std::filesystem::path& path, std::string& source, shaderc::Compiler& compiler, const shaderc::CompileOptions& compileOptions)
 	{
 		shaderc::PreprocessedSourceCompilationResult preProcessResult = compiler.PreprocessGlsl(source, Utility::VulkanToShaderCStage(stage), path.string().c_str(), compileOptions);
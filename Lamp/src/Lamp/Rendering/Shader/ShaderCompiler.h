@@ -36,6 +36,7 @@ namespace Lamp
 	
 		static bool CompileGLSL(const VkShaderStageFlagBits stage, const std::string& src, const std::filesystem::path& path, std::vector<uint32_t>& outShaderData);
 		static bool CompileHLSL(const VkShaderStageFlagBits stage, const std::string& src, const std::filesystem::path& path, std::vector<uint32_t>& outShaderData);
+		static bool OptimizeSPIRV(const std::filesystem::path& path, std::vector<uint32_t>& shaderData); // leaves the binary untouched if the optimizer fails
 
 		static bool PreprocessGLSL(const VkShaderStageFlagBits stage, const std::filesystem::path& path, std::string& source, shaderc::Compiler& compiler, const shaderc::CompileOptions& compileOptions);
 		static bool PreprocessHLSL(const VkShaderStageFlagBits stage, const std::filesystem::path& path, std::string& source);
@@ -0,0 +1,117 @@
+#include "lppch.h"
+#include "ShaderModuleCache.h"
+
+#include "Lamp/Log/Log.h"
+
+#include "Lamp/Core/Graphics/GraphicsContext.h"
+#include "Lamp/Core/Graphics/GraphicsDevice.h"
+
+#include "Lamp/Rendering/Shader/ShaderUtility.h"
+
+namespace Lamp
+{
+	VkShaderModule ShaderModuleCache::GetOrCreate(const std::vector<uint32_t>& data)
+	{
+		const size_t hash = HashBinary(data);
+
+		std::scoped_lock lock{ s_mutex };
+
+		std::vector<CachedModule>& bucket = s_cache[hash];
+		for (CachedModule& cachedModule : bucket)
+		{
+			if (cachedModule.binary == data)
+			{
+				cachedModule.referenceCount++;
+				return cachedModule.shaderModule;
+			}
+		}
+
+		VkShaderModuleCreateInfo moduleInfo{};
+		moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		moduleInfo.codeSize = data.size() * sizeof(uint32_t);
+		moduleInfo.pCode = data.data();
+
+		VkShaderModule shaderModule = nullptr;
+		LP_VK_CHECK(vkCreateShaderModule(GraphicsContext::GetDevice()->GetHandle(), &moduleInfo, nullptr, &shaderModule));
+
+		CachedModule& cachedModule = bucket.emplace_back();
+		cachedModule.shaderModule = shaderModule;
+		cachedModule.referenceCount = 1;
+		cachedModule.binary = data;
+
+		s_moduleHashes[shaderModule] = hash;
+
+		return shaderModule;
+	}
+
+	void ShaderModuleCache::Release(VkShaderModule shaderModule)
+	{
+		std::scoped_lock lock{ s_mutex };
+
+		auto hashIt = s_moduleHashes.find(shaderModule);
+		if (hashIt == s_moduleHashes.end())
+		{
+			LP_CORE_ERROR("Trying to release shader module which is not in the module cache!");
+			return;
+		}
+
+		auto bucketIt = s_cache.find(hashIt->second);
+		LP_CORE_ASSERT(bucketIt != s_cache.end(), "Shader module is missing from the module cache!");
+
+		std::vector<CachedModule>& bucket = bucketIt->second;
+		auto it = std::find_if(bucket.begin(), bucket.end(), [shaderModule](const CachedModule& cachedModule) { return cachedModule.shaderModule == shaderModule; });
+		LP_CORE_ASSERT(it != bucket.end(), "Shader module is missing from the module cache!");
+
+		it->referenceCount--;
+
+		if (it->referenceCount == 0)
+		{
+			vkDestroyShaderModule(GraphicsContext::GetDevice()->GetHandle(), it->shaderModule, nullptr);
+
+			bucket.erase(it);
+			if (bucket.empty())
+			{
+				s_cache.erase(bucketIt);
+			}
+
+			s_moduleHashes.erase(hashIt);
+		}
+	}
+
+	ShaderModuleCache::Statistics ShaderModuleCache::GetStatistics()
+	{
+		std::scoped_lock lock{ s_mutex };
+
+		Statistics stats{};
+
+		for (const auto& [hash, bucket] : s_cache)
+		{
+			for (const CachedModule& cachedModule : bucket)
+			{
+				const uint64_t size = cachedModule.binary.size() * sizeof(uint32_t);
+
+				stats.uniqueModules++;
+				stats.requestedModules += cachedModule.referenceCount;
+				stats.requestedSize += size * cachedModule.referenceCount;
+				stats.uniqueSize += size;
+			}
+		}
+
+		return stats;
+	}
+
+	void ShaderModuleCache::LogStatistics()
+	{
+		const Statistics stats = GetStatistics();
+
+		LP_CORE_INFO("Shader module cache:");
+		LP_CORE_INFO("	Modules: {0} requested, {1} created", stats.requestedModules, stats.uniqueModules);
+		LP_CORE_INFO("	Size: {0} bytes requested, {1} bytes created", stats.requestedSize, stats.uniqueSize);
+	}
+
+	size_t ShaderModuleCache::HashBinary(const std::vector<uint32_t>& data)
+	{
+		const std::string_view binary{ (const char*)data.data(), data.size() * sizeof(uint32_t) };
+		return Utility::HashCombine(std::hash<std::string_view>()(binary), data.size());
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Lamp/Core/Base.h"
+
+#include <vulkan/vulkan.h>
+
+#include <unordered_map>
+#include <mutex>
+#include <vector>
+
+namespace Lamp
+{
+	class ShaderModuleCache
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t requestedModules = 0;
+			uint32_t uniqueModules = 0;
+
+			uint64_t requestedSize = 0;
+			uint64_t uniqueSize = 0;
+		};
+
+		static VkShaderModule GetOrCreate(const std::vector<uint32_t>& data);
+		static void Release(VkShaderModule shaderModule);
+
+		static Statistics GetStatistics();
+		static void LogStatistics();
+
+	private:
+		ShaderModuleCache() = delete;
+
+		struct CachedModule
+		{
+			VkShaderModule shaderModule = nullptr;
+			uint32_t referenceCount = 0;
+			std::vector<uint32_t> binary; // compared on a hash hit, so colliding binaries get their own modules
+		};
+
+		static size_t HashBinary(const std::vector<uint32_t>& data);
+
+		inline static std::unordered_map<size_t, std::vector<CachedModule>> s_cache; // binary hash -> modules with that hash
+		inline static std::unordered_map<VkShaderModule, size_t> s_moduleHashes; // module -> binary hash
+		inline static std::mutex s_mutex;
+	};
+}
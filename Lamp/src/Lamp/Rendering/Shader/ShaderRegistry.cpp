@@ -5,6 +5,8 @@
 
 #include "Lamp/Asset/AssetManager.h"
 #include "Lamp/Rendering/Shader/Shader.h"
+#include "Lamp/Rendering/Shader/ShaderModuleCache.h"
+#include "Lamp/Core/Graphics/DescriptorLayoutCache.h"
 
 #include "Lamp/Utility/FileSystem.h"
 #include "Lamp/Utility/StringUtility.h"
@@ -64,5 +66,8 @@ namespace Lamp
 				Register(shader->GetName(), shader);
 			}
 		}
+
+		ShaderModuleCache::LogStatistics();
+		DescriptorLayoutCache::LogStatistics();
 	}
 }
\ No newline at end of file
@@ -12,9 +12,16 @@ namespace Lamp
 {
 	namespace Utility
 	{
+		// Binaries built with different debug info and optimization settings are cached separately
 		inline std::filesystem::path GetShaderCacheDirectory()
 		{
-			return std::filesystem::path("Engine/Shaders/Cache/");
+#if defined(LP_ENABLE_SHADER_DEBUG)
+			return std::filesystem::path("Engine/Shaders/Cache/Debug/");
+#elif defined(LP_ENABLE_SHADER_OPTIMIZATION)
+			return std::filesystem::path("Engine/Shaders/Cache/Optimized/");
+#else
+			return std::filesystem::path("Engine/Shaders/Cache/Default/");
+#endif
 		}
 
 		inline std::filesystem::path GetShaderDefinitionsDirectory()
@@ -5,8 +5,9 @@
 
 #include "Lamp/Core/Graphics/GraphicsContext.h"
 #include "Lamp/Core/Graphics/GraphicsDevice.h"
+#include "Lamp/Core/Graphics/DeletionQueue.h"
+#include "Lamp/Core/Graphics/BarrierBatch.h"
 
-#include "Lamp/Rendering/Renderer.h"
 #include "Lamp/Rendering/Texture/SamplerLibrary.h"
 
 #include "Lamp/Utility/ImageUtility.h"
@@ -27,9 +28,10 @@ namespace Lamp
 	void Image2D::Invalidate(const void* data)
 	{
 		Release();
-		m_imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		m_subresourceStates.assign((size_t)m_specification.mips * m_specification.layers, SubresourceState{});
 
-		VulkanAllocator allocator{ "Image2D - Create" };
+		const MemoryCategory category = m_specification.usage == ImageUsage::Texture ? MemoryCategory::Texture : MemoryCategory::RenderTarget;
+		VulkanAllocator allocator{ "Image2D - Create", category };
 		auto device = GraphicsContext::GetDevice();
 
 		VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT;
@@ -96,7 +98,14 @@ namespace Lamp
 			imageInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 		}
 
-		m_bufferAllocation = allocator.AllocateImage(imageInfo, VMA_MEMORY_USAGE_GPU_ONLY, m_image);
+		if (m_aliasedMemory)
+		{
+			allocator.CreateAliasingImage(m_aliasedMemory, imageInfo, m_image);
+		}
+		else
+		{
+			m_bufferAllocation = allocator.AllocateImage(imageInfo, VMA_MEMORY_USAGE_GPU_ONLY, m_image);
+		}
 
 		if (data)
 		{
@@ -126,6 +135,7 @@ namespace Lamp
 				Utility::TransitionImageLayout(m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
 				allocator.DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+				SetLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 			}
 		}
 
@@ -168,18 +178,12 @@ namespace Lamp
 			return;
 		}
 
-		Renderer::SubmitResourceFree([imageViews = m_imageViews, image = m_image, bufferAllocation = m_bufferAllocation]()
-			{
-				auto device = GraphicsContext::GetDevice();
-
-				for (auto& imageView : imageViews)
-				{
-					vkDestroyImageView(device->GetHandle(), imageView.second, nullptr);
-				}
+		for (const auto& [mip, imageView] : m_imageViews)
+		{
+			DeletionQueue::RetireImageView(imageView);
+		}
 
-				VulkanAllocator allocator{ "Image2D - Destroy" };
-				allocator.DestroyImage(image, bufferAllocation);
-			});
+		DeletionQueue::RetireImage(m_image, m_bufferAllocation);
 
 		m_imageViews.clear();
 		m_image = nullptr;
@@ -188,22 +192,11 @@ namespace Lamp
 
 	void Image2D::TransitionToLayout(VkCommandBuffer commandBuffer, VkImageLayout targetLayout)
 	{
-		if (m_imageLayout == targetLayout)
-		{
-			return;
-		}
-
-		const VkImageAspectFlags flag = Utility::IsDepthFormat(m_specification.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
-
-		VkImageSubresourceRange subresourceRange{};
-		subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		subresourceRange.baseArrayLayer = 0;
-		subresourceRange.baseMipLevel = 0;
-		subresourceRange.layerCount = m_specification.layers;
-		subresourceRange.levelCount = m_specification.mips;
+		const auto [stage, access] = Utility::GetStageAndAccessFromLayout(targetLayout);
 
-		Utility::TransitionImageLayout(commandBuffer, m_image, m_imageLayout, targetLayout, subresourceRange);
-		m_imageLayout = targetLayout;
+		BarrierBatch barriers;
+		barriers.TransitionImage(*this, targetLayout, stage, access);
+		barriers.Flush(commandBuffer);
 	}
 
 	void Image2D::GenerateMips(bool readOnly, VkCommandBuffer commandBuffer)
@@ -220,92 +213,71 @@ namespace Lamp
 			cmdBuffer = commandBuffer;
 		}
 
-		VkImageMemoryBarrier barrier{};
-		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.image = m_image;
-		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.srcAccessMask = 0;
-		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.oldLayout = m_imageLayout;
-		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		barrier.subresourceRange.baseMipLevel = 0;
-		barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
-		barrier.subresourceRange.layerCount = 1;
-
-		const uint32_t mipLevels = GetMipCount();
-		m_specification.mips = mipLevels;
-
-		for (uint32_t layer = 0; layer < m_specification.layers; layer++)
+		const uint32_t mipLevels = m_specification.mips;
+
+		const VkImageLayout targetLayout = readOnly ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+		const auto [targetStage, targetAccess] = Utility::GetStageAndAccessFromLayout(targetLayout);
+
+		VkImageSubresourceRange mipRange = GetSubresourceRange();
+		mipRange.levelCount = 1;
+
+		BarrierBatch barriers;
+
+		// The first mip is the source of the first blit, the rest are written before they are read
+		if (mipLevels > 1)
+		{
+			VkImageSubresourceRange remainingRange = GetSubresourceRange();
+			remainingRange.baseMipLevel = 1;
+			remainingRange.levelCount = mipLevels - 1;
+
+			barriers.TransitionImage(*this, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, mipRange);
+			barriers.TransitionImage(*this, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, remainingRange);
+		}
+		else
 		{
-			barrier.subresourceRange.baseArrayLayer = layer;
-			vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+			barriers.TransitionImage(*this, targetLayout, targetStage, targetAccess);
 		}
 
+		barriers.Flush(cmdBuffer);
+
 		for (uint32_t i = 1; i < mipLevels; i++)
 		{
-			for (uint32_t layer = 0; layer < m_specification.layers; layer++)
-			{
-				// Transfer last mip
-				{
-					barrier.subresourceRange.baseMipLevel = i - 1;
-					barrier.subresourceRange.baseArrayLayer = layer;
-					barrier.subresourceRange.levelCount = 1;
-					barrier.subresourceRange.layerCount = 1;
-
-					barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-					barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-					barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-					vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-				}
-
-				// Perform blit
-				{
-					VkImageBlit imageBlit{};
-					imageBlit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-					imageBlit.srcSubresource.layerCount = 1;
-					imageBlit.srcSubresource.mipLevel = i - 1;
-					imageBlit.srcSubresource.baseArrayLayer = layer;
-
-					imageBlit.srcOffsets[0] = { 0, 0, 0 };
-					imageBlit.srcOffsets[1] = { int32_t(m_specification.width >> (i - 1)), int32_t(m_specification.height >> (i - 1)), 1 };
-
-					imageBlit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-					imageBlit.dstSubresource.layerCount = 1;
-					imageBlit.dstSubresource.mipLevel = i;
-					imageBlit.dstSubresource.baseArrayLayer = layer;
-
-					imageBlit.dstOffsets[0] = { 0, 0, 0 };
-					imageBlit.dstOffsets[1] = { int32_t(m_specification.width >> i), int32_t(m_specification.height >> i), 1 };
-
-					vkCmdBlitImage(cmdBuffer, m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_LINEAR);
-				}
-
-				// Transfer last mip back
-				{
-					barrier.srcAccessMask = 0;
-					barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-					barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-					barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-
-					vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-				}
-			}
-		}
+			// All layers of a mip are blitted at once
+			VkImageBlit imageBlit{};
+			imageBlit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			imageBlit.srcSubresource.layerCount = m_specification.layers;
+			imageBlit.srcSubresource.mipLevel = i - 1;
+			imageBlit.srcSubresource.baseArrayLayer = 0;
 
-		VkImageSubresourceRange subresourceRange{};
-		subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		subresourceRange.baseArrayLayer = 0;
-		subresourceRange.baseMipLevel = 0;
-		subresourceRange.layerCount = m_specification.layers;
-		subresourceRange.levelCount = m_specification.mips;
+			imageBlit.srcOffsets[0] = { 0, 0, 0 };
+			imageBlit.srcOffsets[1] = { std::max(int32_t(m_specification.width >> (i - 1)), 1), std::max(int32_t(m_specification.height >> (i - 1)), 1), 1 };
 
-		const VkImageLayout targetLayout = readOnly ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+			imageBlit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			imageBlit.dstSubresource.layerCount = m_specification.layers;
+			imageBlit.dstSubresource.mipLevel = i;
+			imageBlit.dstSubresource.baseArrayLayer = 0;
+
+			imageBlit.dstOffsets[0] = { 0, 0, 0 };
+			imageBlit.dstOffsets[1] = { std::max(int32_t(m_specification.width >> i), 1), std::max(int32_t(m_specification.height >> i), 1), 1 };
+
+			vkCmdBlitImage(cmdBuffer, m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_LINEAR);
+
+			// The source is done, the destination becomes the source of the next blit
+			mipRange.baseMipLevel = i - 1;
+			barriers.TransitionImage(*this, targetLayout, targetStage, targetAccess, mipRange);
+
+			mipRange.baseMipLevel = i;
+			if (i + 1 < mipLevels)
+			{
+				barriers.TransitionImage(*this, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, mipRange);
+			}
+			else
+			{
+				barriers.TransitionImage(*this, targetLayout, targetStage, targetAccess, mipRange);
+			}
 
-		Utility::TransitionImageLayout(cmdBuffer, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, targetLayout, subresourceRange);
+			barriers.Flush(cmdBuffer);
+		}
 
 		if (!commandBuffer)
 		{
@@ -313,7 +285,6 @@ namespace Lamp
 		}
 
 		m_hasGeneratedMips = true;
-		m_imageLayout = targetLayout;
 	}
 
 	VkImageView Image2D::CreateMipView(uint32_t mip)
@@ -355,11 +326,66 @@ namespace Lamp
 		return m_imageViews.at(mip);
 	}
 
+	VkImageSubresourceRange Image2D::GetSubresourceRange() const
+	{
+		VkImageAspectFlags aspectMask = Utility::IsDepthFormat(m_specification.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+		if (m_specification.format == ImageFormat::DEPTH24STENCIL8)
+		{
+			aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+		}
+
+		return { aspectMask, 0, m_specification.mips, 0, m_specification.layers };
+	}
+
+	void Image2D::SetLayout(VkImageLayout layout)
+	{
+		// Whatever happened before is only known to have finished by the end of the pipeline
+		SetState(layout, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT);
+	}
+
+	void Image2D::SetState(VkImageLayout layout, VkPipelineStageFlags2 stage, VkAccessFlags2 access)
+	{
+		for (auto& state : m_subresourceStates)
+		{
+			state = { layout, stage, access };
+		}
+	}
+
+	void Image2D::SetAliasedMemory(VmaAllocation allocation)
+	{
+		m_aliasedMemory = allocation;
+	}
+
+	VkMemoryRequirements Image2D::GetMemoryRequirements() const
+	{
+		VkMemoryRequirements memoryRequirements{};
+		if (m_image)
+		{
+			auto device = GraphicsContext::GetDevice();
+			vkGetImageMemoryRequirements(device->GetHandle(), m_image, &memoryRequirements);
+		}
+
+		return memoryRequirements;
+	}
+
 	const uint32_t Image2D::GetMipCount() const
 	{
 		return Utility::CalculateMipCount(m_specification.width, m_specification.height);
 	}
 
+	const uint64_t Image2D::GetMemorySize() const
+	{
+		if (!m_bufferAllocation)
+		{
+			return 0;
+		}
+
+		VmaAllocationInfo allocInfo{};
+		vmaGetAllocationInfo(VulkanAllocator::GetAllocator(), m_bufferAllocation, &allocInfo);
+
+		return (uint64_t)allocInfo.size;
+	}
+
 	Ref<Image2D> Image2D::Create(const ImageSpecification& specification, const void* data)
 	{
 		return CreateRef<Image2D>(specification, data);
@@ -4,12 +4,20 @@
 #include "Lamp/Rendering/Texture/ImageCommon.h"
 
 #include <map>
+#include <vector>
 
 namespace Lamp
 {
 	class Image2D
 	{
 	public:
+		struct SubresourceState
+		{
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags2 stage = VK_PIPELINE_STAGE_2_NONE; // accesses since the last barrier
+			VkAccessFlags2 access = VK_ACCESS_2_NONE;
+		};
+
 		Image2D(const ImageSpecification& specification, const void* data = nullptr);
 		~Image2D();
 
@@ -20,6 +28,10 @@ namespace Lamp
 		void GenerateMips(bool readOnly, VkCommandBuffer commandBuffer = nullptr);
 		VkImageView CreateMipView(uint32_t mip);
 
+		// Places the image in memory owned by someone else on the next invalidation, null returns it to a dedicated allocation
+		void SetAliasedMemory(VmaAllocation allocation);
+		VkMemoryRequirements GetMemoryRequirements() const;
+
 		inline const VkImage GetHandle() const { return m_image; };
 		inline const ImageFormat GetFormat() const { return m_specification.format; }
 		inline const ImageSpecification& GetSpecification() const { return m_specification; }
@@ -27,24 +39,37 @@ namespace Lamp
 		inline const uint32_t GetWidth() const { return m_specification.width; }
 		inline const uint32_t GetHeight() const { return m_specification.height; }
 		const uint32_t GetMipCount() const;
+		const uint64_t GetMemorySize() const;
 
 		inline const VkImageView GetView(uint32_t index = 0) const { return m_imageViews.at(index); }
 		inline const VkSampler GetSampler() const { return m_sampler; }
-		inline const VkImageLayout GetLayout() const { return m_imageLayout; }
+		inline const VkImageLayout GetLayout(uint32_t mip = 0, uint32_t layer = 0) const { return m_subresourceStates.empty() ? VK_IMAGE_LAYOUT_UNDEFINED : m_subresourceStates.at(layer * m_specification.mips + mip).layout; }
+		inline const SubresourceState& GetSubresourceState(uint32_t mip, uint32_t layer) const { return m_subresourceStates.at(layer * m_specification.mips + mip); }
+		VkImageSubresourceRange GetSubresourceRange() const;
+		inline const bool IsAliased() const { return m_aliasedMemory != nullptr; }
 
 		static Ref<Image2D> Create(const ImageSpecification& specification, const void* data = nullptr);
 
 	private:
 		friend class RenderPipelineCompute;
-		friend class ImageBarrier;
+		friend class BarrierBatch;
+		friend class FrameGraph;
+		friend class DefaultTextureImporter;
+		friend class DDSTextureImporter;
+
+		// Sets every subresource, used after work recorded outside of the tracking, e.g. uploads
+		void SetLayout(VkImageLayout layout);
+		void SetState(VkImageLayout layout, VkPipelineStageFlags2 stage, VkAccessFlags2 access);
+		inline SubresourceState& GetState(uint32_t mip, uint32_t layer) { return m_subresourceStates[layer * m_specification.mips + mip]; }
 
 		ImageSpecification m_specification;
 
 		VmaAllocation m_bufferAllocation = nullptr;
+		VmaAllocation m_aliasedMemory = nullptr;
 		VkImage m_image = nullptr;
 
 		VkFormat m_format = VK_FORMAT_R8G8B8A8_UNORM;
-		VkImageLayout m_imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		std::vector<SubresourceState> m_subresourceStates; // layer * mips + mip
 		VkSampler m_sampler;
 
 		std::map<uint32_t, VkImageView> m_imageViews;
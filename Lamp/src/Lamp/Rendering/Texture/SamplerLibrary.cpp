@@ -13,11 +13,10 @@ namespace Lamp
 {
 	void SamplerLibrary::Shutdown()
 	{
-		auto device = GraphicsContext::GetDevice();
-
+		// A headless renderer never created a device or samplers
 		for (const auto& [hash, sampler] : m_samplers)
 		{
-			vkDestroySampler(device->GetHandle(), sampler, nullptr);
+			vkDestroySampler(GraphicsContext::GetDevice()->GetHandle(), sampler, nullptr);
 		}
 
 		m_samplers.clear();
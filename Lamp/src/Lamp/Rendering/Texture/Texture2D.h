@@ -4,6 +4,8 @@
 
 #include "Lamp/Rendering/Texture/Image2D.h"
 
+#include <atomic>
+
 namespace Lamp
 {
 	class Texture2D : public Asset
@@ -19,16 +21,29 @@ namespace Lamp
 		const uint32_t GetHeight() const;
 
 		inline const Ref<Image2D> GetImage() const { return m_image; }
+		inline const bool IsResident() const { return m_isResident.load(); }
+		inline const uint32_t GetGeneration() const { return m_generation; }
+		inline const uint64_t GetLastUsedFrame() const { return m_lastUsedFrame.load(); }
 
 		static AssetType GetStaticType() { return AssetType::Texture; }
 		AssetType GetType() override { return GetStaticType(); }		
+		uint64_t GetCPUMemorySize() const override { return sizeof(Texture2D); } // pixel data only lives on the GPU
 		
 		static Ref<Texture2D> Create(ImageFormat format, uint32_t width, uint32_t height, const void* data = nullptr);
 
 	private:
 		friend class DefaultTextureImporter;
 		friend class DDSTextureImporter;
+		friend class ResidencyManager;
 
 		Ref<Image2D> m_image;
+
+		// Residency is read from any thread (statistics, asset loading) while the thread recording the frame updates it
+		std::atomic_uint64_t m_lastUsedFrame = 0;
+		uint64_t m_memorySize = 0;
+		uint32_t m_generation = 0; // bumped whenever the image is swapped, the views of the old one become invalid
+
+		std::atomic_bool m_isResident = true;
+		std::atomic_bool m_reloadRequested = false;
 	};
 }
\ No newline at end of file
@@ -10,263 +10,59 @@ namespace Lamp
 {
 	namespace Utility
 	{
-		inline void AccessMasksFromLayouts(VkImageLayout sourceLayout, VkImageLayout targetLayout, VkImageMemoryBarrier& outBarrier)
+		// The stages and accesses an image in the layout is typically used with
+		inline std::pair<VkPipelineStageFlags2, VkAccessFlags2> GetStageAndAccessFromLayout(VkImageLayout layout)
 		{
-			// Source layouts (old)
-			// Source access mask controls actions that have to be finished on the old layout
-			// before it will be transitioned to the new layout
-			switch (sourceLayout)
+			switch (layout)
 			{
-				case VK_IMAGE_LAYOUT_UNDEFINED:
-					// Image layout is undefined (or does not matter)
-					// Only valid as initial layout
-					// No flags required, listed only for completeness
-					outBarrier.srcAccessMask = 0;
-					break;
-
-				case VK_IMAGE_LAYOUT_PREINITIALIZED:
-					// Image is preinitialized
-					// Only valid as initial layout for linear images, preserves memory contents
-					// Make sure host writes have been finished
-					outBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-					// Image is a color attachment
-					// Make sure any writes to the color buffer have been finished
-					outBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-					break;
-
+				case VK_IMAGE_LAYOUT_UNDEFINED: return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE };
+				case VK_IMAGE_LAYOUT_PREINITIALIZED: return { VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_WRITE_BIT };
+				case VK_IMAGE_LAYOUT_GENERAL: return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT };
+				case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT };
 				case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-					// Image is a depth/stencil attachment
-					// Make sure any writes to the depth/stencil buffer have been finished
-					outBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
-					// Image is a depth/stencil attachment
-					// Make sure any writes to the depth/stencil buffer have been finished
-					outBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-					// Image is a transfer source
-					// Make sure any reads from the image have been finished
-					outBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-					// Image is a transfer destination
-					// Make sure any writes to the image have been finished
-					outBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-					// Image is read by a shader
-					// Make sure any shader reads from the image have been finished
-					outBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-					break;
-
+				case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL: return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
 				case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
-					// Image is read by a shader
-					// Make sure any shader reads from the image have been finished
-					outBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL:
-					// Image is read by a shader
-					// Make sure any shader reads from the image have been finished
-					outBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_GENERAL:
-					outBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-					break;
-					
-				default:
-					LP_CORE_ERROR("Layouts are not configured!");
-					break;
+				case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL: return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_SHADER_SAMPLED_READ_BIT };
+				case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT };
+				case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return { VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT };
+				case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL: return { VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT };
+				case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE };
 			}
 
-			// Target layouts (new)
-			// Destination access mask controls the dependency for the new image layout
-			switch (targetLayout)
-			{
-				case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-					// Image will be used as a transfer destination
-					// Make sure any writes to the image have been finished
-					outBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-					// Image will be used as a transfer source
-					// Make sure any reads from the image have been finished
-					outBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-					// Image will be used as a color attachment
-					// Make sure any writes to the color buffer have been finished
-					outBarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
-					outBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-					// Image layout will be used as a depth/stencil attachment
-					// Make sure any writes to depth/stencil buffer have been finished
-					outBarrier.dstAccessMask = outBarrier.dstAccessMask | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-					// Image will be read in a shader (sampler, input attachment)
-					// Make sure any writes to the image have been finished
-					outBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL:
-					outBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
-					outBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-					break;
-
-				case VK_IMAGE_LAYOUT_GENERAL:
-					outBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-					break;
-
-				default:
-					LP_CORE_ERROR("Layouts are not configured!");
-					break;
-			}
+			LP_CORE_ERROR("Layouts are not configured!");
+			return { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT };
 		}
 
-		inline std::pair<VkPipelineStageFlags, VkPipelineStageFlags> GetStageFlagsFromLayouts(VkImageLayout currentLayout, VkImageLayout targetLayout)
+		inline void InsertImageMemoryBarrier(VkCommandBuffer commandBuffer, VkImage image, VkAccessFlags2 srcAccess, VkAccessFlags2 dstAccess, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags2 srcStageMask, VkPipelineStageFlags2 dstStageMask, VkImageSubresourceRange subResourceRange)
 		{
-			VkPipelineStageFlags sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-			VkPipelineStageFlags destStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			VkImageMemoryBarrier2 imageMemBarrier{};
+			imageMemBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+			imageMemBarrier.srcStageMask = srcStageMask;
+			imageMemBarrier.srcAccessMask = srcAccess;
+			imageMemBarrier.dstStageMask = dstStageMask;
+			imageMemBarrier.dstAccessMask = dstAccess;
+			imageMemBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageMemBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageMemBarrier.oldLayout = oldLayout;
+			imageMemBarrier.newLayout = newLayout;
+			imageMemBarrier.image = image;
+			imageMemBarrier.subresourceRange = subResourceRange;
 
-			if (currentLayout == VK_IMAGE_LAYOUT_UNDEFINED && targetLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-				destStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-				destStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_UNDEFINED && targetLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-				destStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-				destStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-				destStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-				destStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-				destStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_GENERAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-				destStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-				destStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-				destStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-				destStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-				destStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-				destStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_UNDEFINED && targetLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-				destStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_GENERAL && targetLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-				destStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && targetLayout == VK_IMAGE_LAYOUT_GENERAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-				destStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_UNDEFINED && targetLayout == VK_IMAGE_LAYOUT_GENERAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-				destStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-			}
-			else if (currentLayout == VK_IMAGE_LAYOUT_UNDEFINED && targetLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-			{
-				sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-				destStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-			}
-			else if (currentLayout)
-			{
-			}
-			else
-			{
-				LP_CORE_ERROR("Layouts are not configured!");
-			}
+			VkDependencyInfo dependencyInfo{};
+			dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+			dependencyInfo.imageMemoryBarrierCount = 1;
+			dependencyInfo.pImageMemoryBarriers = &imageMemBarrier;
 
-			return { sourceStage, destStage };
+			vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
 		}
 
+		// Untracked, images are transitioned through Image2D or a BarrierBatch when the layout is known to the tracking
 		inline void TransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout currentLayout, VkImageLayout targetLayout, VkImageSubresourceRange subresource)
 		{
-			// Create an image barrier object
-			VkImageMemoryBarrier imageMemoryBarrier = {};
-			imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemoryBarrier.oldLayout = currentLayout;
-			imageMemoryBarrier.newLayout = targetLayout;
-			imageMemoryBarrier.image = image;
-			imageMemoryBarrier.subresourceRange = subresource;
-
-			AccessMasksFromLayouts(currentLayout, targetLayout, imageMemoryBarrier);
-			const auto [sourceStage, destStage] = GetStageFlagsFromLayouts(currentLayout, targetLayout);
-
-			// Put barrier inside setup command buffer
-			vkCmdPipelineBarrier(commandBuffer, sourceStage, destStage, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+			const auto [srcStage, srcAccess] = GetStageAndAccessFromLayout(currentLayout);
+			const auto [dstStage, dstAccess] = GetStageAndAccessFromLayout(targetLayout);
+
+			InsertImageMemoryBarrier(commandBuffer, image, srcAccess, dstAccess, currentLayout, targetLayout, srcStage, dstStage, subresource);
 		}
 
 		inline void TransitionImageLayout(VkImage image, VkImageLayout currentLayout, VkImageLayout targetLayout)
@@ -309,99 +105,6 @@ namespace Lamp
 			device->FlushThreadSafeCommandBuffer(cmdBuffer);
 		}
 
-		inline void GenerateMipMaps(VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels)
-		{
-			auto device = GraphicsContext::GetDevice();
-			VkCommandBuffer cmdBuffer = device->GetThreadSafeCommandBuffer(true);
-
-			VkImageMemoryBarrier barrier{};
-			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			barrier.image = image;
-			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			barrier.subresourceRange.baseArrayLayer = 0;
-			barrier.subresourceRange.layerCount = 1;
-			barrier.subresourceRange.levelCount = 1;
-
-			int32_t mipWidth = (int32_t)width;
-			int32_t mipHeight = (int32_t)height;
-
-			for (uint32_t i = 1; i < mipLevels; i++)
-			{
-				barrier.subresourceRange.baseMipLevel = i - 1;
-				barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-				barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-				barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-				vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-				VkImageBlit blit{};
-				blit.srcOffsets[0] = { 0, 0, 0 };
-				blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
-				blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-				blit.srcSubresource.mipLevel = i - 1;
-				blit.srcSubresource.baseArrayLayer = 0;
-				blit.srcSubresource.layerCount = 1;
-				blit.dstOffsets[0] = { 0, 0, 0 };
-				blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1 };
-				blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-				blit.dstSubresource.mipLevel = i;
-				blit.dstSubresource.baseArrayLayer = 0;
-				blit.dstSubresource.layerCount = 1;
-
-				vkCmdBlitImage(cmdBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
-
-				barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-				barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-				barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-				barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-				vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-				if (mipWidth > 1)
-				{
-					mipWidth /= 2;
-				}
-
-				if (mipHeight > 1)
-				{
-					mipHeight /= 2;
-				}
-			}
-
-			barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-			vkCmdPipelineBarrier(cmdBuffer,
-				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-				0, nullptr,
-				0, nullptr,
-				1, &barrier);
-
-			device->FlushThreadSafeCommandBuffer(cmdBuffer);
-		}
-
-		inline void InsertImageMemoryBarrier(VkCommandBuffer commandBuffer, VkImage image, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkImageSubresourceRange subResourceRange)
-		{
-			VkImageMemoryBarrier imageMemBarrier{};
-			imageMemBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			imageMemBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-			imageMemBarrier.srcAccessMask = srcAccess;
-			imageMemBarrier.dstAccessMask = dstAccess;
-			imageMemBarrier.oldLayout = oldLayout;
-			imageMemBarrier.newLayout = newLayout;
-			imageMemBarrier.image = image;
-			imageMemBarrier.subresourceRange = subResourceRange;
-
-			vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &imageMemBarrier);
-		}
-
 		///////////////////////////Conversions////////////////////////////
 		inline bool IsDepthFormat(ImageFormat format)
 		{
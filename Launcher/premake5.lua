@@ -88,6 +88,7 @@ project "Launcher"
 				"%{Library.ShaderC_Utils_Debug}",
 				"%{Library.SPIRV_Cross_Debug}",
 				"%{Library.SPIRV_Cross_GLSL_Debug}",
+				"%{Library.SPIRV_Tools_Opt_Debug}",
 				"%{Library.SPIRV_Tools_Debug}",
 
 				"%{Library.VulkanUtils}"
@@ -105,6 +106,8 @@ project "Launcher"
 				"%{Library.ShaderC_Utils_Release}",
 				"%{Library.SPIRV_Cross_Release}",
 				"%{Library.SPIRV_Cross_GLSL_Release}",
+				"%{Library.SPIRV_Tools_Opt_Release}",
+				"%{Library.SPIRV_Tools_Release}",
 			}
 
 		filter "configurations:Dist"
@@ -120,4 +123,6 @@ project "Launcher"
 				"%{Library.ShaderC_Utils_Release}",
 				"%{Library.SPIRV_Cross_Release}",
 				"%{Library.SPIRV_Cross_GLSL_Release}",
+				"%{Library.SPIRV_Tools_Opt_Release}",
+				"%{Library.SPIRV_Tools_Release}",
 			}
\ No newline at end of file
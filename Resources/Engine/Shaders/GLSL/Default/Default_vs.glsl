@@ -12,8 +12,8 @@ layout(location = 4) in vec2 a_texCoords;
 void main()
 {
     const uint meshIndex = u_objectMap[gl_BaseInstance + gl_DrawID];
-    const mat4 transform = u_objectBuffer[meshIndex].transform;
-    const vec4 worldPosition = transform * vec4(a_position, 1.f);
+    const mat3x4 transform = u_objectBuffer[meshIndex].transform;
+    const vec4 worldPosition = vec4(vec4(a_position, 1.f) * transform, 1.f);
 
     gl_Position = u_cameraData.viewProj * worldPosition;
 }
\ No newline at end of file
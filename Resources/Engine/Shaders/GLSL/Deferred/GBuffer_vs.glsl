@@ -24,8 +24,8 @@ layout(location = 0) out OutData
 void main()
 {
     const uint meshIndex = u_objectMap[gl_BaseInstance + gl_DrawID];
-    const mat4 transform = u_objectBuffer[meshIndex].transform;
-    const vec4 worldPosition = transform * vec4(a_position, 1.f);
+    const mat3x4 transform = u_objectBuffer[meshIndex].transform;
+    const vec4 worldPosition = vec4(vec4(a_position, 1.f) * transform, 1.f);
 
     o_outData.worldPosition = worldPosition.xyz;
     o_outData.texCoords = a_texCoords;
@@ -33,7 +33,7 @@ void main()
     o_outData.localNormal = a_normal;
     o_outData.drawId = meshIndex;
 
-    const mat3 worldNormalRotation = mat3(transform);
+    const mat3 worldNormalRotation = transpose(mat3(transform));
     const vec3 T = normalize(worldNormalRotation * a_tangent);
     const vec3 B = normalize(worldNormalRotation * a_bitangent);
     const vec3 N = normalize(worldNormalRotation * a_normal);
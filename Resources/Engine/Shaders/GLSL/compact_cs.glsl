@@ -0,0 +1,68 @@
+#version 460
+
+struct DrawCommand
+{	
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint firstInstance;
+
+	uint objectId;
+	uint batchId;
+	uint boundsIndex;
+};
+
+layout(std140, set = 0, binding = 1) readonly buffer DrawBuffer
+{
+	DrawCommand draws[];
+} u_drawBuffer;
+
+layout(std430, set = 0, binding = 6) readonly buffer VisibilityBuffer
+{
+	uint bits[];
+} u_visibilityBuffer;
+
+layout(std430, set = 1, binding = 4) writeonly buffer ObjectMapBuffer
+{
+	uint objectMap[];
+} u_objectMap;
+
+// Every pass has its own slice, so the lists of all passes can be built ahead of the draws
+layout(std430, set = 1, binding = 5) buffer CountBuffer
+{
+	uint counts[];
+} u_countBuffer;
+
+// One bit per batch drawn by the pass
+layout(std430, set = 1, binding = 6) readonly buffer BatchMaskBuffer
+{
+	uint bits[];
+} u_batchMask;
+
+layout(push_constant) uniform constants
+{
+	uint drawCount;
+	uint visibilityOffset;
+} u_compactData;
+
+layout (local_size_x = 256) in;
+void main()
+{
+	const uint globalId = gl_GlobalInvocationID.x;
+
+	if (globalId < u_compactData.drawCount)
+	{
+		const bool visible = (u_visibilityBuffer.bits[u_compactData.visibilityOffset + globalId / 32] & (1u << (globalId % 32))) != 0;
+		const uint batchId = u_drawBuffer.draws[globalId].batchId;
+		const bool drawnByPass = (u_batchMask.bits[batchId / 32] & (1u << (batchId % 32))) != 0;
+
+		if (visible && drawnByPass)
+		{
+			const uint drawIndex = atomicAdd(u_countBuffer.counts[batchId], 1);
+			const uint baseIndex = u_drawBuffer.draws[globalId].firstInstance;
+
+			u_objectMap.objectMap[baseIndex + drawIndex] = u_drawBuffer.draws[globalId].objectId;
+		}
+	}
+}
@@ -11,6 +11,7 @@ struct DrawCullData
 	float pyramidWidth, pyramidHeight;
 	
 	uint drawCount;
+	uint visibilityOffset; // first word of the view's visibility bits
 	
 	int cullingEnabled;
 	int lodEnabled;
@@ -36,7 +37,7 @@ struct DrawCommand
 
 	uint objectId;
 	uint batchId;
-	uint padding;
+	uint boundsIndex;
 };
 
 layout(std140, set = 0, binding = 1) readonly buffer DrawBuffer
@@ -44,32 +45,40 @@ layout(std140, set = 0, binding = 1) readonly buffer DrawBuffer
 	DrawCommand draws[];
 } u_drawBuffer;
 
-layout(std430, set = 0, binding = 2) writeonly buffer CountBuffer
+// One bit per draw, the passes drawing the view compact their draw lists from it
+layout(std430, set = 0, binding = 6) buffer VisibilityBuffer
 {
-	uint counts[];
-} u_countBuffer;
-
-layout(std430, set = 1, binding = 4) writeonly buffer ObjectMapBuffer
-{
-	uint objectMap[];
-} u_objectMap;
+	uint bits[];
+} u_visibilityBuffer;
 
 layout(std430, set = 0, binding = 4) readonly buffer ObjectBuffer
 {
     ObjectData objects[];
 } u_objectBuffer;
 
+layout(std430, set = 0, binding = 5) readonly buffer BoundsBuffer
+{
+	vec4 bounds[]; // local space bounding sphere per mesh
+} u_boundsBuffer;
+
 layout(push_constant) uniform constants
 {
 	DrawCullData u_cullData;
 };
 
-bool IsVisible(uint objectId)
+bool IsVisible(uint objectId, uint boundsIndex)
 {
-	vec4 sphereBounds = u_objectBuffer.objects[objectId].sphereBounds;
+	const vec4 sphereBounds = u_boundsBuffer.bounds[boundsIndex];
+	const mat3x4 transform = u_objectBuffer.objects[objectId].transform;
+
+	// The columns of the model matrix are spread across the rows of the stored transform
+	const vec3 axisX = vec3(transform[0].x, transform[1].x, transform[2].x);
+	const vec3 axisY = vec3(transform[0].y, transform[1].y, transform[2].y);
+	const vec3 axisZ = vec3(transform[0].z, transform[1].z, transform[2].z);
+	const float maxScale = sqrt(max(dot(axisX, axisX), max(dot(axisY, axisY), dot(axisZ, axisZ))));
 
-	vec3 center = sphereBounds.xyz;
-	float radius = sphereBounds.w;
+	vec3 center = vec4(sphereBounds.xyz, 1.f) * transform;
+	float radius = sphereBounds.w * maxScale;
 
 	center = (u_cullData.view * vec4(center, 1.f)).xyz;
 
@@ -95,15 +104,11 @@ void main()
 	if (globalId < u_cullData.drawCount)
 	{	
 		const uint objectId = u_drawBuffer.draws[globalId].objectId;
-		const bool visible = IsVisible(objectId);
+		const bool visible = IsVisible(objectId, u_drawBuffer.draws[globalId].boundsIndex);
 
 		if (visible)
 		{
-			const uint batchId = u_drawBuffer.draws[globalId].batchId;
-			const uint drawIndex = atomicAdd(u_countBuffer.counts[batchId], 1);
-			const uint baseIndex = u_drawBuffer.draws[globalId].firstInstance;
-
-			u_objectMap.objectMap[baseIndex + drawIndex] = objectId;
+			atomicOr(u_visibilityBuffer.bits[u_cullData.visibilityOffset + globalId / 32], 1u << (globalId % 32));
 		}
 	}
 }
\ No newline at end of file
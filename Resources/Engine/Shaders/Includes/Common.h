@@ -28,8 +28,7 @@
 
 struct ObjectData
 {
-	mat4 transform;
-	vec4 sphereBounds;
+	mat3x4 transform; // columns are the rows of the affine model matrix, multiply as vec4(position, 1.f) * transform
 };
 
 struct DirectionalLight
@@ -112,6 +112,7 @@ project "Sandbox"
 				"%{Library.ShaderC_Utils_Debug}",
 				"%{Library.SPIRV_Cross_Debug}",
 				"%{Library.SPIRV_Cross_GLSL_Debug}",
+				"%{Library.SPIRV_Tools_Opt_Debug}",
 				"%{Library.SPIRV_Tools_Debug}",
 
 				"%{Library.VulkanUtils}"
@@ -129,6 +130,8 @@ project "Sandbox"
 				"%{Library.ShaderC_Utils_Release}",
 				"%{Library.SPIRV_Cross_Release}",
 				"%{Library.SPIRV_Cross_GLSL_Release}",
+				"%{Library.SPIRV_Tools_Opt_Release}",
+				"%{Library.SPIRV_Tools_Release}",
 			}
 
 		filter "configurations:Dist"
@@ -144,4 +147,6 @@ project "Sandbox"
 				"%{Library.ShaderC_Utils_Release}",
 				"%{Library.SPIRV_Cross_Release}",
 				"%{Library.SPIRV_Cross_GLSL_Release}",
+				"%{Library.SPIRV_Tools_Opt_Release}",
+				"%{Library.SPIRV_Tools_Release}",
 			}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "sbpch.h"
+#include "MemoryPanel.h"
+
+#include <Lamp/Asset/AssetManager.h>
+#include <Lamp/Asset/ResidencyManager.h>
+#include <Lamp/Core/Graphics/VulkanAllocator.h>
+#include <Lamp/Log/Log.h>
+
+#include <fstream>
+
+namespace Utility
+{
+	inline static float ToMegaBytes(uint64_t bytes)
+	{
+		return (float)bytes / (1024.f * 1024.f);
+	}
+}
+
+MemoryPanel::MemoryPanel()
+	: EditorWindow("Memory")
+{
+}
+
+void MemoryPanel::UpdateMainContent()
+{
+	const auto stats = Lamp::VulkanAllocator::GetStatistics();
+
+	ImGui::TextUnformatted("Heaps");
+	ImGui::Separator();
+
+	for (uint32_t i = 0; i < (uint32_t)stats.heaps.size(); i++)
+	{
+		const auto& heap = stats.heaps[i];
+		const float fraction = heap.budget > 0 ? (float)heap.usage / (float)heap.budget : 0.f;
+
+		const std::string overlay = std::format("{0:.1f} / {1:.1f} MB", Utility::ToMegaBytes(heap.usage), Utility::ToMegaBytes(heap.budget));
+
+		ImGui::Text("Heap %d (%s)", i, heap.deviceLocal ? "Device" : "Host");
+		ImGui::ProgressBar(fraction, ImVec2(-1.f, 0.f), overlay.c_str());
+	}
+
+	ImGui::Spacing();
+	ImGui::TextUnformatted("Categories");
+	ImGui::Separator();
+
+	if (ImGui::BeginTable("categories", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+	{
+		ImGui::TableSetupColumn("Category");
+		ImGui::TableSetupColumn("Size (MB)");
+		ImGui::TableSetupColumn("Allocations");
+		ImGui::TableHeadersRow();
+
+		for (uint32_t i = 0; i < (uint32_t)Lamp::MemoryCategory::Count; i++)
+		{
+			ImGui::TableNextRow();
+
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(Lamp::VulkanAllocator::GetCategoryName((Lamp::MemoryCategory)i));
+
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", Utility::ToMegaBytes(stats.categoryBytes[i]));
+
+			ImGui::TableNextColumn();
+			ImGui::Text("%d", stats.categoryAllocations[i]);
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::Spacing();
+	ImGui::TextUnformatted("Residency");
+	ImGui::Separator();
+
+	const auto residencyStats = Lamp::ResidencyManager::GetStatistics();
+	if (residencyStats.budgetBytes > 0)
+	{
+		ImGui::Text("Resident: %.2f / %.2f MB", Utility::ToMegaBytes(residencyStats.residentBytes), Utility::ToMegaBytes(residencyStats.budgetBytes));
+	}
+	else
+	{
+		ImGui::Text("Resident: %.2f MB (heap budget)", Utility::ToMegaBytes(residencyStats.residentBytes));
+	}
+
+	ImGui::Text("Textures: %d resident, %d evicted", residencyStats.residentTextures, residencyStats.evictedTextures);
+	ImGui::Text("Meshes: %d resident, %d evicted", residencyStats.residentMeshes, residencyStats.evictedMeshes);
+
+	ImGui::Spacing();
+	ImGui::TextUnformatted("Asset Cache");
+	ImGui::Separator();
+
+	const auto assetStats = Lamp::AssetManager::Get().GetStatistics();
+	ImGui::Text("Cached: %.2f / %.2f MB, %d evicted", Utility::ToMegaBytes(assetStats.cachedBytes), Utility::ToMegaBytes(assetStats.budgetBytes), assetStats.evictedAssets);
+	ImGui::Text("Released after upload: %.2f MB (%.1f%% of the CPU copies)", Utility::ToMegaBytes(assetStats.releasedCPUBytes),
+		assetStats.releasedCPUBytes > 0 ? (float)assetStats.releasedCPUBytes / (float)(assetStats.cachedBytes + assetStats.releasedCPUBytes) * 100.f : 0.f);
+
+	if (ImGui::BeginTable("assetTypes", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+	{
+		ImGui::TableSetupColumn("Type");
+		ImGui::TableSetupColumn("Size (MB)");
+		ImGui::TableSetupColumn("Released (MB)");
+		ImGui::TableSetupColumn("Assets");
+		ImGui::TableHeadersRow();
+
+		for (const auto& [type, typeStats] : assetStats.types)
+		{
+			ImGui::TableNextRow();
+
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(Lamp::GetAssetTypeName(type));
+
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", Utility::ToMegaBytes(typeStats.bytes));
+
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", Utility::ToMegaBytes(typeStats.releasedBytes));
+
+			ImGui::TableNextColumn();
+			ImGui::Text("%d", typeStats.count);
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::Spacing();
+	ImGui::Checkbox("Detailed", &m_detailedDump);
+	ImGui::SameLine();
+
+	if (ImGui::Button("Dump JSON"))
+	{
+		const std::filesystem::path path = "MemoryStats.json";
+
+		std::ofstream output{ path };
+		output << Lamp::VulkanAllocator::BuildStatsString(m_detailedDump);
+		output.close();
+
+		LP_INFO("Memory statistics written to {0}!", path.string());
+	}
+}
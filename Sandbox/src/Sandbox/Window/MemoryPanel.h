@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Sandbox/Window/EditorWindow.h"
+
+class MemoryPanel : public EditorWindow
+{
+public:
+	MemoryPanel();
+
+	void UpdateMainContent() override;
+
+private:
+	bool m_detailedDump = false;
+};
@@ -113,6 +113,7 @@ void ViewportPanel::UpdateMainContent()
 				}
 
 				m_editorScene = Lamp::AssetManager::GetAsset<Lamp::Scene>(handle);
+				Lamp::AssetManager::Get().LogCPUDataSavings();
 
 				break;
 			}
@@ -21,5 +21,8 @@ Lamp::Application* Lamp::CreateApplication()
 	Lamp::ApplicationInfo info{};
 	info.useVSync = false;
 
+	// The editor panels change materials and read framebuffers outside of the render jobs
+	info.useRenderThread = false;
+
 	return new SandboxApp(info);
 }
\ No newline at end of file
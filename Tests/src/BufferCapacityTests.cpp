@@ -0,0 +1,70 @@
+#include "tspch.h"
+#include "Test.h"
+
+#include <Lamp/Rendering/Buffer/BufferCapacity.h>
+
+using namespace Lamp;
+
+LP_TEST(BufferCapacity_GrowsByDoublingUntilTheCountFits)
+{
+	BufferCapacity capacity{ MIN_OBJECT_CAPACITY, OBJECT_SHRINK_FRAME_COUNT };
+	LP_TEST_CHECK(capacity.Get() == MIN_OBJECT_CAPACITY);
+
+	LP_TEST_CHECK(!capacity.Update(100));
+	LP_TEST_CHECK(!capacity.Update(MIN_OBJECT_CAPACITY));
+	LP_TEST_CHECK(capacity.Get() == MIN_OBJECT_CAPACITY);
+
+	LP_TEST_CHECK(capacity.Update(MIN_OBJECT_CAPACITY + 1));
+	LP_TEST_CHECK(capacity.Get() == MIN_OBJECT_CAPACITY * 2);
+
+	// A single large jump grows in one step
+	LP_TEST_CHECK(capacity.Update(100000));
+	LP_TEST_CHECK(capacity.Get() == 131072);
+}
+
+LP_TEST(BufferCapacity_ShrinksOnlyAfterStayingSmall)
+{
+	BufferCapacity capacity{ MIN_OBJECT_CAPACITY, OBJECT_SHRINK_FRAME_COUNT };
+	capacity.Update(MIN_OBJECT_CAPACITY * 8);
+	LP_TEST_CHECK(capacity.Get() == MIN_OBJECT_CAPACITY * 8);
+
+	for (uint32_t frame = 0; frame < OBJECT_SHRINK_FRAME_COUNT - 1; frame++)
+	{
+		LP_TEST_CHECK(!capacity.Update(100));
+	}
+
+	// A frame using more than a quarter restarts the count
+	LP_TEST_CHECK(!capacity.Update(MIN_OBJECT_CAPACITY * 4));
+	LP_TEST_CHECK(!capacity.Update(100));
+
+	for (uint32_t frame = 0; frame < OBJECT_SHRINK_FRAME_COUNT - 2; frame++)
+	{
+		LP_TEST_CHECK(!capacity.Update(100));
+	}
+
+	LP_TEST_CHECK(capacity.Update(100));
+	LP_TEST_CHECK(capacity.Get() == MIN_OBJECT_CAPACITY * 4);
+
+	// Halves once per period and never goes below the minimum
+	for (uint32_t frame = 0; frame < OBJECT_SHRINK_FRAME_COUNT * 10; frame++)
+	{
+		capacity.Update(100);
+	}
+
+	LP_TEST_CHECK(capacity.Get() == MIN_OBJECT_CAPACITY);
+}
+
+LP_TEST(BufferCapacity_ViewCapacityNeverShrinks)
+{
+	BufferCapacity capacity{ MIN_VIEW_CAPACITY };
+
+	LP_TEST_CHECK(capacity.Update(MIN_VIEW_CAPACITY + 1));
+	LP_TEST_CHECK(capacity.Get() == MIN_VIEW_CAPACITY * 2);
+
+	for (uint32_t frame = 0; frame < 1000; frame++)
+	{
+		LP_TEST_CHECK(!capacity.Update(1));
+	}
+
+	LP_TEST_CHECK(capacity.Get() == MIN_VIEW_CAPACITY * 2);
+}
@@ -0,0 +1,150 @@
+#include "tspch.h"
+#include "Test.h"
+
+#include <Lamp/Core/Graphics/DeletionQueue.h>
+#include <Lamp/Rendering/FunctionQueue.hpp>
+
+#include <array>
+#include <chrono>
+
+using namespace Lamp;
+
+LP_TEST(DeletionQueue_DestroysListsOnceTheTimelinePasses)
+{
+	DeletionQueue::Initialize(nullptr);
+
+	uint32_t destroyed = 0;
+	DeletionQueue::RetireFunction([&destroyed]() { destroyed++; });
+
+	DeletionQueue::Update(1, 0);
+	LP_TEST_CHECK(destroyed == 0);
+	LP_TEST_CHECK(DeletionQueue::GetStatistics().retireLists == 1);
+	LP_TEST_CHECK(DeletionQueue::GetStatistics().pendingRetirements == 1);
+
+	DeletionQueue::Update(1, 1);
+	LP_TEST_CHECK(destroyed == 1);
+	LP_TEST_CHECK(DeletionQueue::GetStatistics().retireLists == 0);
+	LP_TEST_CHECK(DeletionQueue::GetStatistics().totalRetired == 1);
+
+	DeletionQueue::Shutdown();
+}
+
+LP_TEST(DeletionQueue_RecyclesDestroyedLists)
+{
+	DeletionQueue::Initialize(nullptr);
+
+	uint32_t destroyed = 0;
+	DeletionQueue::RetireFunction([&destroyed]() { destroyed++; });
+	DeletionQueue::Update(1, 1);
+	LP_TEST_CHECK(DeletionQueue::GetStatistics().freeLists == 1);
+
+	// The next pending list is taken from the free lists instead of being allocated
+	DeletionQueue::RetireFunction([&destroyed]() { destroyed++; });
+	DeletionQueue::Update(2, 1);
+	LP_TEST_CHECK(DeletionQueue::GetStatistics().freeLists == 0);
+
+	DeletionQueue::Update(2, 2);
+	LP_TEST_CHECK(DeletionQueue::GetStatistics().freeLists == 1);
+
+	// With a steady number of frames in flight the lists cycle without the pool growing
+	constexpr uint64_t framesInFlight = 2;
+	for (uint64_t frame = 3; frame < 100; frame++)
+	{
+		DeletionQueue::RetireFunction([&destroyed]() { destroyed++; });
+		DeletionQueue::Update(frame, frame - framesInFlight);
+
+		const auto stats = DeletionQueue::GetStatistics();
+		LP_TEST_CHECK(stats.retireLists <= framesInFlight + 1);
+		LP_TEST_CHECK(stats.freeLists + stats.retireLists <= framesInFlight + 2);
+	}
+
+	LP_TEST_CHECK(destroyed == 99 - framesInFlight);
+
+	DeletionQueue::Shutdown();
+	LP_TEST_CHECK(destroyed == 99);
+}
+
+LP_TEST(DeletionQueue_HundredThousandRetirements)
+{
+	constexpr uint32_t RETIREMENT_COUNT = 100000;
+	constexpr uint32_t RETIREMENTS_PER_FRAME = 100;
+	constexpr uint32_t FRAMES_IN_FLIGHT = 3;
+	constexpr uint32_t FRAME_COUNT = RETIREMENT_COUNT / RETIREMENTS_PER_FRAME;
+
+	// Only the queueing is timed, both variants skip the Vulkan destroy calls: the function queue calls an empty destroy and the retire lists run without a device
+	auto getHandle = [](uint32_t frame, uint32_t i) { return (uint64_t)frame * RETIREMENTS_PER_FRAME + i + 1; };
+
+	// Before: a function queue per frame in flight, flushed when the frame comes around again
+	uint64_t legacyDestroyed = 0;
+	std::array<FunctionQueue, FRAMES_IN_FLIGHT> frameQueues;
+
+	const auto legacyStart = std::chrono::high_resolution_clock::now();
+
+	for (uint32_t frame = 0; frame < FRAME_COUNT; frame++)
+	{
+		auto& queue = frameQueues[frame % FRAMES_IN_FLIGHT];
+		queue.Flush();
+
+		for (uint32_t i = 0; i < RETIREMENTS_PER_FRAME; i++)
+		{
+			const uint64_t handle = getHandle(frame, i);
+
+			switch (i % 3)
+			{
+				case 0: queue.Push([buffer = (VkBuffer)handle, allocation = (VmaAllocation)handle, &legacyDestroyed]() { legacyDestroyed++; }); break;
+				case 1: queue.Push([image = (VkImage)handle, allocation = (VmaAllocation)handle, &legacyDestroyed]() { legacyDestroyed++; }); break;
+				case 2: queue.Push([imageView = (VkImageView)handle, &legacyDestroyed]() { legacyDestroyed++; }); break;
+			}
+		}
+	}
+
+	for (auto& queue : frameQueues)
+	{
+		queue.Flush();
+	}
+
+	const float legacyMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - legacyStart).count();
+
+	// After: typed retire lists tagged with the timeline, the GPU trails the CPU by the frames in flight
+	DeletionQueue::Initialize(nullptr);
+
+	uint32_t maxRetireLists = 0;
+
+	const auto timelineStart = std::chrono::high_resolution_clock::now();
+
+	for (uint32_t frame = 0; frame < FRAME_COUNT; frame++)
+	{
+		for (uint32_t i = 0; i < RETIREMENTS_PER_FRAME; i++)
+		{
+			const uint64_t handle = getHandle(frame, i);
+
+			switch (i % 3)
+			{
+				case 0: DeletionQueue::RetireBuffer((VkBuffer)handle, (VmaAllocation)handle); break;
+				case 1: DeletionQueue::RetireImage((VkImage)handle, (VmaAllocation)handle); break;
+				case 2: DeletionQueue::RetireImageView((VkImageView)handle); break;
+			}
+		}
+
+		const uint64_t submittedValue = frame + 1;
+		DeletionQueue::Update(submittedValue, submittedValue > FRAMES_IN_FLIGHT ? submittedValue - FRAMES_IN_FLIGHT : 0);
+
+		maxRetireLists = std::max(maxRetireLists, DeletionQueue::GetStatistics().retireLists);
+	}
+
+	const float timelineMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - timelineStart).count();
+
+	const auto stats = DeletionQueue::GetStatistics();
+	LP_TEST_CHECK(stats.totalRetired + stats.pendingRetirements == RETIREMENT_COUNT);
+	LP_TEST_CHECK(stats.pendingRetirements == FRAMES_IN_FLIGHT * RETIREMENTS_PER_FRAME);
+	LP_TEST_CHECK(maxRetireLists <= FRAMES_IN_FLIGHT + 1);
+	LP_TEST_CHECK(stats.freeLists + stats.retireLists <= FRAMES_IN_FLIGHT + 2);
+
+	DeletionQueue::Shutdown();
+
+	LP_TEST_CHECK(legacyDestroyed == RETIREMENT_COUNT);
+
+	std::cout << "    " << RETIREMENT_COUNT << " buffer, image and image view retirements over " << FRAME_COUNT << " frames, " << FRAMES_IN_FLIGHT << " frames in flight" << std::endl;
+	std::cout << "    function queues: " << legacyMilliseconds * 1000000.0f / RETIREMENT_COUNT << " ns per retirement" << std::endl;
+	std::cout << "    typed retire lists: " << timelineMilliseconds * 1000000.0f / RETIREMENT_COUNT << " ns per retirement" << std::endl;
+}
@@ -0,0 +1,117 @@
+#include "tspch.h"
+#include "Test.h"
+
+#include <Lamp/Rendering/FrameGraph.h>
+
+using namespace Lamp;
+
+namespace
+{
+	ImageSpecification CreateTargetSpecification(ImageFormat format)
+	{
+		ImageSpecification specification{};
+		specification.width = 1920;
+		specification.height = 1080;
+		specification.format = format;
+		specification.usage = ImageUsage::Attachment;
+
+		return specification;
+	}
+
+	const FrameGraph::Barrier* FindBarrier(const FrameGraph::CompiledPass& compiledPass, FrameGraphResource resource)
+	{
+		for (const auto& barrier : compiledPass.barriers)
+		{
+			if (barrier.resource == resource)
+			{
+				return &barrier;
+			}
+		}
+
+		return nullptr;
+	}
+}
+
+LP_TEST(FrameGraph_DumpScheduleCullsPassesAndAliasesTransientImages)
+{
+	FrameGraph frameGraph;
+
+	const FrameGraphResource depth = frameGraph.DeclareImage("Depth", CreateTargetSpecification(ImageFormat::DEPTH32F));
+	const FrameGraphResource albedo = frameGraph.DeclareImage("Albedo", CreateTargetSpecification(ImageFormat::RGBA16F));
+	const FrameGraphResource lighting = frameGraph.DeclareImage("Lighting", CreateTargetSpecification(ImageFormat::RGBA16F));
+	const FrameGraphResource debug = frameGraph.DeclareImage("Debug", CreateTargetSpecification(ImageFormat::RGBA));
+	const FrameGraphResource output = frameGraph.DeclareImage("Final", CreateTargetSpecification(ImageFormat::RGBA), false);
+	frameGraph.MarkOutput(output);
+
+	const FrameGraphPass prePass = frameGraph.AddPass("PreDepth", FrameGraphPassType::Graphics);
+	frameGraph.Write(prePass, depth, FrameGraphAccess::DepthAttachmentWrite);
+
+	const FrameGraphPass geometryPass = frameGraph.AddPass("Geometry", FrameGraphPassType::Graphics);
+	frameGraph.Read(geometryPass, depth, FrameGraphAccess::DepthAttachmentReadWrite);
+	frameGraph.Write(geometryPass, albedo, FrameGraphAccess::ColorAttachmentWrite);
+
+	// Nothing reads the debug view, so the pass is culled
+	const FrameGraphPass debugPass = frameGraph.AddPass("DebugView", FrameGraphPassType::Graphics);
+	frameGraph.Read(debugPass, albedo, FrameGraphAccess::SampledRead);
+	frameGraph.Write(debugPass, debug, FrameGraphAccess::ColorAttachmentWrite);
+
+	const FrameGraphPass lightingPass = frameGraph.AddPass("Lighting", FrameGraphPassType::Compute);
+	frameGraph.Read(lightingPass, albedo, FrameGraphAccess::SampledRead);
+	frameGraph.Write(lightingPass, lighting, FrameGraphAccess::StorageWrite);
+
+	const FrameGraphPass compositePass = frameGraph.AddPass("Composite", FrameGraphPassType::Graphics);
+	frameGraph.Read(compositePass, lighting, FrameGraphAccess::SampledRead);
+	frameGraph.Write(compositePass, output, FrameGraphAccess::ColorAttachmentWrite);
+
+	frameGraph.Compile();
+
+	const auto& stats = frameGraph.GetStatistics();
+	LP_TEST_CHECK(stats.passCount == 4);
+	LP_TEST_CHECK(stats.culledPassCount == 1);
+
+	// Culled passes are left out of the schedule, the rest keep their declaration order
+	const auto& schedule = frameGraph.GetSchedule();
+	LP_TEST_CHECK(schedule.size() == 4);
+	LP_TEST_CHECK(schedule[0].pass == prePass && schedule[1].pass == geometryPass && schedule[2].pass == lightingPass && schedule[3].pass == compositePass);
+
+	// The debug image is never used by a surviving pass, so it takes no memory
+	const auto& aliasGroups = frameGraph.GetAliasGroups();
+	LP_TEST_CHECK(aliasGroups.size() == 2);
+	LP_TEST_CHECK(stats.transientImageCount == 3);
+
+	// Lighting is first used after the depth is last used, albedo overlaps both
+	const std::vector<FrameGraphResource> sharedGroup{ depth, lighting };
+	const std::vector<FrameGraphResource> albedoGroup{ albedo };
+	LP_TEST_CHECK(aliasGroups[0].resources == sharedGroup);
+	LP_TEST_CHECK(aliasGroups[1].resources == albedoGroup);
+	LP_TEST_CHECK(aliasGroups[0].memoryRequirements.size == 1920ull * 1080 * 8);
+	LP_TEST_CHECK(stats.aliasedBytes < stats.transientBytes);
+
+	// Transient images start every frame from undefined
+	const auto* depthBarrier = FindBarrier(schedule[0], depth);
+	LP_TEST_CHECK(depthBarrier && depthBarrier->discard && depthBarrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && depthBarrier->newLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+
+	// The depth is written again by the next pass, which has to wait for the first write
+	const auto* depthWriteBarrier = FindBarrier(schedule[1], depth);
+	LP_TEST_CHECK(depthWriteBarrier && !depthWriteBarrier->discard && (depthWriteBarrier->srcAccess & VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT) != 0);
+
+	// Albedo goes from attachment to sampled in the compute pass
+	const auto* albedoBarrier = FindBarrier(schedule[2], albedo);
+	LP_TEST_CHECK(albedoBarrier && albedoBarrier->oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && albedoBarrier->newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	LP_TEST_CHECK(albedoBarrier && albedoBarrier->srcStage == VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT && albedoBarrier->dstStage == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+	// Lighting takes over the memory of the depth, so it waits for the depth tests
+	const auto* lightingBarrier = FindBarrier(schedule[2], lighting);
+	LP_TEST_CHECK(lightingBarrier && lightingBarrier->discard && lightingBarrier->newLayout == VK_IMAGE_LAYOUT_GENERAL);
+	LP_TEST_CHECK(lightingBarrier && (lightingBarrier->srcStage & VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT) != 0);
+
+	const std::string scheduleDump = frameGraph.DumpSchedule();
+	LP_TEST_CHECK(scheduleDump.find("FrameGraph: 4 passes, 1 culled") != std::string::npos);
+	LP_TEST_CHECK(scheduleDump.find("[2] Lighting (Compute)") != std::string::npos);
+	LP_TEST_CHECK(scheduleDump.find("Albedo: ColorAttachment -> ShaderReadOnly") != std::string::npos);
+	LP_TEST_CHECK(scheduleDump.find("Final\n    Final: ColorAttachment -> ShaderReadOnly") != std::string::npos);
+	LP_TEST_CHECK(scheduleDump.find("Culled: DebugView") != std::string::npos);
+	LP_TEST_CHECK(scheduleDump.find("Alias group 0 (16588800 bytes): Depth Lighting") != std::string::npos);
+	LP_TEST_CHECK(scheduleDump.find("Alias group 1 (16588800 bytes): Albedo") != std::string::npos);
+	LP_TEST_CHECK(scheduleDump.find("Debug:") == std::string::npos);
+}
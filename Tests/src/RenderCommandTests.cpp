@@ -0,0 +1,471 @@
+#include "tspch.h"
+#include "Test.h"
+
+#include <Lamp/Asset/Mesh/Material.h>
+#include <Lamp/Asset/Mesh/Mesh.h>
+#include <Lamp/Asset/ResidencyManager.h>
+#include <Lamp/Core/ThreadLocalBuffers.h>
+#include <Lamp/Core/Graphics/DeletionQueue.h>
+#include <Lamp/Rendering/Buffer/ShaderStorageBuffer/ShaderStorageBufferRegistry.h>
+#include <Lamp/Rendering/Buffer/UniformBuffer/UniformBufferRegistry.h>
+#include <Lamp/Rendering/Camera/Camera.h>
+#include <Lamp/Rendering/Renderer.h>
+
+#include <chrono>
+#include <numeric>
+#include <random>
+#include <thread>
+
+using namespace Lamp;
+
+namespace
+{
+	constexpr uint32_t SUB_MESH_COUNT = 2;
+
+	constexpr uint32_t SCENE_COMMAND_COUNT = 250000;
+	constexpr uint32_t SCENE_SUBMIT_COUNT = SCENE_COMMAND_COUNT / SUB_MESH_COUNT;
+	constexpr uint32_t SCENE_SUBMIT_THREAD_COUNT = 8;
+
+	constexpr uint32_t SUBMIT_THREAD_COUNT = 32;
+	constexpr uint32_t SUBMITS_PER_THREAD = 256;
+
+	// The renderer without a device: submission, frame packets and the scene buffer bookkeeping
+	struct HeadlessRenderer
+	{
+		HeadlessRenderer()
+		{
+			DeletionQueue::Initialize(nullptr);
+			ResidencyManager::Initialize();
+			UniformBufferRegistry::Initialize();
+			ShaderStorageBufferRegistry::Initialize();
+			Renderer::InitializeHeadless();
+		}
+
+		~HeadlessRenderer()
+		{
+			Renderer::Shutdowm();
+			ShaderStorageBufferRegistry::Shutdowm();
+			UniformBufferRegistry::Shutdowm();
+			ResidencyManager::Shutdown();
+			DeletionQueue::Shutdown();
+		}
+	};
+
+	// Every sub mesh of a mesh has its own material, so a batch is one mesh and sub mesh
+	std::vector<Ref<Mesh>> CreateMeshes(uint32_t count, const std::vector<Ref<Material>>& materials)
+	{
+		std::vector<Ref<Mesh>> meshes;
+
+		for (uint32_t meshIndex = 0; meshIndex < count; meshIndex++)
+		{
+			std::vector<SubMesh> subMeshes;
+			std::unordered_map<uint32_t, Ref<Material>> meshMaterials;
+
+			for (uint32_t subMeshIndex = 0; subMeshIndex < SUB_MESH_COUNT; subMeshIndex++)
+			{
+				subMeshes.emplace_back(subMeshIndex, 36, 0, subMeshIndex * 36);
+				meshMaterials[subMeshIndex] = materials[(meshIndex * SUB_MESH_COUNT + subMeshIndex) % materials.size()];
+			}
+
+			meshes.emplace_back(CreateRef<Mesh>(subMeshes, CreateRef<MultiMaterial>("Test", meshMaterials)));
+		}
+
+		return meshes;
+	}
+
+	std::vector<Ref<Material>> CreateMaterials(uint32_t count)
+	{
+		std::vector<Ref<Material>> materials;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			materials.emplace_back(CreateRef<Material>());
+		}
+
+		return materials;
+	}
+
+	// The commands Submit creates, in submission order
+	std::vector<RenderCommand> CreateCommands(const Ref<Mesh>& mesh, const glm::mat4& transform)
+	{
+		std::vector<RenderCommand> commands;
+
+		for (const auto& subMesh : mesh->GetSubMeshes())
+		{
+			auto& cmd = commands.emplace_back();
+			cmd.mesh = mesh;
+			cmd.material = mesh->GetMaterial()->GetMaterials().at(subMesh.materialIndex);
+			cmd.subMesh = subMesh;
+			cmd.transform = transform;
+		}
+
+		return commands;
+	}
+
+	bool IsSameOrder(std::vector<RenderCommand>& lhs, std::vector<RenderCommand>& rhs)
+	{
+		if (lhs.size() != rhs.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < lhs.size(); i++)
+		{
+			if (lhs[i].mesh != rhs[i].mesh || !(lhs[i].subMesh == rhs[i].subMesh) || memcmp(&lhs[i].transform, &rhs[i].transform, sizeof(glm::mat4)) != 0)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Mirrors IsVisible in cull_cs.glsl
+	bool IsVisibleOnGPU(const CullData& cullData, const ObjectData& objectData, const glm::vec4& sphereBounds)
+	{
+		const glm::mat3x4& transform = objectData.transform;
+
+		const glm::vec3 axisX = glm::vec3(transform[0].x, transform[1].x, transform[2].x);
+		const glm::vec3 axisY = glm::vec3(transform[0].y, transform[1].y, transform[2].y);
+		const glm::vec3 axisZ = glm::vec3(transform[0].z, transform[1].z, transform[2].z);
+		const float maxScale = glm::sqrt(glm::max(glm::dot(axisX, axisX), glm::max(glm::dot(axisY, axisY), glm::dot(axisZ, axisZ))));
+
+		glm::vec3 center = glm::vec4(glm::vec3(sphereBounds), 1.f) * transform;
+		const float radius = sphereBounds.w * maxScale;
+
+		center = glm::vec3(cullData.view * glm::vec4(center, 1.f));
+
+		bool visible = true;
+		visible = visible && center.z * cullData.frustum[1] - glm::abs(center.x) * cullData.frustum[0] > -radius;
+		visible = visible && center.z * cullData.frustum[3] - glm::abs(center.y) * cullData.frustum[2] > -radius;
+
+		return visible || cullData.cullingEnabled == 0;
+	}
+
+	// Ground truth from the projection itself, the objects are points well away from the frustum planes
+	bool IsInsideFrustum(const Camera& camera, const glm::mat4& transform)
+	{
+		const glm::vec4 clip = camera.GetProjection() * camera.GetView() * transform[3];
+		return clip.w > 0.f && glm::abs(clip.x) < clip.w && glm::abs(clip.y) < clip.w;
+	}
+
+	// Position relative to the frustum edge at its depth, away from the edge in both directions
+	float GetFrustumFactor(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> insideDistribution{ -0.9f, 0.9f };
+		std::uniform_real_distribution<float> outsideDistribution{ 1.1f, 3.f };
+
+		if (random() % 4 == 0)
+		{
+			return outsideDistribution(random) * (random() % 2 == 0 ? 1.f : -1.f);
+		}
+
+		return insideDistribution(random);
+	}
+}
+
+LP_TEST(RenderCommands_QuarterMillionCommandsCullCorrectly)
+{
+	const Camera camera{ 60.f, 16.f / 9.f, 0.1f, 1000.f };
+	const float tanHalfFov = glm::tan(glm::radians(60.f) * 0.5f);
+
+	HeadlessRenderer renderer;
+
+	const std::vector<Ref<Material>> materials = CreateMaterials(4);
+	const std::vector<Ref<Mesh>> meshes = CreateMeshes(64, materials);
+
+	// Every thread submits its share through the renderer, which appends to the thread's own buffer
+	const auto submitStart = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::thread> threads;
+	for (uint32_t threadIndex = 0; threadIndex < SCENE_SUBMIT_THREAD_COUNT; threadIndex++)
+	{
+		threads.emplace_back([&, threadIndex]()
+		{
+			std::mt19937 random{ 1337 + threadIndex };
+			std::uniform_real_distribution<float> depthDistribution{ 1.f, 900.f };
+
+			for (uint32_t i = threadIndex; i < SCENE_SUBMIT_COUNT; i += SCENE_SUBMIT_THREAD_COUNT)
+			{
+				// A tenth of the objects is behind the camera
+				const float depth = depthDistribution(random);
+				const float z = random() % 10 == 0 ? depth : -depth;
+
+				const float x = GetFrustumFactor(random) * depth * camera.GetAspectRatio() * tanHalfFov;
+				const float y = GetFrustumFactor(random) * depth * tanHalfFov;
+
+				Renderer::Submit(meshes[i % meshes.size()], glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(x, y, z)), glm::vec3(0.5f + (float)(i % 4))));
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	Scope<FramePacket> packet = Renderer::TakeFramePacket();
+	std::vector<RenderCommand> renderCommands = std::move(packet->renderCommands);
+
+	const float submitMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - submitStart).count();
+	LP_TEST_CHECK(renderCommands.size() == SCENE_COMMAND_COUNT);
+
+	// The scene buffers grow to fit the frame before it is uploaded
+	Renderer::UpdateObjectCapacity((uint32_t)renderCommands.size());
+
+	const uint32_t objectCapacity = Renderer::GetStatistics().objectCapacity;
+	LP_TEST_CHECK(objectCapacity >= SCENE_COMMAND_COUNT && objectCapacity / 2 < SCENE_COMMAND_COUNT);
+
+	const auto uploadStart = std::chrono::high_resolution_clock::now();
+
+	std::vector<IndirectBatch> batches;
+	Renderer::PrepareForIndirectDraw(renderCommands, batches);
+
+	std::vector<GPUIndirectObject> drawCommands(objectCapacity);
+	std::vector<glm::vec4> meshBounds(objectCapacity);
+	std::vector<ObjectData> objectData(objectCapacity);
+	std::unordered_map<Mesh*, uint32_t> meshBoundsIndices;
+
+	Renderer::WriteRenderCommands(renderCommands, batches, meshBoundsIndices, drawCommands.data(), meshBounds.data(), objectData.data());
+
+	const float uploadMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - uploadStart).count();
+
+	LP_TEST_CHECK(meshBoundsIndices.size() == meshes.size());
+	LP_TEST_CHECK(batches.size() == meshes.size() * SUB_MESH_COUNT);
+
+	// Batches cover the sorted commands in order, one per mesh, material and sub mesh
+	uint32_t batchedCount = 0;
+	for (uint32_t batchIndex = 0; batchIndex < (uint32_t)batches.size(); batchIndex++)
+	{
+		const IndirectBatch& batch = batches[batchIndex];
+		LP_TEST_CHECK(batch.id == batchIndex && batch.first == batchedCount);
+
+		for (uint32_t i = batch.first; i < batch.first + batch.count; i++)
+		{
+			RenderCommand& cmd = renderCommands[i];
+			if (cmd.batchId != batch.id || cmd.mesh != batch.mesh || cmd.material != batch.material || !(cmd.subMesh == batch.subMesh))
+			{
+				LP_TEST_CHECK(false && "command does not match its batch");
+				break;
+			}
+		}
+
+		batchedCount += batch.count;
+	}
+
+	LP_TEST_CHECK(batchedCount == SCENE_COMMAND_COUNT);
+
+	// Cull and compact the way the compute shaders do, with every batch drawn by the pass
+	const CullData cullData = Renderer::CreateCullData(camera, SCENE_COMMAND_COUNT);
+
+	std::vector<uint32_t> batchCounts(batches.size(), 0);
+	std::vector<uint32_t> objectMap(objectCapacity, UINT32_MAX);
+
+	uint32_t visibleCount = 0;
+	uint32_t mismatchCount = 0;
+
+	for (uint32_t i = 0; i < SCENE_COMMAND_COUNT; i++)
+	{
+		const GPUIndirectObject& drawCommand = drawCommands[i];
+		const bool visible = IsVisibleOnGPU(cullData, objectData[drawCommand.objectId], meshBounds[drawCommand.boundsIndex]);
+
+		if (visible != IsInsideFrustum(camera, renderCommands[drawCommand.objectId].transform))
+		{
+			mismatchCount++;
+		}
+
+		if (visible)
+		{
+			const uint32_t drawIndex = batchCounts[drawCommand.batchId]++;
+			objectMap[drawCommand.command.firstInstance + drawIndex] = drawCommand.objectId;
+			visibleCount++;
+		}
+	}
+
+	LP_TEST_CHECK(mismatchCount == 0);
+	LP_TEST_CHECK(visibleCount > 0 && visibleCount < SCENE_COMMAND_COUNT);
+
+	// Every visible object is drawn exactly once, within its own batch
+	std::vector<bool> drawn(SCENE_COMMAND_COUNT, false);
+	uint32_t drawnCount = 0;
+
+	for (const IndirectBatch& batch : batches)
+	{
+		LP_TEST_CHECK(batchCounts[batch.id] <= batch.count);
+
+		for (uint32_t i = batch.first; i < batch.first + batchCounts[batch.id]; i++)
+		{
+			const uint32_t objectId = objectMap[i];
+			if (objectId >= SCENE_COMMAND_COUNT || drawn[objectId] || drawCommands[objectId].batchId != batch.id)
+			{
+				LP_TEST_CHECK(false && "object map entry is invalid");
+				break;
+			}
+
+			drawn[objectId] = true;
+			drawnCount++;
+		}
+	}
+
+	LP_TEST_CHECK(drawnCount == visibleCount);
+
+	std::cout << "    " << SCENE_COMMAND_COUNT << " commands in " << batches.size() << " batches, " << visibleCount << " visible" << std::endl;
+	std::cout << "    submit and merge: " << submitMilliseconds << " ms, batch and write: " << uploadMilliseconds << " ms" << std::endl;
+}
+
+LP_TEST(RenderCommands_MultiThreadedSubmitMergesDeterministically)
+{
+	HeadlessRenderer renderer;
+
+	const std::vector<Ref<Material>> materials = CreateMaterials(3);
+	const std::vector<Ref<Mesh>> meshes = CreateMeshes(16, materials);
+
+	// Some submissions share everything but their transform, some are identical
+	std::vector<std::pair<Ref<Mesh>, glm::mat4>> submissions;
+	std::vector<RenderCommand> expected;
+
+	for (uint32_t i = 0; i < SUBMIT_THREAD_COUNT * SUBMITS_PER_THREAD; i++)
+	{
+		const auto& [mesh, transform] = submissions.emplace_back(meshes[i % meshes.size()], glm::translate(glm::mat4(1.f), glm::vec3((float)(i % 97), 0.f, 0.f)));
+
+		const std::vector<RenderCommand> commands = CreateCommands(mesh, transform);
+		expected.insert(expected.end(), commands.begin(), commands.end());
+	}
+
+	Renderer::SortRenderCommands(expected);
+
+	std::mt19937 random{ 1337 };
+
+	for (uint32_t iteration = 0; iteration < 8; iteration++)
+	{
+		// Every thread submits a shuffled share, the threads register in whatever order they start
+		std::vector<uint32_t> order(submissions.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::shuffle(order.begin(), order.end(), random);
+
+		std::vector<std::thread> threads;
+		for (uint32_t threadIndex = 0; threadIndex < SUBMIT_THREAD_COUNT; threadIndex++)
+		{
+			threads.emplace_back([&, threadIndex]()
+			{
+				for (uint32_t i = threadIndex * SUBMITS_PER_THREAD; i < (threadIndex + 1) * SUBMITS_PER_THREAD; i++)
+				{
+					const auto& [mesh, transform] = submissions[order[i]];
+					Renderer::Submit(mesh, transform);
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		Scope<FramePacket> packet = Renderer::TakeFramePacket();
+		Renderer::SortRenderCommands(packet->renderCommands);
+
+		LP_TEST_CHECK(IsSameOrder(packet->renderCommands, expected));
+	}
+
+	// The buffers of the exited threads were dropped by the merges, nothing carries over
+	LP_TEST_CHECK(Renderer::TakeFramePacket()->renderCommands.empty());
+}
+
+LP_TEST(RenderCommands_GrowingPastTwentyThousandResizesAndRebinds)
+{
+	HeadlessRenderer renderer;
+
+	const std::vector<Ref<Material>> materials = CreateMaterials(2);
+	const std::vector<Ref<Mesh>> meshes = CreateMeshes(8, materials);
+
+	auto submitFrame = [&](uint32_t submitCount)
+	{
+		for (uint32_t i = 0; i < submitCount; i++)
+		{
+			Renderer::Submit(meshes[i % meshes.size()], glm::translate(glm::mat4(1.f), glm::vec3((float)i, 0.f, 0.f)));
+		}
+
+		// The way Begin sizes the buffers for the packet's commands
+		Scope<FramePacket> packet = Renderer::TakeFramePacket();
+		Renderer::UpdateObjectCapacity((uint32_t)packet->renderCommands.size());
+
+		return (uint32_t)packet->renderCommands.size();
+	};
+
+	const auto initialStats = Renderer::GetStatistics();
+	LP_TEST_CHECK(initialStats.objectCapacity == MIN_OBJECT_CAPACITY);
+
+	// Within the initial capacity nothing is reallocated or re-pointed
+	LP_TEST_CHECK(submitFrame(MIN_OBJECT_CAPACITY / SUB_MESH_COUNT) == MIN_OBJECT_CAPACITY);
+	LP_TEST_CHECK(Renderer::GetStatistics().sceneBufferResizes == 0);
+	LP_TEST_CHECK(Renderer::GetStatistics().bufferBindingRefreshes == 0);
+
+	// Past the old fixed limit of 20,000 objects the buffers grow once and everything bound to them is refreshed
+	constexpr uint32_t LARGE_SUBMIT_COUNT = 10500;
+	const uint32_t largeCommandCount = submitFrame(LARGE_SUBMIT_COUNT);
+	LP_TEST_CHECK(largeCommandCount == LARGE_SUBMIT_COUNT * SUB_MESH_COUNT && largeCommandCount > 20000);
+
+	const auto grownStats = Renderer::GetStatistics();
+	LP_TEST_CHECK(grownStats.objectCapacity >= largeCommandCount && grownStats.objectCapacity / 2 < largeCommandCount);
+	LP_TEST_CHECK(grownStats.sceneBufferResizes == 1);
+	LP_TEST_CHECK(grownStats.bufferBindingRefreshes == 1);
+
+	// The same frame again fits, so the buffers and their bindings stay
+	submitFrame(LARGE_SUBMIT_COUNT);
+	LP_TEST_CHECK(Renderer::GetStatistics().sceneBufferResizes == 1);
+	LP_TEST_CHECK(Renderer::GetStatistics().bufferBindingRefreshes == 1);
+}
+
+LP_TEST(RenderCommands_SixtyFourReservedViewsFitBeforeTheFrameBegins)
+{
+	HeadlessRenderer renderer;
+
+	constexpr uint32_t VIEW_COUNT = 64;
+	LP_TEST_CHECK(Renderer::GetStatistics().viewCapacity == MIN_VIEW_CAPACITY);
+
+	// BeginPass fails hard past the capacity, so the reservation has to grow the buffers for every view at once
+	Renderer::ReserveViews(VIEW_COUNT);
+	LP_TEST_CHECK(Renderer::GetStatistics().viewCapacity == VIEW_COUNT);
+	LP_TEST_CHECK(Renderer::GetStatistics().bufferBindingRefreshes == 1);
+
+	// Fewer views later on keep the buffers and their bindings
+	Renderer::ReserveViews(2);
+	Renderer::ReserveViews(VIEW_COUNT);
+	LP_TEST_CHECK(Renderer::GetStatistics().viewCapacity == VIEW_COUNT);
+	LP_TEST_CHECK(Renderer::GetStatistics().bufferBindingRefreshes == 1);
+}
+
+LP_TEST(RenderCommands_ThreadRegistersAgainForANewBufferSet)
+{
+	{
+		ThreadLocalBuffers<uint32_t> buffers;
+		buffers.Get().emplace_back(1);
+	}
+
+	// A recreated set, as after a renderer restart, must not see the buffer of the destroyed one
+	ThreadLocalBuffers<uint32_t> buffers;
+	buffers.Get().emplace_back(2);
+	buffers.Get().emplace_back(3);
+
+	std::vector<uint32_t> merged;
+	buffers.MoveInto(merged);
+
+	LP_TEST_CHECK(merged.size() == 2 && merged[0] == 2 && merged[1] == 3);
+	LP_TEST_CHECK(buffers.GetBufferCount() == 1);
+
+	// The buffer keeps its registration for the next frame
+	buffers.Get().emplace_back(4);
+	merged.clear();
+	buffers.MoveInto(merged);
+
+	LP_TEST_CHECK(merged.size() == 1 && merged[0] == 4);
+
+	// Buffers of threads which have exited are dropped once they have been merged
+	std::thread([&buffers]() { buffers.Get().emplace_back(5); }).join();
+	LP_TEST_CHECK(buffers.GetBufferCount() == 2);
+
+	merged.clear();
+	buffers.MoveInto(merged);
+
+	LP_TEST_CHECK(merged.size() == 1 && merged[0] == 5);
+	LP_TEST_CHECK(buffers.GetBufferCount() == 1);
+}
@@ -0,0 +1,82 @@
+#include "tspch.h"
+#include "Test.h"
+
+#include <Lamp/Asset/ResidencyManager.h>
+#include <Lamp/Asset/Mesh/Mesh.h>
+
+using namespace Lamp;
+
+namespace
+{
+	std::vector<Ref<Mesh>> RegisterMeshes(uint32_t count)
+	{
+		std::vector<Ref<Mesh>> meshes;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			Ref<Mesh> mesh = CreateRef<Mesh>();
+			mesh->path = "Tests/Mesh" + std::to_string(i) + ".lgf";
+
+			ResidencyManager::Register(mesh);
+			meshes.emplace_back(mesh);
+		}
+
+		return meshes;
+	}
+}
+
+LP_TEST(ResidencyManager_EvictsLeastRecentlyUsedFirst)
+{
+	ResidencyManager::Initialize();
+
+	// An explicit budget keeps the heap budgets, and with them the device, out of the update
+	ResidencyManager::SetBudget(std::numeric_limits<uint64_t>::max());
+
+	std::vector<Ref<Mesh>> meshes = RegisterMeshes(4);
+
+	ResidencyManager::Update(); // frame 1
+	for (const auto& mesh : meshes)
+	{
+		ResidencyManager::MarkUsed(*mesh);
+	}
+
+	ResidencyManager::Update(); // frame 2
+	ResidencyManager::MarkUsed(*meshes[2]);
+	ResidencyManager::MarkUsed(*meshes[0]);
+
+	ResidencyManager::Update(); // frame 3
+	ResidencyManager::MarkUsed(*meshes[0]);
+
+	ResidencyManager::Update();
+	ResidencyManager::Update();
+	ResidencyManager::Update(); // frame 6
+
+	LP_TEST_CHECK(ResidencyManager::GetCurrentFrame() == 6);
+
+	// Meshes last used in the same frame keep their registration order
+	{
+		const auto candidates = ResidencyManager::GetEvictionCandidates(2);
+		LP_TEST_CHECK(candidates.size() == 4);
+		LP_TEST_CHECK(candidates.size() == 4 && candidates[0] == meshes[1] && candidates[1] == meshes[3] && candidates[2] == meshes[2] && candidates[3] == meshes[0]);
+	}
+
+	// Meshes which frames in flight might still use are never candidates
+	{
+		const auto candidates = ResidencyManager::GetEvictionCandidates(3);
+		LP_TEST_CHECK(candidates.size() == 3);
+		LP_TEST_CHECK(std::find(candidates.begin(), candidates.end(), meshes[0]) == candidates.end());
+	}
+
+	// Released meshes drop out of the tracking on their own
+	meshes[1] = nullptr;
+	{
+		const auto candidates = ResidencyManager::GetEvictionCandidates(2);
+		LP_TEST_CHECK(candidates.size() == 3);
+		LP_TEST_CHECK(candidates.size() == 3 && candidates[0] == meshes[3]);
+	}
+
+	const auto stats = ResidencyManager::GetStatistics();
+	LP_TEST_CHECK(stats.residentMeshes == 3);
+	LP_TEST_CHECK(stats.frameEvictions == 0);
+
+	ResidencyManager::Shutdown();
+}
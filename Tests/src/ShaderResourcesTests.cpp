@@ -0,0 +1,286 @@
+#include "tspch.h"
+#include "Test.h"
+
+#include <Lamp/Rendering/Shader/Shader.h>
+
+#include <array>
+#include <chrono>
+#include <memory_resource>
+
+using namespace Lamp;
+
+using ShaderResources = Shader::ShaderResources;
+
+LP_TEST(ShaderResources_FindsResourcesByPackedKey)
+{
+	// Tables are kept sorted by key, as the shader reflection builds them
+	std::vector<Shader::UniformBuffer> uniformBuffers;
+	for (const auto& [set, binding] : std::vector<std::pair<uint32_t, uint32_t>>{ { 0, 0 }, { 0, 3 }, { 1, 0 }, { 1, 1 }, { 1, 2 }, { 3, 7 } })
+	{
+		auto& uniformBuffer = uniformBuffers.emplace_back();
+		uniformBuffer.key = ShaderResources::PackKey(set, binding);
+	}
+
+	LP_TEST_CHECK(ShaderResources::GetSet(ShaderResources::PackKey(3, 7)) == 3);
+	LP_TEST_CHECK(ShaderResources::GetBinding(ShaderResources::PackKey(3, 7)) == 7);
+
+	const Shader::UniformBuffer* found = ShaderResources::Find(uniformBuffers, 1, 1);
+	LP_TEST_CHECK(found == &uniformBuffers[3]);
+
+	LP_TEST_CHECK(ShaderResources::Find(uniformBuffers, 0, 1) == nullptr);
+	LP_TEST_CHECK(ShaderResources::Find(uniformBuffers, 2, 0) == nullptr);
+	LP_TEST_CHECK(ShaderResources::Find(uniformBuffers, 3, 8) == nullptr);
+
+	auto [setBegin, setEnd] = ShaderResources::FindSet(uniformBuffers, 1);
+	LP_TEST_CHECK(std::distance(setBegin, setEnd) == 3);
+	LP_TEST_CHECK(setBegin->key == ShaderResources::PackKey(1, 0));
+
+	auto [emptyBegin, emptyEnd] = ShaderResources::FindSet(uniformBuffers, 2);
+	LP_TEST_CHECK(emptyBegin == emptyEnd);
+}
+
+namespace
+{
+	// Counts the bytes allocated through it, so container memory can be measured without hooking the global allocator
+	class CountingResource : public std::pmr::memory_resource
+	{
+	public:
+		size_t allocatedBytes = 0;
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			allocatedBytes += bytes;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override
+		{
+			std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+
+	template<typename T>
+	using LegacyTable = std::pmr::map<uint32_t, std::pmr::map<uint32_t, T>>; // set -> binding -> resource
+
+	// The resource tables as they were before they were flattened, every material held one copy per frame in flight
+	struct LegacyShaderResources
+	{
+		LegacyShaderResources(std::pmr::memory_resource* resource)
+			: uniformBuffersInfos(resource), storageBuffersInfos(resource), imageInfos(resource), writeDescriptors(resource), dynamicBufferOffsets(resource)
+		{
+		}
+
+		LegacyTable<Shader::UniformBuffer> uniformBuffersInfos;
+		LegacyTable<Shader::ShaderStorageBuffer> storageBuffersInfos;
+		LegacyTable<Shader::SampledImage> imageInfos;
+		LegacyTable<VkWriteDescriptorSet> writeDescriptors;
+
+		std::pmr::map<uint32_t, std::pmr::vector<Shader::DynamicOffset>> dynamicBufferOffsets; // set -> offsets
+	};
+
+	// The state a material keeps per frame in flight now, the tables themselves live once in the shader
+	struct FlatMaterialState
+	{
+		FlatMaterialState(std::pmr::memory_resource* resource)
+			: frameDescriptorSets(resource), imageOverrides(resource)
+		{
+		}
+
+		std::pmr::vector<std::pmr::vector<VkDescriptorSet>> frameDescriptorSets;
+		std::pmr::unordered_map<uint64_t, VkDescriptorImageInfo> imageOverrides;
+	};
+
+	// Resembles the deferred geometry shaders: per frame buffers, dynamic per pass buffers and the material textures
+	struct BenchmarkBinding
+	{
+		uint32_t set;
+		uint32_t binding;
+		Shader::ResourceType type;
+		bool isDynamic;
+	};
+
+	const std::vector<BenchmarkBinding> s_benchmarkBindings
+	{
+		{ 0, 0, Shader::ResourceType::UniformBuffer, false },
+		{ 0, 1, Shader::ResourceType::UniformBuffer, false },
+		{ 0, 2, Shader::ResourceType::StorageBuffer, false },
+		{ 0, 3, Shader::ResourceType::StorageBuffer, false },
+		{ 1, 0, Shader::ResourceType::UniformBuffer, true },
+		{ 1, 1, Shader::ResourceType::UniformBuffer, true },
+		{ 1, 2, Shader::ResourceType::StorageBuffer, true },
+		{ 1, 3, Shader::ResourceType::StorageBuffer, true },
+		{ 3, 0, Shader::ResourceType::SampledImage, false },
+		{ 3, 1, Shader::ResourceType::SampledImage, false },
+		{ 3, 2, Shader::ResourceType::SampledImage, false },
+		{ 3, 3, Shader::ResourceType::SampledImage, false },
+		{ 3, 4, Shader::ResourceType::SampledImage, false },
+		{ 3, 5, Shader::ResourceType::SampledImage, false },
+	};
+
+	const std::vector<uint32_t> s_benchmarkSets{ 0, 1, 3 };
+}
+
+LP_TEST(ShaderResources_MaterialBindModel)
+{
+	// A model, not a measurement of Material::Bind: real materials need a device, so only the per material state and the offset lookups
+	// of the old and the new layout are rebuilt here. The Vulkan calls and the bound state filtering of Material::Bind are left out
+	constexpr uint32_t MATERIAL_COUNT = 5000;
+	constexpr uint32_t FRAMES_IN_FLIGHT = 3;
+	constexpr uint32_t PASS_INDEX = 2;
+	constexpr uint32_t DYNAMIC_OFFSET_SIZE = 256;
+
+	ShaderResources flatResources;
+	for (const auto& binding : s_benchmarkBindings)
+	{
+		const uint32_t key = ShaderResources::PackKey(binding.set, binding.binding);
+
+		auto& writeDescriptor = flatResources.writeDescriptors.emplace_back();
+		writeDescriptor.key = key;
+		writeDescriptor.type = binding.type;
+		writeDescriptor.setIndex = (uint32_t)std::distance(s_benchmarkSets.begin(), std::find(s_benchmarkSets.begin(), s_benchmarkSets.end(), binding.set));
+
+		switch (binding.type)
+		{
+			case Shader::ResourceType::UniformBuffer:
+				writeDescriptor.resourceIndex = (uint32_t)flatResources.uniformBuffersInfos.size();
+				flatResources.uniformBuffersInfos.emplace_back().key = key;
+				flatResources.uniformBuffersInfos.back().isDynamic = binding.isDynamic;
+				break;
+
+			case Shader::ResourceType::StorageBuffer:
+				writeDescriptor.resourceIndex = (uint32_t)flatResources.storageBuffersInfos.size();
+				flatResources.storageBuffersInfos.emplace_back().key = key;
+				flatResources.storageBuffersInfos.back().isDynamic = binding.isDynamic;
+				break;
+
+			default:
+				writeDescriptor.resourceIndex = (uint32_t)flatResources.imageInfos.size();
+				flatResources.imageInfos.emplace_back().key = key;
+				break;
+		}
+
+		if (binding.isDynamic)
+		{
+			flatResources.dynamicBufferOffsets.emplace_back(Shader::DynamicOffset{ DYNAMIC_OFFSET_SIZE, key });
+		}
+	}
+
+	CountingResource legacyMemory;
+	std::vector<std::vector<LegacyShaderResources>> legacyMaterials(MATERIAL_COUNT);
+
+	for (auto& frames : legacyMaterials)
+	{
+		for (uint32_t frame = 0; frame < FRAMES_IN_FLIGHT; frame++)
+		{
+			auto& resources = frames.emplace_back(&legacyMemory);
+			for (const auto& binding : s_benchmarkBindings)
+			{
+				switch (binding.type)
+				{
+					case Shader::ResourceType::UniformBuffer: resources.uniformBuffersInfos[binding.set][binding.binding].isDynamic = binding.isDynamic; break;
+					case Shader::ResourceType::StorageBuffer: resources.storageBuffersInfos[binding.set][binding.binding].isDynamic = binding.isDynamic; break;
+					default: resources.imageInfos[binding.set][binding.binding]; break;
+				}
+
+				resources.writeDescriptors[binding.set][binding.binding] = VkWriteDescriptorSet{};
+
+				if (binding.isDynamic)
+				{
+					resources.dynamicBufferOffsets[binding.set].emplace_back(Shader::DynamicOffset{ DYNAMIC_OFFSET_SIZE, binding.binding });
+				}
+			}
+		}
+	}
+
+	CountingResource flatMemory;
+	std::vector<FlatMaterialState> flatMaterials;
+	flatMaterials.reserve(MATERIAL_COUNT);
+
+	for (uint32_t material = 0; material < MATERIAL_COUNT; material++)
+	{
+		auto& state = flatMaterials.emplace_back(&flatMemory);
+		for (uint32_t frame = 0; frame < FRAMES_IN_FLIGHT; frame++)
+		{
+			auto& sets = state.frameDescriptorSets.emplace_back();
+			for (uint32_t setIndex = 0; setIndex < (uint32_t)s_benchmarkSets.size(); setIndex++)
+			{
+				sets.emplace_back((VkDescriptorSet)(uintptr_t)(material * 16 + setIndex + 1));
+			}
+		}
+	}
+
+	// Old layout: every set looked up its offsets in the nested map and gathered them into a new vector
+	uint64_t legacyChecksum = 0;
+	const auto legacyStart = std::chrono::high_resolution_clock::now();
+
+	for (const auto& frames : legacyMaterials)
+	{
+		const auto& resources = frames[1];
+		for (const uint32_t set : s_benchmarkSets)
+		{
+			std::vector<uint32_t> resultOffsets;
+			if (auto it = resources.dynamicBufferOffsets.find(set); it != resources.dynamicBufferOffsets.end())
+			{
+				for (const auto& offset : it->second)
+				{
+					resultOffsets.emplace_back(offset.offset * PASS_INDEX);
+				}
+			}
+
+			for (const uint32_t offset : resultOffsets)
+			{
+				legacyChecksum += offset;
+			}
+		}
+	}
+
+	const float legacyMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - legacyStart).count();
+
+	// New layout: the sets are bound as they are and the offsets come from the sorted shader table
+	uint64_t flatChecksum = 0;
+	const auto flatStart = std::chrono::high_resolution_clock::now();
+
+	for (const auto& state : flatMaterials)
+	{
+		const auto& sets = state.frameDescriptorSets[1];
+		for (uint32_t setIndex = 0; setIndex < (uint32_t)sets.size(); setIndex++)
+		{
+			if (!sets[setIndex])
+			{
+				continue;
+			}
+
+			std::array<uint32_t, 32> resultOffsets;
+			uint32_t offsetCount = 0;
+
+			const auto [begin, end] = ShaderResources::FindSet(flatResources.dynamicBufferOffsets, s_benchmarkSets[setIndex]);
+			for (auto it = begin; it != end; ++it)
+			{
+				resultOffsets[offsetCount++] = it->offset * PASS_INDEX;
+			}
+
+			for (uint32_t i = 0; i < offsetCount; i++)
+			{
+				flatChecksum += resultOffsets[i];
+			}
+		}
+	}
+
+	const float flatMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - flatStart).count();
+
+	const size_t legacyBytes = legacyMemory.allocatedBytes / MATERIAL_COUNT + sizeof(LegacyShaderResources) * FRAMES_IN_FLIGHT;
+	const size_t flatBytes = flatMemory.allocatedBytes / MATERIAL_COUNT + sizeof(FlatMaterialState);
+
+	std::cout << "    model of " << MATERIAL_COUNT << " materials, " << FRAMES_IN_FLIGHT << " frames in flight, not Material::Bind" << std::endl;
+	std::cout << "    nested maps model: " << legacyBytes << " bytes per material, " << legacyMilliseconds * 1000000.0f / MATERIAL_COUNT << " ns for the offsets of a material" << std::endl;
+	std::cout << "    flat tables model: " << flatBytes << " bytes per material, " << flatMilliseconds * 1000000.0f / MATERIAL_COUNT << " ns for the offsets of a material" << std::endl;
+
+	LP_TEST_CHECK(legacyChecksum == flatChecksum);
+	LP_TEST_CHECK(flatBytes < legacyBytes);
+}
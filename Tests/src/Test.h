@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+// Minimal test harness, every test registers itself before main runs. Checks may be used from any thread
+namespace Test
+{
+	struct TestCase
+	{
+		const char* name;
+		std::function<void()> function;
+	};
+
+	inline std::vector<TestCase>& GetTestCases()
+	{
+		static std::vector<TestCase> testCases;
+		return testCases;
+	}
+
+	inline std::atomic_uint32_t& GetFailureCount()
+	{
+		static std::atomic_uint32_t failureCount = 0;
+		return failureCount;
+	}
+
+	void ReportFailure(const char* expression, const char* file, int line);
+
+	struct Registrar
+	{
+		Registrar(const char* name, std::function<void()>&& function)
+		{
+			GetTestCases().emplace_back(TestCase{ name, std::move(function) });
+		}
+	};
+}
+
+#define LP_TEST(name) static void name(); static ::Test::Registrar name##Registrar{ #name, &name }; static void name()
+#define LP_TEST_CHECK(expression) if (!(expression)) { ::Test::ReportFailure(#expression, __FILE__, __LINE__); }
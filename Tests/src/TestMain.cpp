@@ -0,0 +1,45 @@
+#include "tspch.h"
+#include "Test.h"
+
+#include <Lamp/Log/Log.h>
+
+#include <chrono>
+#include <mutex>
+
+namespace Test
+{
+	static std::mutex s_reportMutex;
+
+	void ReportFailure(const char* expression, const char* file, int line)
+	{
+		std::scoped_lock lock{ s_reportMutex };
+
+		std::cout << "    " << file << "(" << line << "): check failed: " << expression << std::endl;
+		GetFailureCount()++;
+	}
+}
+
+int main()
+{
+	Lamp::Log::Initialize();
+
+	uint32_t failedTests = 0;
+	for (const auto& testCase : Test::GetTestCases())
+	{
+		const uint32_t failuresBefore = Test::GetFailureCount();
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		testCase.function();
+
+		const float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		const bool passed = Test::GetFailureCount() == failuresBefore;
+
+		std::cout << (passed ? "[PASS] " : "[FAIL] ") << testCase.name << " (" << milliseconds << " ms)" << std::endl;
+		failedTests += passed ? 0 : 1;
+	}
+
+	std::cout << Test::GetTestCases().size() - failedTests << "/" << Test::GetTestCases().size() << " tests passed" << std::endl;
+
+	Lamp::Log::Shutdown();
+	return failedTests > 0 ? 1 : 0;
+}
@@ -0,0 +1 @@
+#include "tspch.h"
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <set>
+
+#include <string>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <istream>
+
+#include <functional>
+#include <algorithm>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
\ No newline at end of file
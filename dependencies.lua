@@ -38,11 +38,14 @@ Library["ShaderC_Utils_Debug"] = "%{LibraryDir.VulkanSDK_Debug}/shaderc_utild.li
 Library["SPIRV_Cross_Debug"] = "%{LibraryDir.VulkanSDK_Debug}/spirv-cross-cored.lib"
 Library["SPIRV_Cross_GLSL_Debug"] = "%{LibraryDir.VulkanSDK_Debug}/spirv-cross-glsld.lib"
 Library["SPIRV_Tools_Debug"] = "%{LibraryDir.VulkanSDK_Debug}/SPIRV-Toolsd.lib"
+Library["SPIRV_Tools_Opt_Debug"] = "%{LibraryDir.VulkanSDK_Debug}/SPIRV-Tools-optd.lib"
 
 Library["ShaderC_Release"] = "%{LibraryDir.VulkanSDK}/shaderc_shared.lib"
 Library["ShaderC_Utils_Release"] = "%{LibraryDir.VulkanSDK}/shaderc_util.lib"
 Library["SPIRV_Cross_Release"] = "%{LibraryDir.VulkanSDK}/spirv-cross-core.lib"
 Library["SPIRV_Cross_GLSL_Release"] = "%{LibraryDir.VulkanSDK}/spirv-cross-glsl.lib"
+Library["SPIRV_Tools_Release"] = "%{LibraryDir.VulkanSDK}/SPIRV-Tools.lib"
+Library["SPIRV_Tools_Opt_Release"] = "%{LibraryDir.VulkanSDK}/SPIRV-Tools-opt.lib"
 
 Library["fbxsdk"] = "%{LibraryDir.fbxsdk}/libfbxsdk-md.lib"
 Library["libxml2"] = "%{LibraryDir.fbxsdk}/libxml2-md.lib"
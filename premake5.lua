@@ -31,4 +31,5 @@ include "Lamp"
 
 group ""
 include "Launcher"
-include "Sandbox"
\ No newline at end of file
+include "Sandbox"
+include "Tests"
\ No newline at end of file